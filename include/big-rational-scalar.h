@@ -1,5 +1,4 @@
-
-class big_rational : public Scalar
+class big_rational
 {
 	rational<bigint> r;
 	
@@ -8,28 +7,23 @@ class big_rational : public Scalar
 		big_rational():r(){}
 		big_rational(int a):r(bigint(a)){}
 		
-		big_rational* plus_eq (Scalar* a) {big_rational* ptr = dynamic_cast<big_rational*>(a); r+=ptr->r; return this;}
-		big_rational* minus_eq (Scalar* a) {big_rational* ptr = dynamic_cast<big_rational*>(a); r-=ptr->r; return this;}
-		big_rational* times_eq (Scalar* a) {big_rational* ptr = dynamic_cast<big_rational*>(a); r*=ptr->r; return this;}
-		big_rational* divide_eq (Scalar* a) {big_rational* ptr = dynamic_cast<big_rational*>(a); r/=ptr->r; return this;}
-		big_rational* remainder_eq (Scalar* a) {r=bigint(0); return this;}
-		bool eq (Scalar* a) const {big_rational* ptr = dynamic_cast<big_rational*>(a); return r == ptr->r;}
-		bool ne (Scalar* a) const {big_rational* ptr = dynamic_cast<big_rational*>(a); return r != ptr->r;}
-		bool gt (Scalar* a) const {big_rational* ptr = dynamic_cast<big_rational*>(a); return r > ptr->r;}
-		bool lt (Scalar* a) const {big_rational* ptr = dynamic_cast<big_rational*>(a); return r < ptr->r;}
-		bool ge (Scalar* a) const {big_rational* ptr = dynamic_cast<big_rational*>(a); return r >= ptr->r;}
-		bool le (Scalar* a) const {big_rational* ptr = dynamic_cast<big_rational*>(a); return r <= ptr->r;}
+		void plus_eq (const big_rational& a) {r+=a.r;}
+		void minus_eq (const big_rational& a) {r-=a.r;}
+		void times_eq (const big_rational& a) {r*=a.r;}
+		void divide_eq (const big_rational& a) {r/=a.r;}
+		void remainder_eq (const big_rational& a) {r=bigint(0);}
+		bool eq (const big_rational& a) const {return r == a.r;}
+		bool gt (const big_rational& a) const {return r > a.r;}
+		bool lt (const big_rational& a) const {return r < a.r;}
 
-		big_rational* abs_val() { big_rational* result = new big_rational(*this); result->r = abs(result->r); return result;}
+		void abs_val() {r = abs(r);}
 		void increment() {}
 		void decrement() {}
 		void read(istream& s) {s >> r;}
-		void print (ostream& s) {s << r;}
-		int nl() {return num_len(r);}
+		void print (ostream& s) const {s << r;}
+		int nl() const {return num_len(r);}
 		void dump(ostream& s) const;
 		void sanitize() {}
-		
-		big_rational* clone() {return new big_rational(*this);}	
 };
 
 inline void big_rational::dump(ostream& s) const
@@ -43,4 +37,3 @@ inline void big_rational::dump(ostream& s) const
 	bd.dump(s);
 	s << endl;
 }
-
@@ -1,5 +1,4 @@
-
-class bigint_scalar : public Scalar
+class bigint_scalar
 {
 	bigint n;
 	
@@ -8,27 +7,21 @@ class bigint_scalar : public Scalar
 		bigint_scalar():n(){}
 		bigint_scalar(int a):n(bigint(a)){}
 		
-		bigint_scalar* plus_eq (Scalar* a) {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); n+=ptr->n; return this;}
-		bigint_scalar* minus_eq (Scalar* a) {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); n-=ptr->n; return this;}
-		bigint_scalar* times_eq (Scalar* a) {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); n*=ptr->n; return this;}
-		bigint_scalar* divide_eq (Scalar* a) {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); n/=ptr->n; return this;}
-		bigint_scalar* remainder_eq (Scalar* a) {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); n%=ptr->n; return this;}
-		bool eq (Scalar* a) const {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); return n == ptr->n;}
-		bool ne (Scalar* a) const {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); return n != ptr->n;}
-		bool gt (Scalar* a) const {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); return n > ptr->n;}
-		bool lt (Scalar* a) const {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); return n < ptr->n;}
-		bool ge (Scalar* a) const {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); return n >= ptr->n;}
-		bool le (Scalar* a) const {bigint_scalar* ptr = dynamic_cast<bigint_scalar*>(a); return n <= ptr->n;}
+		void plus_eq (const bigint_scalar& a) {n+=a.n;}
+		void minus_eq (const bigint_scalar& a) {n-=a.n;}
+		void times_eq (const bigint_scalar& a) {n*=a.n;}
+		void divide_eq (const bigint_scalar& a) {n/=a.n;}
+		void remainder_eq (const bigint_scalar& a) {n%=a.n;}
+		bool eq (const bigint_scalar& a) const {return n == a.n;}
+		bool gt (const bigint_scalar& a) const {return n > a.n;}
+		bool lt (const bigint_scalar& a) const {return n < a.n;}
 
-		bigint_scalar* abs_val() {bigint_scalar* result = new bigint_scalar(*this); result->n = abs(result->n); return result;}
+		void abs_val() {n = abs(n);}
 		void increment() {n++;}
 		void decrement() {n--;}
 		void read(istream& s) {s >> n;}
-		void print (ostream& s) {s << n;}
-		int nl() {return num_len(n);}
+		void print (ostream& s) const {s << n;}
+		int nl() const {return num_len(n);}
 		void dump(ostream& s) const {n.dump(s);}
 		void sanitize() {n.sanitize();}
-		
-		bigint_scalar* clone() {return new bigint_scalar(*this);}	
 };
-
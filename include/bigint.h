@@ -2,49 +2,49 @@
 			   bigint
 	       A. Bartholomew 2nd October 2005
 
-    bigint numbers are groups of 8 unsigned int values with
-    operators carrying out the arithmetic 'long hand'.  The four numbers
-    represents digits modulo 2^16, since 2^16 - 1 is the largest
-    number whose square may be stored in an unsigned long.
-
-    The digits are stored in reverse order, so array element i represents
-    the ith power of 2^16.
-
-    The sign is taken care of separately with a flag.
+    bigint numbers are held as a sign flag and a magnitude made up of
+    64-bit limbs.  The limbs are stored in reverse order, so limb i
+    represents the ith power of 2^64, and products and carries of limbs
+    are evaluated using unsigned __int128.
 
+    A magnitude that fits in a single limb is held inline, in small, and
+    the vector n is then empty, so the small values that make up most of
+    the programme's arithmetic never allocate memory.  Otherwise n holds
+    at least two limbs and its most significant limb is non-zero.  Zero
+    is never negative.
 
 ***********************************************************************/
 
-/* 
-This class assumes a 32-bit architecture.  If a 64 bit architecture is used
-in the future, the bigint constructors from const int and const unsigned long should be changed
-or BASE redefined to accommodate the larger architecture.  Currently these constructors assume that an
-unsigned long cannot be larger than BASE^2 -1
-*/
-
-#define BASE 65536
-#define MAX_DIGIT 65535
-#define BIGINT_MSB 0x8000
-#define BIGINT_BITS 0xFFFF
-
 #include <vector>
 
 class bigint
 {
-    vector<unsigned int> n;
+public:
+	typedef unsigned long long limb;
+
+private:
+	limb small;
+    vector<limb> n;
     bool negative;
-	
+
+	size_t size() const {return n.empty()? 1: n.size();}
+	const limb* limbs() const {return n.empty()? &small: &n[0];}
+	void assign(const limb* a, size_t length);
+
+	static int compare(const bigint& a, const bigint& b);
+	static void accumulate(bigint& a, const bigint& b, bool subtract);
+	static void divide(const bigint& a, const bigint& b, bigint* quotient, bigint* remainder);
+
 public:
-	
-//    bigint():n(1) {negative = false;}
-    bigint():n(1,0),negative(false){}
-    bigint(const int num);
-    bigint(const unsigned long num);
-	
+
+    bigint():small(0),negative(false){}
+    bigint(const int num):small(num < 0? 0ULL-static_cast<limb>(num): static_cast<limb>(num)),negative(num < 0){}
+    bigint(const unsigned long num):small(num),negative(false){}
+
 	operator int(); // conversion operator to an int
 	operator bool(); // conversion operator to a bool
 
-	bool even() const {return !(n[0]%2);}
+	bool even() const {return !(limbs()[0]%2);}
 
     bigint& operator ++ (); //prefix
     bigint operator ++ (int); //postfix
@@ -53,17 +53,17 @@ public:
 
 	void dump(ostream& s) const;
 	void sanitize();
-	
+
 	friend void sum(bigint& result,const bigint& a, const bigint& b);
 	friend void diff(bigint& result,const bigint& a, const bigint& b);
 
-    friend bigint operator += (bigint& a, const bigint& b);
-    friend bigint operator -= (bigint& a, const bigint& b);
-    friend bigint operator *= (bigint& a, const bigint& b);
-    friend bigint operator /= (bigint& a, const bigint& b);
-    friend bigint operator %= (bigint& a, const bigint& b);
-	friend bigint operator >>= (bigint& a, int n);
-	friend bigint operator <<= (bigint& a, int n);
+    friend bigint& operator += (bigint& a, const bigint& b);
+    friend bigint& operator -= (bigint& a, const bigint& b);
+    friend bigint& operator *= (bigint& a, const bigint& b);
+    friend bigint& operator /= (bigint& a, const bigint& b);
+    friend bigint& operator %= (bigint& a, const bigint& b);
+	friend bigint& operator >>= (bigint& a, int n);
+	friend bigint& operator <<= (bigint& a, int n);
     friend bigint operator + (const bigint& a, const bigint& b);
     friend bigint operator - (const bigint& a, const bigint& b);
     friend bigint operator * (const bigint& a, const bigint& b);
@@ -89,7 +89,7 @@ struct bigint_control
 	enum parameters
 	{
 		general = 	0x00000001, // unused
-		sanitize =  0x00000002, 
+		sanitize =  0x00000002,
 		add = 		0x00000004,
 		subtract = 	0x00000008,
 		multiply = 	0x00000010,
@@ -64,6 +64,7 @@ struct braid_control
 	static bool		MANTUROV_ALEXANDER;
 	static bool		MATRIX;
 	static bool		MOCK_ALEXANDER;
+	static bool		MODULAR_HOMOLOGY;
 	static bool     NORMALIZING_Q_POLYNOMIALS;
 	static bool		NORMALIZE_BRACKET;
 	static bool		NUMERATOR_GCD;
@@ -118,6 +119,9 @@ struct braid_control
 
 	static int 		REMOVE_COMPONENT; // used to identify a component of a peer code to be removed
 	static int		SWITCH_POWER; // used to control whether powers of switches are calculated.
+	static int		BRACKET_ENGINE; // the method used to evaluate the Kauffman bracket state sum
+	static int		HOMOLOGY_ENGINE; // dense or sparse boundary maps for homology generators, dense unless requested
+	static int		COLOURING_ENGINE; // the method used to enumerate colourings by a finite switch
 	
 	static int		HC_INCLUDE_EDGE; // used by hamiltonian_circuit if we are to include a specific edge in the circuit.
 
@@ -135,11 +139,14 @@ struct braid_control
 
 	static bool VOGEL_DEBUG;
 	
+	static int num_threads; // number of worker threads
 	static int wait_threshold;
 	static int wait_count;
 	static int reset_count; // number of times wait_count has reached wait_threshold
 	static int birack_poly_writhe_limit; // determined the number of terms calculated for the COCYCLE_INVARIANT birack polynomial
 	static int homology_index; // determines the value of k when calculating H_k or H^k
+	static int homfly_cache_limit; // maximum number of polynomials recorded in the HOMFLY transposition table, zero disables the table
+	static int canonical_cache_limit; // maximum number of left and over preferred Gauss codes recorded in their caches, zero disables the caches
 
 	/* ST_pair_type is an enumeration of the type of pairs of finite switches S and T */
 	enum class ST_pair_type {FLAT_ESSENTIAL_VIRTUAL, ESSENTIAL_VIRTUAL, ESSENTIAL_WELDED, ESSENTIAL_DOODLE};
@@ -147,5 +154,9 @@ struct braid_control
 //	enum infinity {LEGACY_DIAGONAL, FIXED_WRITHE, FIXED_TURNING, WRITHE_ONLY, WRITHE_CYCLE};
 	
 	enum cycle {BRAID_RTC=-2, UNSPECIFIED=-1};
+	
+	enum bracket_engine {AUTOMATIC, STATE_SUM, TANGLE};
+	enum homology_engine {BY_SIZE, DENSE, SPARSE};
+	enum colouring_engine {PROPAGATE, EXHAUSTIVE};
 };
 
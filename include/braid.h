@@ -6,6 +6,9 @@ used by the programme
 #include <hash-defs.h>
 #include <braid-control.h>
 #include <debug-control.h>
+#include <modular.h>
+#include <colouring-search.h>
+#include <functional>
 //#include <braid-util.h>
 //#include <generic-code.h>
 
@@ -27,6 +30,8 @@ public:
 	int num_cocycle_invariants;
 //	vector<polynomial<int> > cocycle_invariant;
 	vector<Cpolynomial> cocycle_invariant;
+	vector<int> image_size_count; // sizes of the smallest parent biracks of the colourings, recorded only when evaluated in advance
+	string batch_output; // output produced by a colouring evaluated in advance, written when the colouring is retrieved
 
 	colouring_data():num_fixed_points(0), num_cocycle_invariants(0){}
 };
@@ -50,14 +55,46 @@ public:
 	list<string> cocycle_string; 
 	list<vector<scalar> > cocycle_scalar; 
 	vector<int> chain_map;  // maps n-tuples to non-degenerate n-tuples for use with the cocycle invariant.
+
+	/* With the threads option, batch_colouring_invariant evaluates the colourings required for a switch in advance.  While batch_recording
+	   is set the colourings requested by colouring_invariant are recorded in batch_request rather than evaluated, batch_evaluating is set
+	   while worker threads evaluate them and the results are held in batch_colourings until colouring_invariant retrieves them.
+	*/
+	bool batch_recording;
+	bool batch_evaluating;
+	map<string,function<colouring_data()> > batch_request;
+	map<string,colouring_data> batch_colourings;
 	
-	generic_switch_data():title(""), definition(""),size(0),num_chain_generators(0),cocycles_calculated(false),biquandle(false){}
-	generic_switch_data(string t,string s): title(t), definition(s),size(0),num_chain_generators(0),cocycles_calculated(false),biquandle(false){}
+	generic_switch_data():title(""), definition(""),size(0),num_chain_generators(0),cocycles_calculated(false),biquandle(false),
+	                      batch_recording(false),batch_evaluating(false){}
+	generic_switch_data(string t,string s): title(t), definition(s),size(0),num_chain_generators(0),cocycles_calculated(false),biquandle(false),
+	                      batch_recording(false),batch_evaluating(false){}
 	
 };
 
 void print_switch_data(ostream& s, generic_switch_data& switch_data, string prefix="");
 
+/* batch_switch_data records the switch (S,T) determined for the switch at index in the switch_cache, so that the colourings of several 
+   switches may be evaluated together by batch_colouring_invariant.
+*/
+class batch_switch_data
+{
+public:
+	unsigned int index;
+	matrix<int> Su;
+	matrix<int> Sd;
+	matrix<int> invSu;
+	matrix<int> invSd;
+	matrix<int> Tu;
+	matrix<int> Td;
+	braid_control::ST_pair_type pair_type;
+	
+	batch_switch_data(unsigned int s, matrix<int>& su, matrix<int>& sd, matrix<int>& isu, matrix<int>& isd, matrix<int>& tu, matrix<int>& td, 
+	                  braid_control::ST_pair_type p): index(s), Su(su), Sd(sd), invSu(isu), invSd(isd), Tu(tu), Td(td), pair_type(p) {}
+};
+
+bool batch_colouring_data(generic_switch_data& switch_data, string key, int n, function<colouring_data()> evaluate, colouring_data& result);
+
 template <class T> class Rational : public rational<T>
 {
 public:
@@ -362,3 +399,378 @@ if (rational_control::DEBUG)
 	return result;
 }
 
+
+/* polynomial determinant specializations
+
+   Matrices of commutative polynomials with scalar coefficients may be evaluated by modular evaluation and interpolation or by 
+   Bareiss' fraction-free elimination, as determined by select_determinant_algorithm.  The polynomial division used by Bareiss' 
+   algorithm does not support Laurent polynomials, so laurent_bareiss_determinant first multiplies each row by a monomial that clears any negative exponents from that row 
+   and then divides the result by the product of these monomials.  Matrices with quaternionic entries are not commutative and 
+   always use the cofactor expansion in immanant.
+*/
+template <typename V, typename E> polynomial<scalar,V,E> laurent_bareiss_determinant (const matrix<polynomial<scalar,V,E>,scalar>& M, string title, int n, const vector<int>& rperm, const vector<int>& cperm)
+{
+	matrix<polynomial<scalar,V,E>,scalar> A(n,n);
+	map<char,E> determinant_shift;
+	
+	for (int i=0; i< n; i++)
+	{
+		map<char,E> row_shift;
+		for (int j=0; j< n; j++)
+		{
+			const polynomial<scalar,V,E>& entry = M[rperm[i]][cperm[j]];
+			typename list<pterm<scalar,E> >::const_iterator pterm_ptr = entry.pt.begin();
+			while (pterm_ptr != entry.pt.end())
+			{
+				typename map<char,E>::const_iterator mptr = pterm_ptr->e.begin();
+				while (mptr != pterm_ptr->e.end())
+				{
+					if (mptr->second < E(0) && (row_shift.find(mptr->first) == row_shift.end() || mptr->second < row_shift[mptr->first]))
+						row_shift[mptr->first] = mptr->second;
+					mptr++;
+				}
+				pterm_ptr++;
+			}
+		}
+
+		if (row_shift.size())
+		{
+			ostringstream oss;
+			typename map<char,E>::iterator mptr = row_shift.begin();
+			while (mptr != row_shift.end())
+			{
+				oss << mptr->first << '^' << -mptr->second;
+				determinant_shift[mptr->first] += mptr->second;
+				mptr++;
+			}
+			
+			polynomial<scalar,V,E> row_monomial(oss.str());
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+	debug << "laurent_bareiss_determinant: multiplying row " << i << " by " << row_monomial << endl;
+
+			for (int j=0; j< n; j++)
+				A[i][j] = M[rperm[i]][cperm[j]] * row_monomial;
+		}
+		else
+		{
+			for (int j=0; j< n; j++)
+				A[i][j] = M[rperm[i]][cperm[j]];
+		}
+	}
+	
+	polynomial<scalar,V,E> det = bareiss_determinant(A, title, 0, vector<int>(0), vector<int>(0));
+	
+	if (determinant_shift.size() && det.non_zero())
+	{
+		ostringstream oss;
+		typename map<char,E>::iterator mptr = determinant_shift.begin();
+		while (mptr != determinant_shift.end())
+		{
+			oss << mptr->first << '^' << mptr->second;
+			mptr++;
+		}
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+	debug << "laurent_bareiss_determinant: multiplying Bareiss determinant " << det << " by " << oss.str() << endl;
+
+		det *= polynomial<scalar,V,E>(oss.str());
+	}
+	
+	return det;
+}
+
+/* modular_laurent_determinant evaluates the determinant of the sub-matrix of M determined by rperm and cperm by evaluating the 
+   matrix at enough points modulo enough primes for modular_polynomial_determinant to reconstruct the determinant by interpolation
+   and the Chinese remainder theorem.  As in laurent_bareiss_determinant we first clear any negative exponents by multiplying each 
+   row by a monomial.  When we are working mod p the determinant is evaluated modulo p itself, which requires p to exceed the degree
+   bounds.  The function returns false if the matrix cannot be evaluated in this way, because the polynomials use mapped variables, 
+   a coefficient is not an integer, there are too few residues mod p, or the evaluation would be too large.  The evaluations are 
+   shared between num_threads worker threads.
+*/
+template <typename V, typename E> bool modular_laurent_determinant (const matrix<polynomial<scalar,V,E>,scalar>& M, int n, const vector<int>& rperm, const vector<int>& cperm, polynomial<scalar,V,E>& det, int num_threads)
+{
+	unsigned int modulus = (scalar::variant == scalar::MOD_P? mod_p::get_p() : 0);
+		
+	vector<char> variable;
+	for (int i=0; i< n; i++)
+	for (int j=0; j< n; j++)
+	{
+		const polynomial<scalar,V,E>& entry = M[rperm[i]][cperm[j]];
+		if (entry.vm.size())
+			return false;
+		variable.insert(variable.end(),entry.vc.begin(),entry.vc.end());
+	}
+	sort(variable.begin(),variable.end());
+	variable.erase(unique(variable.begin(),variable.end()),variable.end());
+	int num_variables = variable.size();
+	
+	vector<vector<modular_term> > modular_entry(n*n);
+	vector<int> determinant_shift(num_variables,0);
+	
+	for (int i=0; i< n; i++)
+	{
+		vector<int> row_shift(num_variables,0);
+		for (int j=0; j< n; j++)
+		{
+			const polynomial<scalar,V,E>& entry = M[rperm[i]][cperm[j]];
+			typename list<pterm<scalar,E> >::const_iterator pterm_ptr = entry.pt.begin();
+			while (pterm_ptr != entry.pt.end())
+			{
+				modular_term term;
+				ostringstream oss;
+				oss << pterm_ptr->n;
+				term.coefficient = oss.str();
+				term.exponent = vector<int>(num_variables,0);
+				
+				typename map<char,E>::const_iterator mptr = pterm_ptr->e.begin();
+				while (mptr != pterm_ptr->e.end())
+				{
+					int v = find(variable.begin(),variable.end(),mptr->first) - variable.begin();
+					term.exponent[v] = mptr->second;
+					row_shift[v] = min(row_shift[v],term.exponent[v]);
+					mptr++;
+				}
+				
+				modular_entry[i*n+j].push_back(term);
+				pterm_ptr++;
+			}
+		}
+		
+		for (int v=0; v< num_variables; v++)
+		{
+			determinant_shift[v] += row_shift[v];
+			for (int j=0; j< n; j++)
+			{
+				for (size_t t=0; t< modular_entry[i*n+j].size(); t++)
+					modular_entry[i*n+j][t].exponent[v] -= row_shift[v];
+			}
+		}
+	}
+
+	vector<int> degree;
+	vector<string> coefficient;
+	if (!modular_polynomial_determinant(modular_entry, n, num_variables, degree, coefficient, num_threads, modulus))
+		return false;
+	
+	vector<pterm<scalar,E> > terms;
+	for (size_t g=0; g< coefficient.size(); g++)
+	{
+		if (coefficient[g] == "0")
+			continue;
+			
+		pterm<scalar,E> term;
+		if (coefficient[g].length() < 10)
+		{
+			term.n = scalar(atoi(coefficient[g].c_str()));
+		}
+		else
+		{
+			istringstream iss(coefficient[g]);
+			iss >> term.n;
+		}
+		
+		long index = g;
+		for (int v=num_variables-1; v>= 0; v--)
+		{
+			int exponent = index % (degree[v]+1) + determinant_shift[v];
+			index /= degree[v]+1;
+			
+			if (exponent != 0)
+				term.e[variable[v]] = exponent;
+		}
+		
+		terms.push_back(term);
+	}
+	
+	det = polynomial<scalar,V,E>();
+	det.nv = num_variables;
+	det.vc = variable;
+	polynomial<scalar,V,E>::accumulate_pterms(det,terms);
+	sanitize(det);
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+	debug << "modular_laurent_determinant: determinant = " << det << endl;
+
+	return true;
+}
+
+template <typename V, typename E> polynomial<scalar,V,E> determinant (const matrix<polynomial<scalar,V,E>,scalar>& M, string title="untitled", int n=0, vector<int> rperm=vector<int>(0), vector<int> cperm=vector<int>(0), int num_threads=braid_control::num_threads)
+{
+	if (rperm.size() == 0)
+	{
+		n = M.numcols();
+		rperm = vector<int>(M.numrows());
+		for (size_t i=0; i< M.numrows(); i++)
+			rperm[i] = i;
+		cperm = vector<int>(n);
+		for (int i=0; i< n; i++)
+			cperm[i] = i;
+	}
+
+	int algorithm = select_determinant_algorithm(M, n, rperm, cperm);
+	
+	if (algorithm == matrix_control::modular)
+	{
+		polynomial<scalar,V,E> det;
+		if (modular_laurent_determinant(M, n, rperm, cperm, det, num_threads))
+			return det;
+		
+		algorithm = matrix_control::bareiss;
+	}
+	
+	if (algorithm == matrix_control::bareiss)
+		return laurent_bareiss_determinant(M, title, n, rperm, cperm);
+	else
+		return immanant (M, title, n, rperm, cperm, false); // permanent = false
+}
+
+/* Rational polynomial matrices are evaluated by the polynomial determinant only if every entry has a unit denominator, as is the 
+   case for the matrix representations of braids, otherwise the cofactor expansion is used.
+*/
+template <typename V, typename E> Rational<polynomial<scalar,V,E> > determinant (const matrix<Rational<polynomial<scalar,V,E> >,scalar>& M, string title="untitled", int n=0, vector<int> rperm=vector<int>(0), vector<int> cperm=vector<int>(0), int num_threads=braid_control::num_threads)
+{
+	if (rperm.size() == 0)
+	{
+		n = M.numcols();
+		rperm = vector<int>(M.numrows());
+		for (size_t i=0; i< M.numrows(); i++)
+			rperm[i] = i;
+		cperm = vector<int>(n);
+		for (int i=0; i< n; i++)
+			cperm[i] = i;
+	}
+
+	if (select_determinant_algorithm(M, n, rperm, cperm) != matrix_control::expansion)
+	{
+		matrix<polynomial<scalar,V,E>,scalar> numerator(n,n);
+		bool unit_denominators = true;
+		
+		for (int i=0; i< n && unit_denominators; i++)
+		for (int j=0; j< n; j++)
+		{
+			Rational<polynomial<scalar,V,E> > entry = M[rperm[i]][cperm[j]];
+			if (!entry.getd().is_one())
+			{
+				unit_denominators = false;
+				break;
+			}
+			numerator[i][j] = entry.getn();
+		}
+		
+		if (unit_denominators)
+		{
+			return Rational<polynomial<scalar,V,E> >(determinant(numerator, title, n, vector<int>(0), vector<int>(0), num_threads));
+		}
+	}
+	
+	return immanant (M, title, n, rperm, cperm, false); // permanent = false
+}
+
+/* modular_minor_matrix and modular_minor_multiple support the pruning of minors in delta_1.  The first converts the matrix M, in 
+   which delta_1 has set s=1, into modular_terms and returns false unless every entry is a polynomial in a single variable, which 
+   is returned in variable, over the rationals.  The second determines whether
+   the determinant of the minor of this image determined by rperm and cperm is provably a multiple of hcf with larger span, in which 
+   case gcd(hcf,delta) returns hcf itself and the minor may be skipped, using num_threads worker threads.  Other types of matrix are 
+   never pruned.
+*/
+template <typename T, typename St> bool modular_minor_matrix (const matrix<T,St>& M, vector<vector<modular_term> >& entry, char& variable)
+{
+	return false;
+}
+
+template <typename V, typename E> bool modular_minor_matrix (const matrix<polynomial<scalar,V,E>,scalar>& M, vector<vector<modular_term> >& entry, char& variable)
+{
+	if (scalar::variant != scalar::RATIONAL && scalar::variant != scalar::BIGRATIONAL)
+		return false;
+		
+	int rows = M.numrows();
+	int cols = M.numcols();
+	entry = vector<vector<modular_term> >(rows*cols);
+	variable = 0;
+	
+	for (int i=0; i< rows; i++)
+	for (int j=0; j< cols; j++)
+	{
+		const polynomial<scalar,V,E>& poly = M[i][j];
+		if (poly.vm.size())
+			return false;
+
+		typename list<pterm<scalar,E> >::const_iterator pterm_ptr = poly.pt.begin();
+		while (pterm_ptr != poly.pt.end())
+		{
+			modular_term term;
+			ostringstream oss;
+			oss << pterm_ptr->n;
+			term.coefficient = oss.str();
+			term.exponent = vector<int>(1,0);
+			
+			if (pterm_ptr->e.size() > 1)
+				return false;
+			else if (pterm_ptr->e.size() == 1)
+			{
+				if (variable == 0)
+					variable = pterm_ptr->e.begin()->first;
+				else if (pterm_ptr->e.begin()->first != variable)
+					return false;
+					
+				term.exponent[0] = pterm_ptr->e.begin()->second;
+			}
+			
+			entry[i*cols+j].push_back(term);
+			pterm_ptr++;
+		}
+	}
+	
+	return true;
+}
+
+template <typename T> bool modular_minor_multiple (const vector<vector<modular_term> >& entry, int cols, char variable, int n, const vector<int>& rperm, const vector<int>& cperm, const T& hcf, int num_threads)
+{
+	return false;
+}
+
+template <typename V, typename E> bool modular_minor_multiple (const vector<vector<modular_term> >& entry, int cols, char variable, int n, const vector<int>& rperm, const vector<int>& cperm, const polynomial<scalar,V,E>& hcf, int num_threads)
+{
+	if (hcf.is_zero() || hcf.vm.size() || hcf.nv > 1 || (hcf.nv == 1 && hcf.vc[0] != variable))
+		return false;
+	
+	/* hcf has been Laurent scaled, so its exponents are non-negative */
+	vector<string> divisor;
+	typename list<pterm<scalar,E> >::const_iterator pterm_ptr = hcf.pt.begin();
+	while (pterm_ptr != hcf.pt.end())
+	{
+		int exponent = (pterm_ptr->e.size()? pterm_ptr->e.begin()->second: 0);
+		if (exponent < 0)
+			return false;
+		if (exponent >= static_cast<int>(divisor.size()))
+			divisor.resize(exponent+1,"0");
+			
+		ostringstream oss;
+		oss << pterm_ptr->n;
+		divisor[exponent] = oss.str();
+		pterm_ptr++;
+	}
+	
+	/* shift each row of the minor so that its exponents are non-negative */
+	vector<vector<modular_term> > minor(n*n);
+	for (int i=0; i< n; i++)
+	{
+		int row_shift = 0;
+		for (int j=0; j< n; j++)
+		{
+			const vector<modular_term>& terms = entry[rperm[i]*cols+cperm[j]];
+			for (size_t t=0; t< terms.size(); t++)
+				row_shift = min(row_shift,terms[t].exponent[0]);
+		}
+
+		for (int j=0; j< n; j++)
+		{
+			minor[i*n+j] = entry[rperm[i]*cols+cperm[j]];
+			for (size_t t=0; t< minor[i*n+j].size(); t++)
+				minor[i*n+j][t].exponent[0] -= row_shift;
+		}
+	}
+	
+	return modular_proper_multiple(minor, n, divisor, num_threads);
+}
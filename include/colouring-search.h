@@ -0,0 +1,83 @@
+/*************************************************************************************************
+                  Constraint propagating colouring search
+
+A colouring_search enumerates the colourings of a diagram by a finite switch without enumerating every
+assignment of labels to its arcs.  The diagram is described by a set of variables, the arc labels, and a
+set of crossings, each of which relates two ingress variables to two egress variables through a relation
+that determines the egress labels from the ingress labels.
+
+When a relation is injective, as it is for the up and down actions of a switch, the ingress labels are also
+determined by the egress labels, so as soon as either pair of labels at a crossing is known the other pair
+follows.  The search assigns labels to the branch variables in turn, propagates each assignment around the
+diagram and backtracks as soon as a crossing is contradicted, so that partial assignments that cannot be
+completed are discarded without being extended.
+
+Colourings are returned in lexicographic order of the labels of the branch variables.
+
+int colouring_search::add_relation(const vector<int>& egress)
+void colouring_search::add_crossing(int relation, int ingress_0, int ingress_1, int egress_0, int egress_1)
+void colouring_search::set_branch_order(const vector<int>& order)
+bool colouring_search::next(vector<int>& colouring)
+*************************************************************************************************/
+
+class colouring_search
+{
+	/* a relation maps the ingress pair (a,b) at index a*n+b to the egress pair (c,d) stored as c*n+d, or to -1 if the
+	   relation is not defined at (a,b).  If the relation is injective, inverse holds the inverse map, otherwise it is empty.
+	*/
+	struct relation_data
+	{
+		vector<int> egress;
+		vector<int> inverse;
+	};
+
+	struct crossing_data
+	{
+		int relation;
+		int ingress[2];
+		int egress[2];
+	};
+
+	/* a search_level records the state of the search at one branch variable, the trail size when the level was reached
+	   and the next label to try; a variable already assigned by propagation when its level is reached has no alternatives.
+	*/
+	struct search_level
+	{
+		size_t mark;
+		int next_label;
+	};
+
+	int n;
+	vector<relation_data> relation;
+	vector<crossing_data> crossing;
+	vector<vector<int> > incident_crossings;
+	vector<int> branch_order;
+
+	vector<int> label;
+	vector<int> trail;
+	vector<int> pending;
+	vector<search_level> level;
+	int depth;
+	bool started;
+	bool exhausted;
+
+	bool assign(int variable, int value);
+	bool propagate();
+	void undo(size_t mark);
+
+public:
+	colouring_search(int _n, int num_variables): n(_n), incident_crossings(num_variables), label(num_variables,-1),
+	                                             depth(0), started(false), exhausted(false) {}
+
+	/* add_relation takes the egress pairs of a relation, as described above, and returns the index of the relation */
+	int add_relation(const vector<int>& egress);
+	void add_crossing(int relation, int ingress_0, int ingress_1, int egress_0, int egress_1);
+
+	/* the branch order determines the order in which variables are labelled; any variable that is not included, or
+	   determined by those that are, is labelled after the branch variables in order of index.
+	*/
+	void set_branch_order(const vector<int>& order);
+
+	/* next sets colouring to the next colouring of the variables, returning false when there are none left */
+	bool next(vector<int>& colouring);
+};
@@ -55,3 +55,4 @@ public:
 void print_gauss_data(gauss_orientation_data g, ostream& os, string prefix);
 void write_gauss_data(gauss_orientation_data g, ostream& os, bool zig_zags=false, int immersion_character = generic_code_data::character::CLOSED, int head_zig_zag_count = 0);
 gauss_orientation_data left_preferred(const gauss_orientation_data& g, bool unoriented=false, int immersion_character=generic_code_data::character::CLOSED);
+string left_preferred_gauss_data(const gauss_orientation_data& g, bool unoriented=false, int immersion_character=generic_code_data::character::CLOSED, bool zig_zags=false, int head_zig_zag_count=0);
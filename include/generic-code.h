@@ -205,8 +205,10 @@ void read_immersion_code (generic_code_data& code_data, string input_string);
 void write_immersion_code(ostream& s, generic_code_data& code_data);
 void print_code_data(ostream& s, generic_code_data& code_data, string prefix="");
 void read_peer_code (generic_code_data& code_data, string input_string);
+void rebuild_peer_code_data (generic_code_data& code_data);
 void write_peer_code(ostream& s, const generic_code_data& code_data, bool zig_zags=false, bool labelled=true);
 void read_gauss_code (generic_code_data& code_data, string input_string);
+void assign_gauss_code_data (generic_code_data& code_data, const vector<int>& gauss_data, const vector<int>& num_terms_in_component, const vector<int>& crossing_sign);
 void write_gauss_code(ostream& s, generic_code_data& code_data, bool OU_FORMAT = false);
 void read_code_data (generic_code_data& code_data, string input_string);
 void write_code_data(ostream& s, generic_code_data& code_data);
@@ -224,6 +226,7 @@ bool calculate_turning_cycles(generic_code_data& code_data, matrix<int>& cycle,
 bool realizable_code_data(generic_code_data& code_data, matrix<int>& cycle, int& num_left_cycles, int& num_cycles);
 bool valid_knotoid_input(generic_code_data& code_data);
 string over_preferred_gauss_code(generic_code_data& code_data, bool unoriented);
+void print_canonical_cache_use(string cache_name, long hits, long misses, size_t size);
 int amalgamate_zig_zag_counts(int a, int b);
 string read_dowker_code (string input_string);
 int three_connected(generic_code_data& code_data, bool flat_crossings);
@@ -27,3 +27,12 @@ This header file defines the #defines required by the programme
 #define VIRTUAL_CROSSING 2
 #define SHORTCUT_CROSSING	3
 #define ODD_CROSSING	4
+
+/* weighting of the tangle engine's estimated number of boundary connections against the number of bracket states */
+#define TANGLE_COST_FACTOR	16
+
+/* number of entries in the dense boundary maps above which birack homology is calculated from sparse boundary maps */
+#define SPARSE_HOMOLOGY_THRESHOLD	262144
+
+/* number of word-size primes used to determine the rank of a boundary map over the rationals when homology is evaluated modulo primes first */
+#define MODULAR_RANK_PRIMES		2
@@ -10,9 +10,17 @@ The current version is restricted to integer matrices and does not support the r
 permutation provided by the original.  However, this implementation supports non-square matrices
 
 template <class T, class St> void test_matrices (matrix<T,St>& D, matrix<T,St>& P, matrix<T,St>& Q, const matrix<T,St> A, string test_case)
+template <class T, class St> bool modular_Smith_normal_form (matrix<T,St>& D, matrix<T,St>& P, matrix<T,St>& Q, int& rank)
+template <class T, class St> bool modular_matrix_inverse (const matrix<T,St>& M, matrix<T,St>& Minv)
+template <class T, class St> bool modular_matrix_product (const matrix<T,St>& A, const matrix<T,St>& B, matrix<T,St>& C)
+template <class T, class St> int modular_rational_rank (const matrix<T,St>& M)
+template <class T, class St> bool modular_exact_inverse (const matrix<T,St>& M, matrix<T,St>& Minv)
 template <class T, class St> int Smith_normal_form (const matrix<T,St> A, matrix<T,St>& D, matrix<T,St>& P, matrix<T,St>& Q,  bool field_coefficients = false)
 template <class T, class St> matrix<T,St> SNF_inverse (const matrix<T,St>& M, bool field_coefficients = false)
+template <class T, class St> matrix<T,St> transformation_inverse (const matrix<T,St>& M, homology_control h_control)
 template <class T, class St> homology_generators_return<T> homology_generators(matrix<T,St>& Delta_k, matrix<T,St>& Delta_kp1, bool cohomology, bool field_coefficients)	
+template <class T> void lattice_basis_insert(vector<vector<T> >& basis, vector<T>& v)
+template <class T> homology_generators_return<T> sparse_homology_generators(sparse_matrix<T>& Delta_k, sparse_matrix<T>& Delta_kp1, bool cohomology, homology_control h_control)
 *************************************************************************************************/
 
 class homology_control
@@ -21,8 +29,10 @@ public:
 	bool field_coefficients;
 	bool silent_operation;
 	bool test_Smith_normal_form;
+	bool modular_first;
+	ostream* os; // the stream to which progress is reported, unless silent_operation is set
 
-	homology_control(): field_coefficients(false), silent_operation(false),test_Smith_normal_form(false) {}
+	homology_control(): field_coefficients(false), silent_operation(false),test_Smith_normal_form(false), modular_first(false), os(&cout) {}
 };
 
 
@@ -92,6 +102,199 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 }
 
 
+/* When the coefficients are the integers mod p, the field coefficient calculations below are carried out on word-size residues by
+   the functions in modular.h.  The generic templates return false, so that the calculation is made in T; the scalar overloads convert 
+   to and from residues only when scalar::variant is MOD_P.
+*/
+template <class St> void modular_matrix_residues (const matrix<scalar,St>& M, vector<unsigned int>& residue)
+{
+	int n = M.numrows();
+	int m = M.numcols();
+	residue = vector<unsigned int>(n*m);
+	
+	for (int i=0; i< n; i++)
+	for (int j=0; j< m; j++)
+	{
+		ostringstream oss;
+		oss << M[i][j];
+		istringstream iss(oss.str());
+		iss >> residue[i*m+j];
+	}
+}
+
+template <class St> void modular_matrix_assign (matrix<scalar,St>& M, const vector<unsigned int>& residue)
+{
+	int n = M.numrows();
+	int m = M.numcols();
+	
+	for (int i=0; i< n; i++)
+	for (int j=0; j< m; j++)
+		M[i][j] = scalar(static_cast<int>(residue[i*m+j]));
+}
+
+template <class T, class St> bool modular_Smith_normal_form (matrix<T,St>& D, matrix<T,St>& P, matrix<T,St>& Q, int& rank) {return false;}
+
+template <class St> bool modular_Smith_normal_form (matrix<scalar,St>& D, matrix<scalar,St>& P, matrix<scalar,St>& Q, int& rank)
+{
+	if (scalar::variant != scalar::MOD_P)
+		return false;
+		
+	vector<unsigned int> residue_D;
+	vector<unsigned int> residue_P;
+	vector<unsigned int> residue_Q;
+	
+	modular_matrix_residues(D,residue_D);
+	rank = modular_Smith_normal_form(residue_D, D.numrows(), D.numcols(), residue_P, residue_Q, mod_p::get_p());
+	modular_matrix_assign(D,residue_D);
+	modular_matrix_assign(P,residue_P);
+	modular_matrix_assign(Q,residue_Q);
+	
+	return true;
+}
+
+template <class T, class St> bool modular_matrix_inverse (const matrix<T,St>& M, matrix<T,St>& Minv) {return false;}
+
+template <class St> bool modular_matrix_inverse (const matrix<scalar,St>& M, matrix<scalar,St>& Minv)
+{
+	if (scalar::variant != scalar::MOD_P)
+		return false;
+
+	int n = M.numrows();
+	vector<unsigned int> residue_M;
+	vector<unsigned int> residue_Minv;
+	
+	modular_matrix_residues(M,residue_M);
+	if (!modular_matrix_inverse(residue_M, n, residue_Minv, mod_p::get_p()))
+		return false;
+	
+	Minv = matrix<scalar,St>(n,n);
+	modular_matrix_assign(Minv,residue_Minv);
+	return true;
+}
+
+template <class T, class St> bool modular_matrix_product (const matrix<T,St>& A, const matrix<T,St>& B, matrix<T,St>& C) {return false;}
+
+template <class St> bool modular_matrix_product (const matrix<scalar,St>& A, const matrix<scalar,St>& B, matrix<scalar,St>& C)
+{
+	if (scalar::variant != scalar::MOD_P)
+		return false;
+
+	vector<unsigned int> residue_A;
+	vector<unsigned int> residue_B;
+	vector<unsigned int> residue_C;
+	
+	modular_matrix_residues(A,residue_A);
+	modular_matrix_residues(B,residue_B);
+	modular_matrix_product(residue_A, residue_B, A.numrows(), A.numcols(), B.numcols(), residue_C, mod_p::get_p());
+	
+	C = matrix<scalar,St>(A.numrows(),B.numcols());
+	modular_matrix_assign(C,residue_C);
+	return true;
+}
+
+/* When h_control.modular_first is set and the coefficients are the integers or the rationals, homology_generators evaluates the quantities
+   that are uniquely determined by the boundary maps modulo word-size primes, rather than by elimination in T.  The ranks of the boundary
+   maps over the rationals are the largest of their ranks modulo MODULAR_RANK_PRIMES primes, which may only fall short of the true rank
+   if every prime divides the same non-zero minor.  The ranks are used only to skip work whose result is then known exactly: a map of rank
+   zero is a zero matrix.  The inverses of the transformation matrices produced by Smith_normal_form are reconstructed from their residues
+   and checked exactly before they are used, so the result is the same as that of exact elimination.
+*/
+template <class St> void modular_matrix_strings (const matrix<scalar,St>& M, vector<string>& value)
+{
+	int n = M.numrows();
+	int m = M.numcols();
+	value = vector<string>(n*m);
+	
+	for (int i=0; i< n; i++)
+	for (int j=0; j< m; j++)
+	{
+		ostringstream oss;
+		oss << M[i][j];
+		value[i*m+j] = oss.str();
+	}
+}
+
+inline int modular_string_rank (const vector<string>& value, int n, int m, unsigned int p)
+{
+	vector<unsigned int> residue(n*m);
+	for (int i=0; i< n*m; i++)
+	{
+		if (!modular_residue(value[i],p,residue[i]))
+			return -1;
+	}
+	return modular_rank(residue, n, m, p);
+}
+
+template <class T, class St> int modular_rational_rank (const matrix<T,St>& M) {return -1;}
+
+template <class St> int modular_rational_rank (const matrix<scalar,St>& M)
+{
+	if (scalar::variant == scalar::MOD_P)
+		return -1;
+		
+	int n = M.numrows();
+	int m = M.numcols();
+	vector<string> value;
+	modular_matrix_strings(M,value);
+	
+	int rank = 0;
+	for (int i=0; i< MODULAR_RANK_PRIMES; i++)
+		rank = max(rank, modular_string_rank(value,n,m,modular_prime(i)));
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "modular_rational_rank: " << n << " by " << m << " matrix has rank " << rank << endl;
+
+	return rank;
+}
+
+template <class T, class St> bool modular_exact_inverse (const matrix<T,St>& M, matrix<T,St>& Minv) {return false;}
+
+template <class St> bool modular_exact_inverse (const matrix<scalar,St>& M, matrix<scalar,St>& Minv)
+{
+	if (scalar::variant == scalar::MOD_P)
+		return false;
+		
+	int n = M.numrows();
+	vector<string> value;
+	modular_matrix_strings(M,value);
+	
+	vector<string> identity(n*n,"0");
+	for (int i=0; i< n; i++)
+		identity[i*n+i] = "1";
+	
+	vector<string> inverse_value;
+	if (!modular_linear_solve(value, n, n, identity, n, inverse_value))
+		return false;
+
+	bool integral = (scalar::variant == scalar::INT || scalar::variant == scalar::BIGINT);
+	Minv = matrix<scalar,St>(n,n);
+	for (int i=0; i< n; i++)
+	for (int j=0; j< n; j++)
+	{
+		const string& entry = inverse_value[i*n+j];
+		if ((integral && entry.find('/') != string::npos) || (scalar::variant == scalar::INT && entry.length() > 9))
+			return false;
+			
+		istringstream iss(entry);
+		iss >> Minv[i][j];
+	}
+	
+	/* check the reconstruction exactly */
+	matrix<scalar,St> check = M*Minv;
+	for (int i=0; i< n; i++)
+	for (int j=0; j< n; j++)
+	{
+		if (check[i][j] != scalar(i==j?1:0))
+		{
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "modular_exact_inverse: reconstructed inverse failed check" << endl;
+			return false;
+		}
+	}
+	
+	return true;
+}
+
 /* Smith_normal_form reduces the matrix A to Smith normal form, assigning to P and Q matrices such that
    PAQ = D, where D is diagonal.  These matrices need to be of the correct size at the call to this function.
    
@@ -105,13 +308,31 @@ template <class T, class St> int Smith_normal_form (const matrix<T,St> A, matrix
 
 	bool field_coefficients = h_control.field_coefficients;
 	bool silent_operation=h_control.silent_operation;
+	ostream& os = *h_control.os;
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "Smith_normal_form: calculating Smith normal form " << n << " rows	" << m << " columns, field_coefficients = " << field_coefficients << endl;
 
 	if (!silent_operation)
-		cout << "Calculating Smith normal form " << n << " rows " << m << " columns" << endl;
+		os << "Calculating Smith normal form " << n << " rows " << m << " columns" << endl;
+
+	if (field_coefficients)
+	{
+		int rank;
+		if (modular_Smith_normal_form(D,P,Q,rank))
+		{
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "Smith_normal_form: evaluated modulo " << mod_p::get_p() << ", rank " << rank << endl;
 
+/*####################################################################*/
+if (h_control.test_Smith_normal_form)
+	test_matrices(D, P, Q, A,"Testing Smith normal form...");
+/*####################################################################*/
+
+			return rank;
+		}
+	}
+	
 	for (int i=0; i<n; i++)
 	{
 	    for (int j=0; j<i; j++)
@@ -144,7 +365,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	{
 
 		if (!silent_operation)
-			cout << '.' << flush;
+			os << '.' << flush;
 
 		if (D[pivot_r][pivot_c] == T(0) )
 		{
@@ -599,7 +820,7 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	} while (!complete && pivot_r < n && pivot_c < m);
 
 	if (!silent_operation)
-		cout << endl;
+		os << endl;
 
 
 	/* invert any rows of D that have negative values in D[i][i] and 
@@ -691,6 +912,24 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	return Minv;	
 }
 
+/* transformation_inverse inverts one of the transformation matrices produced by Smith_normal_form, which are invertible over T */
+template <class T, class St> matrix<T,St> transformation_inverse (const matrix<T,St>& M, homology_control h_control)
+{
+	matrix<T,St> Minv;
+	
+	if (h_control.modular_first && modular_exact_inverse(M, Minv))
+		return Minv;
+	
+	if (h_control.field_coefficients)
+	{
+		if (!modular_matrix_inverse(M, Minv))
+			Minv = inverse(M, true);
+	}
+	else
+		Minv = SNF_inverse(M, h_control);
+		
+	return Minv;
+}
 
 /* homology_generators calculates the k-th homology or cohomology generators from the boundary matrices Delta_k : C_k --> C_{k-1} and Delta_kp1 : : C_{k+1} --> C_k.  
    The function works with coeficients only and has no understanding of the basis elements for the chain groups C_n.  It returns the number of generators, the number of 
@@ -715,12 +954,39 @@ template <class T, class St> homology_generators_return<T> homology_generators(m
 	
 	bool field_coefficients = h_control.field_coefficients;
 	bool silent_operation=h_control.silent_operation;
+	ostream& os = *h_control.os;
 	
 	homology_generators_return<T> return_data;
 	
 	bool zero_Delta_kp1 = (Delta_kp1.numcols()==0);
 	bool zero_Delta_k = (Delta_k.numcols()==0);
 
+	if (h_control.modular_first)
+	{
+		/* The modular ranks are lower bounds for the ranks over the rationals, so if they show that there are no cycles, or cocycles, 
+		   the homology is trivial.
+		*/
+		int modular_Delta_k_rank = (zero_Delta_k? 0: modular_rational_rank(Delta_k));
+		int modular_Delta_kp1_rank = (zero_Delta_kp1? 0: modular_rational_rank(Delta_kp1));
+		
+		if (modular_Delta_k_rank != -1 && modular_Delta_kp1_rank != -1)
+		{
+			int num_cycles = num_k_generators - (cohomology? modular_Delta_kp1_rank: modular_Delta_k_rank);
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
+	debug << "homology_generators: modular Delta_k_rank = " << modular_Delta_k_rank << ", modular Delta_kp1_rank = " << modular_Delta_kp1_rank 
+	      << ", free rank = " << num_cycles - (cohomology? modular_Delta_k_rank: modular_Delta_kp1_rank) << endl;
+}
+			if (num_cycles == 0)
+			{
+				if (!silent_operation)
+					os << "no " << (cohomology? "cocycles": "cycles") << " modulo word-size primes, homology is trivial" << endl;
+				return return_data;
+			}
+		}
+	}
+
 /*	
 if (debug_control::DEBUG >= debug_control::BASIC)	
 {
@@ -745,7 +1011,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		Delta_k_rank = Smith_normal_form (Delta_k,Delta_k_D,Delta_k_P,Delta_k_Q,h_control);													
 
 		if (!silent_operation)
-			cout << "calculated Smith normal form of Delta_k" << endl;
+			os << "calculated Smith normal form of Delta_k" << endl;
 
 if (debug_control::DEBUG >= debug_control::BASIC)
 {
@@ -775,7 +1041,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		Delta_kp1_rank = Smith_normal_form (Delta_kp1,Delta_kp1_D,Delta_kp1_P,Delta_kp1_Q,h_control);													
 
 	if (!silent_operation)
-		cout << "calculated Smith normal form of Delta_kp1" << endl;
+		os << "calculated Smith normal form of Delta_kp1" << endl;
 
 if (debug_control::DEBUG >= debug_control::BASIC)
 {
@@ -830,15 +1096,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		if (!zero_Delta_k)
 		{
 			if (!silent_operation)
-				cout << "Starting inverse calculation for Delta_k_Q (" << Delta_k_Q.numrows() << "x" << Delta_k_Q.numcols() << ")..." << flush;
+				os << "Starting inverse calculation for Delta_k_Q (" << Delta_k_Q.numrows() << "x" << Delta_k_Q.numcols() << ")..." << flush;
 			
-			if (field_coefficients)
-				Delta_k_Q_inv = inverse(Delta_k_Q, field_coefficients);
-			else
-				Delta_k_Q_inv = SNF_inverse(Delta_k_Q, h_control);
+			Delta_k_Q_inv = transformation_inverse(Delta_k_Q, h_control);
 
 			if (!silent_operation)
-				cout << "done" << endl;
+				os << "done" << endl;
 			
 
 if (debug_control::DEBUG >= debug_control::BASIC)	
@@ -846,7 +1109,8 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << "homology_generators: Delta_k_Q_inv:" << endl;
 	print(Delta_k_Q_inv, debug,3,"homology_generators: ");
 }	
-			Delta_k_T_image = Delta_k_D*Delta_k_Q_inv;
+			if (!modular_matrix_product(Delta_k_D, Delta_k_Q_inv, Delta_k_T_image))
+				Delta_k_T_image = Delta_k_D*Delta_k_Q_inv;
 
 if (debug_control::DEBUG >= debug_control::BASIC)	
 {
@@ -919,15 +1183,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		if (!zero_Delta_kp1)
 		{		
 			if (!silent_operation)
-				cout << "Starting inverse calculation for Delta_kp1_P (" << Delta_kp1_P.numrows() << "x" << Delta_kp1_P.numcols() << ")..." << endl;
+				os << "Starting inverse calculation for Delta_kp1_P (" << Delta_kp1_P.numrows() << "x" << Delta_kp1_P.numcols() << ")..." << endl;
 
-			if (field_coefficients)
-				Delta_kp1_P_inv = inverse(Delta_kp1_P, field_coefficients);
-			else
-				Delta_kp1_P_inv = SNF_inverse(Delta_kp1_P, h_control);
+			Delta_kp1_P_inv = transformation_inverse(Delta_kp1_P, h_control);
 
 			if (!silent_operation)
-				cout << "done" << endl;
+				os << "done" << endl;
 
 if (debug_control::DEBUG >= debug_control::BASIC)	
 {
@@ -935,7 +1196,8 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 	print(Delta_kp1_P_inv, debug,3,"homology_generators: ");
 
 }	
-			Delta_kp1_image = Delta_kp1_P_inv * Delta_kp1_D;
+			if (!modular_matrix_product(Delta_kp1_P_inv, Delta_kp1_D, Delta_kp1_image))
+				Delta_kp1_image = Delta_kp1_P_inv * Delta_kp1_D;
 
 if (debug_control::DEBUG >= debug_control::BASIC)	
 {
@@ -1028,12 +1290,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	if (Gk.numcols() !=0)
 	{
 		if (!silent_operation)
-			cout << "Starting echelon calculation for Gk (" << Gk.numrows() << "x" << Gk.numcols() << ")..." << flush;
+			os << "Starting echelon calculation for Gk (" << Gk.numrows() << "x" << Gk.numcols() << ")..." << flush;
 			
 		echelon(Gk_copy,field_coefficients,true);
 
 		if (!silent_operation)
-			cout << "done" << endl;
+			os << "done" << endl;
 
 	}
 		
@@ -1109,7 +1371,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		int N_rank = Smith_normal_form (N,N_D,N_P,N_Q,h_control); 
 
 	if (!silent_operation)
-		cout << "calculated Smith normal form of N" << endl;
+		os << "calculated Smith normal form of N" << endl;
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)	
 {
@@ -1121,16 +1383,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 }
 
 		if (!silent_operation)
-			cout << "Starting inverse calculation for N_P (" << N_P.numrows() << "x" << N_P.numcols() << ")..." << flush;
+			os << "Starting inverse calculation for N_P (" << N_P.numrows() << "x" << N_P.numcols() << ")..." << flush;
 			
-		matrix<T,St> N_P_inv(N.numrows(),N.numrows());	
-		if (field_coefficients)
-			N_P_inv = inverse(N_P, field_coefficients);
-		else
-			N_P_inv = SNF_inverse(N_P, h_control);
+		matrix<T,St> N_P_inv = transformation_inverse(N_P, h_control);
 
 		if (!silent_operation)
-			cout << "done" << endl;
+			os << "done" << endl;
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)	
 {
@@ -1249,3 +1507,265 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	
 	return return_data;
 }
+
+/* lattice_basis_insert adds the vector v to the basis, held in echelon form, of the lattice over the integers spanned by the vectors
+   previously added.  The leading entry of v is combined with that of the basis vector having the same leading position using the 
+   unimodular transformation given by the extended Euclidean algorithm, which leaves the lattice unchanged and clears the leading 
+   entry of v, until either v is zero or it has a leading position not already in the basis.  Note that v is modified by the function.
+*/
+template <class T> void lattice_basis_insert(vector<vector<T> >& basis, vector<T>& v)
+{
+	int n = v.size();
+	int p = 0;
+	
+	for (;;)
+	{
+		while (p < n && v[p] == T(0))
+			p++;
+		
+		if (p == n)
+			return;
+			
+		size_t i;
+		for (i=0; i< basis.size(); i++)
+		{
+			int leading = 0;
+			while (basis[i][leading] == T(0))
+				leading++;
+			if (leading == p)
+				break;
+		}
+		
+		if (i == basis.size())
+		{
+			basis.push_back(v);
+			return;
+		}
+		
+		vector<T>& b = basis[i];
+		T a = b[p];
+		T c = v[p];
+		
+		if (c % a == T(0))
+		{
+			T q = c/a;
+			for (int j=p; j< n; j++)
+				v[j] -= q*b[j];
+		}
+		else
+		{
+			/* x*a + y*c = g, so the transformation (b,v) -> (xb+yv, (a/g)v-(c/g)b) has determinant 1 */
+			T x;
+			T y;
+			T g = ext_gcd(a,c,x,y);
+			T a_g = a/g;
+			T c_g = c/g;
+			
+			for (int j=p; j< n; j++)
+			{
+				T bj = b[j];
+				b[j] = x*bj + y*v[j];
+				v[j] = a_g*v[j] - c_g*bj;
+			}
+		}
+	}
+}
+
+/* sparse_homology_generators evaluates the same generators as homology_generators, from sparse boundary maps.  The chain complex
+   C_{k+1} --> C_k --> C_{k-1} is first reduced by cancelling pairs of cells of adjacent dimension that are related by a unit entry 
+   in a boundary map.  Cancelling such a pair does not change the homology, so the reduced complex has the same homology as the original
+   but, typically, very few cells remain in dimension k.
+   
+   The unit pivots used by sparse_elimination on Delta_kp1 each cancel a k-cell b against a (k+1)-cell a, where the boundary of a is 
+   pb+... for the unit p.  This removes the column b from Delta_k and leaves the Schur complement of the pivot in Delta_kp1, and the
+   k-chains of the reduced complex include directly into C_k.  The corresponding k-cochains pull back to C^k by assigning to b the value
+   -1/p times the value of the cochain on the remainder of the boundary of a, so we record the pivot columns.
+
+   The unit pivots subsequently used by sparse_elimination on Delta_k each cancel a k-cell a against a (k-1)-cell b.  This removes the 
+   row a from Delta_kp1 and leaves the Schur complement in Delta_k.  Now the k-cochains of the reduced complex extend by zero on a but
+   a k-chain c of the reduced complex includes into C_k as c - (1/p)<d(c),b>a, so we record the pivot rows.
+
+   If the coefficients are a field, elimination reduces both boundary maps to zero, so the homology is freely generated by the remaining
+   k-cells and is determined by the ranks of the boundary maps alone.  Otherwise, the residual boundary maps contain no unit entries and 
+   we apply the dense homology_generators to them.  In either case the generators of the reduced complex are then taken back to C_k or C^k
+   by reversing the cancellations.
+*/
+template <class T> homology_generators_return<T> sparse_homology_generators(sparse_matrix<T>& Delta_k, sparse_matrix<T>& Delta_kp1, bool cohomology, homology_control h_control)	
+{
+	int num_k_generators = Delta_kp1.numrows();
+	bool field_coefficients = h_control.field_coefficients;
+	
+	/* cancel k-cells against (k+1)-cells using the unit entries of Delta_kp1 */
+	vector<sparse_pivot<T> > kp1_pivots;
+	int Delta_kp1_rank = sparse_elimination(Delta_kp1, kp1_pivots, field_coefficients, false, cohomology);
+	
+	/* remove the cancelled k-cells from Delta_k, which are the pivot rows of Delta_kp1 */
+	vector<bool> cancelled(num_k_generators);
+	for (size_t i=0; i< kp1_pivots.size(); i++)
+		cancelled[kp1_pivots[i].row] = true;
+
+	for (size_t i=0; i< Delta_k.numrows(); i++)
+	{
+		typename map<int,T>::iterator mptr = Delta_k[i].begin();
+		while (mptr != Delta_k[i].end())
+		{
+			if (cancelled[mptr->first])
+				Delta_k[i].erase(mptr++);
+			else
+				mptr++;
+		}
+	}
+	
+	/* cancel k-cells against (k-1)-cells using the unit entries of Delta_k */
+	vector<sparse_pivot<T> > k_pivots;
+	int Delta_k_rank = sparse_elimination(Delta_k, k_pivots, field_coefficients, !cohomology, false);
+
+	for (size_t i=0; i< k_pivots.size(); i++)
+		cancelled[k_pivots[i].col] = true;
+		
+	/* enumerate the k-cells that remain in the reduced complex */
+	vector<int> cell;
+	vector<int> cell_index(num_k_generators,-1);
+	for (int i=0; i< num_k_generators; i++)
+	{
+		if (!cancelled[i])
+		{
+			cell_index[i] = cell.size();
+			cell.push_back(i);
+		}
+	}
+	int num_cells = cell.size();
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)	
+{
+	debug << "sparse_homology_generators: Delta_kp1 unit pivot rank = " << Delta_kp1_rank << ", Delta_k unit pivot rank = " << Delta_k_rank << endl;
+	debug << "sparse_homology_generators: reduced complex has " << num_cells << " of the original " << num_k_generators << " k-cells" << endl;
+}
+
+	if (!h_control.silent_operation)
+		*h_control.os << "reduced chain complex to " << num_cells << " of " << num_k_generators << " generators in dimension k" << endl;
+	
+	/* The residual boundary maps of the reduced complex comprise the rows of Delta_k with an entry in a remaining k-cell and the 
+	   columns of Delta_kp1 with an entry in a remaining k-cell.  Homology and cohomology depend only on the lattice spanned by the
+	   rows of Delta_k and by the columns of Delta_kp1, so we replace these with a basis of the lattice they span.  There may be
+	   many more residual columns of Delta_kp1 than remaining k-cells, so this keeps the dense calculation small.
+	*/
+	vector<vector<T> > residual_k_rows;
+	for (size_t i=0; i< Delta_k.numrows(); i++)
+	{
+		if (Delta_k[i].size() != 0)
+		{
+			vector<T> residual_row(num_cells);
+			typename map<int,T>::iterator mptr = Delta_k[i].begin();
+			while (mptr != Delta_k[i].end())
+			{
+				residual_row[cell_index[mptr->first]] = mptr->second;
+				mptr++;
+			}
+			lattice_basis_insert(residual_k_rows, residual_row);
+		}
+	}
+	
+	vector<vector<T> > residual_kp1_columns;
+	vector<vector<T> > residual_column(Delta_kp1.numcols());
+	for (int i=0; i< num_cells; i++)
+	{
+		typename map<int,T>::iterator mptr = Delta_kp1[cell[i]].begin();
+		while (mptr != Delta_kp1[cell[i]].end())
+		{
+			if (residual_column[mptr->first].size() == 0)
+				residual_column[mptr->first] = vector<T>(num_cells);
+			residual_column[mptr->first][i] = mptr->second;
+			mptr++;
+		}
+	}
+	for (size_t j=0; j< residual_column.size(); j++)
+	{
+		if (residual_column[j].size() != 0)
+		{
+			lattice_basis_insert(residual_kp1_columns, residual_column[j]);
+			vector<T>().swap(residual_column[j]);
+		}
+	}
+
+	homology_generators_return<T> return_data;
+	
+	if (num_cells == 0)
+		return return_data;
+		
+	if (residual_k_rows.size() == 0 && residual_kp1_columns.size() == 0)
+	{
+		/* the reduced complex has zero boundary maps, so every remaining k-cell is a generator */
+		return_data.num_generators = num_cells;
+		for (int i=0; i< num_cells; i++)
+		{
+			vector<T> generator(num_cells);
+			generator[i] = 1;
+			return_data.generators.push_back(generator);
+		}
+	}
+	else
+	{
+		matrix<T> residual_Delta_k;
+		if (residual_k_rows.size() != 0)
+		{
+			residual_Delta_k = matrix<T>(residual_k_rows.size(),num_cells);
+			for (size_t i=0; i< residual_k_rows.size(); i++)
+			for (int j=0; j< num_cells; j++)
+				residual_Delta_k[i][j] = residual_k_rows[i][j];
+		}
+		
+		matrix<T> residual_Delta_kp1(num_cells,residual_kp1_columns.size());
+		for (int i=0; i< num_cells; i++)
+		for (size_t j=0; j< residual_kp1_columns.size(); j++)
+			residual_Delta_kp1[i][j] = residual_kp1_columns[j][i];
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)	
+	debug << "sparse_homology_generators: residual Delta_k is " << residual_Delta_k.numrows() << " by " << residual_Delta_k.numcols() 
+	      << ", residual Delta_kp1 is " << residual_Delta_kp1.numrows() << " by " << residual_Delta_kp1.numcols() << endl;
+
+		return_data = homology_generators(residual_Delta_k, residual_Delta_kp1, cohomology, h_control);
+	}
+	
+	/* take the generators of the reduced complex back to the original complex */
+	list<vector<T> > generators;
+	typename list<vector<T> >::iterator gptr = return_data.generators.begin();
+	while (gptr != return_data.generators.end())
+	{
+		vector<T> generator(num_k_generators);
+		for (int i=0; i< num_cells; i++)
+			generator[cell[i]] = (*gptr)[i];
+
+		if (cohomology)
+		{
+			for (int i= kp1_pivots.size()-1; i >= 0; i--)
+			{
+				sparse_pivot<T>& pivot = kp1_pivots[i];
+				T value = 0;
+				for (size_t j=0; j< pivot.column_entries.size(); j++)
+					value += pivot.column_entries[j].second * generator[pivot.column_entries[j].first];
+				generator[pivot.row] = T(0) - value/pivot.value;
+			}
+		}
+		else
+		{
+			for (int i= k_pivots.size()-1; i >= 0; i--)
+			{
+				sparse_pivot<T>& pivot = k_pivots[i];
+				T value = 0;
+				for (size_t j=0; j< pivot.row_entries.size(); j++)
+					value += pivot.row_entries[j].second * generator[pivot.row_entries[j].first];
+				generator[pivot.col] = T(0) - value/pivot.value;
+			}
+		}
+		
+		generators.push_back(generator);
+		gptr++;
+	}
+	return_data.generators = generators;
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)	
+	debug << "sparse_homology_generators:   found " << return_data.num_generators << " generators, " << return_data.num_torsion_generators << " torsion generators" << endl;;
+	
+	return return_data;
+}
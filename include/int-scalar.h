@@ -1,5 +1,4 @@
-
-class int_scalar : public Scalar
+class int_scalar
 {
 	int n; 
 	
@@ -7,27 +6,21 @@ class int_scalar : public Scalar
 		int_scalar(){n=0;}
 		int_scalar(int a){n=a;}
 		
-		int_scalar* plus_eq (Scalar* a) {int_scalar* ptr = dynamic_cast<int_scalar*>(a); n+=ptr->n; return this;}
-		int_scalar* minus_eq (Scalar* a) {int_scalar* ptr = dynamic_cast<int_scalar*>(a); n=n-ptr->n; return this;}
-		int_scalar* times_eq (Scalar* a) {int_scalar* ptr = dynamic_cast<int_scalar*>(a); n*=ptr->n; return this;}
-		int_scalar* divide_eq (Scalar* a) {int_scalar* ptr = dynamic_cast<int_scalar*>(a); n/=ptr->n; return this;}
-		int_scalar* remainder_eq (Scalar* a) {int_scalar* ptr = dynamic_cast<int_scalar*>(a); n%=ptr->n; return this;}
-		bool eq (Scalar* a) const {int_scalar* ptr = dynamic_cast<int_scalar*>(a); return n == ptr->n;}
-		bool ne (Scalar* a) const {int_scalar* ptr = dynamic_cast<int_scalar*>(a); return n != ptr->n;}
-		bool gt (Scalar* a) const {int_scalar* ptr = dynamic_cast<int_scalar*>(a); return n > ptr->n;}
-		bool lt (Scalar* a) const {int_scalar* ptr = dynamic_cast<int_scalar*>(a); return n < ptr->n;}
-		bool ge (Scalar* a) const {int_scalar* ptr = dynamic_cast<int_scalar*>(a); return n >= ptr->n;}
-		bool le (Scalar* a) const {int_scalar* ptr = dynamic_cast<int_scalar*>(a); return n <= ptr->n;}
+		void plus_eq (const int_scalar& a) {n+=a.n;}
+		void minus_eq (const int_scalar& a) {n=n-a.n;}
+		void times_eq (const int_scalar& a) {n*=a.n;}
+		void divide_eq (const int_scalar& a) {n/=a.n;}
+		void remainder_eq (const int_scalar& a) {n%=a.n;}
+		bool eq (const int_scalar& a) const {return n == a.n;}
+		bool gt (const int_scalar& a) const {return n > a.n;}
+		bool lt (const int_scalar& a) const {return n < a.n;}
 
-		int_scalar* abs_val() { int_scalar* result = new int_scalar(*this); result->n = std::abs(result->n); return result;}
+		void abs_val() {n = std::abs(n);}
 		void increment() {n++;}
 		void decrement() {n--;}
 		void read(istream& s) {s >> n;}
-		void print (ostream& s) {s << n;}
-		int nl() {return num_len(n);} 
+		void print (ostream& s) const {s << n;}
+		int nl() const {return num_len(n);} 
 		void dump(ostream& s) const {s << n;}
 		void sanitize() {}
-		
-		int_scalar* clone() {return new int_scalar(*this);}	
 };
-
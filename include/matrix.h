@@ -35,6 +35,9 @@ struct matrix_control
 	static int wait_threshold;
 	static int wait_count;
 	static int reset_count; // number of times wait_count has reached wait_threshold
+	static int DETERMINANT_ALGORITHM;
+	
+	enum determinant_algorithm {automatic, expansion, bareiss, modular};
 };
 
 struct matrix_error {
@@ -942,8 +945,179 @@ if (matrix_control::DEBUG & matrix_control::immanant && n >= matrix_control::DET
     return det;
 }
 
+/* bareiss_determinant evaluates the determinant of the n x n sub-matrix of M determined by rperm and cperm using 
+   Bareiss' fraction-free elimination.  After the k-th pivot every entry of the remaining sub-matrix is a (k+1)x(k+1) 
+   minor of the original, so the division by the previous pivot is always exact.  The entries must therefore belong to 
+   a commutative integral domain in which T / T returns the exact quotient; it is the caller's responsibility to ensure 
+   this, e.g. by clearing negative exponents from Laurent polynomials, since we cannot check it here.
+*/
+template <class T, class St> 
+T bareiss_determinant (const matrix<T,St>& M, string title, int n, vector<int> rperm, vector<int> cperm)
+{
+    T zero = T(St(0));
+
+	if (rperm.size() == 0)
+	{
+		n = M.numcols();
+		rperm = vector<int>(M.numrows());
+		for (size_t i=0; i< M.numrows(); i++)
+			rperm[i] = i;
+		cperm = vector<int>(n);
+		for (int i=0; i< n; i++)
+			cperm[i] = i;
+	}
+
+	matrix<T,St> A(n,n);
+	for (int i=0; i< n; i++)
+	for (int j=0; j< n; j++)
+		A[i][j] = M[rperm[i]][cperm[j]];
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+{
+	debug << "matrix::bareiss_determinant: " << title << ", n = " << n << ", sub-matrix A = \n";
+	print (A,debug,0,"matrix::bareiss_determinant: ");
+}
+	
+	T previous_pivot = T(St(1));
+	bool negate = false;
+	
+	for (int k=0; k< n-1; k++)
+	{
+		/* look for a non-zero pivot in column k, swapping rows if necessary */
+		if (A[k][k] == zero)
+		{
+			int pivot_row = k+1;
+			while (pivot_row < n && A[pivot_row][k] == zero)
+				pivot_row++;
+				
+			if (pivot_row == n)
+			{
+if (matrix_control::DEBUG & matrix_control::immanant)
+	debug << "matrix::bareiss_determinant: column " << k << " has no non-zero pivot, determinant is zero" << endl;
+				return zero;
+			}
+
+			for (int j=k; j< n; j++)
+				swap(A[k][j],A[pivot_row][j]);
+			negate = !negate;
+		}
+		
+		for (int i=k+1; i< n; i++)
+		{
+			for (int j=k+1; j< n; j++)
+			{
+				A[i][j] = A[k][k]*A[i][j] - A[i][k]*A[k][j];
+				if (k > 0)
+					A[i][j] = A[i][j] / previous_pivot;
+			}
+			A[i][k] = zero;
+		}
+		
+		previous_pivot = A[k][k];
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+{
+	debug << "matrix::bareiss_determinant: after pivot " << k << (negate? " (rows swapped an odd number of times)":"") << " A = \n";
+	print (A,debug,0,"matrix::bareiss_determinant: ");
+}
+
+		if (matrix_control::WAIT_INFO && matrix_control::COMFORT_DOTS && n-k > matrix_control::wait_threshold)
+		{
+			cout << ".";
+			cout.flush();
+		}
+	}
+	
+	T det = A[n-1][n-1];
+	if (negate)
+		det *= T(St(-1));
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+	debug << "matrix::bareiss_determinant: determinant = " << det << endl;
+	
+	return det;
+}
+
+/* expansion_calls counts the number of calls to immanant that would be made in evaluating the cofactor expansion of the 
+   sub-matrix determined by rperm and cperm, given the pattern of non-zero entries in M, stored by row.  It follows the same 
+   choice of row or column as immanant but stops counting once the count exceeds limit.
+*/
+inline void expansion_calls (const vector<char>& nonzero, int cols, int n, const vector<int>& rperm, const vector<int>& cperm, long& calls, long limit)
+{
+	calls++;
+	if (n <= 2 || calls > limit)
+		return;
+		
+	int num_zeros = 0;
+	for (int i=0; i < n; i++)
+	{
+		if (!nonzero[rperm[0]*cols+cperm[i]])
+			num_zeros++;
+		if (!nonzero[rperm[i]*cols+cperm[0]])
+			num_zeros--;
+	}
+	bool evaluate_along_row = (num_zeros >= 0);
+	
+	vector<int> sub_r_perm(n-1);
+	vector<int> sub_c_perm(n-1);
+	for (int i=1; i<n;i++)
+	{
+		if (evaluate_along_row)
+			sub_r_perm[i-1] = rperm[i];
+		else
+			sub_c_perm[i-1] = cperm[i];
+	}
+	
+	for (int i=0; i<n && calls <= limit; i++)
+	{
+		if (evaluate_along_row && nonzero[rperm[0]*cols+cperm[i]])
+		{
+			for (int j=0; j<n-1;j++)
+				sub_c_perm[j] = cperm[j<i?j:j+1];
+			expansion_calls(nonzero,cols,n-1,sub_r_perm,sub_c_perm,calls,limit);
+		}
+		else if (!evaluate_along_row && nonzero[rperm[i]*cols+cperm[0]])
+		{
+			for (int j=0; j<n-1;j++)
+				sub_r_perm[j] = rperm[j<i?j:j+1];
+			expansion_calls(nonzero,cols,n-1,sub_r_perm,sub_c_perm,calls,limit);
+		}
+	}
+}
+
+/* select_determinant_algorithm determines how the determinant of the n x n sub-matrix of M determined by rperm and cperm should 
+   be evaluated, for entry types that support more than cofactor expansion.  Unless an algorithm has been requested explicitly, 
+   we use cofactor expansion if it would involve at most 2n^3 sub-determinants, since it is cheap for sparse matrices such as the 
+   matrix representations of short braids, and otherwise modular evaluation, for which the caller falls back to Bareiss' algorithm
+   if the entries cannot be evaluated modulo a prime.
+*/
+template <class T, class St> 
+int select_determinant_algorithm (const matrix<T,St>& M, int n, const vector<int>& rperm, const vector<int>& cperm)
+{
+	if (matrix_control::DETERMINANT_ALGORITHM != matrix_control::automatic)
+		return matrix_control::DETERMINANT_ALGORITHM;
+	
+	int rows = M.numrows();
+	int cols = M.numcols();
+	T zero = T(St(0));
+	vector<char> nonzero(rows*cols);
+	for (int i=0; i< rows; i++)
+	for (int j=0; j< cols; j++)
+		nonzero[i*cols+j] = (M[i][j] != zero);
+		
+	long calls = 0;
+	long limit = 2L*n*n*n;
+	expansion_calls(nonzero,cols,n,rperm,cperm,calls,limit);
+
+if (matrix_control::DEBUG & matrix_control::immanant)
+	debug << "matrix::select_determinant_algorithm: n = " << n << ", cofactor expansion calls " << (calls > limit? "exceed ": "= ") << (calls > limit? limit : calls) << endl;
+
+	return (calls > limit? matrix_control::modular : matrix_control::expansion);
+}
+
+/* num_threads is used only by the polynomial determinants in braid.h, which may share their evaluation between worker threads */
 template <class T, class St> 
-T determinant (const matrix<T,St>& M, string title="untitled", int n=0, vector<int> rperm=vector<int>(0), vector<int> cperm=vector<int>(0))
+T determinant (const matrix<T,St>& M, string title="untitled", int n=0, vector<int> rperm=vector<int>(0), vector<int> cperm=vector<int>(0), int num_threads=1)
 {
 	return immanant (M, title, n, rperm, cperm, false); // permanent = false
 }
@@ -0,0 +1,119 @@
+/*************************************************************************************************
+                  Word-size modular arithmetic
+
+The functions declared here evaluate integer quantities modulo primes that fit in a machine word and reconstruct the
+integer result using the Chinese remainder theorem.  The primes are all less than 2^31, so that the product of two residues
+fits in an unsigned 64-bit integer.
+
+unsigned int modular_prime(int i)
+unsigned int modular_inverse(unsigned int a, unsigned int p)
+unsigned int modular_determinant(vector<unsigned int>& A, int n, unsigned int p)
+int modular_Smith_normal_form(vector<unsigned int>& D, int n, int m, vector<unsigned int>& P, vector<unsigned int>& Q, unsigned int p)
+bool modular_matrix_inverse(const vector<unsigned int>& A, int n, vector<unsigned int>& inverse, unsigned int p)
+void modular_matrix_product(const vector<unsigned int>& A, const vector<unsigned int>& B, int n, int k, int m, vector<unsigned int>& C, unsigned int p)
+void modular_interpolate(unsigned int* values, int num_points, int stride, unsigned int p, const vector<unsigned int>& inverse)
+bool modular_polynomial_determinant(const vector<vector<modular_term> >& entry, int n, int num_variables, vector<int>& degree, vector<string>& coefficient, int num_threads, unsigned int field_prime)
+bool modular_proper_multiple(const vector<vector<modular_term> >& entry, int n, const vector<string>& divisor, int num_threads)
+int modular_rank(vector<unsigned int>& A, int n, int m, unsigned int p)
+bool modular_residue(const string& value, unsigned int p, unsigned int& residue)
+bool modular_linear_solve(const vector<string>& A, int n, int m, const vector<string>& B, int c, vector<string>& X)
+*************************************************************************************************/
+
+/* a modular_term is a term of a polynomial with integer coefficients, the coefficient is held as a decimal string
+   so that it may be read from any of the scalar variants; the exponents are non-negative, one for each variable
+*/
+struct modular_term
+{
+	string coefficient;
+	vector<int> exponent;
+};
+
+/* A modular_reducer reduces unsigned 64-bit integers modulo a fixed p < 2^31 by Barrett reduction, using the precomputed
+   m = floor((2^64-1)/p).  The estimate q = floor(xm/2^64) of x/p is at most one too small, so x - qp < 2p and a single
+   masked subtraction completes the reduction without a branch.
+   
+   The sum of a residue and lazy_limit products of residues does not overflow 64 bits, so accumulators may absorb that many 
+   row operations or products in a dot product before they need to be reduced.
+*/
+struct modular_reducer
+{
+	unsigned long long p;
+	unsigned long long m;
+	unsigned long long lazy_limit;
+	
+	modular_reducer(unsigned int _p): p(_p), m(~0ULL/_p) 
+	{
+		unsigned long long square = static_cast<unsigned long long>(_p-1)*(_p-1);
+		lazy_limit = (square == 0? ~0ULL : (~0ULL - p)/square);
+	}
+	
+	unsigned int reduce(unsigned long long x) const
+	{
+		unsigned long long q = static_cast<unsigned long long>((static_cast<unsigned __int128>(x) * m) >> 64);
+		unsigned long long r = x - q*p;
+		r -= p & (0ULL - static_cast<unsigned long long>(r >= p));
+		return static_cast<unsigned int>(r);
+	}
+
+	unsigned int multiply(unsigned long long a, unsigned long long b) const {return reduce(a*b);}
+};
+
+/* modular_prime returns the i-th largest prime less than 2^31 */
+unsigned int modular_prime(int i);
+
+unsigned int modular_inverse(unsigned int a, unsigned int p);
+
+/* modular_determinant evaluates the determinant of the n x n matrix A, stored by row, modulo p.  A is overwritten. */
+unsigned int modular_determinant(vector<unsigned int>& A, int n, unsigned int p);
+
+/* modular_Smith_normal_form evaluates the Smith normal form of the n x m matrix D, stored by row, over the field of integers modulo
+   the prime p and returns its rank.  D is overwritten by its Smith normal form and P (n x n) and Q (m x m) are set so that PAQ = D,
+   where A is the original D.  The row and column operations are exactly those made by Smith_normal_form in homology.h for field 
+   coefficients, so that P and Q agree with that function.
+*/
+int modular_Smith_normal_form(vector<unsigned int>& D, int n, int m, vector<unsigned int>& P, vector<unsigned int>& Q, unsigned int p);
+
+/* modular_matrix_inverse sets inverse to the inverse of the n x n matrix A modulo p, returning false if A is singular */
+bool modular_matrix_inverse(const vector<unsigned int>& A, int n, vector<unsigned int>& inverse, unsigned int p);
+
+/* modular_matrix_product sets C to the product of the n x k matrix A and the k x m matrix B modulo p */
+void modular_matrix_product(const vector<unsigned int>& A, const vector<unsigned int>& B, int n, int k, int m, vector<unsigned int>& C, unsigned int p);
+
+/* modular_interpolate replaces the values of a polynomial at 0,1,...,num_points-1, stored at values[0], values[stride],...,
+   by the coefficients of the polynomial, constant term first.  The vector inverse holds the inverses of 1,...,num_points-1 mod p.
+*/
+void modular_interpolate(unsigned int* values, int num_points, int stride, unsigned int p, const vector<unsigned int>& inverse);
+
+/* modular_polynomial_determinant evaluates the determinant of the n x n matrix of polynomials whose entry (i,j) is the sum of
+   the terms in entry[i*n+j].  On success the degree vector holds the degree bound used for each variable and coefficient holds
+   the coefficients of the determinant as decimal strings, indexed by exponent with the first variable most significant.
+   The function returns false if the evaluation would be too large, or a coefficient is not an integer.
+   
+   If field_prime is non-zero it is a prime and the determinant is evaluated over the integers modulo that prime, so the coefficients 
+   are returned as residues.  In that case there must be more residues than the degree bound of each variable, so that there are 
+   enough evaluation points, otherwise the function returns false.
+*/
+bool modular_polynomial_determinant(const vector<vector<modular_term> >& entry, int n, int num_variables, vector<int>& degree, vector<string>& coefficient, int num_threads=1, unsigned int field_prime=0);
+
+/* modular_proper_multiple determines whether the determinant of the n x n matrix of polynomials in one variable whose entry (i,j) is 
+   the sum of the terms in entry[i*n+j] is a multiple of the polynomial whose integer coefficients are given by divisor, constant term
+   first, and has a larger span than the divisor, in the sense that the difference between the highest and lowest powers of the 
+   variable is larger.  The function returns true only if this can be proved, using enough primes to exceed the bound on the 
+   coefficients of the pseudo-remainder.  A zero determinant is regarded as such a multiple.
+*/
+bool modular_proper_multiple(const vector<vector<modular_term> >& entry, int n, const vector<string>& divisor, int num_threads=1);
+
+/* modular_rank returns the rank of the n x m matrix A, stored by row, modulo p.  A is overwritten. */
+int modular_rank(vector<unsigned int>& A, int n, int m, unsigned int p);
+
+/* modular_residue sets residue to the residue modulo p of an integer or rational held as a decimal string, such as "-12" or "3/4", 
+   returning false if p divides the denominator.
+*/
+bool modular_residue(const string& value, unsigned int p, unsigned int& residue);
+
+/* modular_linear_solve determines the solution X of AX = B, where A is n x m of rank m and B is n x c, the entries of each matrix
+   being integers or rationals held by row as decimal strings.  The solution is found modulo a sequence of primes and reconstructed as
+   rationals, which are returned as decimal strings.  The function returns false if A does not have rank m, the system is inconsistent
+   or no reconstruction is found.  Since the reconstruction is only checked modulo one further prime, the caller should verify X.
+*/
+bool modular_linear_solve(const vector<string>& A, int n, int m, const vector<string>& B, int c, vector<string>& X);
@@ -82,6 +82,8 @@ public:
 	polynomial<T,V,E>(string);
 	
     static void add_pterm (polynomial<T,V,E>&, const pterm<T,E>&);
+    static void accumulate_pterms (polynomial<T,V,E>&, vector<pterm<T,E> >&);
+    static bool ordered_pterms (const list<pterm<T,E> >&, const vector<char>&);
 //	int printlen() const;
 //	int numvars() const {return nv;}
 	int numterms() const {return pt.size();}
@@ -155,9 +157,10 @@ struct polynomial_control
 	static bool WAIT_INFO;
 	static bool MOD_P; // used in the output function to control the generation of '-' signs
 	static bool OUTPUT_PROXY_VARIABLES_ONLY;  // used for inverting variables
-	static bool SUBSTITUTE_MAPPED_VARIABLES;  // used for polynomial output
+	static thread_local bool SUBSTITUTE_MAPPED_VARIABLES;  // used for polynomial output, thread_local since it is changed temporarily when substituting variables
 	static bool WRITE_PARITY_PEER_CODES; // in addition to unoriented left preferred Gauss code
 	static bool TeX; // output polynomials in TeX format.
+	static bool ACCUMULATE_PTERMS; // combine the pterms of products and sums by sorting them once, rather than adding them individually with add_pterm
 	static int wait_threshold;
 };
 
@@ -417,6 +420,162 @@ if (polynomial_control::DEBUG & polynomial_control::general)
 	}	
 }
 
+/* accumulate_pterms sets the list of pterms of poly to the sum of the pterms in the vector terms, which need not be
+   ordered and may contain several pterms with the same variables.  The variables of poly should already include those 
+   of every pterm in terms and be sorted, as they are following merge_variables.  This is not the case in divide_by, where
+   the product of a quotient pterm and the denominator only has the variables of the denominator, so if we find a pterm 
+   variable that is not in poly.vc we fall back to add_pterm, which compares pterms based only on the variables in vc.
+
+   Rather than inserting each pterm into the list with add_pterm, which requires a linear walk of the list and a comparison 
+   of exponent maps at each step, we unpack the exponents of each pterm into a dense key of poly.nv exponents, indexed by the 
+   position of the variable in poly.vc, together with a flag for each variable recording whether it is present in the pterm.
+   We then sort the pterms once, in the descending lexicographical order used by compare_variables, and combine the 
+   coefficients of adjacent pterms having identical keys.  The sort is stable, so the coefficients of like pterms are 
+   added in the same order as they would have been by successive calls to add_pterm.  The pterms are moved out of terms
+   into poly, so terms is left in an unspecified state.
+   
+   If polynomial_control::ACCUMULATE_PTERMS is false the pterms are added individually with add_pterm, so that the two 
+   approaches may be compared.
+*/
+template <typename T, typename V, typename E> void polynomial<T,V,E>::accumulate_pterms (polynomial<T,V,E>& poly, vector<pterm<T,E> >& terms)
+{
+	poly.pt.clear();
+	
+	size_t num_terms = terms.size();	
+	if (num_terms == 0)
+	{
+		return;
+	}
+	else if (num_terms == 1)
+	{
+		if (terms[0].n != T(0))
+			poly.pt.push_back(std::move(terms[0]));
+		return;
+	}
+
+	else if (!polynomial_control::ACCUMULATE_PTERMS)
+	{
+		for (size_t i=0; i< num_terms; i++)
+		{
+			if (terms[i].n != T(0))
+				add_pterm(poly,terms[i]);
+		}
+		return;
+	}
+
+	int nv = poly.vc.size();
+
+	vector<E> exponent(num_terms*nv);
+	vector<char> present(num_terms*nv);
+	
+	for (size_t i=0; i< num_terms; i++)
+	{
+		/* the exponent map and poly.vc are both in ascending order of variable character */
+		int place = 0;
+		typename map<char,E>::const_iterator mptr = terms[i].e.begin();
+		while (mptr != terms[i].e.end())
+		{
+			while (place < nv && poly.vc[place] != mptr->first)
+				place++;
+				
+			if (place == nv)
+			{
+if (polynomial_control::DEBUG & polynomial_control::general) 
+	debug << "polynomial::accumulate_pterms: pterm " << terms[i] << " has variables not in poly, adding pterms individually" << endl;
+
+				for (size_t j=0; j< num_terms; j++)
+				{
+					if (terms[j].n != T(0))
+						add_pterm(poly,terms[j]);
+				}
+				return;
+			}
+			
+			exponent[i*nv+place] = mptr->second;
+			present[i*nv+place] = 1;
+			mptr++;
+		}
+	}
+
+	/* compare returns 1, 0 or -1 in the same manner as compare_variables */
+	struct key_compare
+	{
+		const vector<E>& exponent;
+		const vector<char>& present;
+		int nv;
+		
+		key_compare(const vector<E>& e, const vector<char>& p, int n): exponent(e), present(p), nv(n) {}
+		
+		int compare (size_t a, size_t b) const
+		{
+			for (int i=0; i< nv; i++)
+			{
+				if (present[a*nv+i] != present[b*nv+i])
+					return (present[a*nv+i]? 1: -1);
+				else if (present[a*nv+i])
+				{
+					if (exponent[a*nv+i] > exponent[b*nv+i])
+						return 1;
+					else if (exponent[a*nv+i] < exponent[b*nv+i])
+						return -1;
+				}
+			}
+			return 0;
+		}
+		
+		bool operator () (size_t a, size_t b) const {return compare(a,b) > 0;}
+	} key(exponent,present,nv);
+
+	vector<size_t> order(num_terms);
+	for (size_t i=0; i< num_terms; i++)
+		order[i] = i;
+		
+	stable_sort(order.begin(),order.end(),key);
+
+if (polynomial_control::DEBUG & polynomial_control::general) 
+	debug << "polynomial::accumulate_pterms: sorted " << num_terms << " pterms based on " << nv << " variables" << endl;
+
+	size_t i=0;
+	while (i < num_terms)
+	{
+		pterm<T,E>& sum = terms[order[i]];
+		size_t j = i+1;
+		while (j < num_terms && key.compare(order[i],order[j]) == 0)
+		{
+			sum.n += terms[order[j]].n;
+			j++;
+		}
+		
+		if (sum.n != T(0))
+			poly.pt.push_back(std::move(sum));
+		
+		i = j;
+	}
+}
+
+/* ordered_pterms returns true if the pterms in the list terms are in strictly decending lexicographical order
+   of variables, as determined by vc.
+*/
+template <typename T, typename V, typename E> bool polynomial<T,V,E>::ordered_pterms (const list<pterm<T,E> >& terms, const vector<char>& vc)
+{
+	if (terms.size() < 2)
+		return true;
+		
+	typename list<pterm<T,E> >::const_iterator previous = terms.begin();
+	typename list<pterm<T,E> >::const_iterator pptr = previous;
+	pptr++;
+	
+	while (pptr != terms.end())
+	{
+		if (previous->compare_variables(*pptr,vc) <= 0)
+			return false;
+			
+		previous = pptr;
+		pptr++;
+	}
+	return true;
+}
+
 template <typename T, typename V, typename E> void polynomial<T,V,E>::set_varmap(char c, V v)
 {
 	if (nv && find(vc.begin(),vc.end(),c) != vc.end())
@@ -585,20 +744,55 @@ if (polynomial_control::DEBUG & polynomial_control::general)
 
 	result.vm = merged_data.second;
 	
-    /* add in the pterms of a and b to the result */
-	typename list<pterm<T,E> >::const_iterator pptr = a.pt.begin();
-    while (pptr != a.pt.end())
-    {
-		polynomial<T,V,E>::add_pterm(result,*pptr);			
-		pptr++;
-    }
-
-	pptr = b.pt.begin();
-    while (pptr != b.pt.end())
-    {
-		polynomial<T,V,E>::add_pterm(result,*pptr);			
-		pptr++;
-    }
+    /* add in the pterms of a and b to the result.  Since the variables of a and b are a subset of those of the result, 
+       the pterms of each remain in decending order with respect to result.vc, unless merge_variables has had to substitute 
+       variables in b, so we normally merge the two lists in a single pass, and fall back to accumulating the pterms otherwise.
+    */
+	if (polynomial_control::ACCUMULATE_PTERMS && ordered_pterms(a.pt,result.vc) && ordered_pterms(b.pt,result.vc))
+	{
+		typename list<pterm<T,E> >::const_iterator a_pptr = a.pt.begin();
+		typename list<pterm<T,E> >::const_iterator b_pptr = b.pt.begin();
+		
+		while (a_pptr != a.pt.end() && b_pptr != b.pt.end())
+		{
+			int comparison = a_pptr->compare_variables(*b_pptr,result.vc);
+			
+			if (comparison > 0)
+			{
+				result.pt.push_back(*a_pptr);
+				a_pptr++;
+			}
+			else if (comparison < 0)
+			{
+				result.pt.push_back(*b_pptr);
+				b_pptr++;
+			}
+			else
+			{
+				T n = a_pptr->n + b_pptr->n;
+				if (n != T(0))
+				{
+					result.pt.push_back(*a_pptr);
+					result.pt.back().n = n;
+				}
+				a_pptr++;
+				b_pptr++;
+			}
+		}
+		result.pt.insert(result.pt.end(),a_pptr,a.pt.cend());
+		result.pt.insert(result.pt.end(),b_pptr,b.pt.cend());
+	}
+	else
+	{
+if (polynomial_control::DEBUG & polynomial_control::add) 
+	debug << "polynomial::operator += : pterms not ordered with respect to merged variables, accumulating pterms" << endl;
+	
+		vector<pterm<T,E> > terms;
+		terms.reserve(a.pt.size()+b.pt.size());
+		terms.insert(terms.end(),a.pt.begin(),a.pt.end());
+		terms.insert(terms.end(),b.pt.begin(),b.pt.end());
+		accumulate_pterms(result,terms);
+	}
 
     /* finally sanitize the result before returning */
     sanitize (result);
@@ -609,9 +803,14 @@ if (polynomial_control::DEBUG & polynomial_control::general)
 
 template <typename T, typename V, typename E> polynomial<T,V,E> polynomial<T,V,E>::operator -= (const polynomial<T,V,E>& poly)
 {
-	polynomial<T,V,E> loc; 
-	loc = poly;
-	loc *= 	polynomial<T,V,E>(T(-1));
+	/* negate the coefficients of a copy of poly directly, rather than multiplying by -1 */
+	polynomial<T,V,E> loc = poly;
+	typename list<pterm<T,E> >::iterator pterm_ptr = loc.pt.begin();
+	while (pterm_ptr != loc.pt.end())
+	{
+		pterm_ptr->n *= T(-1);
+		pterm_ptr++;
+	}
 	
 	return *this = *this + loc;
 }
@@ -638,7 +837,12 @@ if (polynomial_control::DEBUG & polynomial_control::general)
 
 	result.vm = merged_data.second;
 
-	/* multiply through the list of b pterms by the list of a pterms */
+	/* multiply through the list of b pterms by the list of a pterms, collecting the products so that 
+	   they may be accumulated into the result in a single pass 
+	*/
+	vector<pterm<T,E> > products;
+	products.reserve(a.pt.size()*b.pt.size());
+	
 	typename list<pterm<T,E> >::iterator a_pterm_ptr = a.pt.begin();
 	while (a_pterm_ptr != a.pt.end())
 	{
@@ -658,13 +862,15 @@ if (polynomial_control::DEBUG & polynomial_control::multiply)
 	debug << " product = " << pterm_product << endl;
 			
 			if (pterm_product.n != T(0))
-				add_pterm(result,pterm_product);
+				products.push_back(pterm_product);
 				
 			b_pterm_ptr++;
 		}
 		
 		a_pterm_ptr++;
 	}
+	
+	accumulate_pterms(result,products);
 
 if (polynomial_control::DEBUG & polynomial_control::multiply) 
 	debug << "polynomial::operator *= : result = " << result << endl;
@@ -1377,8 +1583,20 @@ if (polynomial_control::DEBUG & polynomial_control::divide)
 		*/
 
 		polynomial<T,V,E> product;
-		polynomial<T,V,E>::add_pterm(product, quotient_pterm);		
-		product *= denominator;
+		product.nv = numerator.nv;
+		product.vc = numerator.vc;
+		product.vm = numerator.vm;
+		
+		vector<pterm<T,E> > products;
+		products.reserve(denominator.pt.size());
+		typename list<pterm<T,E> >::const_iterator dptr = denominator.pt.begin();
+		while (dptr != denominator.pt.end())
+		{
+			products.push_back(quotient_pterm * (*dptr));
+			dptr++;
+		}
+		polynomial<T,V,E>::accumulate_pterms(product, products);
+		sanitize(product);
 
 if (polynomial_control::DEBUG & polynomial_control::divide)
     debug << "polynomial::divide_by: product = " << product << endl;
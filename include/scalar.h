@@ -1,116 +1,268 @@
 #include <rational.h>
 #include <bigint.h>
+#include <new>
 
-/* Scalar is an abstract class providing the interface to our scalar types */
-class Scalar
-{
+/* The scalar classes hold the value of a scalar for each variant.  They are value types that share a common
+   interface, so that the templated kernels in scalar may be instantiated with any of them.
+*/
+#include <mod-p-scalar.h>
+#include <int-scalar.h>
+#include <bigint-scalar.h>
+#include <rational-scalar.h>
+#include <big-rational-scalar.h>
 
-public:
-	virtual Scalar* plus_eq (Scalar*) = 0;
-	virtual Scalar* minus_eq (Scalar*) = 0;
-	virtual Scalar* times_eq (Scalar*) = 0;
-	virtual Scalar* divide_eq (Scalar*) = 0;
-	virtual Scalar* remainder_eq (Scalar*) = 0;
-	virtual bool eq (Scalar*) const = 0;
-	virtual bool ne (Scalar*) const = 0;
-	virtual bool gt (Scalar*) const = 0;
-	virtual bool lt (Scalar*) const = 0;
-	virtual bool ge (Scalar*) const = 0;
-	virtual bool le (Scalar*) const = 0;
-
-	virtual Scalar* abs_val() = 0;
-	virtual void increment() = 0;
-	virtual void decrement() = 0;
-
-	virtual void print(ostream&) = 0;
-	virtual void read(istream&) = 0;
-	virtual int nl() = 0; // num_len
-	virtual void dump(ostream&) const = 0;
-	virtual void sanitize() = 0;
-
-	virtual Scalar* clone() = 0; // virtual form of copy constructor	
-	virtual ~Scalar() {}
-};
+/* scalar is a concrete class that holds the value of one of the above scalar classes inline, in a
+   tagged union.  The tag records the variant in force when the scalar was constructed, as set by
+   scalar::set_variant, and arithmetic is carried out by templated kernels selected by a switch on
+   the tag, so no arithmetic operation makes a virtual call or allocates a new scalar.
 
-/* scalar is a concrete class that hides the polymorphic, 
-   pointer-oriented operation of the underlying Scalar class.
+   As with the polymorphic implementation that this replaces, binary operations assume both scalars
+   have the same variant.
 */
 class scalar
 {
-	Scalar* C;
 public:
 	static int variant;
 	enum scalar_variant {MOD_P, INT, BIGINT, RATIONAL, BIGRATIONAL};
 	static void set_variant(scalar_variant t);
 	static void show_variant(ostream& s);
-	
-	scalar operator = (const scalar& c) {if (this != &c){if (C) delete C; C = c.C->clone();} return *this;} 
-	scalar operator ++ () {C->increment(); return *this;} // prefix
-	scalar operator ++ (int) {scalar t = *this; C->increment(); return t;} // postfix
-	scalar operator -- () {C->decrement(); return *this;}
-	scalar operator -- (int) {scalar t = *this; C->decrement(); return t;}
-	scalar operator += (const scalar& c) {C->plus_eq(c.C); return *this;} 
-	scalar operator -= (const scalar& c) {C->minus_eq(c.C); return *this;} 
-	scalar operator *= (const scalar& c) {C->times_eq(c.C); return *this;} 
-	scalar operator /= (const scalar& c) {C->divide_eq(c.C); return *this;} 
-	scalar operator %= (const scalar& c) {C->remainder_eq(c.C); return *this;} 
-	bool operator == (const scalar& c) const {return C->eq(c.C);} 
-	bool operator != (const scalar& c) const {return C->ne(c.C);} 
-	bool operator > (const scalar& c) const {return C->gt(c.C);} 
-	bool operator < (const scalar& c) const {return C->lt(c.C);} 
-	bool operator >= (const scalar& c) const {return C->ge(c.C);} 
-	bool operator <= (const scalar& c) const {return C->le(c.C);} 
-
-	friend scalar operator + (const scalar& a, const scalar& b) {scalar r(a); r.C = r.C->plus_eq(b.C); return r;} 
-	friend scalar operator - (const scalar& a, const scalar& b) {scalar r(a); r.C = r.C->minus_eq(b.C); return r;}
-	friend scalar operator * (const scalar& a, const scalar& b) {scalar r(a); r.C = r.C->times_eq(b.C); return r;}
-	friend scalar operator / (const scalar& a, const scalar& b) {scalar r(a); r.C = r.C->divide_eq(b.C); return r;}
-	friend scalar operator % (const scalar& a, const scalar& b) {scalar r(a); r.C = r.C->remainder_eq(b.C); return r;}
-
-	void dump(ostream& s) const {C->dump(s);}
-	void sanitize() {C->sanitize();}
-	friend scalar abs(const scalar& c) {scalar result; delete result.C; result.C = c.C->abs_val(); return result;}
-	friend ostream& operator << (ostream& s, const scalar& c) {(c.C)->print(s); return s;}
-	friend istream& operator >> (istream& s, const scalar& c) {(c.C)->read(s); return s;}
-	friend int num_len (const scalar c) {return c.C->nl();}
-	
-	scalar();
-	scalar(const scalar& c) {C = c.C->clone();}
-	scalar(int);
-	~scalar() {delete C; C=0;}
+
+private:
+	int tag;
+	union
+	{
+		mod_p mp;
+		int_scalar is;
+		bigint_scalar bi;
+		rational_scalar ra;
+		big_rational br;
+	};
+
+	enum arithmetic_op {ASSIGN, PLUS, MINUS, TIMES, DIVIDE, REMAINDER};
+	enum relation_op {EQ, GT, LT};
+	enum unary_op {INCREMENT, DECREMENT, ABS, SANITIZE};
+
+	template <typename S> static void arithmetic(S& a, const S& b, arithmetic_op op);
+	template <typename S> static bool relation(const S& a, const S& b, relation_op op);
+	template <typename S> static void unary(S& a, unary_op op);
+
+	void construct();
+	void construct(int a);
+	void construct(const scalar& c);
+	void destroy();
+	void arithmetic(const scalar& c, arithmetic_op op);
+	bool relation(const scalar& c, relation_op op) const;
+	void unary(unary_op op);
+
+public:
+	scalar& operator = (const scalar& c) {if (this != &c) {if (tag == c.tag) arithmetic(c,ASSIGN); else {destroy(); construct(c);}} return *this;}
+	scalar& operator ++ () {unary(INCREMENT); return *this;} // prefix
+	scalar operator ++ (int) {scalar t = *this; unary(INCREMENT); return t;} // postfix
+	scalar& operator -- () {unary(DECREMENT); return *this;}
+	scalar operator -- (int) {scalar t = *this; unary(DECREMENT); return t;}
+	scalar& operator += (const scalar& c) {arithmetic(c,PLUS); return *this;}
+	scalar& operator -= (const scalar& c) {arithmetic(c,MINUS); return *this;}
+	scalar& operator *= (const scalar& c) {arithmetic(c,TIMES); return *this;}
+	scalar& operator /= (const scalar& c) {arithmetic(c,DIVIDE); return *this;}
+	scalar& operator %= (const scalar& c) {arithmetic(c,REMAINDER); return *this;}
+	bool operator == (const scalar& c) const {return relation(c,EQ);}
+	bool operator != (const scalar& c) const {return !relation(c,EQ);}
+	bool operator > (const scalar& c) const {return relation(c,GT);}
+	bool operator < (const scalar& c) const {return relation(c,LT);}
+	bool operator >= (const scalar& c) const {return !relation(c,LT);}
+	bool operator <= (const scalar& c) const {return !relation(c,GT);}
+
+	friend scalar operator + (const scalar& a, const scalar& b) {scalar r(a); r.arithmetic(b,PLUS); return r;}
+	friend scalar operator - (const scalar& a, const scalar& b) {scalar r(a); r.arithmetic(b,MINUS); return r;}
+	friend scalar operator * (const scalar& a, const scalar& b) {scalar r(a); r.arithmetic(b,TIMES); return r;}
+	friend scalar operator / (const scalar& a, const scalar& b) {scalar r(a); r.arithmetic(b,DIVIDE); return r;}
+	friend scalar operator % (const scalar& a, const scalar& b) {scalar r(a); r.arithmetic(b,REMAINDER); return r;}
+
+	void dump(ostream& s) const;
+	void sanitize() {unary(SANITIZE);}
+	friend scalar abs(const scalar& c) {scalar result(c); result.unary(ABS); return result;}
+	friend ostream& operator << (ostream& s, const scalar& c);
+	friend istream& operator >> (istream& s, scalar& c);
+	friend int num_len (const scalar& c);
+
+	scalar() {tag = variant; construct();}
+	scalar(const scalar& c) {construct(c);}
+	scalar(int a) {tag = variant; construct(a);}
+	~scalar() {destroy();}
 };
 
 struct scalar_error {
 	scalar_error (char* message) {cout << "\nscalar error!" << message << endl;}
 };
 
-
-/* scalar construction will be done via function pointers 
-   that will point to a function returning a pointer to
-   an object of the appropriate type
-   
+/* The templated kernels are instantiated for each of the scalar classes; the op argument is a constant
+   at each call site, so the inner switch is resolved when the kernel is inlined.
 */
-extern Scalar* (*make_scalar) ();
-extern Scalar* (*make_scalar_int) (int);
+template <typename S> inline void scalar::arithmetic(S& a, const S& b, arithmetic_op op)
+{
+	switch (op)
+	{
+		case ASSIGN: a = b; break;
+		case PLUS: a.plus_eq(b); break;
+		case MINUS: a.minus_eq(b); break;
+		case TIMES: a.times_eq(b); break;
+		case DIVIDE: a.divide_eq(b); break;
+		case REMAINDER: a.remainder_eq(b); break;
+	}
+}
 
-/* so now the scalar constructor can call make_scalar 
-   to get the right type of object
-*/
-inline scalar::scalar()
+template <typename S> inline bool scalar::relation(const S& a, const S& b, relation_op op)
 {
-	C=make_scalar();
+	switch (op)
+	{
+		case EQ: return a.eq(b);
+		case GT: return a.gt(b);
+		default: return a.lt(b);
+	}
 }
 
-inline scalar::scalar(int a)
+template <typename S> inline void scalar::unary(S& a, unary_op op)
 {
-	C=make_scalar_int(a);
+	switch (op)
+	{
+		case INCREMENT: a.increment(); break;
+		case DECREMENT: a.decrement(); break;
+		case ABS: a.abs_val(); break;
+		case SANITIZE: a.sanitize(); break;
+	}
 }
 
+/* construct() and construct(int) build the value for the variant already recorded in tag */
+inline void scalar::construct()
+{
+	switch (tag)
+	{
+		case MOD_P: new (&mp) mod_p; break;
+		case INT: new (&is) int_scalar; break;
+		case BIGINT: new (&bi) bigint_scalar; break;
+		case RATIONAL: new (&ra) rational_scalar; break;
+		default: new (&br) big_rational;
+	}
+}
 
-/* finally, include the scalar classes that are based on Scalar */
-#include <mod-p-scalar.h>
-#include <int-scalar.h>
-#include <bigint-scalar.h>
-#include <rational-scalar.h>
-#include <big-rational-scalar.h>
+inline void scalar::construct(int a)
+{
+	switch (tag)
+	{
+		case MOD_P: new (&mp) mod_p(a); break;
+		case INT: new (&is) int_scalar(a); break;
+		case BIGINT: new (&bi) bigint_scalar(a); break;
+		case RATIONAL: new (&ra) rational_scalar(a); break;
+		default: new (&br) big_rational(a);
+	}
+}
+
+inline void scalar::construct(const scalar& c)
+{
+	tag = c.tag;
+	switch (tag)
+	{
+		case MOD_P: new (&mp) mod_p(c.mp); break;
+		case INT: new (&is) int_scalar(c.is); break;
+		case BIGINT: new (&bi) bigint_scalar(c.bi); break;
+		case RATIONAL: new (&ra) rational_scalar(c.ra); break;
+		default: new (&br) big_rational(c.br);
+	}
+}
+
+inline void scalar::destroy()
+{
+	switch (tag)
+	{
+		case BIGINT: bi.~bigint_scalar(); break;
+		case RATIONAL: ra.~rational_scalar(); break;
+		case BIGRATIONAL: br.~big_rational(); break;
+		default: break; // mod_p and int_scalar are trivially destructible
+	}
+}
+
+inline void scalar::arithmetic(const scalar& c, arithmetic_op op)
+{
+	switch (tag)
+	{
+		case MOD_P: arithmetic(mp, c.mp, op); break;
+		case INT: arithmetic(is, c.is, op); break;
+		case BIGINT: arithmetic(bi, c.bi, op); break;
+		case RATIONAL: arithmetic(ra, c.ra, op); break;
+		default: arithmetic(br, c.br, op);
+	}
+}
+
+inline bool scalar::relation(const scalar& c, relation_op op) const
+{
+	switch (tag)
+	{
+		case MOD_P: return relation(mp, c.mp, op);
+		case INT: return relation(is, c.is, op);
+		case BIGINT: return relation(bi, c.bi, op);
+		case RATIONAL: return relation(ra, c.ra, op);
+		default: return relation(br, c.br, op);
+	}
+}
 
+inline void scalar::unary(unary_op op)
+{
+	switch (tag)
+	{
+		case MOD_P: unary(mp, op); break;
+		case INT: unary(is, op); break;
+		case BIGINT: unary(bi, op); break;
+		case RATIONAL: unary(ra, op); break;
+		default: unary(br, op);
+	}
+}
+
+inline void scalar::dump(ostream& s) const
+{
+	switch (tag)
+	{
+		case MOD_P: mp.dump(s); break;
+		case INT: is.dump(s); break;
+		case BIGINT: bi.dump(s); break;
+		case RATIONAL: ra.dump(s); break;
+		default: br.dump(s);
+	}
+}
+
+inline ostream& operator << (ostream& s, const scalar& c)
+{
+	switch (c.tag)
+	{
+		case scalar::MOD_P: c.mp.print(s); break;
+		case scalar::INT: c.is.print(s); break;
+		case scalar::BIGINT: c.bi.print(s); break;
+		case scalar::RATIONAL: c.ra.print(s); break;
+		default: c.br.print(s);
+	}
+	return s;
+}
+
+inline istream& operator >> (istream& s, scalar& c)
+{
+	switch (c.tag)
+	{
+		case scalar::MOD_P: c.mp.read(s); break;
+		case scalar::INT: c.is.read(s); break;
+		case scalar::BIGINT: c.bi.read(s); break;
+		case scalar::RATIONAL: c.ra.read(s); break;
+		default: c.br.read(s);
+	}
+	return s;
+}
+
+inline int num_len (const scalar& c)
+{
+	switch (c.tag)
+	{
+		case scalar::MOD_P: return c.mp.nl();
+		case scalar::INT: return c.is.nl();
+		case scalar::BIGINT: return c.bi.nl();
+		case scalar::RATIONAL: return c.ra.nl();
+		default: return c.br.nl();
+	}
+}
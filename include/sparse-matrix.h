@@ -0,0 +1,288 @@
+/*************************************************************************************************
+                  Sparse matrices and sparse elimination
+
+The boundary maps used to calculate birack homology have a number of non-zero entries in each column
+that depends only on the dimension, so for all but the smallest biracks they are almost entirely zero.
+A sparse_matrix holds each row as a map from column index to the non-zero entries in that row, so
+that the memory required is proportional to the number of non-zero entries rather than to the product
+of the matrix dimensions.
+
+template <class T> void print (const sparse_matrix<T>& M, ostream& os, int w, string prefix)
+template <class T> int sparse_elimination (sparse_matrix<T>& A, vector<sparse_pivot<T> >& pivots, bool field_coefficients, bool record_rows, bool record_columns)
+*************************************************************************************************/
+#include <map>
+#include <set>
+#include <queue>
+
+template <class T> class sparse_matrix
+{
+	size_t rows;
+	size_t cols;
+	vector<map<int,T> > r;
+
+public:
+    sparse_matrix(): rows(0), cols(0) {}
+    sparse_matrix(size_t n, size_t m): rows(n), cols(m), r(n) {}
+
+    size_t numrows() const {return rows;}
+    size_t numcols() const {return cols;}
+
+	/* M[i][j] += x creates the entry (i,j) if it is not already present, so entries should be read through
+	   the const operator or the find member of the row if an absent entry is not to be created.
+	*/
+	map<int,T>& operator[] (size_t i) {return r[i];}
+	const map<int,T>& operator[] (size_t i) const {return r[i];}
+
+	size_t non_zero_count() const;
+	void remove_zeros();
+};
+
+template <class T> size_t sparse_matrix<T>::non_zero_count() const
+{
+	size_t count = 0;
+	for (size_t i=0; i< rows; i++)
+		count += r[i].size();
+	return count;
+}
+
+/* remove_zeros removes the entries that have cancelled as a matrix was constructed */
+template <class T> void sparse_matrix<T>::remove_zeros()
+{
+	for (size_t i=0; i< rows; i++)
+	{
+		typename map<int,T>::iterator mptr = r[i].begin();
+		while (mptr != r[i].end())
+		{
+			if (mptr->second == T(0))
+				r[i].erase(mptr++);
+			else
+				mptr++;
+		}
+	}
+}
+
+template <class T> void print (const sparse_matrix<T>& M, ostream& os, int w, string prefix)
+{
+	for (size_t i=0; i< M.numrows(); i++)
+	{
+		os << prefix;
+		for (size_t j=0; j< M.numcols(); j++)
+		{
+			typename map<int,T>::const_iterator mptr = M[i].find(j);
+			if (mptr == M[i].end())
+				os << setw(w) << 0;
+			else
+				os << setw(w) << mptr->second;
+		}
+		os << endl;
+	}
+}
+
+template <class T> bool sparse_column_order(const pair<int,T>& a, const pair<int,T>& b) {return a.first < b.first;}
+
+/* A sparse_pivot records a pivot used by sparse_elimination.  If requested, the entries of the pivot row and
+   pivot column, other than the pivot itself, are recorded as they were at the time the pivot was used.
+*/
+template <class T> class sparse_pivot
+{
+public:
+	int row;
+	int col;
+	T value;
+	vector<pair<int,T> > row_entries;
+	vector<pair<int,T> > column_entries;
+};
+
+/* sparse_elimination carries out Gaussian elimination on A using row operations alone, choosing each pivot by
+   Markowitz's criterion, so as to limit the fill-in created by each elimination step.  The column with the
+   fewest non-zero entries is considered first and within that column the pivot is taken from the row with the
+   fewest non-zero entries, so the pivot minimizes (r-1)(c-1) amongst the entries in that column, where r and c
+   are the number of non-zero entries in the pivot row and column.
+
+   Only unit pivots are used, so that if the coefficients are not a field, every row operation is invertible
+   over the integers and the pivots contribute a diagonal entry of 1 to the Smith normal form of A.  With
+   field coefficients every non-zero entry is a unit and elimination continues until A has been reduced to zero,
+   otherwise elimination stops when no unit entry remains.
+
+   Each pivot row and column is removed from A once it has been used, so that on return A holds the Schur
+   complement of the pivots, the residual matrix whose Smith normal form supplies the remaining diagonal entries.
+   The pivots are returned in the order they were used and the function returns the number of pivots.
+   
+   During the elimination the rows are held as vectors of entries sorted by column, so that a row operation is a
+   single merge of two rows.  The list of rows in each column is only brought up to date when the column is 
+   considered for a pivot, column_count records the number of non-zero entries in each column.
+*/
+template <class T> int sparse_elimination (sparse_matrix<T>& A, vector<sparse_pivot<T> >& pivots, bool field_coefficients, bool record_rows, bool record_columns)
+{
+	typedef vector<pair<int,T> > sparse_row;
+	
+	int num_rows = A.numrows();
+	int num_cols = A.numcols();
+
+	vector<sparse_row> row(num_rows);
+	vector<vector<int> > column(num_cols);
+	vector<size_t> column_count(num_cols);
+	
+	for (int i=0; i< num_rows; i++)
+	{
+		row[i] = sparse_row(A[i].begin(),A[i].end());
+		for (size_t j=0; j< row[i].size(); j++)
+		{
+			column[row[i][j].first].push_back(i);
+			column_count[row[i][j].first]++;
+		}
+	}
+
+	/* candidate columns are held in a priority queue ordered by their non-zero count, out of date entries are
+	   discarded when they reach the top of the queue
+	*/
+	typedef pair<size_t,int> candidate_column;
+	priority_queue<candidate_column, vector<candidate_column>, greater<candidate_column> > candidates;
+
+	for (int j=0; j< num_cols; j++)
+	{
+		if (column_count[j] != 0)
+			candidates.push(candidate_column(column_count[j],j));
+	}
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "sparse_elimination: " << num_rows << " by " << num_cols << " matrix with " << A.non_zero_count() << " non-zero entries, field_coefficients = " << field_coefficients << endl;
+
+	int rank = 0;
+	vector<int> last_seen(num_rows,-1); // used to remove repeated rows from a column list
+	int stamp = 0;
+	vector<int> position(num_rows); // the position of the pivot column's entry in each row of the column list
+	sparse_row merged_row;
+
+	while (!candidates.empty())
+	{
+		candidate_column candidate = candidates.top();
+		candidates.pop();
+
+		int pc = candidate.second;
+		if (column_count[pc] != candidate.first)
+			continue;
+
+		/* bring the list of rows in column pc up to date and look for the unit entry lying in the shortest row */
+		vector<int>& rows_in_column = column[pc];
+		size_t num_rows_in_column = 0;
+		int pr = -1;
+		stamp++;
+		for (size_t i=0; i< rows_in_column.size(); i++)
+		{
+			int r = rows_in_column[i];
+			if (last_seen[r] == stamp)
+				continue;
+			last_seen[r] = stamp;
+			
+			typename sparse_row::iterator entry = lower_bound(row[r].begin(),row[r].end(),pair<int,T>(pc,T(0)),sparse_column_order<T>);
+			if (entry == row[r].end() || entry->first != pc)
+				continue;
+
+			position[r] = entry - row[r].begin();
+			rows_in_column[num_rows_in_column++] = r;
+			
+			if ((field_coefficients || abs(entry->second) == T(1)) && (pr == -1 || row[r].size() < row[pr].size()))
+				pr = r;
+		}
+		rows_in_column.resize(num_rows_in_column);
+
+		if (pr == -1)
+			continue; // the column will be considered again if an elimination step changes it
+
+		sparse_pivot<T> pivot;
+		pivot.row = pr;
+		pivot.col = pc;
+		pivot.value = row[pr][position[pr]].second;
+
+		if (record_rows)
+		{
+			for (size_t j=0; j< row[pr].size(); j++)
+			{
+				if (row[pr][j].first != pc)
+					pivot.row_entries.push_back(row[pr][j]);
+			}
+		}
+
+		if (record_columns)
+		{
+			for (size_t i=0; i< num_rows_in_column; i++)
+			{
+				int r = rows_in_column[i];
+				if (r != pr)
+					pivot.column_entries.push_back(pair<int,T>(r,row[r][position[r]].second));
+			}
+		}
+
+		/* remove the pivot row from A */
+		sparse_row pivot_row;
+		pivot_row.swap(row[pr]);
+		for (size_t j=0; j< pivot_row.size(); j++)
+			column_count[pivot_row[j].first]--;
+
+		/* subtract multiples of the pivot row from the other rows with an entry in the pivot column, this removes
+		   those entries, so the pivot column is cleared.
+		*/
+		vector<int> target_rows;
+		target_rows.swap(rows_in_column);
+		
+		for (size_t i=0; i< target_rows.size(); i++)
+		{
+			int r = target_rows[i];
+			if (r == pr)
+				continue;
+
+			sparse_row& target = row[r];
+			T multiplier = target[position[r]].second/pivot.value;
+
+			merged_row.clear();
+			size_t t=0;
+			size_t p=0;
+			while (t < target.size() || p < pivot_row.size())
+			{
+				if (p == pivot_row.size() || (t < target.size() && target[t].first < pivot_row[p].first))
+				{
+					merged_row.push_back(target[t++]);
+				}
+				else if (t == target.size() || pivot_row[p].first < target[t].first)
+				{
+					/* fill-in */
+					int col = pivot_row[p].first;
+					merged_row.push_back(pair<int,T>(col,T(0) - multiplier * pivot_row[p].second));
+					column[col].push_back(r);
+					column_count[col]++;
+					p++;
+				}
+				else
+				{
+					T value = target[t].second - multiplier * pivot_row[p].second;
+					if (value != T(0))
+						merged_row.push_back(pair<int,T>(target[t].first,value));
+					else
+						column_count[target[t].first]--;
+					t++;
+					p++;
+				}
+			}
+			target.swap(merged_row);
+		}
+
+		for (size_t j=0; j< pivot_row.size(); j++)
+		{
+			int col = pivot_row[j].first;
+			if (column_count[col] != 0)
+				candidates.push(candidate_column(column_count[col],col));
+		}
+
+		pivots.push_back(pivot);
+		rank++;
+	}
+
+	for (int i=0; i< num_rows; i++)
+		A[i] = map<int,T>(row[i].begin(),row[i].end());
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "sparse_elimination: rank " << rank << " from unit pivots, residual matrix has " << A.non_zero_count() << " non-zero entries" << endl;
+
+	return rank;
+}
@@ -9,6 +9,11 @@ related to any particular template class
 #include <sstream>
 #include <vector>
 #include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_map>
 
 template <class T> T gcd (T i, T j)
 {
@@ -92,6 +97,143 @@ template <class T> inline void get_number (T& num, string s, string::size_type p
 	ss >> num;
 }
 
+/* ordered_parallel_fold evaluates the items 0,...,num_items-1 by calling evaluate(i,result), with result initialized to 
+   initial, and passes each result to fold(i,result) in index order, returning when fold returns true or all the items have been folded.  If num_workers > 1 
+   the items are evaluated by a pool of worker threads, each taking the next unevaluated item, while the calling thread 
+   folds the results as they become available, so the outcome is the same as that of the serial calculation.  Once fold 
+   has returned true the workers do not start any further items.
+*/
+template <typename R, typename Evaluate, typename Fold> void ordered_parallel_fold(int num_items, int num_workers, const R& initial, Evaluate evaluate, Fold fold)
+{
+	if (num_workers <= 1 || num_items <= 1)
+	{
+		for (int i=0; i< num_items; i++)
+		{
+			R result = initial;
+			evaluate(i,result);
+			if (fold(i,result))
+				return;
+		}
+		return;
+	}
+	
+	vector<R> result(num_items,initial);
+	vector<char> ready(num_items,0);
+	mutex ready_mutex;
+	condition_variable ready_condition;
+	atomic<int> next_item(0);
+	atomic<bool> terminate(false);
+	
+	auto evaluate_items = [&]()
+	{
+		while (!terminate)
+		{
+			int i = next_item++;
+			if (i >= num_items)
+				break;
+				
+			R item_result = initial;
+			evaluate(i,item_result);
+			
+			{
+				lock_guard<mutex> lock(ready_mutex);
+				result[i] = item_result;
+				ready[i] = 1;
+			}
+			ready_condition.notify_all();
+		}
+	};
+	
+	vector<thread> worker;
+	for (int w=0; w< min(num_workers,num_items); w++)
+		worker.push_back(thread(evaluate_items));
+	
+	for (int i=0; i< num_items; i++)
+	{
+		R item_result = initial;
+		{
+			unique_lock<mutex> lock(ready_mutex);
+			ready_condition.wait(lock, [&]{return ready[i] != 0;});
+			item_result = result[i];
+			result[i] = initial;
+		}
+		
+		if (fold(i,item_result))
+		{
+			terminate = true;
+			break;
+		}
+	}
+	
+	for (size_t w=0; w< worker.size(); w++)
+		worker[w].join();
+}
+
+/* lru_cache records at most capacity values, discarding the least recently used values when a new value is recorded in a full 
+   cache, the capacity being given when the value is recorded.  The keys are hashed by an unordered_map, which also compares the keys so that 
+   a hash collision cannot return the wrong value.  The cache may be shared by worker threads, so the entries and the hit and miss 
+   counts are accessed only with cache_mutex held.
+*/
+template <typename K, typename V> class lru_cache
+{
+	typedef list<pair<K,V> > entry_list;
+	
+	entry_list entries; // most recently used first
+	unordered_map<K,typename entry_list::iterator> index;
+	mutable mutex cache_mutex;
+	long _hits;
+	long _misses;
+	
+public:
+	lru_cache(): _hits(0), _misses(0) {}
+
+	/* find sets value and returns true if key is in the cache, making it the most recently used entry */
+	bool find(const K& key, V& value)
+	{
+		lock_guard<mutex> lock(cache_mutex);
+		typename unordered_map<K,typename entry_list::iterator>::iterator it = index.find(key);
+		if (it == index.end())
+		{
+			_misses++;
+			return false;
+		}
+		
+		_hits++;
+		entries.splice(entries.begin(),entries,it->second);
+		value = it->second->second;
+		return true;
+	}
+	
+	void insert(const K& key, const V& value, size_t capacity)
+	{
+		lock_guard<mutex> lock(cache_mutex);
+		if (capacity == 0 || index.find(key) != index.end())
+			return;
+			
+		while (entries.size() >= capacity)
+		{
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+		
+		entries.push_front(pair<K,V>(key,value));
+		index[key] = entries.begin();
+	}
+	
+	void clear()
+	{
+		lock_guard<mutex> lock(cache_mutex);
+		entries.clear();
+		index.clear();
+		_hits = 0;
+		_misses = 0;
+	}
+	
+	long hits() const {lock_guard<mutex> lock(cache_mutex); return _hits;}
+	long misses() const {lock_guard<mutex> lock(cache_mutex); return _misses;}
+	size_t size() const {lock_guard<mutex> lock(cache_mutex); return entries.size();}
+};
+
 /* Other utility functions defined in util.cpp */
 int num_len (long n);
 char* c_string(const string& s);
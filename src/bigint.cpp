@@ -1,14 +1,21 @@
-/*********************************************************************** 
+/***********************************************************************
              bigint A. Bartholomew 2nd October 2005
 
-    bigint is an arbitrary precision integer class with an interface designed 
-	to meet the requirements of the braid programme.  It is based on earlier 
-	int128 and int64 code but uses the division algorithm in Knuth The Art 
-	of Computer Programing Vol 2 (third edition), page 272 (Algorithm D).  
+    bigint is an arbitrary precision integer class with an interface designed
+	to meet the requirements of the braid programme.
 
-	The class uses radix 2^16 storing the numerals in reverse order in a vector,
-	so that the ith place stores the numeral for the ith power of the radix.  The 
-	sign is stored separately.
+	The class uses radix 2^64 storing the limbs in reverse order, so that the
+	ith place stores the limb for the ith power of the radix, and the sign is
+	stored separately.  A magnitude of a single limb is stored inline and the
+	arithmetic operators handle that case directly, using unsigned __int128
+	where a result may exceed a limb, so only genuinely large values reach the
+	multi-limb routines below.
+
+	Multiplication uses Karatsuba's algorithm once both operands have
+	KARATSUBA_THRESHOLD limbs and the long multiplication otherwise.  Division
+	uses Algorithm D in Knuth The Art of Computer Programing Vol 2 (third
+	edition), page 272, and gcd uses the binary algorithm, Algorithm B from
+	section 4.5.2, working in place on the limbs.
 
 ***********************************************************************/
 
@@ -22,6 +29,7 @@
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -30,694 +38,667 @@ extern ofstream debug;
 #include <util.h>
 #include <bigint.h>
 
-unsigned long decimal[10];
+typedef bigint::limb limb;
+typedef unsigned __int128 double_limb;
+
+/* KARATSUBA_THRESHOLD is the number of limbs below which the long multiplication is faster than Karatsuba's algorithm */
+#define KARATSUBA_THRESHOLD 32
+
+/* DECIMAL_CHUNK is the largest power of ten that fits in a limb, it has DECIMAL_CHUNK_DIGITS digits */
+#define DECIMAL_CHUNK 10000000000000000000ULL
+#define DECIMAL_CHUNK_DIGITS 19
 
 /********************* Function prototypes ********************/
 void sum(bigint& result,const bigint& a, const bigint& b);
 void diff(bigint& result,const bigint& a, const bigint& b);
-int ten_power (int exponent);
 int num_len (unsigned int n);
 ostream& operator << (ostream& os, const bigint& a);
 
-/*
-bigint::bigint()
-{
-    n.resize(1);
-	n[0] = 0;
-    negative = false;
-	cout << "\nmade a bigint with vector at " << &n << endl;
-}
+/* The following functions act on magnitudes held as arrays of limbs, least significant first */
 
-bigint::bigint() : n(1)
+/* limb_length returns the length of a once leading zero limbs are removed, at least 1 */
+static inline size_t limb_length(const limb* a, size_t length)
 {
-    negative = false;
+	while (length > 1 && a[length-1] == 0)
+		length--;
+	return length;
 }
-*/
-
 
-bigint::bigint(const int nn)
+static int compare_limbs(const limb* a, size_t na, const limb* b, size_t nb)
 {
+	na = limb_length(a,na);
+	nb = limb_length(b,nb);
 
-	int num = nn;
-    if (num <0)
-    {
-		negative = true;
-		num *= -1;
-    }
-    else
-		negative = false;
-
-	int digits = (num > BASE ? 2 : 1);
+	if (na != nb)
+		return (na > nb? 1: -1);
 
-    n.resize(digits);
-	n[0] = num%BASE;
-	
-	if (digits > 1)
-		n[1] = num/BASE;
+	for (size_t i=na; i> 0; i--)
+	{
+		if (a[i-1] != b[i-1])
+			return (a[i-1] > b[i-1]? 1: -1);
+	}
+	return 0;
 }
 
-bigint::bigint(const unsigned long num)
+/* add_limbs adds the na limbs of a to the nr limbs of r, where na <= nr, and returns the carry out of r */
+static limb add_limbs(limb* r, size_t nr, const limb* a, size_t na)
 {
-	negative = false;
+	limb carry = 0;
+	size_t i;
+	for (i=0; i< na; i++)
+	{
+		double_limb t = static_cast<double_limb>(r[i]) + a[i] + carry;
+		r[i] = static_cast<limb>(t);
+		carry = static_cast<limb>(t >> 64);
+	}
 
-	int digits = (num > BASE ? 2 : 1);
-    n.resize(digits);
-	n[0] = num%BASE;
-	
-	if (digits > 1)
-		n[1] = num/BASE;
+	for (; carry && i< nr; i++)
+	{
+		r[i]++;
+		carry = (r[i] == 0);
+	}
+	return carry;
 }
 
-bigint::operator bool() // conversion operator to a bool
-{
-
-if (bigint_control::DEBUG & bigint_control::bool_conv)
+/* subtract_limbs subtracts the na limbs of a from the nr limbs of r, where na <= nr, and returns the borrow out of r */
+static limb subtract_limbs(limb* r, size_t nr, const limb* a, size_t na)
 {
-	debug << "bigint::operator bool() : ";
-	(*this).dump(debug);
-	debug << endl;
-}
+	limb borrow = 0;
+	size_t i;
+	for (i=0; i< na; i++)
+	{
+		limb t = r[i] - a[i];
+		limb b = (r[i] < a[i]);
+		r[i] = t - borrow;
+		borrow = b | (t < borrow);
+	}
 
-	if (*this != bigint(0))
-		return true;
-	else
-		return false;
+	for (; borrow && i< nr; i++)
+	{
+		borrow = (r[i] == 0);
+		r[i]--;
+	}
+	return borrow;
 }
 
-bigint::operator int() // conversion operator to an int
+/* multiply_add_limb sets the nr limbs of r to r*factor+addend and returns the limb carried out of r */
+static limb multiply_add_limb(limb* r, size_t nr, limb factor, limb addend)
 {
-	if (negative)
-		return -1 * n[0];
-	else
-		return n[0];
+	limb carry = addend;
+	for (size_t i=0; i< nr; i++)
+	{
+		double_limb t = static_cast<double_limb>(r[i]) * factor + carry;
+		r[i] = static_cast<limb>(t);
+		carry = static_cast<limb>(t >> 64);
+	}
+	return carry;
 }
 
-bigint& bigint::operator ++ () //prefix
+/* divide_limb divides the nr limbs of r in place by divisor and returns the remainder */
+static limb divide_limb(limb* r, size_t nr, limb divisor)
 {
-    bigint local = 1;
-    *this += local;
-    return *this;
+	double_limb remainder = 0;
+	for (size_t i=nr; i> 0; i--)
+	{
+		double_limb t = (remainder << 64) | r[i-1];
+		r[i-1] = static_cast<limb>(t / divisor);
+		remainder = t % divisor;
+	}
+	return static_cast<limb>(remainder);
 }
 
-bigint bigint::operator ++ (int) //postfix
+/* long_multiply sets the na+nb limbs of r to the product of a and b */
+static void long_multiply(limb* r, const limb* a, size_t na, const limb* b, size_t nb)
 {
-    bigint tmp = *this;
-    ++*this;
-    return tmp;
-}
+	fill(r, r+na+nb, 0);
+	for (size_t i=0; i< na; i++)
+	{
+		if (a[i] == 0)
+			continue;
 
-bigint& bigint::operator -- () //prefix
-{
-    bigint local = 1;
-    *this -= local;
-    return *this;
+		limb carry = 0;
+		for (size_t j=0; j< nb; j++)
+		{
+			double_limb t = static_cast<double_limb>(a[i]) * b[j] + r[i+j] + carry;
+			r[i+j] = static_cast<limb>(t);
+			carry = static_cast<limb>(t >> 64);
+		}
+		r[i+nb] = carry;
+	}
 }
 
-bigint bigint::operator -- (int) //postfix
+/* multiply_limbs sets the na+nb limbs of r to the product of a and b, which must not overlap r.  Writing a = a_1 B^h + a_0 and
+   b = b_1 B^h + b_0, Karatsuba's algorithm evaluates ab = a_1 b_1 B^2h + ((a_0+a_1)(b_0+b_1) - a_0 b_0 - a_1 b_1) B^h + a_0 b_0
+   with three half size products.  If b is shorter than half of a we multiply b by successive blocks of a instead.
+*/
+static void multiply_limbs(limb* r, const limb* a, size_t na, const limb* b, size_t nb)
 {
-    bigint tmp = *this;
-    --*this;
-    return tmp;
-}
+	if (na < nb)
+	{
+		swap(a,b);
+		swap(na,nb);
+	}
 
-void bigint::dump(ostream& s) const
-{
-	
-	s << "bigint(";
-	s << n.size() << ',';
-	
-	if (negative)
-		s << '-';
-	else 
-		s << '+';
-		
-	for (vector<unsigned int>::const_iterator nptr = n.begin(); nptr != n.end(); nptr++)
-		s << ',' << *nptr;
-	s << ')' << flush;
-}
+	if (nb < KARATSUBA_THRESHOLD)
+	{
+		long_multiply(r,a,na,b,nb);
+		return;
+	}
 
-/* sanitize removes any leading zeros from the list of digits */
+	size_t h = (na+1)/2;
+	size_t nr = na+nb;
 
-void bigint::sanitize()
-{
+	if (nb <= h)
+	{
+		fill(r, r+nr, 0);
+		vector<limb> block(2*nb);
+		for (size_t i=0; i< na; i+= nb)
+		{
+			size_t length = min(nb, na-i);
+			multiply_limbs(&block[0], a+i, length, b, nb);
+			add_limbs(r+i, nr-i, &block[0], length+nb);
+		}
+		return;
+	}
 
-if (bigint_control::DEBUG & bigint_control::sanitize)
-{
-	debug << "bigint::sanitize : ";
-	(*this).dump(debug);
-	debug << endl;
+	vector<limb> sum_a(h+1);
+	copy(a, a+h, sum_a.begin());
+	sum_a[h] = add_limbs(&sum_a[0], h, a+h, na-h);
+
+	vector<limb> sum_b(h+1);
+	copy(b, b+h, sum_b.begin());
+	sum_b[h] = add_limbs(&sum_b[0], h, b+h, nb-h);
+
+	vector<limb> middle(2*h+2);
+	multiply_limbs(&middle[0], &sum_a[0], h+1, &sum_b[0], h+1);
+
+	multiply_limbs(r, a, h, b, h);
+	multiply_limbs(r+2*h, a+h, na-h, b+h, nb-h);
+
+	subtract_limbs(&middle[0], 2*h+2, r, 2*h);
+	subtract_limbs(&middle[0], 2*h+2, r+2*h, nr-2*h);
+
+	/* the middle term is a_0 b_1 + a_1 b_0, so its significant limbs fit in r above B^h */
+	add_limbs(r+h, nr-h, &middle[0], min(2*h+2, nr-h));
 }
-	size_t size = n.size();
 
-if (bigint_control::DEBUG & bigint_control::sanitize)
+/* divide_limbs is Knuth's Algorithm D.  It sets quotient and remainder to the quotient and remainder of u by v, where nu >= nv
+   and the most significant limb of v is non-zero.  We use u, v, n, m, j, q_hat and r_hat as in Knuth, with b = 2^64.
+*/
+static void divide_limbs(const limb* u, size_t nu, const limb* v, size_t nv, vector<limb>& quotient, vector<limb>& remainder)
 {
-	debug << "bigint::sanitize : initial size = " << size << endl;
-}
-	
-	for (vector<unsigned int>::reverse_iterator n_ptr=n.rbegin(); n_ptr != n.rend(); n_ptr++)
+	size_t n = nv;
+	size_t m = nu - nv;
+	quotient.assign(m+1,0);
+
+	if (n == 1)
 	{
-		if (*n_ptr == 0)
-			size--;
-		else
-			break;	
+		quotient.assign(u, u+nu);
+		remainder.assign(1, divide_limb(&quotient[0], nu, v[0]));
+		return;
 	}
 
-if (bigint_control::DEBUG & bigint_control::sanitize)
-{
-	debug << "bigint::sanitize : final size = " << size << endl;
-}
-	if(size == 0)
-		size=1;
-		
-	n.resize(size); // discards high end zeros.
+	/* D1: normalize, so the most significant limb of v has its top bit set */
+	int shift = __builtin_clzll(v[n-1]);
+	vector<limb> vn(n);
+	vector<limb> un(nu+1);
 
-if (bigint_control::DEBUG & bigint_control::sanitize)
-{
-	debug << "bigint::sanitize : after sanitizing (*this) = ";
-	(*this).dump(debug);
-	debug << endl;
-}
+	for (size_t i=n-1; i> 0; i--)
+		vn[i] = (shift? (v[i] << shift) | (v[i-1] >> (64-shift)): v[i]);
+	vn[0] = v[0] << shift;
 
-}
+	un[nu] = (shift? u[nu-1] >> (64-shift): 0);
+	for (size_t i=nu-1; i> 0; i--)
+		un[i] = (shift? (u[i] << shift) | (u[i-1] >> (64-shift)): u[i]);
+	un[0] = u[0] << shift;
 
-bigint operator + (const bigint& a, const bigint& b)
-{
-if (bigint_control::DEBUG & bigint_control::add)
-{
-	debug << "bigint::operator + : a = " << a << 
-	         "\n                     b = " << b << endl;
-}
-    bigint result;
+	/* D2 to D7, the loop is really j=m; j>=0; j-- but j is unsigned */
+	for (size_t J=m+1; J> 0; J--)
+	{
+		size_t j = J-1;
 
-    if (a.negative && b.negative)
-    {
-if (bigint_control::DEBUG & bigint_control::add)
-	debug << "bigint::operator + : both negative" << endl;
-		result.negative = true;
-		sum(result,a,b);
-    }
-    else if (a.negative)
-    {
-		if ( abs(a) >= abs(b) )
-		{
-if (bigint_control::DEBUG & bigint_control::add)
-	debug << "bigint::operator + : a negative b positive result negative" << endl;
-	    	result.negative = true;
-	    	diff (result,a,b);
-		}
-		else
+		/* D3: un[j+n] <= vn[n-1], so q_hat may reach b, in which case the first test fails without evaluating a product that
+		   could overflow; once r_hat reaches b the test cannot succeed.
+		*/
+		double_limb numerator = (static_cast<double_limb>(un[j+n]) << 64) | un[j+n-1];
+		double_limb q_hat = numerator / vn[n-1];
+		double_limb r_hat = numerator % vn[n-1];
+
+		while ((q_hat >> 64) || q_hat * vn[n-2] > ((r_hat << 64) | un[j+n-2]))
 		{
-if (bigint_control::DEBUG & bigint_control::add)
-	debug << "bigint::operator + : a negative b positive result positive" << endl;
-		    result.negative = false;
-		    diff (result,b,a);
+			q_hat--;
+			r_hat += vn[n-1];
+			if (r_hat >> 64)
+				break;
 		}
-    }
-    else if (b.negative)
-    {
-		if ( abs(a) >= abs(b) )
+
+		/* D4: multiply and subtract */
+		limb carry = 0;
+		limb borrow = 0;
+		for (size_t i=0; i< n; i++)
 		{
-if (bigint_control::DEBUG & bigint_control::add)
-	debug << "bigint::operator + : a positive b negative result positive" << endl;
-	    	result.negative = false;
-	    	diff (result,a,b);
+			double_limb product = q_hat * vn[i] + carry;
+			carry = static_cast<limb>(product >> 64);
+			double_limb difference = static_cast<double_limb>(un[i+j]) - static_cast<limb>(product) - borrow;
+			un[i+j] = static_cast<limb>(difference);
+			borrow = static_cast<limb>(difference >> 127);
 		}
-		else
+		double_limb difference = static_cast<double_limb>(un[j+n]) - carry - borrow;
+		un[j+n] = static_cast<limb>(difference);
+
+		/* D5 and D6: add back if the result was negative */
+		if (difference >> 127)
 		{
-if (bigint_control::DEBUG & bigint_control::add)
-	debug << "bigint::operator + : a positive b negative result negative" << endl;
-	    	result.negative = true;
-	    	diff (result,b,a);
+			q_hat--;
+			un[j+n] += add_limbs(&un[j], n, &vn[0], n);
 		}
-    }
-    else
-    {
-if (bigint_control::DEBUG & bigint_control::add)
-	debug << "bigint::operator + : both positive" << endl;
-		result.negative = false;
-		sum (result,a,b);
-    }
-    return result;
+
+		quotient[j] = static_cast<limb>(q_hat);
+	}
+
+	/* D8: unnormalize */
+	remainder.resize(n);
+	for (size_t i=0; i< n-1; i++)
+		remainder[i] = (shift? (un[i] >> shift) | (un[i+1] << (64-shift)): un[i]);
+	remainder[n-1] = un[n-1] >> shift;
 }
 
-bigint operator - (const bigint& a, const bigint& b)
+/* shift_right_limbs shifts the magnitude in r right by bits places, returning the new length */
+static size_t shift_right_limbs(limb* r, size_t nr, size_t bits)
 {
-if (bigint_control::DEBUG & bigint_control::subtract)
-	debug << "bigint::operator - :" << endl;
-	
-	bigint minusb = b*-1;
-	return a+minusb;
+	size_t limbs = bits/64;
+	int shift = bits%64;
+
+	if (limbs >= nr)
+	{
+		r[0] = 0;
+		return 1;
+	}
+
+	size_t length = nr - limbs;
+	for (size_t i=0; i< length; i++)
+	{
+		limb high = (i+1 < length? r[i+limbs+1]: 0);
+		r[i] = (shift? (r[i+limbs] >> shift) | (high << (64-shift)): r[i+limbs]);
+	}
+	return limb_length(r,length);
 }
 
-bigint operator * (const bigint& a, const bigint& b)
-{
-	unsigned long carry;
-    bigint result;
-	
-if (bigint_control::DEBUG & bigint_control::multiply)
+static size_t trailing_zero_bits(const limb* r, size_t nr)
 {
-	debug << "bigint::operator * : a = " << a << 
-             "\n                     b = " << b << endl;
-	debug << "bigint::operator * : a = ";
-	a.dump(debug);
-	debug << endl;
-	debug << "bigint::operator * : b = ";
-	b.dump(debug);
-	debug << endl;
+	size_t bits = 0;
+	for (size_t i=0; i< nr; i++)
+	{
+		if (r[i])
+			return bits + __builtin_ctzll(r[i]);
+		bits += 64;
+	}
+	return bits;
 }
 
-    /* first check for zero product */
-    if (a == 0 || b == 0)
-    {
+static limb gcd_limb(limb u, limb v)
+{
+	if (u == 0)
+		return v;
+	if (v == 0)
+		return u;
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-	debug << "bigint::operator * : zero operand, returning zero" << endl;	
+	int k = __builtin_ctzll(u|v);
+	u >>= __builtin_ctzll(u);
+	do
+	{
+		v >>= __builtin_ctzll(v);
+		if (u > v)
+			swap(u,v);
+		v -= u;
+	} while (v != 0);
 
-		return 0;
-    }
+	return u << k;
+}
 
-    if (a == 1 )
-    {
+/********************* bigint members ********************/
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-	debug << "bigint::operator * : a = 1, returning b" << endl;	
+/* assign sets the magnitude to the length limbs at a, keeping the inline form whenever the magnitude fits in a limb */
+void bigint::assign(const limb* a, size_t length)
+{
+	length = limb_length(a,length);
 
-		return b;
-    }
+	if (length == 1)
+	{
+		small = a[0];
+		n.clear();
+	}
+	else
+	{
+		small = 0;
+		n.assign(a, a+length);
+	}
 
-    if (b == 1 )
-    {
+	if (small == 0 && n.empty())
+		negative = false;
+}
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-	debug << "bigint::operator * : b = 1, returning a" << endl;	
+int bigint::compare(const bigint& a, const bigint& b)
+{
+	if (a.negative != b.negative)
+		return (a.negative? -1: 1);
 
-		return a;
-    }
+	int magnitude;
+	if (a.n.empty() && b.n.empty())
+		magnitude = (a.small == b.small? 0: (a.small > b.small? 1: -1));
+	else
+		magnitude = compare_limbs(a.limbs(), a.size(), b.limbs(), b.size());
 
-    if ((a.negative || b.negative) && !(a.negative && b.negative))
-        result.negative = true;
-    else
-        result.negative = false;
-        
-	result.n.resize(a.n.size()+b.n.size());
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * : a.n.size() = " << a.n.size() << " b.n.size() = " << b.n.size()  << " result.n.size() = " << result.n.size() << endl;
+	return (a.negative? -magnitude: magnitude);
 }
-	
-    /* now multiply b through by a */
-    for (size_t apower=0; apower < a.n.size(); apower++)
-    {
-		unsigned long loc_res;
-		
-		if (a.n[apower] == 0)
-	    	continue;
 
-if (bigint_control::DEBUG & bigint_control::multiply)
+/* accumulate adds b to a, or subtracts it if subtract is true */
+void bigint::accumulate(bigint& a, const bigint& b, bool subtract)
 {
-	debug << "bigint::operator * : multiply b by " << a.n[apower] << endl;
-}
-		size_t rpower = apower;
-		carry = 0;
+	bool b_negative = (b.negative != subtract);
 
-		for (size_t bpower = 0; bpower < b.n.size(); bpower++)
+	if (a.n.empty() && b.n.empty())
+	{
+		if (a.negative == b_negative || a.small == 0)
 		{
-		    loc_res = (unsigned long)a.n[apower]*(unsigned long)b.n[bpower]+carry;
+			if (a.small == 0)
+				a.negative = b_negative;
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * : rpower = " << rpower << " carry = " << carry << endl;
-	debug << "bigint::operator * : initial result = " << loc_res <<endl;
-}			
-	    	carry = 0;
-	    	if ( loc_res > MAX_DIGIT )
-	    	{
-				carry = loc_res / BASE;
-				loc_res %= BASE;
+			limb t = a.small + b.small;
+			if (t < a.small)
+			{
+				a.n.resize(2);
+				a.n[0] = t;
+				a.n[1] = 1;
+				a.small = 0;
+			}
+			else
+				a.small = t;
+		}
+		else if (a.small >= b.small)
+		{
+			a.small -= b.small;
+		}
+		else
+		{
+			a.small = b.small - a.small;
+			a.negative = b_negative;
+		}
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * :     carry = " << carry << endl;
-	debug << "bigint::operator * :     interim result = " << loc_res <<endl;
-}			
-	    	}
+		if (a.small == 0 && a.n.empty())
+			a.negative = false;
+		return;
+	}
 
-			loc_res += (unsigned long)result.n[rpower];
-				
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * :   add in " << result.n[rpower] << endl;
-	debug << "bigint::operator * :   interim result = " << loc_res <<endl;
-}			
-	    	if ( loc_res > MAX_DIGIT )
-	    	{
-				loc_res %= BASE;
-				carry++;
+	const limb* x = a.limbs();
+	size_t nx = a.size();
+	const limb* y = b.limbs();
+	size_t ny = b.size();
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * :     carry = " << carry << endl;
-	debug << "bigint::operator * :     interim result = " << loc_res <<endl;
-}			
-	    	}
-			
-			result.n[rpower++] = (unsigned int)loc_res;
+	if (a.negative == b_negative)
+	{
+		size_t length = max(nx,ny)+1;
+		vector<limb> result(length,0);
+		copy(x, x+nx, result.begin());
+		add_limbs(&result[0], length, y, ny);
+		a.assign(&result[0], length);
+	}
+	else
+	{
+		bool result_negative = a.negative;
+		if (compare_limbs(x,nx,y,ny) < 0)
+		{
+			swap(x,y);
+			swap(nx,ny);
+			result_negative = b_negative;
+		}
+		vector<limb> result(x,x+nx);
+		subtract_limbs(&result[0], nx, y, ny);
+		a.negative = result_negative;
+		a.assign(&result[0], nx);
+	}
+}
 
-if (bigint_control::DEBUG & bigint_control::multiply)
+/* divide sets the quotient and remainder of a by b, either of which may be null.  As for the built in integer types, the
+   quotient is truncated towards zero and the remainder takes the sign of a.
+*/
+void bigint::divide(const bigint& a, const bigint& b, bigint* quotient, bigint* remainder)
 {
-	debug << "bigint::operator * :   result.n[" << rpower << "] = " << loc_res <<endl;
-}			
-		}
+   	if (b.n.empty() && b.small == 0)
+   	{
+    	cout << "bigint::operator / : zero divide error" << endl;
+       	exit(0);
+   	}
 
-	    if (carry)
+	bool quotient_negative = (a.negative != b.negative);
+	bool remainder_negative = a.negative;
+
+	if (a.n.empty() && b.n.empty())
+	{
+		limb q = a.small / b.small;
+		limb r = a.small % b.small;
+
+		if (quotient != 0)
 		{
-			result.n[rpower] = carry;
+			quotient->n.clear();
+			quotient->small = q;
+			quotient->negative = (quotient_negative && q != 0);
+		}
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * :   carry left over" << endl;
-	debug << "bigint::operator * :     result.n[" << rpower << "] = " << loc_res <<endl;
-}			
+		if (remainder != 0)
+		{
+			remainder->n.clear();
+			remainder->small = r;
+			remainder->negative = (remainder_negative && r != 0);
 		}
-    }
+		return;
+	}
 
-	if (result.n[result.n.size()-1] == 0)
-		result.n.pop_back(); // removes the zero in the most significant digit
+	if (compare_limbs(a.limbs(),a.size(),b.limbs(),b.size()) < 0)
+	{
+		if (remainder != 0)
+			*remainder = a;
+		if (quotient != 0)
+			*quotient = bigint(0);
+		return;
+	}
 
-if (bigint_control::DEBUG & bigint_control::multiply)
-{
-	debug << "bigint::operator * : result = " << result << endl;
-	debug << "bigint::operator * : result = ";
-	result.dump(debug);
-	debug << endl;
-}
-   return result;
+	vector<limb> q;
+	vector<limb> r;
+	divide_limbs(a.limbs(), a.size(), b.limbs(), b.size(), q, r);
+
+	if (quotient != 0)
+	{
+		quotient->negative = quotient_negative;
+		quotient->assign(&q[0], q.size());
+	}
+
+	if (remainder != 0)
+	{
+		remainder->negative = remainder_negative;
+		remainder->assign(&r[0], r.size());
+	}
 }
 
-/* the division operator is based on the algorithm D in Knuth The Art of Computer Programing 
-   Vol 2 (third edition), page 272 (Algorithm D).  We use u,v, n, m i and j as in Knuth.
-	   */
-bigint operator / (const bigint& a, const bigint& b)
+bigint::operator bool() // conversion operator to a bool
 {
-	bigint u = a;
-	bigint v = b;
-   	bigint q; //quotient
 
-if (bigint_control::DEBUG & bigint_control::divide)
+if (bigint_control::DEBUG & bigint_control::bool_conv)
 {
-	debug << "bigint::operator / : u = " << u << 
-	         "\n                     v = " << v << endl;
-	debug << "bigint::operator / : u = "; 
-	u.dump(debug);
-	debug << endl;
-	debug << "bigint::operator / : v = "; 
-	v.dump(debug);
+	debug << "bigint::operator bool() : ";
+	(*this).dump(debug);
 	debug << endl;
 }
 
-   	if (v == bigint(0))
-   	{
-    	cout << "bigint::operator / : zero divide error" << endl;
-       	exit(0);
-   	}
+	return !n.empty() || small != 0;
+}
 
-   	if (v == bigint(1))
-   	{
-    	q = u;
-		
-if (bigint_control::DEBUG & bigint_control::divide)
+bigint::operator int() // conversion operator to an int
 {
-	debug << "bigint::operator / : v = 1, returning u" << endl;
+	int value = static_cast<int>(limbs()[0]);
+
+	if (negative)
+		return -1 * value;
+	else
+		return value;
 }
-       	return q;
-   	}
 
-   	if (u == v)
-   	{
-if (bigint_control::DEBUG & bigint_control::divide)
+bigint& bigint::operator ++ () //prefix
 {
-	debug << "bigint::operator / : u = v, returning 1" << endl;
+    accumulate(*this,bigint(1),false);
+    return *this;
 }
-    	q = 1;
-       	return q;
-   	}
-
-   	if ( abs(v) > abs(u) )
-   	{
 
-if (bigint_control::DEBUG & bigint_control::divide)
+bigint bigint::operator ++ (int) //postfix
 {
-	debug << "bigint::operator / : abs(v) > abs(u), returning 0" << endl;
+    bigint tmp = *this;
+    ++*this;
+    return tmp;
 }
-       	q = 0;
-       	return q;
-   	}
 
-   	if (u.n.size() == 1  && v.n.size() == 1)
-   	{
-
-if (bigint_control::DEBUG & bigint_control::divide)
+bigint& bigint::operator -- () //prefix
 {
-	debug << "bigint::operator / : both u and v fit in unsigned long" << endl;
+    accumulate(*this,bigint(1),true);
+    return *this;
 }
-       	unsigned long t = u.n[0]/v.n[0];
-		q = t;
-
-       	if ((u.negative || v.negative) && !(u.negative && v.negative))
-	   		q.negative = true;
 
-if (bigint_control::DEBUG & bigint_control::divide)
+bigint bigint::operator -- (int) //postfix
 {
-	debug << "bigint::operator / : returning q = " << q << endl;
+    bigint tmp = *this;
+    --*this;
+    return tmp;
 }
-       	return q;
-   	}
-	else if (v.n.size() == 1)
-	{
-
-		unsigned long r = 0;
-		size_t n = u.n.size();
-		q.n.resize(n);
 
-if (bigint_control::DEBUG & bigint_control::divide)
+void bigint::dump(ostream& s) const
 {
-	debug << "bigint::operator / : using single digit denominator algorithm" << endl;
-	debug << "bigint::operator / : n = " << n << endl;
+
+	s << "bigint(";
+	s << size() << ',';
+
+	if (negative)
+		s << '-';
+	else
+		s << '+';
+
+	const limb* l = limbs();
+	for (size_t i=0; i< size(); i++)
+		s << ',' << l[i];
+	s << ')' << flush;
 }
 
-		for (size_t j=n; j> 0; j--)
-		{
-		
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug <<"bigint::operator / :   j = " << j-1 << endl;			
+/* sanitize restores the inline form of a magnitude that fits in a single limb and clears the sign of zero */
+void bigint::sanitize()
+{
 
-			/* set q_{j} = (r*b + u_{j})/v_{0}
-			           r = (r*b + u_{j}) - q_{j} * v_{0}
-			   loop is for j=n-1 j>=0 j--, but j is unsigned, hence translation
-			*/
-			r = r * BASE + u.n[j-1];
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug <<"bigint::operator / :     r = " << r << endl;			
-			q.n[j-1] = r / v.n[0];
-if (bigint_control::DEBUG & bigint_control::divide)
+if (bigint_control::DEBUG & bigint_control::sanitize)
 {
-	debug << "bigint::operator / :     q.n[j] = " << q.n[j-1] << endl;			
-	debug << "bigint::operator / :     product = " << q.n[j-1] * v.n[0] << endl;
+	debug << "bigint::sanitize : ";
+	(*this).dump(debug);
+	debug << endl;
 }
-			r -= q.n[j-1] * v.n[0];
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :     r = " << r << endl;			
-		}
+	if (!n.empty())
+	{
+		vector<limb> magnitude;
+		magnitude.swap(n);
+		assign(&magnitude[0], magnitude.size());
+	}
+	else if (small == 0)
+		negative = false;
 
-	   	/* now set the sign of the quotient */
-	   	if ((u.negative || v.negative) && !(u.negative && v.negative))
-    	    q.negative = true;
+if (bigint_control::DEBUG & bigint_control::sanitize)
+{
+	debug << "bigint::sanitize : after sanitizing (*this) = ";
+	(*this).dump(debug);
+	debug << endl;
+}
 
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug <<"bigint::operator / :   q = " << q << endl;			
-		
-		q.sanitize();
-		
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug <<"bigint::operator / :   after sanitizing q = " << q << endl;			
+}
 
-		return q;
-	}
+/********************* bigint friends ********************/
 
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / : full division algorithm required" << endl;
+bigint operator + (const bigint& a, const bigint& b)
+{
+if (bigint_control::DEBUG & bigint_control::add)
+{
+	debug << "bigint::operator + : a = " << a <<
+	         "\n                     b = " << b << endl;
+}
+	bigint result = a;
+	bigint::accumulate(result,b,false);
+	return result;
+}
 
-   	/* so we've go some work to do, with abs(v) < abs(u), 
-	*/
-	size_t n = v.n.size();
-	size_t m = u.n.size() - n;
-	q.n.resize(m+1);
-	
-	/* normalize */
-	unsigned long d = BASE/(v.n[n-1] +1);
+bigint operator - (const bigint& a, const bigint& b)
+{
+if (bigint_control::DEBUG & bigint_control::subtract)
+{
+	debug << "bigint::operator - : a = " << a <<
+	         "\n                     b = " << b << endl;
+}
+	bigint result = a;
+	bigint::accumulate(result,b,true);
+	return result;
+}
 
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / : normalizing factor d = " << d << endl;
+bigint operator * (const bigint& a, const bigint& b)
+{
+    bigint result;
 
-	if (d != 1)
-	{
-		u *= bigint(d);
-		v *= bigint(d);
-	}
-	
-if (bigint_control::DEBUG & bigint_control::divide)
+if (bigint_control::DEBUG & bigint_control::multiply)
 {
-	debug << "bigint::operator / : scaled u = " << u << endl;
-	debug << "bigint::operator / : scaled v = " << v << endl;
+	debug << "bigint::operator * : a = " << a <<
+             "\n                     b = " << b << endl;
 }
 
-	/* provide the introduction of the new digit position from step D1
-	   if it has not already been done by the normalizing */
-	u.n.resize(m+n+1); 
+	bool negative = (a.negative != b.negative);
 
-if (bigint_control::DEBUG & bigint_control::divide)
-{
-	debug << "bigint::operator / : resized u = ";
-	u.dump(debug);
-	debug << endl;
-	debug << "bigint::operator / : v = ";
-	v.dump(debug);
-	debug << endl;}
-	
-	/* this is the loop through steps D2 to D7
-	   again, loop is really j=m; j>=0; j-- but j is again unsigned.  As the complexity is greater here,
-	   we use J as the loop control variable and adjust to j for use in the code.
-	*/
-	for (size_t J=m+1; J>0; J--)
+	if (a.n.empty() && b.n.empty())
 	{
-		size_t j= J-1;  // so we loop j=m; j>=0; j--
+		double_limb product = static_cast<double_limb>(a.small) * b.small;
+		limb high = static_cast<limb>(product >> 64);
 
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / : j = " << j << endl;
-		
-		/* each digit is <= BASE-1, so u[j+n]*BASE +u[j+n-1] < (BASE-1)*BASE + BASE-1 = BASE^2 -1
-		   and this is less than BASE^2, so it fits in an unsigned long.
-		*/
-		unsigned long r_hat = u.n[j+n]*BASE + u.n[j+n-1];
-		unsigned long q_hat = r_hat/v.n[n-1];
-		r_hat -= q_hat * v.n[n-1];
-		
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :   q_hat = " << q_hat << " r_hat = " << r_hat << endl;
-		
-		if (q_hat == BASE || q_hat * v.n[n-2] > BASE * r_hat + u.n[j+n-2])
+		if (high == 0)
+			result.small = static_cast<limb>(product);
+		else
 		{
-			q_hat--;
-			r_hat += v.n[n-1];
-
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :   after first test q_hat = " << q_hat << " r_hat = " << r_hat << endl;
-
-			if (r_hat < BASE && (q_hat == BASE || q_hat * v.n[n-2] > BASE * r_hat + u.n[j+n-2]))
-			{
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :   after second test q_hat = " << q_hat << endl;
-				q_hat--;
-			}
+			result.n.resize(2);
+			result.n[0] = static_cast<limb>(product);
+			result.n[1] = high;
 		}
-		
-		/* multiply and subtract */
-		unsigned long borrow = 0;
-		bigint p = bigint(q_hat) * v; //product;		
-		p.n.resize(n+1);
+		result.negative = (negative && product != 0);
+	}
+	else
+	{
+		size_t na = a.size();
+		size_t nb = b.size();
+		vector<limb> product(na+nb);
+		multiply_limbs(&product[0], a.limbs(), na, b.limbs(), nb);
+		result.negative = negative;
+		result.assign(&product[0], na+nb);
+	}
 
-if (bigint_control::DEBUG & bigint_control::divide)
+if (bigint_control::DEBUG & bigint_control::multiply)
 {
-	debug << "bigint::operator / :   q_hat * v = " << p << endl;
-	debug << "bigint::operator / :   q_hat * v = ";
-	p.dump(debug);
+	debug << "bigint::operator * : result = ";
+	result.dump(debug);
 	debug << endl;
 }
-		
-		for (size_t i = 0; i < n+1; i++)
-		{
-
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :   subtraction: i = " << i << endl;
-		
-			/* Here we would naturally write 
-               u.n[j+i] -= p.n[i] + borrow;
-			   if (u.n[j+i] < 0)
-			   	...
-			   
-			   but the vector is unsigned integeters, so we have to 
-			   carry out the check for borrow first.
-			*/
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :     p.n[" << i << "] = " << p.n[i] << " borrow = " << borrow << 
-	" u.n[" << j+i << "] = " << u.n[j+i] << endl;
+   return result;
+}
 
-			if (p.n[i] + borrow > u.n[j+i])
-			{
-				u.n[j+i] += BASE;
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :     add BASE to u.n[" << j+i << "] to give " << u.n[j+i] << endl;
-				u.n[j+i] -= p.n[i] + borrow;
-				borrow = 1;
-			}
-			else
-			{
-				u.n[j+i] -= p.n[i] + borrow;
-				borrow = 0;
-			}
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :     u.n[" << j+i << "] = " << u.n[j+i] << " borrow = " << borrow << endl;
-		}
-			
-		/* Step D6 */
-		if (borrow)
-		{
-if (bigint_control::DEBUG & bigint_control::divide)
-	debug << "bigint::operator / :     result negative, add back " << endl;
-			q_hat--;
-			
-			unsigned long carry = 0;
-			
-			for (size_t i = 0; i < n+1; i++)
-			{
-				u.n[j+i] += v.n[i] + carry;
-				if (u.n[j+i] >= BASE) 
-				{
-					u.n[j+i] -= BASE;
-					carry = 1;
-				}
-				else
-					carry = 0;
-			}
-			
+bigint operator / (const bigint& a, const bigint& b)
+{
 if (bigint_control::DEBUG & bigint_control::divide)
 {
-	debug << "bigint::operator / :   q_hat = " << q_hat << endl;
-	debug << "bigint::operator / :   u = ";
-	u.dump(debug);
-	debug << endl;
+	debug << "bigint::operator / : u = " << a <<
+	         "\n                     v = " << b << endl;
 }
-			// ignore any carry left over
-			
-		}
-
-		q.n[j] = q_hat;
-		
-	}
-
-   	/* finally, set the sign of the quotient */
-   	if ((u.negative || v.negative) && !(u.negative && v.negative))
-        q.negative = true;
+	bigint q;
+	bigint::divide(a,b,&q,0);
 
 if (bigint_control::DEBUG & bigint_control::divide)
-{
 	debug << "bigint::operator / : result = " << q << endl;
-	debug << "bigint::operator / : result = ";
-	q.dump(debug);
-	debug << endl;
-}
-	
-	q.sanitize();
+
    	return q;
 }
 
@@ -725,190 +706,110 @@ bigint operator % (const bigint& a, const bigint& b)
 {
 if (bigint_control::DEBUG & bigint_control::remainder)
 	debug << "bigint::operator % : " << endl;
-    return a - a/b * b;
+
+	bigint r;
+	bigint::divide(a,b,0,&r);
+	return r;
 }
 
-bigint operator += (bigint& a, const bigint& b)
+bigint& operator += (bigint& a, const bigint& b)
 {
-    return a = a+b;
+	bigint::accumulate(a,b,false);
+    return a;
 }
 
-bigint operator -= (bigint& a, const bigint& b)
+bigint& operator -= (bigint& a, const bigint& b)
 {
-    return a = a-b;
+	bigint::accumulate(a,b,true);
+    return a;
 }
 
-bigint operator *= (bigint& a, const bigint& b)
+bigint& operator *= (bigint& a, const bigint& b)
 {
     return a = a*b;
 }
 
-bigint operator /= (bigint& a, const bigint& b)
+bigint& operator /= (bigint& a, const bigint& b)
 {
-    return a = a/b;
+	bigint::divide(bigint(a),b,&a,0);
+    return a;
 }
 
-bigint operator %= (bigint& a, const bigint& b)
+bigint& operator %= (bigint& a, const bigint& b)
 {
-    return a = a%b;
+	bigint::divide(bigint(a),b,0,&a);
+    return a;
 }
 
-bigint operator >>= (bigint& a, int n)
+/* the shift operators shift the magnitude of a, leaving the sign unchanged */
+bigint& operator >>= (bigint& a, int n)
 {
-	vector<unsigned int>::iterator aptr;
 
 if (bigint_control::DEBUG & bigint_control::r_shift)
 {
 	debug << "bigint::operator >>= : a = " << a  << ", n = " << n << endl;
-	debug << "bigint::operator >>= : a = ";
-	a.dump(debug);
-	debug << endl;	
 }
-	 
-
-//cout << "\nin shift operator" << endl;	
-
-	for (int i=0; i < n; i++)
+	if (a.n.empty())
 	{
-		aptr = a.n.begin();	
-		
-//cout << "\n\niteration " << i+1 << " of " << n	<< endl;
-
-		if (a.n.size() == 1)
-		{
-//cout << "\nsize = 1, *aptr = " << *aptr << endl;			
-			*aptr >>= 1;
-//cout << "\nsize = 1, after right shift *aptr = " << *aptr << endl;			
-		}
-		else
-		{
-			// r.n.size() >= 2
-			for ( ;aptr != a.n.end()-1; aptr++)
-			{
-//cout << "\n*aptr = " << *aptr << endl;			
-				*aptr >>= 1;
-//cout << "\nafter right shift *aptr = " << *aptr << endl;			
-				if (*(aptr+1) & 1)
-					*aptr |= BIGINT_MSB;
-			}
-//cout << "\nafter loop *aptr = " << *aptr << endl;			
-			*aptr >>= 1;
-//cout << "\nafter right shift *aptr = " << *aptr << endl;			
-		}
+		a.small = (n < 64? a.small >> n: 0);
+		if (a.small == 0)
+			a.negative = false;
+	}
+	else
+	{
+		vector<limb> magnitude;
+		magnitude.swap(a.n);
+		size_t length = shift_right_limbs(&magnitude[0], magnitude.size(), n);
+		a.assign(&magnitude[0], length);
 	}
 
-	a.sanitize();
-	
 if (bigint_control::DEBUG & bigint_control::r_shift)
 {
 	debug << "bigint::operator >>= : returning a = " << a << endl;
-	debug << "bigint::operator >>= : a = ";
-	a.dump(debug);
-	debug << endl;
 }
 	return a;
 }
 
-bigint operator <<= (bigint& a, int n)
+bigint& operator <<= (bigint& a, int n)
 {
-	vector<unsigned int>::reverse_iterator aptr;
-	
+
 if (bigint_control::DEBUG & bigint_control::l_shift)
 {
 	debug << "bigint::operator <<= : a = " << a  << ", n = " << n << endl;
-	debug << "bigint::operator <<= : a = ";
-	a.dump(debug);
-	debug << endl;	
 }
 
-	for (int i=0; i < n; i++)
+	if (n > 0 && a)
 	{
-		aptr = a.n.rbegin();
-		
- 		if (a.n.size() == 1)
-		{
-//cout << "\naptr = " << *aptr << endl;		
-			if (*aptr & BIGINT_MSB)
-			{
-				a.n.resize(a.n.size()+1);
-				*a.n.rbegin() = 1;
-//cout << "\nafter resizing aptr = " << *aptr << endl;		
-			}
-			*aptr <<= 1;
-			*aptr &= BIGINT_BITS;
-		}
-		else
+		size_t limbs = n/64;
+		int shift = n%64;
+		size_t na = a.size();
+		const limb* x = a.limbs();
+
+		vector<limb> magnitude(na+limbs+1,0);
+		for (size_t i=0; i< na; i++)
 		{
-//cout << "\naptr = " << *aptr << endl;		
-			if (*aptr & BIGINT_MSB)
-			{
-				a.n.resize(a.n.size()+1);
-				*a.n.rbegin() = 1;
-//cout << "\nafter resizing aptr = " << *aptr << endl;		
-			}
-			// r.n.size() >= 2
-			for ( ;aptr != a.n.rend()-1; aptr++)
-			{
-				*aptr <<= 1;
-				*aptr &= BIGINT_BITS;
-				if (*(aptr+1) & BIGINT_MSB)
-					*aptr |= 1;
-			}
-			*aptr <<= 1;
-			*aptr &= BIGINT_BITS;
+			magnitude[i+limbs] |= x[i] << shift;
+			if (shift)
+				magnitude[i+limbs+1] = x[i] >> (64-shift);
 		}
+		a.assign(&magnitude[0], magnitude.size());
 	}
 
 if (bigint_control::DEBUG & bigint_control::l_shift)
 {
 	debug << "bigint::operator <<= : returning a = " << a << endl;
-	debug << "bigint::operator <<= : a = ";
-	a.dump(debug);
-	debug << endl;
 }
 	return a;
 }
 
-bool operator == (const bigint& aa, const bigint& bb)
+bool operator == (const bigint& a, const bigint& b)
 {
-	bigint a = aa;
-	bigint b = bb;
-	a.sanitize();
-	b.sanitize();
-/* necessary? */
-
 if (bigint_control::DEBUG & bigint_control::equal)
 {
-	debug << "bigint::operator == : a = " << a << 
+	debug << "bigint::operator == : a = " << a <<
 	         "\n                      b = " << b << endl;
 }
-
-    if (a.n.size() != b.n.size())
-	{
-if (bigint_control::DEBUG & bigint_control::equal)
-	debug << "bigint::operator == : different sizes, return false" << endl; 
-		return false;
-	}
-
-    if (a.negative != b.negative)
-	{
-if (bigint_control::DEBUG & bigint_control::equal)
-	debug << "bigint::operator == : different signs, return false" << endl; 
-		return false;
-	}
-	
-    for (size_t i = 0; i < a.n.size(); i++)
-    {
-		if (a.n[i] != b.n[i])
-		{
-if (bigint_control::DEBUG & bigint_control::equal)
-	debug << "bigint::operator == : a.n[" << i << "] != b.n[" << i << "], return false" << endl; 
-	    	return false;
-		}
-    }
-if (bigint_control::DEBUG & bigint_control::equal)
-	debug << "bigint::operator == : returning true" << endl; 
-    return true;
+	return bigint::compare(a,b) == 0;
 }
 
 bool operator != (const bigint& a, const bigint& b)
@@ -921,104 +822,15 @@ bool operator > (const bigint& a, const bigint& b)
 
 if (bigint_control::DEBUG & bigint_control::greater)
 {
-	debug << "bigint::operator > : a = " << a << 
+	debug << "bigint::operator > : a = " << a <<
 	         "\n                     b = " << b << endl;
-	debug << "bigint::operator > : a = ";
-	a.dump(debug);
-	debug << endl;
-	debug << "bigint::operator > : b = ";
-	b.dump(debug);
-	debug << endl;
-}
-	if  (a == b)
-	{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : a = b, return false" << endl; 
-		return false;
-	}
-		
-	if (a.negative && !b.negative)
-	{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : a negative b positive, return false" << endl; 
-		return false;
-	}
-	
-	if (!a.negative && b.negative)
-	{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : a positive b negative, return true" << endl; 
-		return true;
-	}
-	
-	/* take local copies and sanitize to remove leading zeros */
-	bigint aa = a;
-	bigint bb = b;
-	aa.sanitize();
-	bb.sanitize();
-
-	const bigint* A;
-	const bigint* B;
-	
-	if (a.negative) // b.negative also, check |b| > |a|
-	{
-		A = &bb;
-		B = &aa;
-	}
-	else // !a.negative && !b.negative, check |a| > |b|
-	{
-		A = &aa;
-		B = &bb;
-	}
-
-if (bigint_control::DEBUG & bigint_control::greater)
-{
-	debug << "bigint::operator > : checking A > B where A = " << *A << 
-	       "\n                                          B = " << *B << endl; 
 }
-	
-	/* so here we return true iff |A| > |B| */
-	
-	if (A->n.size() > B->n.size())
-	{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : A size > B size, return true" << endl; 
-		return true;
-	}
-	else if (A->n.size() < B->n.size())
-	{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : A size < B size, return false" << endl; 
-		return false;
-	}
-	
-	bool result=false;
-    for (size_t i = A->n.size(); i > 0; i--)
-    {
-		if (A->n[i-1] > B->n[i-1])
-		{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : A.n[" << i-1 << "] > B.n[" << i-1 <<"] return true" << endl; 
-	    	result = true;
-			break;
-		}
-		else if (A->n[i-1] < B->n[i-1])
-		{
-if (bigint_control::DEBUG & bigint_control::greater)
-	debug << "bigint::operator > : A.n[" << i-1 << "] < B.n[" << i-1 <<"] return false" << endl; 
-			break; // result already false
-		}
-    }
-
-	return result;
+	return bigint::compare(a,b) > 0;
 }
 
 bool operator < (const bigint& a, const bigint& b)
 {
-  if (a == b || a > b)
-	  return false;
-  else
-  	return true;
+	return bigint::compare(a,b) < 0;
 }
 
 bool operator >= (const bigint& a, const bigint& b)
@@ -1031,100 +843,53 @@ bool operator <= (const bigint& a, const bigint& b)
 	return (!(a>b));
 }
 
-/*(This version dumps the output, for debugging the real << operator
-ostream& operator << (ostream& os, const bigint& a)
-{
-	a.dump(os);
-	return os;
-}
+/* The output operator divides a copy of the magnitude by DECIMAL_CHUNK, so each division produces DECIMAL_CHUNK_DIGITS
+   decimal digits.  The characters are written to os one at a time, as they always have been, so that any field width set 
+   on os applies to the first character only.
 */
-
-/* This is the real << operator */
-
 ostream& operator << (ostream& os, const bigint& a)
-//ostream& output(ostream& os, const bigint& a)
-{	
-	unsigned int loc_debug = bigint_control::DEBUG;
-	bigint_control::DEBUG = 0;
-
-if (bigint_control::DEBUG & bigint_control::output)
-	debug << "bigint::operator << : a = " << a << endl;
+{
+	ostringstream oss;
+	if (a.negative)
+		oss << '-';
 
-    if (a == bigint(0))
+	if (a.n.empty())
 	{
-	
-if (bigint_control::DEBUG & bigint_control::output)
-{
-	debug << "bigint::operator << : a == 0 ";
-	a.dump(debug);
-	debug << endl;
-}
-	
-		os << 0;
+		oss << a.small;
 	}
 	else
 	{
-		bigint loc = a;
-		bigint ten(10);
-		ostringstream oss;
-
-		/* we handle the sign from a  later */
-		loc.negative = false;
+		vector<limb> magnitude(a.n);
+		size_t length = magnitude.size();
+		vector<limb> chunk;
 
-		do
+		while (length > 1 || magnitude[0] >= DECIMAL_CHUNK)
 		{
+			chunk.push_back(divide_limb(&magnitude[0], length, DECIMAL_CHUNK));
+			length = limb_length(&magnitude[0], length);
+		}
 
-if (bigint_control::DEBUG & bigint_control::output)
-{		
-	debug << "bigint::operator << : loc = ";
-	loc.dump(debug);
-	debug << endl;
-}
-			int digit = loc % ten;
-
-if (bigint_control::DEBUG & bigint_control::output)
-{		
-	debug << "bigint::operator << : digit = " << digit << endl;
-}
-			oss << digit;
-								
-			bigint t1 = loc/ten;
+		oss << magnitude[0];
+		for (size_t i=chunk.size(); i> 0; i--)
+			oss << setw(DECIMAL_CHUNK_DIGITS) << setfill('0') << chunk[i-1];
+	}
 
-if (bigint_control::DEBUG & bigint_control::output)
-{		
-	debug << "bigint::operator << : t1 = ";
-	t1.dump(debug);
-	debug << endl;
-}
-			loc = t1;
-			
-//			loc /= ten;
-		}while (loc);
-		
-		/* now the sign, since oss holds digits in reverse order */
-		if (a.negative)
-			oss << '-';
-	
-		string str = oss.str();
-				
 if (bigint_control::DEBUG & bigint_control::output)
 	debug << "bigint::operator << : oss = " << oss.str() << endl;
-		
-		string::reverse_iterator sptr = str.rbegin();
-		while (sptr != str.rend())
-			os << *sptr++;	
-	}
-	
-	bigint_control::DEBUG = loc_debug;
-	return os;	
+
+	string str = oss.str();
+	os << str[0];
+	if (str.length() > 1)
+		os << str.substr(1);
+
+	return os;
 }
 
 istream& operator >> (istream& is, bigint& a)
 {
-    string input;
 	char ch = 0;
 	bool negative = false;
-	bigint ten(10);
+	string digits;
 
     /* set a to zero */
     a = 0; // sets nagative = false
@@ -1133,14 +898,14 @@ istream& operator >> (istream& is, bigint& a)
 
 if (bigint_control::DEBUG & bigint_control::input)
 	debug << "bigint::operator >> : initial character from istream: " << ch << endl;
-	
+
 	if (is.fail()) // || ch == 0) no non-white characters have been read
 	{
 if (bigint_control::DEBUG & bigint_control::input)
-	debug << "bigint::operator >> : initial read failed, returning with failbit set on istream at " << &is << endl;	
+	debug << "bigint::operator >> : initial read failed, returning with failbit set on istream at " << &is << endl;
 		return is;
 	}
-	
+
 	if (ch == '-' || ch == '+')
 	{
 		char next = 0;
@@ -1159,14 +924,14 @@ if (bigint_control::DEBUG & bigint_control::input)
 		{
 	   		negative = true;
 if (bigint_control::DEBUG & bigint_control::input)
-	debug << "bigint::operator >> : detected good minus sign" << endl;	
+	debug << "bigint::operator >> : detected good minus sign" << endl;
 		}
 		else
 		{
 if (bigint_control::DEBUG & bigint_control::input)
-	debug << "bigint::operator >> : detected good plus sign" << endl;	
+	debug << "bigint::operator >> : detected good plus sign" << endl;
 		}
-		
+
 	}
 	else if (isdigit(ch))
 	{
@@ -1182,9 +947,9 @@ if (bigint_control::DEBUG & bigint_control::input)
 	debug << "bigint::operator >> : no number to read, putting back the " << ch << " and setting failbit on istream at " << &is << endl;
 		return is;
 	}
-	
+
 	/* here we know there is at least one digit to read from the istream */
-	do 
+	do
 	{
 		is.get(ch);
 
@@ -1196,48 +961,51 @@ if (bigint_control::DEBUG & bigint_control::input)
 if (bigint_control::DEBUG & bigint_control::input)
 	debug << "bigint::operator >> : read characters to end of istream, clearing state flags on istream at " << &is << endl;
 
-			return is; // the fail will be visible to the calling code if we've just read '+' or '-'
-		}		
+			break; // the fail will be visible to the calling code if we've just read '+' or '-'
+		}
 		else if (isdigit(ch))
 		{
-
-if (bigint_control::DEBUG & bigint_control::input)
-	debug << "bigint::operator >> : next character from istream: " << ch << endl;
-
-			if (a)
-				a *= ten;
-				
-			switch (ch)
-			{
-				case '1': a += bigint(1); break;
-				case '2': a += (bigint)2; break;
-				case '3': a += (bigint)3; break;
-				case '4': a += (bigint)4; break;
-				case '5': a += (bigint)5; break;
-				case '6': a += (bigint)6; break;
-				case '7': a += (bigint)7; break;
-				case '8': a += (bigint)8; break;
-				case '9': a += (bigint)9; break;
-				default:;
-			}
-
-if (bigint_control::DEBUG & bigint_control::input)
-	debug << "bigint::operator >> :   a = " << a << endl;		
-
+			digits += ch;
 		}
 		else
 		{
 			if (!isspace(ch))
-				is.putback(ch);			
+				is.putback(ch);
 			break; // reached end of digits
 		}
 	} while (true);
 
-if (negative)	
-	a.negative = true;
+	/* convert the digits DECIMAL_CHUNK_DIGITS at a time, the first chunk taking any excess */
+	vector<limb> magnitude(digits.length()/DECIMAL_CHUNK_DIGITS+1,0);
+	size_t length = 1;
+	size_t start = 0;
+	size_t chunk_length = digits.length() % DECIMAL_CHUNK_DIGITS;
+	if (chunk_length == 0)
+		chunk_length = DECIMAL_CHUNK_DIGITS;
+
+	while (start < digits.length())
+	{
+		limb chunk = 0;
+		limb scale = 1;
+		for (size_t i=start; i< start+chunk_length; i++)
+		{
+			chunk = chunk*10 + (digits[i]-'0');
+			scale *= 10;
+		}
+
+		limb carry = multiply_add_limb(&magnitude[0], length, scale, chunk);
+		if (carry)
+			magnitude[length++] = carry;
+
+		start += chunk_length;
+		chunk_length = DECIMAL_CHUNK_DIGITS;
+	}
+
+	a.negative = negative;
+	a.assign(&magnitude[0], length);
 
 if (bigint_control::DEBUG & bigint_control::input)
-	debug << "bigint::operator >> : final value of a = " << a << endl;		
+	debug << "bigint::operator >> : final value of a = " << a << endl;
 
     return is;
 }
@@ -1249,200 +1017,45 @@ bigint abs (const bigint& a)
    return result;
 }
 
-/* sum calculates the sum of the bigints at a and b and stores it at
-   result.  The signs of a and b must have been taken care of elsewhere, 
+/* sum calculates the sum of the magnitudes of the bigints at a and b and stores it at
+   result.  The signs of a and b must have been taken care of elsewhere,
    sum asumes the negative flag in result is correct.
 */
-void sum(bigint& result,const bigint& aa, const bigint& bb)
-{
-
-if (bigint_control::DEBUG & bigint_control::sum)
-{
-	debug << "bigint::sum : a = " << aa << 
-	         "\n              b = " << bb << endl;
-	debug << "bigint::sum : a = ";
-	aa.dump(debug);
-	debug << endl;
-	debug << "bigint::sum : b = ";
-	bb.dump(debug);
-	debug << endl;
-}
-
-    /* check for a == 0 */
-    if (aa == 0)
-    {
-		result = bb;
-		return;
-    }
-
-    if (bb == 0)
-	{
-		result = aa;
-		return;
-	}
-
-	bigint a = aa;
-	bigint b = bb;
-
-    /* set result to a and add b to it */
-    bool hold_negative = result.negative;
-    result = a;
-    result.negative = hold_negative;
-
-	size_t result_size = (a.n.size() > b.n.size() ? a.n.size() : b.n.size());
-	result.n.resize(result_size);
-	a.n.resize(result_size);
-	b.n.resize(result_size);
-
-if (bigint_control::DEBUG & bigint_control::sum)
-{
-	debug << "bigint::sum : original a.n.size() = " << aa.n.size() << " original b.n.size() = " << bb.n.size()  << endl;
-	debug << "bigint::sum : a.n.size() = " << a.n.size() << " b.n.size() = " << b.n.size()  << " result.n.size() = " << result.n.size() << endl;
-	debug << "bigint::sum : a now = " << a << " b now = " << b << endl;
-}
-	
-    int carry = 0;
-    for (size_t i=0; i<b.n.size(); i++)
-    {
-		long loc_res = (long)a.n[i] + (long)b.n[i] + (long)carry;
-
-if (bigint_control::DEBUG & bigint_control::sum)
-{
-	debug << "bigint::sum :   adding digits " << i << " carry = " << carry << endl;
-	debug << "bigint::sum :     interim result = " << loc_res;
-}
-		carry = 0;
-
-
-		if ( loc_res > MAX_DIGIT )
-		{
-		    carry = 1;
-	    	loc_res %= BASE;
-
-if (bigint_control::DEBUG & bigint_control::sum)
-{
-	debug << "bigint::sum :       carry = " << carry << " interim result = " << loc_res;
-}
-		}
-		result.n[i] = (unsigned int)loc_res;
-
-if (bigint_control::DEBUG & bigint_control::sum)
-{
-	debug << "bigint::sum :     result.n[" << i << "] = " << loc_res <<endl;
-}			
-
-    }
-
-    if (carry)
-	{
-		result.n.resize (result_size+1);
-		result.n[result_size] = 1;
-
-if (bigint_control::DEBUG & bigint_control::sum)
+void sum(bigint& result,const bigint& a, const bigint& b)
 {
-	debug << "bigint::sum :   carry left over, result resized to " << result.n.size() << endl;
-}
 
-	}
-	
 if (bigint_control::DEBUG & bigint_control::sum)
 {
-	debug << "bigint::sum : result = " << result << endl;
-	debug << "bigint::sum : result = ";
-	result.dump(debug);
-	debug << endl;
+	debug << "bigint::sum : a = " << a <<
+	         "\n              b = " << b << endl;
 }
-	result.sanitize();
+	bool negative = result.negative;
+	result = abs(a);
+	bigint::accumulate(result,abs(b),false);
+	result.negative = (negative && result);
 }
 
-/* diff calculates the difference between the bigints at a and b and stores it at
+/* diff calculates the difference between the magnitudes of the bigints at a and b and stores it at
    result.  The signs must have been taken care of elsewhere and
    a must be greater than or equal to b.
 
    diff clears the negative flag in result if the difference is 0
 */
-void diff(bigint& result,const bigint& a, const bigint& bb)
-{
-
-if (bigint_control::DEBUG & bigint_control::diff)
-{
-	debug << "bigint::diff : a = " << a << 
-	         "\n               b = " << bb << endl;
-	debug << "bigint::diff : a = ";
-	a.dump(debug);
-	debug << endl;
-	debug << "bigint::diff : b = ";
-	bb.dump(debug);
-	debug << endl;
-}
-
-    /* copy the numeric part of a into result; note a >= b */
-	result.n = a.n;
-	
-	bigint b = bb;
-	b.n.resize(a.n.size());
-	
-
-if (bigint_control::DEBUG & bigint_control::diff)
-{
-	debug << "bigint::diff : a.n.size() = " << a.n.size() << " bb.n.size() = " << bb.n.size()  << 
-  	         " b.n.size() = " << b.n.size()  << " result.n.size() = " << result.n.size() << endl;
-}
-
-
-    /* now subtract b from a */
-    int borrow = 0;
-	size_t i;
-    for (i = 0; i < b.n.size(); i++)
-    {
-		long loc_res = (long)result.n[i] - (long)b.n[i] - (long)borrow;
-
-if (bigint_control::DEBUG & bigint_control::diff)
+void diff(bigint& result,const bigint& a, const bigint& b)
 {
-	debug << "bigint::diff :   subtracting digits " << i << " borrow = " << borrow << endl;
-	debug << "bigint::diff :     interim result = " << loc_res << endl;
-}
-
-		borrow = 0;
-		if ( loc_res < 0 )
-		{
-		    borrow = 1;
-	    	loc_res += BASE;
 
 if (bigint_control::DEBUG & bigint_control::diff)
 {
-	debug << "bigint::diff :       borrow = " << borrow << " interim result = " << loc_res << endl;
+	debug << "bigint::diff : a = " << a <<
+	         "\n               b = " << b << endl;
 }
-
-		}
-		result.n[i] = (unsigned int)loc_res;
-
-if (bigint_control::DEBUG & bigint_control::diff)
-{
-	debug << "bigint::diff :     result.n[" << i << "] = " << loc_res <<endl;
-}			
-
-    }
-	
-	if (borrow)
+	if (abs(a) < abs(b))
 		throw bigint_error("diff attempting to subtract b from a where b>a");
 
-    /* check for the zero result */
-    bool loc_sign = result.negative;
-    result.negative = false;
-    if (!(result == bigint(0)))
-		result.negative = loc_sign;
-
-if (bigint_control::DEBUG & bigint_control::diff)
-{
-	debug << "bigint::diff : result = " << result << endl;
-	debug << "bigint::diff : result = ";
-	result.dump(debug);
-	debug << endl;
-}
-
-	result.sanitize();
-
+	bool negative = result.negative;
+	result = abs(a);
+	bigint::accumulate(result,abs(b),true);
+	result.negative = (negative && result);
 }
 
 int num_len (unsigned int n)
@@ -1462,119 +1075,71 @@ int num_len(const bigint& a)
 {
 if (bigint_control::DEBUG & bigint_control::num_len)
 	debug << "bigint::num_len : a = " << a << endl;
-	
-//	string str;
-	ostringstream oss;//(str);
+
+	ostringstream oss;
 	oss << a;
-//output(oss,a);
-	
-if (bigint_control::DEBUG & bigint_control::num_len)
-	debug << "bigint::num_len : str = " << oss.str() << endl;
-	
+
 	return oss.str().length();
 }
 
 /* The following binary gcd algorithm is Algorithm B from Knuth, The Art of
-   Computer Programming vol 2, section 4.5.2.  The notation used here is
-   chosen to be consistent with Knuth's.
+   Computer Programming vol 2, section 4.5.2, applied to the limbs of u and v
+   in place.  Once both u and v fit in a single limb we complete the calculation
+   with 64-bit arithmetic.
 */
-//int hcf_count;
 bigint gcd (const bigint& a, const bigint& b)
 {
-	int k = 0;
-	bigint t;
-	bigint u(a);
-	bigint v(b);
-	
-	/* could use abs but faster to set value directly 
-	   and avoid the function call
-	*/
-	u.negative = false;
-	v.negative = false;
-
-	if (u == bigint(0))
-		return v;
-	
-	if (v == bigint(0))
-		return u;
+	if (a.n.empty() && b.n.empty())
+		return bigint(static_cast<unsigned long>(gcd_limb(a.small,b.small)));
 
-//	hcf_count = 0;
-//  cout << endl;
-	
-if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : u = " << u << " v = " << v << endl;
+	if (a.n.empty() && a.small == 0)
+		return abs(b);
 
-	while (u.even() && v.even()) //B.1
-	{
-		k++;
-		u >>= 1;
-		v >>= 1;
-if (bigint_control::DEBUG & bigint_control::gcd)
-{
-	debug  << "bigint::gcd : B.1 both u and v even, k incremented to " << k << endl;
-	debug << "bigint::gcd :   u >>= " << u << " v >>= " << v << endl;
-}
-	}
-	
-	if (u.even())               // B.2
-	{
+	if (b.n.empty() && b.small == 0)
+		return abs(a);
 
 if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : u remains even" << endl;
-		t = u;
-	}
-	else
-		t = v * bigint(-1);
-	
-if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : B.2 t = " << t << endl;
-
-	do
+	debug << "bigint::gcd : u = " << a << " v = " << b << endl;
+
+	vector<limb> u(a.limbs(), a.limbs()+a.size());
+	vector<limb> v(b.limbs(), b.limbs()+b.size());
+	size_t nu = u.size();
+	size_t nv = v.size();
+
+	/* B1: find the power of 2 common to u and v and remove all factors of 2 from each */
+	size_t u_zeros = trailing_zero_bits(&u[0],nu);
+	size_t v_zeros = trailing_zero_bits(&v[0],nv);
+	size_t k = min(u_zeros,v_zeros);
+	nu = shift_right_limbs(&u[0],nu,u_zeros);
+	nv = shift_right_limbs(&v[0],nv,v_zeros);
+
+	/* B2 to B6: both u and v are now odd, replace the larger by their difference with its factors of 2 removed */
+	while (nu > 1 || nv > 1)
 	{
+		int comparison = compare_limbs(&u[0],nu,&v[0],nv);
+		if (comparison == 0)
+			break;
 
-if (bigint_control::DEBUG & bigint_control::gcd)
-{
-	debug << "bigint::gcd : t remains non-zero" << t << endl;
-//	debug << "\n" << "\t" << t << flush;
-}
-
-		while (t.even())       // B.4
-		{
-			t >>= 1;           // B.3
-
-if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : B.4   t remains even t >> = " << t << endl;
-	
-		}
-			
-		if (t > bigint(0))     // B.5
-		{
-			u = t;
-
-if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : B.5   u set to " << u << endl;
-	
-		}
-		else
+		if (comparison < 0)
 		{
-			v = t * bigint(-1);
-if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : B.5   v set to " << v << endl;
-	
+			u.swap(v);
+			swap(nu,nv);
 		}
 
-		t = u-v;              // B.6
+		subtract_limbs(&u[0],nu,&v[0],nv);
+		nu = shift_right_limbs(&u[0],nu,trailing_zero_bits(&u[0],nu));
+	}
 
-if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : B.6   t set to " << t << endl;
+	bigint result;
+	if (nu == 1 && nv == 1)
+		result.small = gcd_limb(u[0],v[0]);
+	else
+		result.assign(&u[0],nu);
 
-	} while (t != bigint(0));
-	
-	u <<= k;
+	result <<= k;
 
 if (bigint_control::DEBUG & bigint_control::gcd)
-	debug << "bigint::gcd : u right shifted " << k << " to give " << u << endl;
-	
-	return u;
-}
+	debug << "bigint::gcd : returning " << result << endl;
 
+	return result;
+}
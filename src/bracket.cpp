@@ -21,6 +21,10 @@ unicursal_component_zig_zag_count contains the correct counts for a relaxed pari
 #include <ctype.h>
 #include <stdio.h>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <cmath>
+#include <climits>
 
 using namespace std;
 
@@ -39,6 +43,8 @@ extern ifstream     input;
 #include <gauss-orientation.h>
 #include <reidemeister.h>
 
+extern lru_cache<string,string> left_preferred_cache;
+
 class bracket_variable
 {
 public:
@@ -74,14 +80,10 @@ bracket_variable::bracket_variable(generic_code_data& c): code_data(c)
 	_type = bracket_variable::variable_type::GRAPH;
 	gauss_orientation_data g(code_data);
 
-	ostringstream oss;
-	
 	/* if the code_data is a knotoid then we cannot use the left_preferred Gauss data, since
 	   we have to start at the leg and proceed towards the head.
 	*/
-	gauss_orientation_data gauss_data = left_preferred(g,true,c.immersion_character); //unoriented = true	
-	write_gauss_data(gauss_data,oss,true,c.immersion_character,c.head_zig_zag_count); // zig_zags = true
-	_string = oss.str();
+	_string = left_preferred_gauss_data(g,true,c.immersion_character,true,c.head_zig_zag_count); //unoriented = true, zig_zags = true
 	
 	/* write the knotoid or long knot head semi-arc count to the end of _string, before the ')' character
 	if (c.immersion != generic_code_data::character::CLOSED)	
@@ -145,11 +147,364 @@ void print_bracket_variable(const bracket_variable bv, ostream& os, string prefi
 }
 
 
+/* dense_laurent_polynomial is a univariate Laurent polynomial with integer coefficients, stored as the exponent 
+   of the first coefficient together with a contiguous vector of coefficients.  It is used by bracket_polynomial 
+   to accumulate the state sum for those variants that do not involve graphical bracket_variables, where every state 
+   contributes a term of the form A^sigma (-A^2-A^{-2})^k, possibly with additional u or arrow polynomial variables,
+   so the contributions may be accumulated as array operations rather than by polynomial arithmetic.
+   
+   The coefficients are held as long long, which avoids any overflow in the intermediate sums of the int coefficients
+   of a typical bracket polynomial.  The arithmetic is checked, and if a long long coefficient would overflow the 
+   polynomial is promoted: the coefficients are moved to big_coefficient and overflow is set, after which all the 
+   arithmetic is carried out using bigints.  fits_int tells bracket_polynomial whether the coefficients may be 
+   represented in an int bracket polynomial, or whether the result has to be written using bigint coefficients.
+*/
+class dense_laurent_polynomial
+{
+public:
+	int offset; /* exponent of coefficient[0] */
+	vector<long long> coefficient;
+	vector<bigint> big_coefficient;
+	bool overflow;
+	
+	dense_laurent_polynomial(): offset(0), overflow(false) {}
+	dense_laurent_polynomial(long long c, int e): offset(e), coefficient(1,c), overflow(false) {}
+	
+	void add_monomial(long long c, int e);
+	void add_monomial(const bigint& c, int e);
+	void add_shifted(const dense_laurent_polynomial& a, int shift);
+	void promote();
+	dense_laurent_polynomial& operator += (const dense_laurent_polynomial& a);
+	dense_laurent_polynomial& operator *= (const dense_laurent_polynomial& a);
+	string to_string(char variable) const;
+	bool is_zero() const;
+	bool fits_int() const;
+};
+
+/* to_bigint converts a long long to a bigint, which has constructors only from int and unsigned long */
+bigint to_bigint(long long c)
+{
+	bigint magnitude(static_cast<unsigned long>(c < 0? 0ULL-static_cast<unsigned long long>(c): c));
+	return (c < 0? bigint(0)-magnitude: magnitude);
+}
+
+/* promote moves the long long coefficients to big_coefficient */
+void dense_laurent_polynomial::promote()
+{
+	if (overflow)
+		return;
+		
+	big_coefficient.resize(coefficient.size());
+	for (size_t i=0; i< coefficient.size(); i++)
+		big_coefficient[i] = to_bigint(coefficient[i]);
+	
+	coefficient.clear();
+	overflow = true;
+}
+
+void dense_laurent_polynomial::add_monomial(long long c, int e)
+{
+	if (overflow)
+	{
+		add_monomial(to_bigint(c),e);
+	}
+	else if (coefficient.size() == 0)
+	{
+		offset = e;
+		coefficient.push_back(c);
+	}
+	else if (e < offset)
+	{
+		coefficient.insert(coefficient.begin(),offset-e,0);
+		offset = e;
+		coefficient[0] = c;
+	}
+	else
+	{
+		size_t place = e-offset;
+		if (place >= coefficient.size())
+			coefficient.resize(place+1);
+			
+		long long sum;
+		if (__builtin_add_overflow(coefficient[place],c,&sum))
+		{
+			promote();
+			big_coefficient[place] += to_bigint(c);
+		}
+		else
+			coefficient[place] = sum;
+	}
+}
+
+void dense_laurent_polynomial::add_monomial(const bigint& c, int e)
+{
+	promote();
+
+	if (big_coefficient.size() == 0)
+	{
+		offset = e;
+		big_coefficient.push_back(c);
+	}
+	else if (e < offset)
+	{
+		big_coefficient.insert(big_coefficient.begin(),offset-e,bigint(0));
+		offset = e;
+		big_coefficient[0] = c;
+	}
+	else
+	{
+		size_t place = e-offset;
+		if (place >= big_coefficient.size())
+			big_coefficient.resize(place+1);
+		big_coefficient[place] += c;
+	}
+}
+
+/* add_shifted adds A^shift times a to the polynomial */
+void dense_laurent_polynomial::add_shifted(const dense_laurent_polynomial& a, int shift)
+{
+	if (a.overflow)
+	{
+		for (size_t i=0; i< a.big_coefficient.size(); i++)
+		{
+			if (a.big_coefficient[i] != bigint(0))
+				add_monomial(a.big_coefficient[i],a.offset+i+shift);
+		}
+	}
+	else
+	{
+		for (size_t i=0; i< a.coefficient.size(); i++)
+		{
+			if (a.coefficient[i])
+				add_monomial(a.coefficient[i],a.offset+i+shift);
+		}
+	}
+}
+
+dense_laurent_polynomial& dense_laurent_polynomial::operator += (const dense_laurent_polynomial& a)
+{
+	add_shifted(a,0);
+	return *this;
+}
+
+dense_laurent_polynomial& dense_laurent_polynomial::operator *= (const dense_laurent_polynomial& a)
+{
+	if (is_zero() || a.is_zero())
+	{
+		coefficient.clear();
+		big_coefficient.clear();
+		offset = 0;
+		overflow = false;
+		return *this;
+	}
+	
+	if (!overflow && !a.overflow)
+	{
+		vector<long long> product(coefficient.size()+a.coefficient.size()-1);
+		bool product_overflow = false;
+		for (size_t i=0; i< coefficient.size() && !product_overflow; i++)
+		{
+			if (coefficient[i] == 0)
+				continue;
+				
+			for (size_t j=0; j< a.coefficient.size(); j++)
+			{
+				long long term;
+				if (__builtin_mul_overflow(coefficient[i],a.coefficient[j],&term) || __builtin_add_overflow(product[i+j],term,&product[i+j]))
+				{
+					product_overflow = true;
+					break;
+				}
+			}
+		}
+		
+		if (!product_overflow)
+		{
+			coefficient = product;
+			offset += a.offset;
+			return *this;
+		}
+	}
+	
+	/* evaluate the product using bigints */
+	dense_laurent_polynomial big_a = a;
+	big_a.promote();
+	promote();
+	
+	vector<bigint> product(big_coefficient.size()+big_a.big_coefficient.size()-1);
+	for (size_t i=0; i< big_coefficient.size(); i++)
+	{
+		if (big_coefficient[i] == bigint(0))
+			continue;
+			
+		for (size_t j=0; j< big_a.big_coefficient.size(); j++)
+			product[i+j] += big_coefficient[i] * big_a.big_coefficient[j];
+	}
+	
+	big_coefficient = product;
+	offset += a.offset;
+	return *this;
+}
+
+bool dense_laurent_polynomial::is_zero() const
+{
+	for (size_t i=0; i< coefficient.size(); i++)
+	{
+		if (coefficient[i])
+			return false;
+	}
+
+	for (size_t i=0; i< big_coefficient.size(); i++)
+	{
+		if (big_coefficient[i] != bigint(0))
+			return false;
+	}
+	return true;
+}
+
+/* fits_int returns true if every coefficient lies in the range of int */
+bool dense_laurent_polynomial::fits_int() const
+{
+	for (size_t i=0; i< coefficient.size(); i++)
+	{
+		if (coefficient[i] < INT_MIN || coefficient[i] > INT_MAX)
+			return false;
+	}
+
+	for (size_t i=0; i< big_coefficient.size(); i++)
+	{
+		if (big_coefficient[i] < bigint(INT_MIN) || big_coefficient[i] > bigint(INT_MAX))
+			return false;
+	}
+	return true;
+}
+
+/* write_dense_coefficients writes the terms of a dense Laurent polynomial with coefficients of type T and the 
+   given offset in the form accepted by the polynomial class input operator.
+*/
+template <typename T> string write_dense_coefficients(const vector<T>& coefficient, int offset, char variable)
+{
+	ostringstream oss;
+	bool first_term = true;
+	
+	for (int i = coefficient.size()-1; i >= 0; i--)
+	{
+		const T& c = coefficient[i];
+		if (c == T(0))
+			continue;
+		
+		int e = offset+i;
+			
+		if (c < T(0))
+			oss << '-';
+		else if (!first_term)
+			oss << '+';
+			
+		if (abs(c) != T(1) || e == 0)
+			oss << abs(c);
+			
+		if (e != 0)
+		{
+			oss << variable;
+			if (e != 1)
+				oss << '^' << e;
+		}
+		
+		first_term = false;
+	}
+	
+	if (first_term)
+		oss << '0';
+		
+	return oss.str();
+}
+
+/* to_string writes the polynomial in the form accepted by the polynomial class input operator, using the 
+   given variable character.  The coefficients are written in full, so the string may be read as an int 
+   polynomial only if fits_int returns true, otherwise it has to be read as a bigint polynomial.
+*/
+string dense_laurent_polynomial::to_string(char variable) const
+{
+	if (overflow)
+		return write_dense_coefficients(big_coefficient,offset,variable);
+	else
+		return write_dense_coefficients(coefficient,offset,variable);
+}
+
+/* set_arrow_polynomial_varmap maps the variables of an arrow polynomial, other than A and D, to the L_i and K_i 
+   bracket_variables that they represent.
+*/
+template <typename T> void set_arrow_polynomial_varmap(polynomial<T,bracket_variable>& bracket_poly)
+{
+	for (int i=0; i< bracket_poly.nv; i++)
+	{
+		char ch = bracket_poly.getvar(i);
+		int index=0;
+		if (ch != 'A' && ch != 'D' &&ch < 'n')
+		{
+			index = ch-'a'+1;					
+			bracket_variable bv("L_"+to_string(index));
+			bracket_poly.set_varmap(ch,bv);
+		}
+		else if (ch != 'A' && ch != 'D')
+		{
+			index = ch-'n'+1;	
+			bracket_variable bv("K_"+to_string(index));					
+			bracket_poly.set_varmap(ch,bv);
+		}
+	}
+}
+
+/* state_sum_term records the contributions to the bracket polynomial of those states having the same number of delta 
+   terms, algebraic crossing number and arrow factor, as a dense_laurent_polynomial in the variable A
+*/
+struct state_sum_term
+{
+	int num_delta_terms;
+	int algebraic_crossing_number;
+	polynomial<int,bracket_variable> arrow_factor;
+	dense_laurent_polynomial A_poly;
+};
+
+/* state_sum_comfort_dots displays the comfort dots for the bracket polynomial state sum.  It is called by each 
+   worker thread after each state, so the shared wait information is updated under comfort_dot_mutex.
+*/
+mutex comfort_dot_mutex;
+
+void state_sum_comfort_dots(int& state_count)
+{
+	if (!braid_control::SILENT_OPERATION && braid_control::WAIT_SWITCH)
+	{
+	    if (++state_count == braid_control::wait_threshold)
+	    {
+			lock_guard<mutex> lock(comfort_dot_mutex);
+			
+			cout << ".";
+			cout.flush();
+			
+			if (braid_control::wait_count > 1000)
+			{
+				braid_control::reset_count++;
+	    		cout << "\nworking bracket polynomial (" << braid_control::reset_count << ")\n";
+	    		braid_control::wait_count = 0;
+			}
+			else
+	    		braid_control::wait_count++;
+	    		
+			state_count = 0;
+    	}
+	}
+}
+
 vector<int> gauss_parity(generic_code_data& code_data);
 int remove_virtual_Reidemeister_I(generic_code_data& code_data,vector<int>& component_flags);
 matrix<int> create_incidence_matrix (gauss_orientation_data& gauss_data);
 int remove_virtual_components(generic_code_data& code_data,vector<int>& component_flags);
 generic_code_data partition_peer_code(generic_code_data& code_data, vector<int>& component_flags);
+void add_component_sums(map<string,state_sum_term>& state_sum, vector<dense_laurent_polynomial>& A_poly);
+double tangle_decomposition(generic_code_data& code_data, vector<int>& strand_partner, vector<int>& crossing_order, int& num_virtual_loops);
+void tangle_state_sum(generic_code_data& code_data, vector<int>& sign, vector<int>& strand_partner, vector<int>& crossing_order, 
+                      int num_virtual_loops, map<string,state_sum_term>& state_sum);
 
 /* The function bracket_polynomial evaluates various forms of bracket polynomial depending on the 
    variant parameter supplied.  The function is capable of evaluating
@@ -230,6 +585,10 @@ void bracket_polynomial(generic_code_data& code_data, int variant)
 	vector<int>& first_edge_on_component = code_data.first_edge_on_component;
 	vector<int>& num_component_edges = code_data.num_component_edges;
 	
+	/* note the left preferred Gauss data cache counts, so that we can report the hits and misses for this diagram */
+	long initial_cache_hits = left_preferred_cache.hits();
+	long initial_cache_misses = left_preferred_cache.misses();
+	
 if (debug_control::DEBUG >= debug_control::BASIC)
 {
 	debug << "bracket_polynomial: provided with code data: ";
@@ -311,12 +670,6 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 
 	int num_edges = 2*num_crossings;
 	
-	/* arrow polynomial variables */
-	int arrow_state_zig_zag_count = 0;
-//	int arrow_state_first_non_seifert_turn;
-	int arrow_state_last_non_seifert_turn = generic_code_data::VOID;
-	int non_seifert_turn = generic_code_data::VOID;
-			
 	/* set up a vector of flags to identify the shortcut crossings, the vector is initialized
 	   to zeros which is the correct indication for links, which have no shortcut crossings.
 	   In the case of knotoids the flags will be set by valid_knotoid_input.
@@ -387,7 +740,26 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 			return;
 		}
 	}
-	
+	else if (variant == TURAEV_VARIANT)
+	{
+		/* Turaev's extended bracket polynomial needs the shortcut of a knotoid */
+		if (!braid_control::SILENT_OPERATION)
+			cout << "\nbracket_polynomial: Turaev's extended bracket polynomial requires a knotoid, skipping" << endl;
+
+		if (!braid_control::RAW_OUTPUT)
+		{
+			output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output << "\nbracket_polynomial: Turaev's extended bracket polynomial requires a knotoid, skipping";
+			if (braid_control::OUTPUT_AS_INPUT)
+				output << '\n';
+		}
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "bracket_polynomial: TURAEV_VARIANT provided with code data that is not a knotoid" << endl;
+
+		return;
+	}
+
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << "bracket_polynomial: pure_knotoid_code_data = " << pure_knotoid_code_data << endl;
 	
@@ -606,80 +978,343 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	*/
 	polynomial<int,bracket_variable> bracket_poly;
 
+	/* If the dense state sum described below has a coefficient outside the range of int, the bracket polynomial is 
+	   evaluated in big_bracket_poly, using bigint coefficients, instead of in bracket_poly.
+	*/
+	polynomial<bigint,bracket_variable> big_bracket_poly;
+	bool bigint_coefficients = false;
+
+	/* For those variants that do not involve graphical bracket_variables, the contribution of each state is determined by sigma, 
+	   the number of delta terms, the algebraic crossing number and the arrow factor.  In these cases we accumulate the state sum in 
+	   state_sum, indexed by the latter three, as dense Laurent polynomials in A and evaluate the bracket polynomial once all the 
+	   states have been considered, rather than building a polynomial term for each state.
+	*/
+	bool dense_state_sum = (variant != PARITY_VARIANT && variant != PARITY_ARROW_VARIANT);
+	map<string,state_sum_term> state_sum;
+
 	if (num_state_smoothed_crossings > 0 || ((variant == PARITY_VARIANT || variant == PARITY_ARROW_VARIANT )&& num_classical_non_shortcut_crossings > 0))
 	{
 	
-		bool finished=false;
-	
-		vector<int> state(num_state_smoothed_crossings);
-		for (int i=0; i< num_state_smoothed_crossings; i++)
-			state[i] = -1;
-	
-		int state_count=0;  // used for comfort dots
-		do
+		/* For the Kauffman bracket and Jones polynomial of a diagram without shortcut crossings, the contribution of a state 
+		   depends only on sigma and the number of unicursal components, so rather than tracing every state from scratch 
+		   we enumerate the states in Gray code order, so that successive states differ in the smoothing of a single crossing.  
+		   
+		   We represent the smoothed diagram by the ends of the semi-arcs: end 2e is the tail of edge e and end 2e+1 its head.
+		   Each end is linked to the end with which it is joined at the crossing by the current smoothing, so that a state
+		   component is traced by moving alternately across a crossing and along an edge.  Changing the smoothing at a crossing 
+		   re-links the four ends at that crossing and changes the number of components by -1, 0 or 1, which we determine by 
+		   tracing the component through one end at the crossing before and after the change.  Sigma changes by twice the
+		   crossing sign.
+		   
+		   The state sum is accumulated in dense_laurent_polynomials indexed by the number of components and added to state_sum 
+		   with the same key as would be used by the full trace below.
+		*/
+		bool gray_code_walk = ((variant == KAUFFMAN_VARIANT || variant == JONES_VARIANT) && !pure_knotoid_code_data && num_state_smoothed_crossings > 0);
+		for (int i=0; i< num_crossings && gray_code_walk; i++)
 		{
-			/* determine the contribution to the bracket polynomial from the current state.  We need to count the 
-			   number of components for this state and evaluate sigma, the "state sum".
-			   
-			   We count the components by tracing around the diagram following the smoothing determined by the state.
+			bool classical = (sign[i] == generic_braid_data::crossing_type::POSITIVE || sign[i] == generic_braid_data::crossing_type::NEGATIVE);
+			if (classical == (code_table[generic_code_data::table::LABEL][i] == generic_code_data::VIRTUAL))
+				gray_code_walk = false;
+		}
+		
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "bracket_polynomial: gray_code_walk = " << gray_code_walk << endl;
+
+		/* The tangle engine may be used under the same conditions as the Gray code walk.  Unless an engine has been
+		   specified, we use it if the estimated number of boundary connections it has to consider, weighted to allow 
+		   for the greater cost of considering a connection, is smaller than the number of states.
+		*/
+		bool tangle_engine = false;
+		vector<int> strand_partner;
+		vector<int> crossing_order;
+		int num_virtual_loops = 0;
+		
+		if (gray_code_walk && braid_control::BRACKET_ENGINE != braid_control::bracket_engine::STATE_SUM)
+		{
+			double tangle_cost = tangle_decomposition(code_data,strand_partner,crossing_order,num_virtual_loops);
+			
+			if (braid_control::BRACKET_ENGINE == braid_control::bracket_engine::TANGLE || TANGLE_COST_FACTOR * tangle_cost < pow(2.0,num_state_smoothed_crossings))
+				tangle_engine = true;
+		}
 
-			   In the case of the Turaev variant for knotoids, we must also evaluate the algebraic crossing number 
-			   of the segment component with the shortcut.			   
-			*/
-	
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-{
-	debug << "bracket_polynomial: state ";
-	for (int i=0; i< num_state_smoothed_crossings; i++)
-		debug << state[i] << ' ';
-	debug << endl;
-}
-	
-			/* map the state onto a record of the all crossings in order to accommodate 
-			   virtual crossings and shortcut crossings, as these are never smoothed.
-			   
-			   We shall perform Seifert smoothing, where 2i <-> 2j and 2j-1 <-> 2i+1, on classical 
-			   non-shortcut crossings whose state is 1 and non-Seifert smoothing, where 2i <-> 2j-1 
-			   and 2j <-> 2i+1 on those whose state is -1.
-			   
-			   This is not the usual interpretation of the state, which is normally taken to identify 
-			   A-smoothing or B-smoothings.  However, our interpretation produces an equivalent result
-			   and we allow for our different interpretation when evaluating the state's contribution 
-			   to the bracket polynomial.
-			   
-			   We maintain a boolean to identify whether we are following the underlying immersion 
-			   orientation or not.		   
+	debug << "bracket_polynomial: tangle_engine = " << tangle_engine << endl;
+
+		/* gray_code_states evaluates num_states states in Gray code order, starting with the Gray code of first_state, or all 
+		   the states if num_states is zero.  Bit i of the Gray code determines the smoothing of the i-th classical crossing.
+		*/
+		auto gray_code_states = [&](long long first_state, long long num_states, map<string,state_sum_term>& state_sum)
+		{
+			long long first_gray_code = first_state ^ (first_state >> 1);
+			
+			/* state holds the current state and counter the binary counter whose lowest changing bit 
+			   determines the next crossing whose smoothing changes
 			*/
+			vector<int> state(num_state_smoothed_crossings,-1);
+			vector<int> counter(num_state_smoothed_crossings);
+			if (num_states > 0)
+			{
+				for (int i=0; i< num_state_smoothed_crossings; i++)
+				{
+					counter[i] = (first_state >> i) & 1;
+					if ((first_gray_code >> i) & 1)
+						state[i] = 1;
+				}
+			}
+
+			vector<int> smoothed_crossing(num_state_smoothed_crossings);
+			vector<int> link(2*num_edges);
+			int sigma = 0;
+			int place = 0;
 			
-			vector<int> crossing_record(num_crossings);
-			int place=0;
 			for (int i=0; i< num_crossings; i++)
 			{
+				int OT = code_table[generic_code_data::table::ODD_TERMINATING][i];
+				int ET = code_table[generic_code_data::table::EVEN_TERMINATING][i];
+				
 				if (code_table[generic_code_data::table::LABEL][i] == generic_code_data::VIRTUAL)
 				{
-					crossing_record[i] = VIRTUAL_CROSSING;
-				}
-				else if (pure_knotoid_code_data && shortcut_crossing[i])
-				{
-					crossing_record[i] = SHORTCUT_CROSSING;
-				}
-				else if ((variant == PARITY_VARIANT || variant == PARITY_ARROW_VARIANT) && crossing_parity[i] == gauss_orientation_data::parity::ODD)
-				{
-					crossing_record[i] = ODD_CROSSING;
+					/* link the head of each terminating edge to the tail of its successor on the immersion component */
+					int edge[2] = {OT,ET};
+					for (int j=0; j< 2; j++)
+					{
+						int component;
+						if (edge[j]%2)
+							component = code_table[generic_code_data::table::COMPONENT][(edge[j]-1)/2];
+						else
+							component = code_table[generic_code_data::table::COMPONENT][edge[j]/2];
+
+						int next_edge = (edge[j] + 1 - first_edge_on_component[component])% num_component_edges[component] + first_edge_on_component[component];
+						link[2*edge[j]+1] = 2*next_edge;
+						link[2*next_edge] = 2*edge[j]+1;
+					}
 				}
-				else // classical non-shortcut crossing
+				else
 				{
-					if (state[place] == -1)
-						crossing_record[i] = NON_SEIFERT_SMOOTHED;
+					int OO = code_table[generic_code_data::table::ODD_ORIGINATING][i];
+					int EO = code_table[generic_code_data::table::EVEN_ORIGINATING][i];
+					
+					if (state[place] == 1)
+					{
+						link[2*OT+1] = 2*OO;
+						link[2*OO] = 2*OT+1;
+						link[2*ET+1] = 2*EO;
+						link[2*EO] = 2*ET+1;
+					}
 					else
-						crossing_record[i] = SEIFERT_SMOOTHED;
+					{
+						link[2*OT+1] = 2*ET+1;
+						link[2*ET+1] = 2*OT+1;
+						link[2*OO] = 2*EO;
+						link[2*EO] = 2*OO;
+					}
 					
-					place++;
+					sigma += state[place] * (sign[i] == generic_braid_data::crossing_type::POSITIVE? 1: -1);
+					smoothed_crossing[place++] = i;
 				}
 			}
-	
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{
+
+			/* count the components of the initial state.  The flag is incremented twice for every state, so it is held as 
+			   a long long, an int would overflow, and earlier flags would be reused, once there are more than 2^30 states.
+			*/
+			vector<long long> end_flag(2*num_edges);
+			long long flag = 1;
+			int num_unicursal_components = 0;
+			for (int i=0; i< 2*num_edges; i++)
+			{
+				if (end_flag[i] == 0)
+				{
+					num_unicursal_components++;
+					int end = i;
+					do
+					{
+						end_flag[end] = flag;
+						end = link[end];
+						end_flag[end] = flag;
+						end ^= 1;
+					} while (end != i);
+				}
+			}
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "bracket_polynomial: initial state has " << num_unicursal_components << " components, sigma = " << sigma << endl;
+	
+			/* A_poly[k] holds the contribution from the states having k+1 components */
+			vector<dense_laurent_polynomial> A_poly(num_edges+1);
+			A_poly[num_unicursal_components-1].add_monomial(1,sigma);
+			
+			long long states_evaluated = 1;
+			int state_count=0;  // used for comfort dots
+			
+			while (states_evaluated != num_states)
+			{
+				place = 0;
+				while (place < num_state_smoothed_crossings && counter[place] == 1)
+					counter[place++] = 0;
+					
+				if (place == num_state_smoothed_crossings)
+					break;
+				
+				counter[place] = 1;
+
+				int crossing = smoothed_crossing[place];
+				int OT_head = 2*code_table[generic_code_data::table::ODD_TERMINATING][crossing]+1;
+				int ET_head = 2*code_table[generic_code_data::table::EVEN_TERMINATING][crossing]+1;
+				int OO_tail = 2*code_table[generic_code_data::table::ODD_ORIGINATING][crossing];
+				int EO_tail = 2*code_table[generic_code_data::table::EVEN_ORIGINATING][crossing];
+				
+				/* count the components passing through the crossing before and after the change of smoothing, the 
+				   component through OT_head is the only one if it also passes through the ends not linked to OT_head
+				*/
+				int change = 0;
+				for (int i=0; i< 2; i++)
+				{
+					if (i == 1)
+					{
+						if (state[place] == -1)
+						{
+							link[OT_head] = OO_tail;
+							link[OO_tail] = OT_head;
+							link[ET_head] = EO_tail;
+							link[EO_tail] = ET_head;
+						}
+						else
+						{
+							link[OT_head] = ET_head;
+							link[ET_head] = OT_head;
+							link[OO_tail] = EO_tail;
+							link[EO_tail] = OO_tail;
+						}
+					}
+					
+					flag++;
+					int end = OT_head;
+					do
+					{
+						end_flag[end] = flag;
+						end = link[end];
+						end_flag[end] = flag;
+						end ^= 1;
+					} while (end != OT_head);
+					
+					int other_end = (link[OT_head] == OO_tail? ET_head: OO_tail);
+					int count = (end_flag[other_end] == flag? 1: 2);
+					
+					change += (i == 0? -count: count);
+				}
+				
+				state[place] *= -1;
+				sigma += 2 * state[place] * (sign[crossing] == generic_braid_data::crossing_type::POSITIVE? 1: -1);
+				num_unicursal_components += change;
+				
+				A_poly[num_unicursal_components-1].add_monomial(1,sigma);
+				states_evaluated++;
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
+	debug << "bracket_polynomial: state ";
+	for (int i=0; i< num_state_smoothed_crossings; i++)
+		debug << state[i] << ' ';
+	debug << "has " << num_unicursal_components << " components, sigma = " << sigma << endl;
+}
+	
+				state_sum_comfort_dots(state_count);
+			}
+
+			add_component_sums(state_sum,A_poly);
+		};
+
+		/* evaluate_states traces num_states consecutive states starting at first_state, or all the states if num_states is
+		   zero.  The state vector is read as a binary number, with state[0] the most significant bit and -1 representing
+		   zero.  The contribution of each state is added to state_sum or bracket_poly, unless state_term is provided, in
+		   which case the parity bracket term for each state is stored in state_term.
+		*/
+		auto evaluate_states = [&](long long first_state, long long num_states, map<string,state_sum_term>& state_sum, 
+		                           polynomial<int,bracket_variable>& bracket_poly, polynomial<int,bracket_variable>* state_term)
+		{
+		/* arrow polynomial variables */
+		int arrow_state_zig_zag_count = 0;
+//		int arrow_state_first_non_seifert_turn;
+		int arrow_state_last_non_seifert_turn = generic_code_data::VOID;
+		int non_seifert_turn = generic_code_data::VOID;
+
+		/* algebraic_crossing_number and oss are updated as each state is traced, so each worker has its own copy */
+		int algebraic_crossing_number = 0;
+		ostringstream oss;
+
+		bool finished=false;
+	
+		vector<int> state(num_state_smoothed_crossings);
+		for (int i=0; i< num_state_smoothed_crossings; i++)
+			state[i] = (num_states > 0 && (first_state >> (num_state_smoothed_crossings-1-i)) & 1? 1: -1);
+	
+		long long states_evaluated = 0;
+		int state_count=0;  // used for comfort dots
+		
+		while (!finished)
+		{
+			/* determine the contribution to the bracket polynomial from the current state.  We need to count the 
+			   number of components for this state and evaluate sigma, the "state sum".
+			   
+			   We count the components by tracing around the diagram following the smoothing determined by the state.
+
+			   In the case of the Turaev variant for knotoids, we must also evaluate the algebraic crossing number 
+			   of the segment component with the shortcut.			   
+			*/
+	
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
+	debug << "bracket_polynomial: state ";
+	for (int i=0; i< num_state_smoothed_crossings; i++)
+		debug << state[i] << ' ';
+	debug << endl;
+}
+	
+			/* map the state onto a record of the all crossings in order to accommodate 
+			   virtual crossings and shortcut crossings, as these are never smoothed.
+			   
+			   We shall perform Seifert smoothing, where 2i <-> 2j and 2j-1 <-> 2i+1, on classical 
+			   non-shortcut crossings whose state is 1 and non-Seifert smoothing, where 2i <-> 2j-1 
+			   and 2j <-> 2i+1 on those whose state is -1.
+			   
+			   This is not the usual interpretation of the state, which is normally taken to identify 
+			   A-smoothing or B-smoothings.  However, our interpretation produces an equivalent result
+			   and we allow for our different interpretation when evaluating the state's contribution 
+			   to the bracket polynomial.
+			   
+			   We maintain a boolean to identify whether we are following the underlying immersion 
+			   orientation or not.		   
+			*/
+			
+			vector<int> crossing_record(num_crossings);
+			int place=0;
+			for (int i=0; i< num_crossings; i++)
+			{
+				if (code_table[generic_code_data::table::LABEL][i] == generic_code_data::VIRTUAL)
+				{
+					crossing_record[i] = VIRTUAL_CROSSING;
+				}
+				else if (pure_knotoid_code_data && shortcut_crossing[i])
+				{
+					crossing_record[i] = SHORTCUT_CROSSING;
+				}
+				else if ((variant == PARITY_VARIANT || variant == PARITY_ARROW_VARIANT) && crossing_parity[i] == gauss_orientation_data::parity::ODD)
+				{
+					crossing_record[i] = ODD_CROSSING;
+				}
+				else // classical non-shortcut crossing
+				{
+					if (state[place] == -1)
+						crossing_record[i] = NON_SEIFERT_SMOOTHED;
+					else
+						crossing_record[i] = SEIFERT_SMOOTHED;
+					
+					place++;
+				}
+			}
+	
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
 	debug << "bracket_polynomial: crossing_record (SEIFERT_SMOOTHED = 1, NON_SEIFERT_SMOOTHED = -1, VIRTUAL = 2, SHORTCUT_CROSSING = 3, ODD = 4)" << endl;
 	debug << "bracket_polynomial: crossing_record ";
 	for (int i=0; i< num_crossings; i++)
@@ -2618,26 +3253,54 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 				}
 			}
 	
-			/* build up the next term of the polynomial, first clear the ostringstream */		
-			oss.clear();
-			oss.str("");
-			
-			if (sigma !=0)
-				oss << "A^" << sigma;
+			if (dense_state_sum)
+			{
+				/* For the Kauffman bracket and the Turaev extended bracket, the number of delta terms is one less 
+				   than the number of unicursal components.  The same is true for the arrow polynomial if we are
+				   following the old convention of including delta with zig-zag components (K_i and L_i variables).
+				   However, the default for the arrow polynomial is for ZIG_ZAG_DELTA to be false, in which case
+				   it is the number of non-zig-zag components.
+				*/
+				int num_delta_terms = num_unicursal_components-1;
+				
+				if (variant == ARROW_VARIANT && !braid_control::ZIG_ZAG_DELTA) // the default
+					num_delta_terms -= num_zig_zag_components-1;
+					
+				ostringstream key;
+				key << num_delta_terms << ' ' << algebraic_crossing_number << ' ' << arrow_factor;
+				
+				map<string,state_sum_term>::iterator sptr = state_sum.find(key.str());
+				if (sptr == state_sum.end())
+				{
+					state_sum_term new_term;
+					new_term.num_delta_terms = num_delta_terms;
+					new_term.algebraic_crossing_number = algebraic_crossing_number;
+					new_term.arrow_factor = arrow_factor;
+					sptr = state_sum.insert(pair<string,state_sum_term>(key.str(),new_term)).first;
+				}
+				
+				sptr->second.A_poly.add_monomial(1,sigma);
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "bracket_polynomial:   sigma = " << sigma << " added to state sum term " << key.str() << endl;
+			}
 			else
-				oss << "1";
-	
-			if (variant == TURAEV_VARIANT)
-				oss << "u^" << algebraic_crossing_number;
+			{
+				/* build up the next term of the parity bracket or parity arrow polynomial, first clear the ostringstream */		
+				oss.clear();
+				oss.str("");
+				
+				if (sigma !=0)
+					oss << "A^" << sigma;
+				else
+					oss << "1";
 	
-			polynomial<int,bracket_variable> term(oss.str());			
-			
-			
+				polynomial<int,bracket_variable> term(oss.str());			
+				
+				
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "bracket_polynomial:   term initially set to " << term << endl;
-						
-			if (variant == PARITY_VARIANT || variant == PARITY_ARROW_VARIANT)
-			{				
+							
 				int num_delta_terms = num_non_graphical_u_cpts+num_virtual_components;
 				
 				if (variant == PARITY_ARROW_VARIANT && !braid_control::ZIG_ZAG_DELTA) // the default
@@ -2660,52 +3323,6 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << "bracket_polynomial:   num_non_graphical_u_cpts = " << num_non_graphical_u_cpts << endl;
 	debug << "bracket_polynomial:   num_virtual_components = " << num_virtual_components << endl;
 }
-			}
-			else
-			{
-				/* For the Kauffman bracket and the Turaev extended bracket, the number of delta terms is one less 
-				   than the number of unicursal components.  The same is true for the arrow polynomial if we are
-				   following the old convention of including delta with zig-zag components (K_i and L_i variables).
-				   However, the default for the arrow polynomial is for ZIG_ZAG_DELTA to be false, in which case
-				   it is the number of non-zig-zag components.
-				*/
-				int num_delta_terms = num_unicursal_components-1;
-				
-				if (variant == ARROW_VARIANT && !braid_control::ZIG_ZAG_DELTA) // the default
-					num_delta_terms -= num_zig_zag_components-1;
-					
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "bracket_polynomial:   num_delta_terms = " << num_delta_terms << endl;
-				
-				for (int i=0; i< num_delta_terms; i++)
-				{
-					if (braid_control::EXPANDED_BRACKET_POLYNOMIAL)
-						term *= polynomial<int, bracket_variable>("-A^2-A^-2");	
-					else
-						term *= polynomial<int, bracket_variable>("D");	
-				}
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "bracket_polynomial:   term = " << term << endl;
-			}
-	
-			if (variant == ARROW_VARIANT)
-			{
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "bracket_polynomial:   term before arrow factor = " << term;
-	
-				term *= arrow_factor;			
-
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{
-	bool map_variables = polynomial_control::SUBSTITUTE_MAPPED_VARIABLES;
-	polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = true;			
-	debug << ", arrow_factor = " << arrow_factor << endl;
-	polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;			
-	debug << "bracket_polynomial:   final term = " << term << endl;
-}
-			}
-			else if (variant == PARITY_VARIANT || variant == PARITY_ARROW_VARIANT)
-			{
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "bracket_polynomial:   term before arrow_factor and parity_factor = " << term << endl;
 				for (int i=0; i< arrow_factor.nv; i++)
@@ -2764,10 +3381,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "bracket_polynomial:   final term = " << term << endl;
 	polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;			
 }
-			}
 
-			bracket_poly += term;
-			
+				if (state_term)
+					state_term[states_evaluated] = term;
+				else
+					bracket_poly += term;
+				
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
 	debug << "bracket_polynomial:   updated bracket_poly = ";
@@ -2776,6 +3395,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << bracket_poly << endl;
 	polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;
 }
+			}
 
 			
 			/* increment state */
@@ -2802,27 +3422,105 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				finished = true;
 			}
 	
-			if (!braid_control::SILENT_OPERATION && braid_control::WAIT_SWITCH)
-			{
-			    if (++state_count == braid_control::wait_threshold)
-			    {
-					cout << ".";
-	   				cout.flush();
+			if (num_states > 0 && ++states_evaluated == num_states)
+				finished = true;
 					
-					if (braid_control::wait_count > 1000)
-					{
-						braid_control::reset_count++;
-			    		cout << "\nworking bracket polynomial (" << braid_control::reset_count << ")\n";
-			    		braid_control::wait_count = 0;
-					}
+			state_sum_comfort_dots(state_count);
+			
+		}
+		};
+
+		/* Determine the number of worker threads.  We use a single thread if debugging, since the debug output is 
+		   not thread safe, or if the number of states is too large to be counted in a long long.
+		*/
+		int num_workers = 1;
+		long long num_states = 0;
+		if (braid_control::num_threads > 1 && debug_control::DEBUG == debug_control::OFF && num_state_smoothed_crossings < 63)
+		{
+			num_states = 1LL << num_state_smoothed_crossings;
+			num_workers = static_cast<int>(min(static_cast<long long>(braid_control::num_threads),num_states));
+		}
+		
+		if (tangle_engine)
+		{
+			tangle_state_sum(code_data,sign,strand_partner,crossing_order,num_virtual_loops,state_sum);
+		}
+		else if (num_workers == 1)
+		{
+			if (gray_code_walk)
+				gray_code_states(0,0,state_sum);
+			else
+				evaluate_states(0,0,state_sum,bracket_poly,0);
+		}
+		else if (dense_state_sum)
+		{
+			/* each worker accumulates its own state_sum for a contiguous block of states, we then combine them */
+			vector<map<string,state_sum_term> > worker_state_sum(num_workers);
+			vector<polynomial<int,bracket_variable> > worker_bracket_poly(num_workers);
+			vector<thread> worker;
+			
+			for (int i=0; i< num_workers; i++)
+			{
+				long long first_state = num_states/num_workers*i;
+				long long worker_states = (i == num_workers-1? num_states-first_state: num_states/num_workers);
+				
+				if (gray_code_walk)
+					worker.push_back(thread(gray_code_states,first_state,worker_states,ref(worker_state_sum[i])));
+				else
+					worker.push_back(thread(evaluate_states,first_state,worker_states,ref(worker_state_sum[i]),ref(worker_bracket_poly[i]),
+					                        static_cast<polynomial<int,bracket_variable>*>(0)));
+			}
+			
+			for (int i=0; i< num_workers; i++)
+			{
+				worker[i].join();
+				
+				map<string,state_sum_term>::iterator wptr = worker_state_sum[i].begin();
+				while (wptr != worker_state_sum[i].end())
+				{
+					map<string,state_sum_term>::iterator sptr = state_sum.find(wptr->first);
+					if (sptr == state_sum.end())
+						state_sum.insert(*wptr);
 					else
-			    		braid_control::wait_count++;
-			    		
-					state_count = 0;
-		    	}
+						sptr->second.A_poly += wptr->second.A_poly;
+					wptr++;
+				}
 			}
+		}
+		else
+		{
+			/* The variables of the parity bracket polynomial depend on the order in which the graphical components are
+			   added to bracket_poly, so to reproduce the serial result the workers store the terms of successive blocks 
+			   of states, which we then add to bracket_poly in state order.
+			*/
+			const long long worker_block_size = 1024;
+			long long block_size = worker_block_size * num_workers;
+			vector<polynomial<int,bracket_variable> > state_term(block_size);
+			vector<map<string,state_sum_term> > worker_state_sum(num_workers);
+			vector<polynomial<int,bracket_variable> > worker_bracket_poly(num_workers);
 			
-		} while (!finished);
+			for (long long block_start = 0; block_start < num_states; block_start += block_size)
+			{
+				long long block_states = min(block_size,num_states-block_start);
+				vector<thread> worker;
+				
+				for (int i=0; i< num_workers; i++)
+				{
+					long long first_state = worker_block_size*i;
+					long long worker_states = min(worker_block_size,block_states-first_state);
+					
+					if (worker_states > 0)
+						worker.push_back(thread(evaluate_states,block_start+first_state,worker_states,ref(worker_state_sum[i]),
+						                        ref(worker_bracket_poly[i]),&state_term[first_state]));
+				}
+
+				for (size_t i=0; i< worker.size(); i++)
+					worker[i].join();
+				
+				for (long long i=0; i< block_states; i++)
+					bracket_poly += state_term[i];
+			}
+		}
 		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
@@ -2832,8 +3530,138 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << bracket_poly << endl;
 	polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;
 }		
+		if (dense_state_sum)
+		{
+			/* evaluate the contribution of each state_sum_term, expanding the delta terms as dense Laurent polynomials, if required.
+			   The contributions are first added to factor_sum, which combines the terms having the same factor in the variables other 
+			   than A, so that the range of each coefficient is checked in the sum, since the coefficients of individual terms may
+			   lie outside the range of int even though those of the bracket polynomial do not.  If a coefficient of the sum lies 
+			   outside the range of int, the bracket polynomial is evaluated using bigint coefficients.
+			*/
+			dense_laurent_polynomial delta;
+			delta.add_monomial(-1,2);
+			delta.add_monomial(-1,-2);
+			
+			map<string,state_sum_term> factor_sum;
+			map<string,state_sum_term>::iterator sptr = state_sum.begin();
+			while (sptr != state_sum.end())
+			{
+				state_sum_term& sum_term = sptr->second;
+				dense_laurent_polynomial A_poly = sum_term.A_poly;
+
+				if (braid_control::EXPANDED_BRACKET_POLYNOMIAL)
+				{
+					for (int i=0; i< sum_term.num_delta_terms; i++)
+						A_poly *= delta;
+				}
+				
+				ostringstream key;
+				key << (braid_control::EXPANDED_BRACKET_POLYNOMIAL? 0: sum_term.num_delta_terms) << ' ' 
+				    << (variant == TURAEV_VARIANT? sum_term.algebraic_crossing_number: 0) << ' ';
+				if (variant == ARROW_VARIANT)
+					key << sum_term.arrow_factor;
+					
+				map<string,state_sum_term>::iterator fptr = factor_sum.find(key.str());
+				if (fptr == factor_sum.end())
+				{
+					state_sum_term factor_term = sum_term;
+					factor_term.A_poly = A_poly;
+					factor_sum.insert(pair<string,state_sum_term>(key.str(),factor_term));
+				}
+				else
+					fptr->second.A_poly += A_poly;
+				
+				sptr++;
+			}
+			
+			sptr = factor_sum.begin();
+			while (sptr != factor_sum.end())
+			{
+				state_sum_term& sum_term = sptr->second;
+				dense_laurent_polynomial& A_poly = sum_term.A_poly;
+
+				if (!A_poly.fits_int())
+				{
+					bigint_coefficients = true;
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "bracket_polynomial: state sum factor " << sptr->first << " has a coefficient outside the range of int, using bigint coefficients" << endl;
+				}
+				
+				sptr++;
+			}
+			
+			sptr = factor_sum.begin();
+			while (sptr != factor_sum.end())
+			{
+				state_sum_term& sum_term = sptr->second;
+				dense_laurent_polynomial& A_poly = sum_term.A_poly;
+
+				if (!A_poly.is_zero())
+				{
+					/* with bigint coefficients, term holds the factor in the variables other than A */
+					polynomial<int,bracket_variable> term(bigint_coefficients? string("1"): A_poly.to_string('A'));
+					
+					if (!braid_control::EXPANDED_BRACKET_POLYNOMIAL)
+					{
+						for (int i=0; i< sum_term.num_delta_terms; i++)
+							term *= polynomial<int, bracket_variable>("D");	
+					}
+					
+					if (variant == TURAEV_VARIANT)
+					{
+						oss.clear();
+						oss.str("");
+						oss << "u^" << sum_term.algebraic_crossing_number;
+						term *= polynomial<int, bracket_variable>(oss.str());
+					}
+					else if (variant == ARROW_VARIANT)
+					{
+						term *= sum_term.arrow_factor;
+					}
+
+					if (bigint_coefficients)
+					{
+						oss.clear();
+						oss.str("");
+						bool map_variables = polynomial_control::SUBSTITUTE_MAPPED_VARIABLES;
+						polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = false;
+						oss << term;
+						polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;
+						
+						polynomial<bigint,bracket_variable> big_term(A_poly.to_string('A'));
+						big_term *= polynomial<bigint,bracket_variable>(oss.str());
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "bracket_polynomial: state sum factor " << sptr->first << " contributes " << big_term << endl;
+	
+						big_bracket_poly += big_term;
+					}
+					else
+					{
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "bracket_polynomial: state sum factor " << sptr->first << " contributes " << term << endl;
+	
+						bracket_poly += term;
+					}
+				}
+				
+				sptr++;
+			}
+		}
+		
 		if (braid_control::NORMALIZE_BRACKET)
-			bracket_poly *= normalizing_factor;
+		{
+			if (bigint_coefficients)
+			{
+				oss.clear();
+				oss.str("");
+				oss << normalizing_factor;
+				big_bracket_poly *= polynomial<bigint,bracket_variable>(oss.str());
+			}
+			else
+				bracket_poly *= normalizing_factor;
+		}
 	}
 	else
 	{		
@@ -2851,7 +3679,10 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 
 		ostringstream oss;
 		
-		oss << bracket_poly;
+		if (bigint_coefficients)
+			oss << big_bracket_poly;
+		else
+			oss << bracket_poly;
 		
 		string kstring = oss.str();
 		
@@ -2946,23 +3777,10 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	{
 		if (variant == ARROW_VARIANT)
 		{
-			for (int i=0; i< bracket_poly.nv; i++)
-			{
-				char ch = bracket_poly.getvar(i);
-				int index=0;
-				if (ch != 'A' && ch != 'D' &&ch < 'n')
-				{
-					index = ch-'a'+1;					
-					bracket_variable bv("L_"+to_string(index));
-					bracket_poly.set_varmap(ch,bv);
-				}
-				else if (ch != 'A' && ch != 'D')
-				{
-					index = ch-'n'+1;	
-					bracket_variable bv("K_"+to_string(index));					
-					bracket_poly.set_varmap(ch,bv);
-				}
-			}
+			if (bigint_coefficients)
+				set_arrow_polynomial_varmap(big_bracket_poly);
+			else
+				set_arrow_polynomial_varmap(bracket_poly);
 		}
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
@@ -2974,6 +3792,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << "bracket_polynomial: bracket_polynomial = " << bracket_poly << endl;
 		polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;
 	}
+	else if (bigint_coefficients)
+		debug << "bracket_polynomial: bracket_polynomial = " << big_bracket_poly << endl;
 	else
 		debug << "bracket_polynomial: bracket_polynomial = " << bracket_poly << endl;
 }
@@ -3006,6 +3826,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				cout << " polynomial = " << bracket_poly << endl;
 				polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;
 			}
+			else if (bigint_coefficients)
+				cout<< " polynomial = " << big_bracket_poly << endl;
 			else
 				cout<< " polynomial = " << bracket_poly << endl;			
 		}
@@ -3040,11 +3862,22 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			output << bracket_poly << endl;
 			polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = map_variables;
 		}
+		else if (bigint_coefficients)
+			output << big_bracket_poly << endl;
 		else
 			output << bracket_poly << endl;
 			
 		polynomial_control::TeX = TeX;
 		
+		if (braid_control::EXTRA_OUTPUT && (variant == PARITY_VARIANT || variant == PARITY_ARROW_VARIANT))
+		{
+			print_canonical_cache_use("Left preferred Gauss data",left_preferred_cache.hits() - initial_cache_hits,
+			                          left_preferred_cache.misses() - initial_cache_misses, left_preferred_cache.size());
+		}
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "bracket_polynomial: left preferred Gauss data cache hits = " << left_preferred_cache.hits() - initial_cache_hits 
+	      << ", misses = " << left_preferred_cache.misses() - initial_cache_misses << ", size = " << left_preferred_cache.size() << endl;
 	}	
 }
 
@@ -3104,3 +3937,398 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 }
 
 					
+
+/* add_component_sums adds the contributions to the Kauffman bracket held in A_poly, where A_poly[k] is the contribution 
+   from states having k+1 components, to state_sum, using the same key as bracket_polynomial uses for the full trace
+   of each state.
+*/
+void add_component_sums(map<string,state_sum_term>& state_sum, vector<dense_laurent_polynomial>& A_poly)
+{
+	polynomial<int,bracket_variable> arrow_factor(1);	
+	for (unsigned int i=0; i< A_poly.size(); i++)
+	{
+		if (A_poly[i].is_zero())
+			continue;
+			
+		ostringstream key;
+		key << i << ' ' << 0 << ' ' << arrow_factor;
+
+		map<string,state_sum_term>::iterator sptr = state_sum.find(key.str());
+		if (sptr == state_sum.end())
+		{
+			state_sum_term new_term;
+			new_term.num_delta_terms = i;
+			new_term.algebraic_crossing_number = 0;
+			new_term.arrow_factor = arrow_factor;
+			new_term.A_poly = A_poly[i];
+			state_sum.insert(pair<string,state_sum_term>(key.str(),new_term));
+		}
+		else
+			sptr->second.A_poly += A_poly[i];
+	}
+}
+
+/* The tangle engine evaluates the Kauffman bracket of a diagram all of whose non-virtual crossings are classical by 
+   adding the classical crossings one at a time to a growing tangle and recording, for each way of smoothing the crossings
+   added so far, only how the smoothed tangle connects the ends of the semi-arcs on its boundary, together with the number
+   of closed loops it contains.  Smoothings having the same boundary connections and number of loops are combined, so the 
+   cost depends on the number of boundary connections, which is exponential in the width of the boundary rather than in 
+   the number of crossings.
+   
+   As in bracket_polynomial's Gray code walk, end 2e is the tail of edge e and end 2e+1 its head.  The ends at the classical 
+   crossings are joined in pairs by strands that follow the edges of the diagram through any virtual crossings.
+   
+   tangle_decomposition determines strand_partner, the end at the other end of the strand from each end at a classical 
+   crossing, the order in which the crossings are added to the tangle, and the number of components of the diagram that
+   contain only virtual crossings.  The order is chosen greedily, adding the crossing that results in the smallest 
+   boundary.  The function returns an estimate of the number of boundary connections that the tangle engine will have
+   to consider.
+*/
+double tangle_decomposition(generic_code_data& code_data, vector<int>& strand_partner, vector<int>& crossing_order, int& num_virtual_loops)
+{
+	matrix<int>& code_table = code_data.code_table;
+	int num_crossings = code_data.num_crossings;
+	int num_edges = 2*num_crossings;
+	vector<int>& first_edge_on_component = code_data.first_edge_on_component;
+	vector<int>& num_component_edges = code_data.num_component_edges;
+
+	/* link the ends at virtual crossings, as in the Gray code walk */
+	vector<int> link(2*num_edges,-1);
+	vector<int> end_crossing(2*num_edges);
+	bool virtual_crossings = false;
+	
+	for (int i=0; i< num_crossings; i++)
+	{
+		int edge[4] = {code_table[generic_code_data::table::ODD_TERMINATING][i],code_table[generic_code_data::table::EVEN_TERMINATING][i],
+		               code_table[generic_code_data::table::ODD_ORIGINATING][i],code_table[generic_code_data::table::EVEN_ORIGINATING][i]};
+		end_crossing[2*edge[0]+1] = i;
+		end_crossing[2*edge[1]+1] = i;
+		end_crossing[2*edge[2]] = i;
+		end_crossing[2*edge[3]] = i;
+		
+		if (code_table[generic_code_data::table::LABEL][i] == generic_code_data::VIRTUAL)
+		{
+			virtual_crossings = true;
+			
+			for (int j=0; j< 2; j++)
+			{
+				int component;
+				if (edge[j]%2)
+					component = code_table[generic_code_data::table::COMPONENT][(edge[j]-1)/2];
+				else
+					component = code_table[generic_code_data::table::COMPONENT][edge[j]/2];
+
+				int next_edge = (edge[j] + 1 - first_edge_on_component[component])% num_component_edges[component] + first_edge_on_component[component];
+				link[2*edge[j]+1] = 2*next_edge;
+				link[2*next_edge] = 2*edge[j]+1;
+			}
+		}
+	}
+	
+	/* trace the strands from the ends at classical crossings */
+	strand_partner = vector<int>(2*num_edges,-1);
+	vector<bool> edge_traced(num_edges);
+	for (int i=0; i< 2*num_edges; i++)
+	{
+		if (link[i] != -1 || strand_partner[i] != -1)
+			continue;
+			
+		int end = i;
+		do
+		{
+			edge_traced[end/2] = true;
+			end ^= 1;
+			if (link[end] == -1)
+				break;
+			end = link[end];
+		} while (true);
+		
+		strand_partner[i] = end;
+		strand_partner[end] = i;
+	}
+
+	/* any edges not traced lie on components containing only virtual crossings */
+	num_virtual_loops = 0;
+	for (int i=0; i< num_edges; i++)
+	{
+		if (edge_traced[i])
+			continue;
+			
+		num_virtual_loops++;
+		int end = 2*i;
+		do
+		{
+			edge_traced[end/2] = true;
+			end = link[end^1];
+		} while (end != 2*i);
+	}
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+{
+	debug << "tangle_decomposition: strand_partner ";
+	for (int i=0; i< 2*num_edges; i++)
+		debug << strand_partner[i] << ' ';
+	debug << endl;
+	debug << "tangle_decomposition: num_virtual_loops = " << num_virtual_loops << endl;
+}
+
+	/* choose the crossing order, boundary_ends counts the ends of the strands currently on the boundary */
+	vector<bool> added(num_crossings);
+	for (int i=0; i< num_crossings; i++)
+	{
+		if (code_table[generic_code_data::table::LABEL][i] == generic_code_data::VIRTUAL)
+			added[i] = true;
+	}
+	
+	crossing_order.clear();
+	int boundary_ends = 0;
+	double cost = 0;
+	
+	do
+	{
+		int next_crossing = -1;
+		int next_boundary_ends = 0;
+		
+		for (int i=0; i< num_crossings; i++)
+		{
+			if (added[i])
+				continue;
+				
+			int ends = boundary_ends;
+			for (int j=0; j< 2*num_edges; j++)
+			{
+				if (strand_partner[j] != -1 && end_crossing[j] == i)
+				{
+					int partner_crossing = end_crossing[strand_partner[j]];
+					if (added[partner_crossing])
+						ends--;
+					else if (partner_crossing != i)
+						ends++;
+				}
+			}
+			
+			if (next_crossing == -1 || ends < next_boundary_ends)
+			{
+				next_crossing = i;
+				next_boundary_ends = ends;
+			}
+		}
+		
+		if (next_crossing == -1)
+			break;
+			
+		added[next_crossing] = true;
+		crossing_order.push_back(next_crossing);
+		boundary_ends = next_boundary_ends;
+		
+		/* estimate the number of boundary connections, these are non-crossing if the diagram is classical */
+		double connections = 1;
+		int n = boundary_ends/2;
+		if (virtual_crossings)
+		{
+			for (int i= boundary_ends-1; i > 1; i-=2)
+				connections *= i;
+		}
+		else
+		{
+			for (int i=1; i<= n; i++)
+				connections = connections * (n+i) / i;
+			connections /= n+1;
+		}
+		cost += connections;
+		
+	} while (true);
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+{
+	debug << "tangle_decomposition: crossing_order ";
+	for (unsigned int i=0; i< crossing_order.size(); i++)
+		debug << crossing_order[i] << ' ';
+	debug << endl;
+	debug << "tangle_decomposition: estimated cost = " << cost << endl;
+}
+
+	return cost;
+}
+
+/* tangle_state_sum evaluates the Kauffman bracket state sum using the decomposition determined by tangle_decomposition 
+   and adds the result to state_sum.  A boundary connection is described by the vector connection, where connection[i]
+   is the position in the boundary of the end connected to the i-th boundary end.  The boundary ends are held in 
+   ascending order.
+*/
+void tangle_state_sum(generic_code_data& code_data, vector<int>& sign, vector<int>& strand_partner, vector<int>& crossing_order, 
+                      int num_virtual_loops, map<string,state_sum_term>& state_sum)
+{
+	matrix<int>& code_table = code_data.code_table;
+	int num_crossings = code_data.num_crossings;
+	int num_edges = 2*num_crossings;
+	
+	vector<int> boundary;
+	vector<bool> added(num_crossings);
+	vector<int> end_crossing(2*num_edges);
+	for (int i=0; i< num_crossings; i++)
+	{
+		end_crossing[2*code_table[generic_code_data::table::ODD_TERMINATING][i]+1] = i;
+		end_crossing[2*code_table[generic_code_data::table::EVEN_TERMINATING][i]+1] = i;
+		end_crossing[2*code_table[generic_code_data::table::ODD_ORIGINATING][i]] = i;
+		end_crossing[2*code_table[generic_code_data::table::EVEN_ORIGINATING][i]] = i;
+	}
+
+	/* tangle maps each boundary connection to the contributions of the smoothings that realize it, indexed by the number of closed loops */
+	map<vector<int>, vector<dense_laurent_polynomial> > tangle;
+	tangle[vector<int>()] = vector<dense_laurent_polynomial>(1,dense_laurent_polynomial(1,0));
+	
+	for (unsigned int i=0; i< crossing_order.size(); i++)
+	{
+		int crossing = crossing_order[i];
+		
+		/* the ends at crossing in the order OT head, ET head, OO tail, EO tail */
+		int crossing_end[4] = {2*code_table[generic_code_data::table::ODD_TERMINATING][crossing]+1,2*code_table[generic_code_data::table::EVEN_TERMINATING][crossing]+1,
+		                       2*code_table[generic_code_data::table::ODD_ORIGINATING][crossing],2*code_table[generic_code_data::table::EVEN_ORIGINATING][crossing]};
+		
+		added[crossing] = true;
+		
+		/* The nodes of the local graph are the boundary ends, numbered from zero, followed by the four crossing ends.  
+		   Each node has at most one neighbour along the strands, strand_node, and a second neighbour given by the
+		   boundary connection or the smoothing of the crossing.
+		*/
+		int num_boundary_ends = boundary.size();
+		int num_nodes = num_boundary_ends+4;
+		vector<int> strand_node(num_nodes,-1);
+		
+		for (int j=0; j< 4; j++)
+		{
+			int partner = strand_partner[crossing_end[j]];
+			if (end_crossing[partner] == crossing)
+			{
+				for (int k=0; k< 4; k++)
+				{
+					if (crossing_end[k] == partner)
+						strand_node[num_boundary_ends+j] = num_boundary_ends+k;
+				}
+			}
+			else if (added[end_crossing[partner]])
+			{
+				int place = lower_bound(boundary.begin(),boundary.end(),partner) - boundary.begin();
+				strand_node[num_boundary_ends+j] = place;
+				strand_node[place] = num_boundary_ends+j;
+			}
+		}
+		
+		/* the new boundary comprises the nodes having no strand neighbour */
+		vector<int> new_boundary;
+		vector<int> new_place(num_nodes,-1);
+		vector<pair<int,int> > boundary_node;
+		for (int j=0; j< num_nodes; j++)
+		{
+			if (strand_node[j] == -1)
+				boundary_node.push_back(pair<int,int>(j < num_boundary_ends? boundary[j]: crossing_end[j-num_boundary_ends],j));
+		}
+		sort(boundary_node.begin(),boundary_node.end());
+		for (unsigned int j=0; j< boundary_node.size(); j++)
+		{
+			new_boundary.push_back(boundary_node[j].first);
+			new_place[boundary_node[j].second] = j;
+		}
+		
+		int crossing_sign = (sign[crossing] == generic_braid_data::crossing_type::POSITIVE? 1: -1);
+		
+		map<vector<int>, vector<dense_laurent_polynomial> > new_tangle;
+		map<vector<int>, vector<dense_laurent_polynomial> >::iterator tptr = tangle.begin();
+		while (tptr != tangle.end())
+		{
+			const vector<int>& connection = tptr->first;
+			
+			/* smoothing 1 is the Seifert smoothing, smoothing -1 the non-Seifert smoothing */
+			for (int smoothing = -1; smoothing <= 1; smoothing += 2)
+			{
+				vector<int> other_node(num_nodes);
+				for (int j=0; j< num_boundary_ends; j++)
+					other_node[j] = connection[j];
+					
+				if (smoothing == 1)
+				{
+					other_node[num_boundary_ends] = num_boundary_ends+2;
+					other_node[num_boundary_ends+2] = num_boundary_ends;
+					other_node[num_boundary_ends+1] = num_boundary_ends+3;
+					other_node[num_boundary_ends+3] = num_boundary_ends+1;
+				}
+				else
+				{
+					other_node[num_boundary_ends] = num_boundary_ends+1;
+					other_node[num_boundary_ends+1] = num_boundary_ends;
+					other_node[num_boundary_ends+2] = num_boundary_ends+3;
+					other_node[num_boundary_ends+3] = num_boundary_ends+2;
+				}
+				
+				/* follow the paths from the new boundary ends, then count the closed loops that remain */
+				vector<int> new_connection(new_boundary.size());
+				vector<bool> visited(num_nodes);
+				int loops = 0;
+				
+				for (int j=0; j< num_nodes; j++)
+				{
+					if (visited[j] || new_place[j] == -1)
+						continue;
+					
+					int node = j;
+					visited[node] = true;
+					node = other_node[node];
+					while (strand_node[node] != -1)
+					{
+						visited[node] = true;
+						node = strand_node[node];
+						visited[node] = true;
+						node = other_node[node];
+					}
+					visited[node] = true;
+					
+					new_connection[new_place[j]] = new_place[node];
+					new_connection[new_place[node]] = new_place[j];
+				}
+
+				for (int j=0; j< num_nodes; j++)
+				{
+					if (visited[j])
+						continue;
+					
+					loops++;
+					int node = j;
+					do
+					{
+						visited[node] = true;
+						node = strand_node[node];
+						visited[node] = true;
+						node = other_node[node];
+					} while (node != j);
+				}
+				
+				vector<dense_laurent_polynomial>& contribution = new_tangle[new_connection];
+				const vector<dense_laurent_polynomial>& old_contribution = tptr->second;
+				if (contribution.size() < old_contribution.size() + loops)
+					contribution.resize(old_contribution.size() + loops);
+					
+				for (unsigned int j=0; j< old_contribution.size(); j++)
+				{
+					contribution[j+loops].add_shifted(old_contribution[j],smoothing*crossing_sign);
+				}
+			}
+			
+			tptr++;
+		}
+		
+		tangle.swap(new_tangle);
+		boundary.swap(new_boundary);
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "tangle_state_sum: added crossing " << crossing << ", boundary has " << boundary.size() << " ends and " << tangle.size() << " connections" << endl;
+	}
+	
+	/* the boundary is now empty and the components of each state are the closed loops and the virtual loops */
+	vector<dense_laurent_polynomial>& loop_contribution = tangle[vector<int>()];
+	vector<dense_laurent_polynomial> A_poly(loop_contribution.size()+num_virtual_loops);
+	for (unsigned int i=1; i< loop_contribution.size(); i++)
+		A_poly[i-1+num_virtual_loops] = loop_contribution[i];
+	
+	add_component_sums(state_sum,A_poly);
+}
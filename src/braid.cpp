@@ -12,6 +12,8 @@ string braid_to_generic_code (string braid, int num_terms, int code_type,vector<
 hpolynomial homfly(vector<int> braid_num, vector<int> type, vector<int> component_record, 
                                                                        int basepoint, int level, bool virtual_braid)
 hpolynomial virtual_homfly(vector<int> braid_num, vector<int> type, vector<int> master_component_record, int level)
+string homfly_cache_key(vector<int>& braid_num, vector<int>& type, vector<int>& component_record, int basepoint, bool virtual_braid)
+void clear_homfly_cache()
 int num_braid_terms(string word)
 void set_component_record (int action, vector<int>& braid_num, vector<int>& type, vector<int>& component_record,
                            int base_crossing, int basepoint, int datum)
@@ -23,7 +25,7 @@ bool distinguish_modified_string (matrix<int>& Su, matrix<int>& Sd, matrix<int>&
 void check_3_cycle(matrix<int>& Su,matrix<int>& Sd,matrix<int>& invSu,matrix<int>& invSd,matrix<int>& Tu,matrix<int>& Td,matrix<int>& Xu,matrix<int>& Xd, 
                    vector<int>& Mv, string braid_string, vector<int>& braid_num, vector<bool>& virtual_crossing)
 void braid_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
-			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period)
+			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period, ostream& os, ostream& output_os)
 	
  **************************************************************************/
 #include <string>
@@ -35,9 +37,12 @@ void braid_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& in
 #include <valarray>
 #include <iomanip>
 #include <map>
+#include <algorithm>
 #include <ctype.h>
 #include <stdio.h>
 #include <math.h>
+#include <mutex>
+#include <functional>
 
 using namespace std;
 
@@ -62,6 +67,27 @@ extern ifstream     input;
 #include <braid.h>
 #include <reidemeister.h>
 
+/* The homfly_cache is a transposition table for the homfly function.  It records the HOMFLY polynomial of the braids evaluated at the
+   nodes of the skein tree, so that a braid reached by more than one sequence of crossing changes and smoothings is evaluated only once.
+   Since the skein tree is determined by the braid word, the component record, the basepoint and whether the braid is virtual, these 
+   make up the key, the level of the tree being irrelevant.  At most braid_control::homfly_cache_limit polynomials are recorded, further 
+   results are not cached once the limit is reached.
+   
+   The cache is shared by the worker threads evaluating the permutations in virtual_homfly, so table, hits and misses
+   are accessed only with cache_mutex held.
+*/
+struct homfly_cache_data
+{
+	map<string,hpolynomial> table;
+	long hits;
+	long misses;
+	mutex cache_mutex;
+	
+	homfly_cache_data(): hits(0), misses(0) {}
+};
+
+homfly_cache_data homfly_cache;
+
 /********************* Function prototypes ***********************/
 void help_info();
 void tostring (char*& cptr, int n);
@@ -81,13 +107,16 @@ void normalize(Hpolynomial& poly);
 hpolynomial homfly(vector<int> braid_num, vector<int> type, vector<int> component_record, 
                                                                  int basepoint, int level, bool virtual_braid);
 hpolynomial virtual_homfly(vector<int> braid_num, vector<int> type, vector<int> master_component_record, int level);
+string homfly_cache_key(vector<int>& braid_num, vector<int>& type, vector<int>& component_record, int basepoint, bool virtual_braid);
+void clear_homfly_cache();
 void set_component_record (int action, vector<int>& braid_num, vector<int>& type, vector<int>& component_record,
                            int base_crossing=0, int basepoint=0, int datum=0);
 void write_braid (ostream& s, vector<int>& braid_num, vector<int>& type);
 void Kamada_double_covering(string& braid, int num_terms, int num_strings);
 void generic_code(string input_string, string title);
 //int remove_Reidemeister_II(generic_code_data& code_data, vector<int>& component_flags);
-list<vector<int> > hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit, int include_edge);
+long hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit, int include_edge,
+                         function<void(const vector<int>&)> record_circuit);
 
 vector<int> smallest_parent_birack(matrix<int>& Su, matrix<int>& Sd, vector<int> labels);
 
@@ -100,9 +129,9 @@ void print_k_chain(ostream& os, const vector<int> k_chain, generic_switch_data&
 colouring_data num_fixed_points(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td, 
                      string input_string, int num_terms, int num_strings, generic_switch_data& switch_data, vector<int>* image_size_count=0);
 
-void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0);
-void determine_cohomology_generators(generic_switch_data& switch_data);
-void test_cohomology_generators(generic_switch_data& switch_data);
+void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0, ostream& os=cout, ostream& output_os=output);
+void determine_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os);
+void test_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os);
 
 
 void braid(string input_string, string title)
@@ -377,41 +406,32 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			}
 			else
 			{
-				list<vector<int> > circuit_list = hamiltonian_circuit(code_data, braid_control::HC_LIST_ALL, braid_control::HC_COUNT, braid_control::HC_EDGES, braid_control::HC_INCLUDE_EDGE);
-				
-				if (circuit_list.size() != 0)
+				long num_circuits = hamiltonian_circuit(code_data, braid_control::HC_LIST_ALL, braid_control::HC_COUNT, braid_control::HC_EDGES, braid_control::HC_INCLUDE_EDGE,
+				                                        [&](const vector<int>& circuit)
 				{
-					list<vector<int> >::iterator cptr = circuit_list.begin();
-					while (cptr != circuit_list.end())
+					if (!braid_control::SILENT_OPERATION)
 					{
-						vector<int>& circuit = *cptr;
-						
-							if (!braid_control::HC_COUNT)
-							{
-								if (!braid_control::SILENT_OPERATION)
-								{
-									cout << "Hamiltonian circuit ";
-									for (int i=0; i< code_data.num_crossings; i++)
-										cout << circuit[i] << ' ';
-									cout << endl;
-								}
-								
-								if (!braid_control::RAW_OUTPUT)
-								{
-									output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-									output << "Hamiltonian circuit ";
-								}
-								if (braid_control::OUTPUT_AS_INPUT)
-									output << "\n";
-				
-								for (int i=0; i< code_data.num_crossings; i++)
-									output << circuit[i] << ' ';
-								output << endl;
-				
-								if (!braid_control::SILENT_OPERATION)
-									cout << "\n";
-									
-				
+						cout << "Hamiltonian circuit ";
+						for (int i=0; i< code_data.num_crossings; i++)
+							cout << circuit[i] << ' ';
+						cout << endl;
+					}
+					
+					if (!braid_control::RAW_OUTPUT)
+					{
+						output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+						output << "Hamiltonian circuit ";
+					}
+					if (braid_control::OUTPUT_AS_INPUT)
+						output << "\n";
+					
+					for (int i=0; i< code_data.num_crossings; i++)
+						output << circuit[i] << ' ';
+					output << endl;
+					
+					if (!braid_control::SILENT_OPERATION)
+						cout << "\n";
+					
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
 		debug << "braid: hamiltonian_circuit: " << endl;
@@ -419,12 +439,9 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			debug << circuit[i] << ' ';
 		debug << endl;
 }
-							}
-							
-						cptr++;
-					}
-				}
-				else
+				});
+				
+				if (num_circuits == 0)
 				{
 					if (!braid_control::SILENT_OPERATION)
 						cout << "No Hamiltonian circuit found" << endl;
@@ -442,16 +459,16 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				if (braid_control::HC_COUNT)
 				{
 					if (!braid_control::SILENT_OPERATION)
-						cout << "Found " << circuit_list.size() << " Hamiltonian circuits" << endl;
+						cout << "Found " << num_circuits << " Hamiltonian circuits" << endl;
 					
 					if (!braid_control::RAW_OUTPUT)
 					{
 						output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-						output << "Found " << circuit_list.size() << " Hamiltonian circuits" << endl;
+						output << "Found " << num_circuits << " Hamiltonian circuits" << endl;
 					}
 			
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-		debug << "braid: hamiltonian_circuit: found " << circuit_list.size() << " Hamiltonian circuits" << endl;
+		debug << "braid: hamiltonian_circuit: found " << num_circuits << " Hamiltonian circuits" << endl;
 				}			
 			}
 
@@ -496,6 +513,7 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	debug << "braid: classical braid, using master component_record for call to homfly function" << endl;
 
+					clear_homfly_cache();
 					hpoly = homfly(braid_num,type,master_component_record,1,0,false); //basepoint on strand 1, level=0, virtual=false
 
 					if (!braid_control::SILENT_OPERATION)
@@ -510,8 +528,27 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 					}
 					output << hpoly << endl;
 
+					if (braid_control::EXTRA_OUTPUT)
+					{
+						if (!braid_control::SILENT_OPERATION)
+						{
+							cout << "HOMFLY cache: " << homfly_cache.hits << " hits, " << homfly_cache.misses << " misses, " 
+							     << homfly_cache.table.size() << " polynomials cached" << endl;
+						}
+						
+						if (!braid_control::RAW_OUTPUT)
+						{
+							output << (braid_control::OUTPUT_AS_INPUT? ";" : "");
+							output << "HOMFLY cache: " << homfly_cache.hits << " hits, " << homfly_cache.misses << " misses, " 
+							       << homfly_cache.table.size() << " polynomials cached" << endl;
+						}
+					}
+
 if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
 	debug << "braid: HOMFLY polynomial = " << hpoly << endl;
+	debug << "braid: HOMFLY cache hits = " << homfly_cache.hits << ", misses = " << homfly_cache.misses << ", size = " << homfly_cache.table.size() << endl;
+}
 
 				}
 				else
@@ -2250,6 +2287,34 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 	return result;
 }
 
+/* homfly_cache_key writes the braid terms, as signed braid numbers with virtual crossings offset by the number of strands in the 
+   component record, followed by the component record, basepoint and virtual flag.
+*/
+string homfly_cache_key(vector<int>& braid_num, vector<int>& type, vector<int>& component_record, int basepoint, bool virtual_braid)
+{
+	ostringstream oss;
+	for (size_t i=0; i< braid_num.size(); i++)
+	{
+		if (type[i] == generic_braid_data::crossing_type::NEGATIVE)
+			oss << '-';
+		else if (type[i] == generic_braid_data::crossing_type::VIRTUAL)
+			oss << 't';
+		oss << braid_num[i] << ' ';
+	}
+	oss << '/';
+	for (size_t i=0; i< component_record.size(); i++)
+		oss << component_record[i] << ' ';
+	oss << '/' << basepoint << (virtual_braid? 'v': 'c');
+	return oss.str();
+}
+
+void clear_homfly_cache()
+{
+	homfly_cache.table.clear();
+	homfly_cache.hits = 0;
+	homfly_cache.misses = 0;
+}
+
 /* The homfly function uses the skein relation
 		
 		a^-1 P(L+) - a P(L-) = z P(L0)
@@ -2277,7 +2342,8 @@ if (debug_control::DEBUG >= debug_control::BASIC)
    Note also that the homfly function will not be passed a braid with only one term by a recursive call, due to the 
    braid_reduce function, which will identify it as the unknot.  Therefore when the homfly function passes a smoothed
    braid to the braid_reduce function it still contains at least one crossing.
-
+   
+   Results are recorded in, and retrieved from, the homfly_cache.
 */
 hpolynomial homfly(vector<int> braid_num, vector<int> type, vector<int> component_record, 
                                                                        int basepoint, int level, bool virtual_braid)
@@ -2334,6 +2400,26 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "initial basepoint on strand " << basepoint << endl;
 }
 
+	string cache_key = homfly_cache_key(braid_num,type,component_record,basepoint,virtual_braid);
+	{
+		lock_guard<mutex> lock(homfly_cache.cache_mutex);
+		map<string,hpolynomial>::iterator cptr = homfly_cache.table.find(cache_key);
+		if (cptr != homfly_cache.table.end())
+		{
+			homfly_cache.hits++;
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
+	debug << "homfly:(" << level << ") ";
+	for (int i=0; i< level; i++)
+		debug << "  ";
+	debug << "HOMFLY polynomial found in cache: " << cptr->second << endl;
+}
+			return cptr->second;
+		}
+		homfly_cache.misses++;
+	}
+
 	/* determine the number of strings in the braid */
 	int num_strings = 0;
 	if (num_terms)
@@ -2890,6 +2976,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << "  ";
 	debug << "level " << level << " returning " << result << endl;
 }
+		{
+			lock_guard<mutex> lock(homfly_cache.cache_mutex);
+			if (static_cast<int>(homfly_cache.table.size()) < braid_control::homfly_cache_limit)
+				homfly_cache.table[cache_key] = result;
+		}
+			
 		return result;				
 	}
 }
@@ -2900,6 +2992,10 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    For virtual braids we consider all orderings of the braid components, starting from the order
    presented at the call in the master_component_record.  To consider all orderings we maintain a 
    permutation component_perm that records a permutation of this natural order.
+   
+   The HOMFLY polynomials of the permutations are independent, so when braid_control::num_threads > 1 they are evaluated 
+   by ordered_parallel_fold, sharing the homfly_cache, and multiplied into vhpoly in the order of the permutations.  Worker 
+   threads have a single thread, so the recursive calls to virtual_homfly made by the workers are evaluated serially.
 */
 hpolynomial virtual_homfly(vector<int> braid_num, vector<int> type, vector<int> master_component_record, int level)
 {
@@ -2908,13 +3004,14 @@ hpolynomial virtual_homfly(vector<int> braid_num, vector<int> type, vector<int>
 	for (int i=0; i< num_cpts; i++)
 		component_perm[i] = i;
 
-	hpolynomial vhpoly = hpolynomial("1");
+	/* set the component_record for each component_perm by permuting the master_component_record */
+	vector<vector<int> > component_record;
 	do
 	{
-		/* set the component_record to match the component_perm by permuting the master_component_record*/
-		vector<int> component_record(num_cpts);
+		vector<int> record(num_cpts);
 		for (int i=0; i< num_cpts; i++)
-			component_record[i] = master_component_record[component_perm[i]];
+			record[i] = master_component_record[component_perm[i]];
+		component_record.push_back(record);
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
@@ -2929,13 +3026,30 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << "  ";
 	debug << "component_record = ";
 	for (int i=0; i< num_cpts; i++)
-		debug << component_record[i] << " ";
+		debug << record[i] << " ";
 	debug << endl;	
 }  
-		/* when we call homfly, look for a bad_crossing starting from the lowest strand of the first component */
-		vhpoly *= homfly(braid_num,type,component_record,component_record[0],level,true); //virtual=true
 	} while (next_permutation(component_perm.begin(), component_perm.end()));
+
+	int num_workers = 1;
+	if (braid_control::num_threads > 1 && debug_control::DEBUG == debug_control::OFF && !braid_control::WAIT_SWITCH)
+		num_workers = braid_control::num_threads;
+
+	/* when we call homfly, look for a bad_crossing starting from the lowest strand of the first component */
+	auto evaluate = [&](int i, hpolynomial& result)
+	{
+		result = homfly(braid_num,type,component_record[i],component_record[i][0],level,true); //virtual=true
+	};
 	
+	hpolynomial vhpoly = hpolynomial("1");
+	auto fold = [&](int i, hpolynomial& result) -> bool
+	{
+		vhpoly *= result;
+		return false;
+	};
+	
+	ordered_parallel_fold(component_record.size(), num_workers, hpolynomial("1"), evaluate, fold);
+
 	return vhpoly;
 }
 
@@ -3523,6 +3637,32 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	
 	matrix_control::SINGLE_LINE_OUTPUT = loc_newline;
 }
+
+	/* With the threads option the colourings of the braid may have been evaluated in advance by batch_colouring_invariant, 
+	   or are to be recorded for evaluation in advance, see batch_colouring_data.
+	*/
+	if (switch_data.batch_recording || switch_data.batch_colourings.size())
+	{
+		bool refine = (image_size_count != 0);
+		auto evaluate = [=,&switch_data]() mutable
+		{
+			vector<int> count(Su.numcols());
+			colouring_data result = num_fixed_points(Su,Sd,invSu,invSd,Tu,Td,input_string,num_terms,num_strings,switch_data,(refine? &count: 0));
+			result.image_size_count = count;
+			return result;
+		};
+		
+		colouring_data result;
+		if (batch_colouring_data(switch_data,input_string,Su.numcols(),evaluate,result))
+		{
+			if (refine)
+			{
+				for (size_t i=0; i< result.image_size_count.size(); i++)
+					(*image_size_count)[i] += result.image_size_count[i];
+			}
+			return result;
+		}
+	}
 	
 	int n = Su.numcols();	
 	char* str = c_string(input_string);
@@ -3594,9 +3734,17 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 //	vector<polynomial<int> > cocycle_invariant(num_cocycles);
 	vector<Cpolynomial> cocycle_invariant(num_cocycles);
 
+	/* when the colourings are evaluated in advance by batch_colouring_invariant the k-chains are returned in the colouring_data */
+	ostringstream batch_output;
+	ostream& k_chain_output = (switch_data.batch_evaluating? static_cast<ostream&>(batch_output): static_cast<ostream&>(output));
+
 	/* The fixed point invariant calculates the number of fixed points Mv=v where v ranges through all
 	   vectors of length num_strings over X_n and M is the cumulative effect on v of the S_i and T_i
 	   determined by the braid word given as an input string.
+	   
+	   With the exhaustive colouring engine we apply M to every v in turn.  Otherwise, a colouring_search 
+	   provides the fixed points of M in the same order and we apply M to each of these, so that the 
+	   labels and k-chain of each fixed point are determined exactly as they are by the exhaustive engine.
 	*/
 	vector<int>v(num_strings);
 	for (int i=0;i<num_strings; i++)
@@ -3604,12 +3752,80 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 	int fixed_points = 0;
 
+	bool exhaustive = (braid_control::COLOURING_ENGINE == braid_control::colouring_engine::EXHAUSTIVE);
+	colouring_search* search = 0;
+	
+	if (!exhaustive)
+	{
+		/* The variables of the search are the labels of the strands between the terms of the braid.  The labels 
+		   of v are variables 0 to num_strings-1 and each term introduces two new variables for the strands it 
+		   changes.  Since the closure identifies the labels leaving the braid with v, the last variable introduced 
+		   on each strand is replaced by the corresponding label of v.
+		   
+		   Each term is a crossing whose ingress labels are (Mv[bn-1],Mv[bn]) and whose egress labels are given 
+		   by S, invS or T as described below.
+		*/
+		vector<int> relation_egress[3];  // positive, negative and virtual
+		for (int r=0; r<3; r++)
+			relation_egress[r] = vector<int>(n*n);
+			
+		for (int a=0; a< n; a++)
+		for (int b=0; b< n; b++)
+		{
+			int pair[3][2] = {{Sd[a][b],Su[b][a]},{invSu[a][b],invSd[b][a]},{Td[a][b],Tu[b][a]}};
+			for (int r=0; r<3; r++)
+				relation_egress[r][a*n+b] = (pair[r][0] == -1 || pair[r][1] == -1? -1: pair[r][0]*n+pair[r][1]);
+		}
+	
+		int num_variables = num_strings + 2*num_terms;
+		search = new colouring_search(n,num_variables);
+		int relation[3];
+		for (int r=0; r<3; r++)
+			relation[r] = search->add_relation(relation_egress[r]);
+
+		vector<int> strand_variable(num_strings);
+		for (int i=0; i< num_strings; i++)
+			strand_variable[i] = i;
+		
+		vector<int> closure(num_variables);
+		for (int i=0; i< num_variables; i++)
+			closure[i] = i;
+			
+		for (int i=0; i< num_terms; i++)
+		{
+			int bn = abs(braid_num[i]);
+			strand_variable[bn-1] = num_strings+2*i;
+			strand_variable[bn] = num_strings+2*i+1;
+		}
+		
+		for (int i=0; i< num_strings; i++)
+			closure[strand_variable[i]] = i;
+		
+		for (int i=0; i< num_strings; i++)
+			strand_variable[i] = i;
+
+		for (int i=0; i< num_terms; i++)
+		{
+			int bn = abs(braid_num[i]);
+			int r = (virtual_crossing[i]? 2: braid_num[i] > 0? 0: 1);
+			search->add_crossing(relation[r],strand_variable[bn-1],strand_variable[bn],closure[num_strings+2*i],closure[num_strings+2*i+1]);
+			strand_variable[bn-1] = closure[num_strings+2*i];
+			strand_variable[bn] = closure[num_strings+2*i+1];
+		}
+		
+		vector<int> branch_order(num_strings);
+		for (int i=0; i< num_strings; i++)
+			branch_order[i] = i;
+		search->set_branch_order(branch_order);
+	}
+
 if (debug_control::DEBUG >= debug_control::DETAIL)
 	debug << "num_fixed_points: calculating fixed points" << endl;
 
 //output << "\n\n";
 
-	bool not_finished = true;
+	vector<int> colouring;
+	bool not_finished = (exhaustive || search->next(colouring));
 	int wait_count=0;  // can use a local variable, don't need braid_control::wait_count
 	int wait_reset_count=0;
 
@@ -3617,8 +3833,14 @@ if (debug_control::DEBUG >= debug_control::SUMMARY && braid_control::WAIT_SWITCH
 	debug << "braid_control::wait_threshold = " << braid_control::wait_threshold<< endl;
 
 	
-	do
+	while (not_finished)
 	{
+		if (!exhaustive)
+		{
+			for (int i=0; i< num_strings; i++)
+				v[i] = colouring[i];
+		}
+		
 
     	if (braid_control::WAIT_SWITCH)
     	{
@@ -3952,11 +4174,11 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 if(!braid_control::RAW_OUTPUT)
 {
-	output << "k-chain ";
+	k_chain_output << "k-chain ";
 	for (int i=0; i< num_chain_generators; i++)
-		output << k_chain[i] << ' ';
-	print_k_chain(output, k_chain, switch_data,(braid_control::DOUBLE_BIRACKS?3:2));
-	output << endl;
+		k_chain_output << k_chain[i] << ' ';
+	print_k_chain(k_chain_output, k_chain, switch_data,(braid_control::DOUBLE_BIRACKS?3:2));
+	k_chain_output << endl;
 }
 
 				int number_of_k_tuples = 0;
@@ -4027,24 +4249,31 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 //output << endl;
 		}
 			
-		/* increment v as a num-stings digit number base n */
-		int digit;
-		for (digit = num_strings-1; digit >=0; digit--)
+		if (exhaustive)
 		{
-			if (++v[digit] == n)
-				v[digit] = 0;
-			else
-				break;
+			/* increment v as a num-stings digit number base n */
+			int digit;
+			for (digit = num_strings-1; digit >=0; digit--)
+			{
+				if (++v[digit] == n)
+					v[digit] = 0;
+				else
+					break;
+			}
+			if (digit == -1)
+				not_finished = false;
 		}
-		if (digit == -1)
-			not_finished = false;
-
-	} while (not_finished);		
+		else
+		{
+			not_finished = search->next(colouring);
+		}
+	}		
 	
 	if (braid_control::WAIT_SWITCH)
 		cout << endl;
 		
 	delete [] str;		
+	delete search;
 		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "num_fixed_points: number of fixed points = " << fixed_points << endl;
@@ -4081,6 +4310,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	return_data.num_fixed_points = fixed_points;
 	return_data.num_cocycle_invariants = num_cocycles;
 	return_data.cocycle_invariant = cocycle_invariant;
+	return_data.batch_output = batch_output.str();
 	
 	return return_data;
 }
@@ -4142,13 +4372,14 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    to describe the number of colourings as a polynomial \Sum x_i s^i whose coefficient x_i are the number of colourings of size i.
 */
 void braid_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
-			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period)
+			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period, ostream& os, ostream& output_os)
 {
 	int num_strings;
 	int num_terms;
 	int turning_number=0;
 	
-	if (valid_braid_input(input_string, num_terms, num_strings, braid_control::SILENT_OPERATION, braid_control::RAW_OUTPUT, braid_control::OUTPUT_AS_INPUT))	
+	/* input errors are reported when the colourings are evaluated, not when they are recorded by batch_colouring_invariant */
+	if (valid_braid_input(input_string, num_terms, num_strings, braid_control::SILENT_OPERATION, braid_control::RAW_OUTPUT || switch_data.batch_recording, braid_control::OUTPUT_AS_INPUT))	
 	{
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
@@ -4170,19 +4401,19 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
        	{
 			if (!braid_control::SILENT_OPERATION)
 			{
-				cout << "\n\n" << title << endl;
-				cout << input_string << endl;
+				os << "\n\n" << title << endl;
+				os << input_string << endl;
 			}
     		if (!braid_control::RAW_OUTPUT)
-    			output << "\n\n" << title;
+    			output_os << "\n\n" << title;
        	}    
 		else if (!braid_control::SILENT_OPERATION)
-			cout << "\n\n" << input_string << endl;
+			os << "\n\n" << input_string << endl;
 			
 		if (!braid_control::RAW_OUTPUT)
 		{
-			output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << input_string << endl;		
+			output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << input_string << endl;		
     	}
    
 		/* If the braid qualifier "welded" is present, it is to be considered as a welded braid, 
@@ -4265,12 +4496,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    	debug << "braid_colouring_invariant: terminating since S and T are not an essential welded pair, as required for welded braids" << endl;
     
 			if (!braid_control::SILENT_OPERATION)
-				cout << "\nWelded braid requires essential weldeed pair, skipping" << endl;
+				os << "\nWelded braid requires essential weldeed pair, skipping" << endl;
     
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << "Welded braid requires essential welded pair, skipping" << endl;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "Welded braid requires essential welded pair, skipping" << endl;
 			}
     
 			return;
@@ -4281,12 +4512,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    	debug << "braid_colouring_invariant: terminating since S and T are not an essential doodle pair, as required for doodle braids" << endl;
     
 			if (!braid_control::SILENT_OPERATION)
-				cout << "\nDoodle braid requires essential doodle pair, skipping" << endl;
+				os << "\nDoodle braid requires essential doodle pair, skipping" << endl;
     
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << "Doodle braid requires essential doodle pair, skipping" << endl;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "Doodle braid requires essential doodle pair, skipping" << endl;
 			}
     
 			return;
@@ -4297,12 +4528,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    	debug << "braid_colouring_invariant: terminating since S and T are not a flat essential virtual pair, as required for flat braids" << endl;
     
 			if (!braid_control::SILENT_OPERATION)
-				cout << "\nFlat braid requires flat essential virtual pair, skipping" << endl;
+				os << "\nFlat braid requires flat essential virtual pair, skipping" << endl;
     
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << "Flat braid requires flat essential virtual pair, skipping" << endl;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "Flat braid requires flat essential virtual pair, skipping" << endl;
 			}
     
 			return;
@@ -4314,12 +4545,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    	debug << "braid_colouring_invariant: terminating since S and T are not an essential virtual pair, as required by the input braid" << endl;
     
 			if (!braid_control::SILENT_OPERATION)
-				cout << "\ninput braid requires an essential virtual pair, skipping" << endl;
+				os << "\ninput braid requires an essential virtual pair, skipping" << endl;
     
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << "input braid requires an essential virtual pair, skipping" << endl;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "input braid requires an essential virtual pair, skipping" << endl;
 			}
     
 			return;
@@ -4407,32 +4638,32 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				{
 					if (!braid_control::SILENT_OPERATION)
 					{
-						cout << "\nadding " << oss.str();
+						os << "\nadding " << oss.str();
 						if (count == 2)
-							cout << " and doubling";
+							os << " and doubling";
 						else if (count == 3)
-							cout << " and trebling";
+							os << " and trebling";
 					
 					
-						cout << " produces a knot that is distinguished from the unknot" << endl;
+						os << " produces a knot that is distinguished from the unknot" << endl;
 //						cout <<"\nNumber of fixed-points = " << fixed_points << endl;
 					}
 					
 					if (!braid_control::RAW_OUTPUT)
 					{
-						output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-						output << "adding " << oss.str();
+						output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+						output_os << "adding " << oss.str();
 						if (count == 2)
-							output << " and doubling";
+							output_os << " and doubling";
 						else if (count == 3)
-							output << " and trebling";
+							output_os << " and trebling";
 							
-						output << " produces a knot that is distinguished from the unknot";
+						output_os << " produces a knot that is distinguished from the unknot";
 		//				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 		//				output << "Number of fixed points = ";
 					}
 		//			output << fixed_points << endl;
-					output << endl;
+					output_os << endl;
 		    
 if (debug_control::DEBUG >= debug_control::SUMMARY)
     debug << "braid_colouring_invariant:   distinguishable from unknot" << endl;
@@ -4483,8 +4714,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;flipped to " : "\nflipped to ");
-				   	output << input_string << endl;		
+					output_os << (braid_control::OUTPUT_AS_INPUT? "\n;flipped to " : "\nflipped to ");
+				   	output_os << input_string << endl;		
 				}    
     
 			}
@@ -4498,8 +4729,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
     
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;inverted to " : "\ninverted to ");
-				   	output << input_string << endl;		
+					output_os << (braid_control::OUTPUT_AS_INPUT? "\n;inverted to " : "\ninverted to ");
+				   	output_os << input_string << endl;		
 				}    
 			}
 			
@@ -4512,8 +4743,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;line reflected to " : "\nline reflected to ");
-				   	output << input_string << endl;		
+					output_os << (braid_control::OUTPUT_AS_INPUT? "\n;line reflected to " : "\nline reflected to ");
+				   	output_os << input_string << endl;		
 				}    
     
 			}
@@ -4528,8 +4759,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;plane reflected to " : "\nplane reflected to ");
-				   	output << input_string << endl;		
+					output_os << (braid_control::OUTPUT_AS_INPUT? "\n;plane reflected to " : "\nplane reflected to ");
+				   	output_os << input_string << endl;		
 				}    
 			}
 
@@ -4542,8 +4773,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	
 						if (!braid_control::RAW_OUTPUT)
 						{
-							output << (braid_control::OUTPUT_AS_INPUT? "\n; reversed orientation to " : "\n reversed orientation to ");
-						   	output << input_string << endl;		
+							output_os << (braid_control::OUTPUT_AS_INPUT? "\n; reversed orientation to " : "\n reversed orientation to ");
+						   	output_os << input_string << endl;		
 						}
 	
 			}
@@ -4565,16 +4796,16 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				if (switch_data.cocycles_calculated == false)
 				{
 					if (!braid_control::SILENT_OPERATION)
-						cout << "switch_data does not contain cocycles" << endl;
+						os << "switch_data does not contain cocycles" << endl;
 						
-					birack_homology_generators(switch_data,(braid_control::DOUBLE_BIRACKS?3:2),true); //cohomology = true
+					birack_homology_generators(switch_data,(braid_control::DOUBLE_BIRACKS?3:2),true,0,os,output_os); //cohomology = true
 					switch_data.cocycles_calculated = true;
 					check_cocycle_conditions = true;
 				}
 				else
 				{
 					if (!braid_control::SILENT_OPERATION)
-						cout << "switch_data contains cocycles" << endl;
+						os << "switch_data contains cocycles" << endl;
 				}
 						
 				/* birack_homology_generators has calculated all the cohomology generators, recording them in switch_data.cocycle_string,
@@ -4585,10 +4816,10 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				{
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "braid_colouring_invariant: no integer cocycles found in switch data" << endl;
-					determine_cohomology_generators(switch_data);	
+					determine_cohomology_generators(switch_data,os,output_os);	
 					
 					if (check_cocycle_conditions)
-						test_cohomology_generators(switch_data);
+						test_cohomology_generators(switch_data,os,output_os);
 				}
 					
 if (debug_control::DEBUG >= debug_control::SUMMARY)
@@ -4734,7 +4965,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				for (int i=0; i< num_invariant_terms; i++)
 				{
 					if (braid_control::BIRACK_POLYNOMIAL && !braid_control::SILENT_OPERATION && braid_control::EXTRA_OUTPUT)
-						cout << "term " << i << ", ";
+						os << "term " << i << ", ";
 					
 					if (braid_control::COCYCLE_INVARIANT)
 					{
@@ -4767,9 +4998,9 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 					}
 	
 					if (!braid_control::SILENT_OPERATION && braid_control::EXTRA_OUTPUT)					
-						cout << num_vectors << " vectors to consider" << endl;
+						os << num_vectors << " vectors to consider" << endl;
 					else if (braid_control::WAIT_SWITCH)					
-						cout << num_vectors << ": ";
+						os << num_vectors << ": ";
 					
 					vector<int> image_size_count(n);
 					colouring_data c_data = num_fixed_points(Su,Sd,invSu,invSd,Tu,Td,input_string,num_terms,num_strings,switch_data,(braid_control::REFINE_RACK_POLYNOMIAL?&image_size_count:0));
@@ -4875,9 +5106,9 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 							bool first_term = true;
 							
 							if(braid_control::COCYCLE_INVARIANT)
-								cout << "Cocycle " << i+1 << " birack polynomial = ";
+								os << "Cocycle " << i+1 << " birack polynomial = ";
 							else
-								cout << "Birack polynomial = ";
+								os << "Birack polynomial = ";
 								
 							for (int j=num_invariant_terms-1; j >=0; j--)
 							{
@@ -4894,33 +5125,33 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 									if (!first_term)
 									{
 										if  (parentheses || !coefficient_poly[i][j].is_negative())
-											cout << '+';
+											os << '+';
 										else if (coefficient_poly[i][j].is_minus_one())
-											cout << '-';
+											os << '-';
 									}
 									
-									if (parentheses) 						cout << "(";
-									if (!coefficient_poly[i][j].is_one()|| exponent == 0)	cout << coefficient_poly[i][j];
-									if (parentheses)						cout << ")";
+									if (parentheses) 						os << "(";
+									if (!coefficient_poly[i][j].is_one()|| exponent == 0)	os << coefficient_poly[i][j];
+									if (parentheses)						os << ")";
 									
 									if (exponent != 0)
 									{
-										cout << 't';
+										os << 't';
 										if (exponent !=1)
 										{
-											cout << '^';
-											cout << exponent;
+											os << '^';
+											os << exponent;
 										}
 									}							
 									first_term = false;
 								}
 							}
-							cout << endl;
+							os << endl;
 						}
 					}
 					else
 					{
-						cout << "Birack polynomial = " << birack_poly << endl;
+						os << "Birack polynomial = " << birack_poly << endl;
 					}
 				}
 		
@@ -4931,11 +5162,11 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 					{
 						if (!braid_control::RAW_OUTPUT)
 						{
-							output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+							output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 							if(braid_control::COCYCLE_INVARIANT)
-								output << "Cocycle " << i+1 << " birack polynomial = ";
+								output_os << "Cocycle " << i+1 << " birack polynomial = ";
 							else
-								output << "Birack polynomial = ";
+								output_os << "Birack polynomial = ";
 						}
 		
 						bool first_term=true;
@@ -4957,14 +5188,14 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 								if (!first_term)
 								{
 									if  (parentheses || !coefficient_poly[i][j].is_negative())
-										output << '+';
+										output_os << '+';
 									else if (coefficient_poly[i][j].is_minus_one())
-										output << '-';
+										output_os << '-';
 								}
 								
-								if (parentheses) 						output << "(";
-								if (!coefficient_poly[i][j].is_one()|| exponent == 0)	output << coefficient_poly[i][j];
-								if (parentheses)						output << ")";	
+								if (parentheses) 						output_os << "(";
+								if (!coefficient_poly[i][j].is_one()|| exponent == 0)	output_os << coefficient_poly[i][j];
+								if (parentheses)						output_os << ")";	
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
@@ -4976,47 +5207,47 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 								
 								if (exponent != 0)
 								{
-									output << 't';
+									output_os << 't';
 									if (exponent != 1)
 									{
-										output << '^';
-										output << exponent;
+										output_os << '^';
+										output_os << exponent;
 									}
 								}							
 								first_term = false;
 							}
 						}
-						output << endl;
+						output_os << endl;
 					}
 				}
 				else
 				{
 					if (!braid_control::RAW_OUTPUT)
 					{
-						output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-						output << "Birack polynomial = ";
+						output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+						output_os << "Birack polynomial = ";
 					}
 					
-					output << birack_poly << endl;
+					output_os << birack_poly << endl;
 				}
 				
 		    	if (braid_control::EXTRA_OUTPUT)
 		    	{
 					if (!braid_control::REFINE_RACK_POLYNOMIAL && !braid_control::COCYCLE_INVARIANT)
 					{
-						cout << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";
+						os << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";
 		
 						for (int i=0; i < period; i++)
-							cout << rack_poly_coefficients[i] << ' ';
-						cout << endl;
+							os << rack_poly_coefficients[i] << ' ';
+						os << endl;
 		
 				    	if (!braid_control::RAW_OUTPUT)
 						{
-							output << "Birack polynomial " << birack_poly << endl;
-							output << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";					
+							output_os << "Birack polynomial " << birack_poly << endl;
+							output_os << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";					
 							for (int i=0; i < period; i++)
-								output << rack_poly_coefficients[i] << ' ';
-							output << endl;			
+								output_os << rack_poly_coefficients[i] << ' ';
+							output_os << endl;			
 						}
 					}
 				}	
@@ -5052,17 +5283,17 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 					
 					if (!braid_control::SILENT_OPERATION)
 					{
-						cout << "\ncocycle " << *lptr << endl;
-						cout << "invariant " << c_data.cocycle_invariant[index] << endl;
+						os << "\ncocycle " << *lptr << endl;
+						os << "invariant " << c_data.cocycle_invariant[index] << endl;
 					}
 			    
 					if (!braid_control::RAW_OUTPUT)
 			    	{
-			    		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-						output << "\ncocycle " << *lptr << endl;
-						output << "invariant ";
+			    		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+						output_os << "\ncocycle " << *lptr << endl;
+						output_os << "invariant ";
 			    	}
-			    	output << c_data.cocycle_invariant[index] << endl;
+			    	output_os << c_data.cocycle_invariant[index] << endl;
 			    	
 					lptr++;
 					index++;
@@ -5075,14 +5306,14 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				int fixed_points = c_data.num_fixed_points;
 		    	
 				if (!braid_control::SILENT_OPERATION)
-					cout <<"\nNumber of fixed-points = " << fixed_points << endl;
+					os <<"\nNumber of fixed-points = " << fixed_points << endl;
 		    
 				if (!braid_control::RAW_OUTPUT)
 		    	{
-		    		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-		    		output << "Number of fixed points = ";
+		    		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+		    		output_os << "Number of fixed points = ";
 		    	}
-		    	output << fixed_points << endl;
+		    	output_os << fixed_points << endl;
 			    
 if (debug_control::DEBUG >= debug_control::SUMMARY)
     debug << "braid_colouring_invariant: total number of fixed points = " << fixed_points << endl;
@@ -5093,7 +5324,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				
 				flip_braid(input_string);
 		    	fixed_points = num_fixed_points(Su,Sd,invSu,invSd,Tu,Td,input_string,num_terms,num_strings);
-				output << fixed_points << endl;
+				output_os << fixed_points << endl;
 				 end of test code 26-10-13 */
 			}
 		}
@@ -21,9 +21,10 @@ void commutative_automorphism_invariant(const Qpmatrix& phi, const Qpmatrix& psi
 matrix<int> permutation_cycles (generic_code_data& code_data)
 void print_k_chain(ostream& os, const vector<scalar> k_chain, generic_switch_data& switch_data, int k)
 void print_k_chain(ostream& os, const vector<int> k_chain, generic_switch_data& switch_data, int k)
+bool batch_colouring_data(generic_switch_data& switch_data, string key, int n, function<colouring_data()> evaluate, colouring_data& result)
 void colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, 
-						   matrix<int>& Tu, matrix<int>& Td, braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data)
-void determine_cohomology_generators(generic_switch_data& switch_data)
+						   matrix<int>& Tu, matrix<int>& Td, braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, ostream& os, ostream& output_os)
+void determine_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os)
 vector<int> smallest_parent_birack(matrix<int>& Su, matrix<int>& Sd, vector<int> labels)
 **************************************************************************/
 #include <string>
@@ -64,10 +65,10 @@ bool distinguish_modified_string (matrix<int>& Su, matrix<int>& Sd, matrix<int>&
 
 
 void braid_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
-			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period);
+			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period, ostream& os, ostream& output_os);
 
 void peer_code_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
-			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period);
+			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period, ostream& os, ostream& output_os);
 			
 
 
@@ -83,6 +84,7 @@ void print_prog_params (ostream& os, string level, string prefix)
 	os << prefix << "braid_control::COMMUTATIVE_AUTOMORPHISM = " << braid_control::COMMUTATIVE_AUTOMORPHISM << endl;
 	os << prefix << "braid_control::COCYCLE_INVARIANT = " << braid_control::COCYCLE_INVARIANT << endl;
 	os << prefix << "braid_control::COHOMOLOGY = " << braid_control::COHOMOLOGY << endl;
+	os << prefix << "braid_control::COLOURING_ENGINE = " << braid_control::COLOURING_ENGINE << endl;
 	os << prefix << "braid_control::DOODLE_ALEXANDER = " << braid_control::DOODLE_ALEXANDER << endl;
 	os << prefix << "braid_control::DOWKER_CODE = " << braid_control::DOWKER_CODE << endl;
 	os << prefix << "braid_control::DYNNIKOV_TEST = " << braid_control::DYNNIKOV_TEST << endl;
@@ -90,6 +92,7 @@ void print_prog_params (ostream& os, string level, string prefix)
 	os << prefix << "braid_control::GAUSS_CODE = " << braid_control::GAUSS_CODE << endl;
 	os << prefix << "braid_control::HAMILTONIAN = " << braid_control::HAMILTONIAN << endl;
 	os << prefix << "braid_control::HOMFLY = " << braid_control::HOMFLY << endl;
+	os << prefix << "braid_control::HOMOLOGY_ENGINE = " << braid_control::HOMOLOGY_ENGINE << endl;
 	os << prefix << "braid_control::HOMOLOGY = " << braid_control::HOMOLOGY << endl;
 	os << prefix << "braid_control::IMMERSION_CODE = " << braid_control::IMMERSION_CODE << endl;
 	os << prefix << "braid_control::JONES_POLYNOMIAL = " << braid_control::JONES_POLYNOMIAL << endl;
@@ -97,6 +100,7 @@ void print_prog_params (ostream& os, string level, string prefix)
 	os << prefix << "braid_control::KNOTOID_BRACKET = " << braid_control::KNOTOID_BRACKET << endl;
 	os << prefix << "braid_control::MATRIX = " << braid_control::MATRIX << endl;
 	os << prefix << "braid_control::MOCK_ALEXANDER = " << braid_control::MOCK_ALEXANDER << endl;
+	os << prefix << "braid_control::MODULAR_HOMOLOGY = " << braid_control::MODULAR_HOMOLOGY << endl;
 	os << prefix << "braid_control::PARITY_ARROW = " << braid_control::PARITY_ARROW << endl;
 	os << prefix << "braid_control::PARITY_BRACKET = " << braid_control::PARITY_BRACKET << endl;
 	os << prefix << "braid_control::PEER_CODE = " << braid_control::PEER_CODE << endl;
@@ -155,6 +159,8 @@ void print_prog_params (ostream& os, string level, string prefix)
 		os << prefix << "braid_control::VERIFY_DELTA_0 = " << braid_control::VERIFY_DELTA_0 << endl;
 		os << prefix << "braid_control::WAIT_SWITCH = " << braid_control::WAIT_SWITCH << endl;
 		os << prefix << "braid_control::wait_threshold = " << braid_control::wait_threshold << endl;
+		os << prefix << "braid_control::homfly_cache_limit = " << braid_control::homfly_cache_limit << endl;
+		os << prefix << "braid_control::canonical_cache_limit = " << braid_control::canonical_cache_limit << endl;
 	}
 }
 
@@ -1829,9 +1835,47 @@ void print_k_chain(ostream& os, const vector<int> k_chain, generic_switch_data&
 
 	In the case of COCYCLE_INVARIANT, the function sets num_chain_generators and chain_map in the switch data if cohomology 
 	generators were read from the input file
+	
+	The report is written to os and output_os, normally cout and output, so that batch_colouring_invariant may discard the report
+	while it records the colourings required.
+*/
+/* batch_colouring_data is called by the colouring kernels num_fixed_points and code_data_colourings with a key identifying the diagram 
+   whose colourings are required and a function that evaluates them.  If the colourings have been evaluated in advance by 
+   batch_colouring_invariant, the result is returned from switch_data, together with any output produced by the evaluation.  If 
+   switch_data.batch_recording is set, evaluate is recorded in switch_data.batch_request and result is set to a placeholder for 
+   a switch of size n, since the output of colouring_invariant is discarded while recording.  In either case the function returns 
+   true, otherwise it returns false and the caller evaluates the colourings itself.
 */
+bool batch_colouring_data(generic_switch_data& switch_data, string key, int n, function<colouring_data()> evaluate, colouring_data& result)
+{
+	map<string,colouring_data>::iterator mptr = switch_data.batch_colourings.find(key);
+	if (mptr != switch_data.batch_colourings.end())
+	{
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "batch_colouring_data: colourings of " << key << " evaluated in advance, number of colourings = " << mptr->second.num_fixed_points << endl;
+
+		result = mptr->second;
+		output << result.batch_output;
+		return true;
+	}
+	else if (switch_data.batch_recording)
+	{
+		switch_data.batch_request.insert(pair<string,function<colouring_data()> >(key,evaluate));
+
+		result = colouring_data();
+		result.num_cocycle_invariants = switch_data.cocycle_scalar.size();
+		result.cocycle_invariant = vector<Cpolynomial>(result.num_cocycle_invariants);
+		result.image_size_count = vector<int>(n);
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
 void colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, 
-						   matrix<int>& Tu, matrix<int>& Td, braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data)
+						   matrix<int>& Tu, matrix<int>& Td, braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, ostream& os, ostream& output_os)
 {		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
   	debug << "colouring_invariant: presented with input_string =  " << input_string << endl;
@@ -1849,20 +1893,20 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	if (title.length())
    	{
 		if (!braid_control::SILENT_OPERATION)
-			cout << "\n\n" << title << endl;
+			os << "\n\n" << title << endl;
 		if (!braid_control::RAW_OUTPUT)
-			output << "\n\n" << title;
+			output_os << "\n\n" << title;
    	}
    	else if (!braid_control::SILENT_OPERATION)
    	{
-		cout << "\n\n" << input_string << endl;
+		os << "\n\n" << input_string << endl;
 	}
 		
 
 	if (!braid_control::RAW_OUTPUT)
 	{
-		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-	   	output << input_string << endl;		
+		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+	   	output_os << input_string << endl;		
 	}
 	
 	int n = switch_data.size;
@@ -1989,12 +2033,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		if (!birack_polynomial_defined)
 		{
 			if (!braid_control::SILENT_OPERATION)			
-				cout << "Birack polynomial is not defined for this doubled birack" << endl;
+				os << "Birack polynomial is not defined for this doubled birack" << endl;
 					
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << "Birack polynomial is not defined for this doubled birack";
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "Birack polynomial is not defined for this doubled birack";
 			}
 			
 			return;
@@ -2085,13 +2129,13 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 //return; // XXX FOR TESTING ONLY
 
 		if (!braid_control::SILENT_OPERATION && braid_control::EXTRA_OUTPUT)			
-			cout << "period of birack = " << period << endl;
+			os << "period of birack = " << period << endl;
 			
 		if (!braid_control::RAW_OUTPUT && braid_control::EXTRA_OUTPUT)
 		{
-			output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << "period of birack = ";
-			output << period << endl;
+			output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << "period of birack = ";
+			output_os << period << endl;
 		}
 	}
 
@@ -2140,15 +2184,15 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	
 	if (input_string.find('(') != string::npos || input_string.find('[') != string::npos)
 	{
-		peer_code_colouring_invariant(Su,Sd,invSu,invSd,Tu,Td,pair_type,input_string,title,switch_data,period);
+		peer_code_colouring_invariant(Su,Sd,invSu,invSd,Tu,Td,pair_type,input_string,title,switch_data,period,os,output_os);
 	}
 	else
 	{
-		braid_colouring_invariant(Su,Sd,invSu,invSd,Tu,Td,pair_type,input_string,title,switch_data,period);
+		braid_colouring_invariant(Su,Sd,invSu,invSd,Tu,Td,pair_type,input_string,title,switch_data,period,os,output_os);
 	}
 }
 
-void determine_cohomology_generators(generic_switch_data& switch_data)
+void determine_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os)
 {						
 	int n = switch_data.size;
 	int num_chain_generators = switch_data.num_chain_generators;
@@ -2236,7 +2280,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			}
 			else
 			{
-				cout << "Error reading cochomology generator from switch data!" << endl;
+				os << "Error reading cochomology generator from switch data!" << endl;
 				exit(0);
 			}
 			
@@ -2304,12 +2348,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	if (switch_data.cocycle_string.size() == 0)
 	{
 		if (!braid_control::SILENT_OPERATION)
-			cout << "no cohomology generators satisfying cocycle condition:" << endl;
+			os << "no cohomology generators satisfying cocycle condition:" << endl;
 			    
 		if (!braid_control::RAW_OUTPUT)
 	 	{
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << "no cohomology generators satisfying cocycle condition:" << endl;
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << "no cohomology generators satisfying cocycle condition:" << endl;
 	 	}	
 	}
 	else
@@ -2317,28 +2361,28 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		
 		if (!braid_control::SILENT_OPERATION)
 		{
-			cout << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:" << endl;
+			os << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:" << endl;
 			lptr = switch_data.cocycle_string.begin();
 			while (lptr != switch_data.cocycle_string.end())
 			{
-				cout << *lptr << endl;
+				os << *lptr << endl;
 				lptr++;
 			};
 		}
 
 		if (!braid_control::RAW_OUTPUT)
 		{
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:";
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:";
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 			lptr = switch_data.cocycle_string.begin();
 			while (lptr != switch_data.cocycle_string.end())
 			{
-				output << *lptr;
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << *lptr;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 				lptr++;
 			};
-			output << flush;
+			output_os << flush;
 		}
 
 	}
@@ -33,64 +33,14 @@ extern ofstream debug;
 #endif
 
 #ifdef INITIALIZE_SCALAR
-	Scalar* make_int() {return new int_scalar;}
-	Scalar* make_int(int a) {return new int_scalar(a);}
-	Scalar* make_bigint() {return new bigint_scalar;}
-	Scalar* make_bigint(int a) {return new bigint_scalar(a);}
-	Scalar* make_mod_p() {return new mod_p;}
-	Scalar* make_mod_p(int a) {return new mod_p(a);}
-	Scalar* make_rational() {return new rational_scalar;}
-	Scalar* make_rational(int a) {return new rational_scalar(a);}
-	Scalar* make_big_rational() {return new big_rational;}
-	Scalar* make_big_rational(int a) {return new big_rational(a);}
-	
-	/* here are the function pointers that will point to 
-	   one of the above, set to the default variant
-	*/
-	Scalar* (*make_scalar) () = make_big_rational;
-	Scalar* (*make_scalar_int) (int) = make_big_rational;
-	
-	
-	/* The variant member of scalar is for debugging and performmng variant-specifica actions, 
-	   such as in the calculation of Smith normal form
+	/* The variant member of scalar is the variant given to newly constructed scalars.  It is also used for debugging 
+	   and performing variant-specific actions, such as in the calculation of Smith normal form
 	*/
 	int scalar::variant = scalar::BIGRATIONAL;
 	
-	/* We only need the if-else logic when we set  
-	   the variant of the scalar, not when we create one.
-	*/
 	void scalar::set_variant(scalar_variant t)
 	{
-		if (t == INT)
-		{
-			make_scalar = make_int;
-			make_scalar_int = make_int;
-			variant = INT;
-		}
-		else if (t == BIGINT)
-		{
-			make_scalar = make_bigint;
-			make_scalar_int = make_bigint;
-			variant = BIGINT;
-		}
-		else if (t == RATIONAL)
-		{
-			make_scalar = make_rational;
-			make_scalar_int = make_rational;
-			variant = RATIONAL;
-		}
-		else if (t == BIGRATIONAL)
-		{
-			make_scalar = make_big_rational;
-			make_scalar_int = make_big_rational;
-			variant = BIGRATIONAL;
-		}
-		else
-		{
-			make_scalar = make_mod_p;
-			make_scalar_int = make_mod_p;
-			variant = MOD_P;
-		}
+		variant = t;
 	}
 	
 	
@@ -133,17 +83,19 @@ extern ofstream debug;
 	int matrix_control::wait_threshold = 5;
 	int matrix_control::wait_count = 0;
 	int matrix_control::reset_count = 0;
+	int matrix_control::DETERMINANT_ALGORITHM = matrix_control::automatic;
 #endif
 
 #ifdef INITIALIZE_POLYNOMIAL	
 #include <polynomial.h>
 	unsigned int polynomial_control::DEBUG = 0;
 	bool polynomial_control::WAIT_INFO = false;
-	bool polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = true;
+	thread_local bool polynomial_control::SUBSTITUTE_MAPPED_VARIABLES = true;
 	bool polynomial_control::OUTPUT_PROXY_VARIABLES_ONLY = false;
 	bool polynomial_control::WRITE_PARITY_PEER_CODES = false;
 	bool polynomial_control::MOD_P = false;
 	bool polynomial_control::TeX = false;
+	bool polynomial_control::ACCUMULATE_PTERMS = true;
 	int polynomial_control::wait_threshold = 10;
 #endif
 
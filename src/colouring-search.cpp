@@ -0,0 +1,232 @@
+/*************************************************************************************************
+                  Constraint propagating colouring search
+
+The functions in this module implement the colouring_search class declared in colouring-search.h
+
+*************************************************************************************************/
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+extern ofstream     debug;
+
+#include <debug-control.h>
+#include <colouring-search.h>
+
+int colouring_search::add_relation(const vector<int>& egress)
+{
+	relation_data r;
+	r.egress = egress;
+	r.inverse = vector<int>(n*n,-1);
+
+	for (int i=0; i< n*n; i++)
+	{
+		if (egress[i] == -1)
+			continue;
+
+		if (r.inverse[egress[i]] != -1)
+		{
+			/* not injective, so the egress labels do not determine the ingress labels */
+			r.inverse.clear();
+			break;
+		}
+		r.inverse[egress[i]] = i;
+	}
+
+if (debug_control::DEBUG >= debug_control::DETAIL)
+	debug << "colouring_search::add_relation: relation " << relation.size() << (r.inverse.size()? " is": " is not") << " injective" << endl;
+
+	relation.push_back(r);
+	return relation.size()-1;
+}
+
+void colouring_search::add_crossing(int relation, int ingress_0, int ingress_1, int egress_0, int egress_1)
+{
+	crossing_data c;
+	c.relation = relation;
+	c.ingress[0] = ingress_0;
+	c.ingress[1] = ingress_1;
+	c.egress[0] = egress_0;
+	c.egress[1] = egress_1;
+
+	int index = crossing.size();
+	crossing.push_back(c);
+
+	/* a variable may appear more than once at a crossing, it need only be recorded once */
+	int variable[4] = {ingress_0, ingress_1, egress_0, egress_1};
+	for (int i=0; i< 4; i++)
+	{
+		vector<int>& incident = incident_crossings[variable[i]];
+		if (incident.empty() || incident.back() != index)
+			incident.push_back(index);
+	}
+}
+
+void colouring_search::set_branch_order(const vector<int>& order)
+{
+	branch_order = order;
+}
+
+/* assign sets the label of variable to value, returning false if the variable already has a different label */
+bool colouring_search::assign(int variable, int value)
+{
+	if (label[variable] != -1)
+		return label[variable] == value;
+
+	label[variable] = value;
+	trail.push_back(variable);
+	pending.push_back(variable);
+	return true;
+}
+
+void colouring_search::undo(size_t mark)
+{
+	while (trail.size() > mark)
+	{
+		label[trail.back()] = -1;
+		trail.pop_back();
+	}
+}
+
+/* propagate checks each crossing incident with a newly labelled variable, labelling the egress variables if both ingress labels are known
+   or, for an injective relation, the ingress variables if both egress labels are known.  It returns false if a crossing is contradicted.
+*/
+bool colouring_search::propagate()
+{
+	while (!pending.empty())
+	{
+		int variable = pending.back();
+		pending.pop_back();
+
+		for (size_t i=0; i< incident_crossings[variable].size(); i++)
+		{
+			crossing_data& c = crossing[incident_crossings[variable][i]];
+			relation_data& r = relation[c.relation];
+
+			int a = label[c.ingress[0]];
+			int b = label[c.ingress[1]];
+
+			if (a != -1 && b != -1)
+			{
+				int image = r.egress[a*n+b];
+				if (image == -1 || !assign(c.egress[0],image/n) || !assign(c.egress[1],image%n))
+				{
+					pending.clear();
+					return false;
+				}
+			}
+			else if (r.inverse.size())
+			{
+				int x = label[c.egress[0]];
+				int y = label[c.egress[1]];
+
+				if (x != -1 && y != -1)
+				{
+					int preimage = r.inverse[x*n+y];
+					if (preimage == -1 || !assign(c.ingress[0],preimage/n) || !assign(c.ingress[1],preimage%n))
+					{
+						pending.clear();
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool colouring_search::next(vector<int>& colouring)
+{
+	if (exhausted)
+		return false;
+
+	if (!started)
+	{
+		started = true;
+
+		/* complete the branch order with any variable at a crossing that it does not include */
+		vector<bool> included(label.size());
+		for (size_t i=0; i< branch_order.size(); i++)
+			included[branch_order[i]] = true;
+		for (size_t i=0; i< label.size(); i++)
+		{
+			if (!included[i] && !incident_crossings[i].empty())
+				branch_order.push_back(i);
+		}
+
+		if (branch_order.empty())
+		{
+			exhausted = true;
+			colouring = label;
+			return true;
+		}
+
+		level = vector<search_level>(branch_order.size());
+		depth = 0;
+		level[0].next_label = -1;
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "colouring_search::next: " << label.size() << " variables, " << crossing.size() << " crossings, " << relation.size()
+	      << " relations, " << branch_order.size() << " branch variables" << endl;
+	}
+	else
+	{
+		/* resume from the colouring returned by the last call */
+		depth--;
+	}
+
+	while (true)
+	{
+		if (depth == static_cast<int>(branch_order.size()))
+		{
+			colouring = label;
+			return true;
+		}
+
+		search_level& current = level[depth];
+		int variable = branch_order[depth];
+
+		if (current.next_label == -1)
+		{
+			/* we have just reached this level */
+			current.mark = trail.size();
+			if (label[variable] != -1)
+			{
+				current.next_label = n;
+				depth++;
+				if (depth < static_cast<int>(branch_order.size()))
+					level[depth].next_label = -1;
+				continue;
+			}
+			current.next_label = 0;
+		}
+
+		undo(current.mark);
+
+		if (current.next_label == n)
+		{
+			if (depth == 0)
+			{
+				exhausted = true;
+				return false;
+			}
+			depth--;
+			continue;
+		}
+
+		if (assign(variable,current.next_label++) && propagate())
+		{
+			depth++;
+			if (depth < static_cast<int>(branch_order.size()))
+				level[depth].next_label = -1;
+		}
+		else
+		{
+			pending.clear();
+		}
+	}
+}
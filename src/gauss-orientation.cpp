@@ -24,6 +24,7 @@ void gauss_orientation_data::reverse_components( vector<bool>&)
 void print_gauss_data(gauss_orientation_data g, ostream& os, string prefix)
 void write_gauss_data(gauss_orientation_data g, ostream& os, bool zig_zags)
 gauss_orientation_data left_preferred(gauss_orientation_data g, bool unoriented=false, int immersion_character = generic_code_data::character::CLOSED)
+string left_preferred_gauss_data(const gauss_orientation_data& g, bool unoriented, int immersion_character, bool zig_zags, int head_zig_zag_count)
 bool gauss_orientation_data::operator == (gauss_orientation_data& b) const
 
 **************************************************************************/
@@ -44,8 +45,11 @@ extern ofstream     debug;
 #include <matrix.h>
 #include <generic-code.h>
 #include <debug-control.h>
+#include <braid-control.h>
 #include <gauss-orientation.h>
 
+lru_cache<string,string> left_preferred_cache;
+
 bool operator < (const matrix<int>& a, const matrix<int>& b)
 {
 	if (a.numrows() != b.numrows() || a.numcols() != b.numcols())
@@ -1371,6 +1375,33 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	return g;
 }
 
+/* left_preferred_gauss_data returns the left preferred representation of g, written by write_gauss_data.  The parity bracket and parity arrow 
+   polynomials evaluate this for the graphical components of every state and the same small diagrams recur many times, so the results are 
+   memoised in left_preferred_cache, keyed on the Gauss data of g, including any zig-zag counts, together with the other parameters.  At most 
+   braid_control::canonical_cache_limit results are recorded, the least recently used being discarded once the limit is reached.
+*/
+string left_preferred_gauss_data(const gauss_orientation_data& g, bool unoriented, int immersion_character, bool zig_zags, int head_zig_zag_count)
+{
+	ostringstream key;
+	key << (unoriented? 'U': 'O') << immersion_character << (zig_zags? 'Z': 'N') << head_zig_zag_count << ':';
+	write_gauss_data(g,key,true,immersion_character,head_zig_zag_count); // zig_zags = true, so the key includes any counts
+	
+	string lp_gauss_data;
+	if (braid_control::canonical_cache_limit > 0 && left_preferred_cache.find(key.str(),lp_gauss_data))
+	{
+if (debug_control::DEBUG >= debug_control::DETAIL)
+	debug << "left_preferred_gauss_data: found " << key.str() << " in cache: " << lp_gauss_data << endl;
+
+		return lp_gauss_data;
+	}
+	
+	ostringstream oss;
+	write_gauss_data(left_preferred(g,unoriented,immersion_character),oss,zig_zags,immersion_character,head_zig_zag_count);
+	lp_gauss_data = oss.str();
+	
+	left_preferred_cache.insert(key.str(),lp_gauss_data,braid_control::canonical_cache_limit);
+	return lp_gauss_data;
+}
 
 /* if two sets of gauss_orientation_data are equal they represent the same diagram, in which case they 
    will yield the same left-preferred representation of the corresponding Gauss code.
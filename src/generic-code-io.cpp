@@ -3,8 +3,10 @@ void read_immersion_code (generic_code_data& code_data, string input_string)
 void write_immersion_code(ostream& s, generic_code_data& code_data)
 void print_code_data(ostream& s, generic_code_data& code_data, string prefix)
 void read_peer_code (generic_code_data& code_data, string input_string)
+void rebuild_peer_code_data (generic_code_data& code_data)
 void write_peer_code(ostream& s, const generic_code_data& code_data, bool zig_zags, bool labelled)
 void read_gauss_code (generic_code_data& code_data, string input_string)
+void assign_gauss_code_data (generic_code_data& code_data, const vector<int>& gauss_data, const vector<int>& num_terms_in_component, const vector<int>& crossing_sign)
 void write_gauss_code(ostream& s, generic_code_data& code_data, bool OU_FORMAT)
 void read_planar_diagram (generic_code_data& code_data, string input_string)
 void write_planar_diagram(ostream& s, generic_code_data& code_data)
@@ -822,6 +824,157 @@ if (debug_control::DEBUG >= debug_control::EXHAUSTIVE)
 	delete[] inbuf;
 }
 
+/* rebuild_peer_code_data recomputes the code data of a peer code in place, producing the same result as writing the 
+   peer code with write_peer_code and reading it back with read_peer_code, but without the round trip through a string.  
+   It uses the same data as write_peer_code: the generic_code_data::table::ODD_TERMINATING, generic_code_data::table::TYPE, 
+   generic_code_data::table::LABEL and generic_code_data::table::COMPONENT rows of the code table, num_components, 
+   num_component_edges and, if required, the head and virtual_index.  From these it rebuilds the remaining rows of the code 
+   table, the component data and term_crossing and orig_crossing, renumbering the components consecutively as read_peer_code
+   does.
+   
+   Multi-linkoids are still handled by writing and reading the peer code, since read_peer_code recovers their component_type 
+   from the head indicators, as is any code data whose num_component_edges does not account for every crossing.
+*/
+void rebuild_peer_code_data (generic_code_data& code_data)
+{
+	int num_crossings = code_data.num_crossings;
+	int num_written_crossings = 0;
+	for (int i=0; i< code_data.num_components; i++)
+		num_written_crossings += code_data.num_component_edges[i]/2;
+
+	if (code_data.type != generic_code_data::peer_code || code_data.immersion_character == generic_code_data::character::MULTI_LINKOID ||
+	    (num_crossings > 0 && num_written_crossings != num_crossings))
+	{
+		ostringstream oss;
+		write_peer_code(oss, code_data);
+
+if (debug_control::DEBUG >= debug_control::EXHAUSTIVE)
+	debug << "rebuild_peer_code_data: rebuilding code data from peer code " << oss.str() << endl;
+
+		read_peer_code(code_data, oss.str());
+		return;
+	}
+
+	const matrix<int>& old_code_table = code_data.code_table;
+	matrix<int> code_table(generic_code_data::table::CODE_TABLE_SIZE,num_crossings);
+	vector<int> virtual_index(num_crossings);
+	
+	/* write_peer_code separates components only where the generic_code_data::table::COMPONENT row changes at the start of a 
+	   component and read_peer_code numbers components by counting the separators, so we do the same.
+	*/
+	int component = 0;
+	int crossing = 0;
+	for (int i=0; i< code_data.num_components; i++)
+	{
+		if (crossing > 0 && crossing < num_crossings && 
+		    old_code_table[generic_code_data::table::COMPONENT][crossing] != old_code_table[generic_code_data::table::COMPONENT][crossing-1])
+			component++;
+			
+		for (int j=0; j< code_data.num_component_edges[i]/2; j++)
+			code_table[generic_code_data::table::COMPONENT][crossing++] = component;
+	}
+
+	for (int i=0; i< num_crossings; i++)
+	{
+		int peer = old_code_table[generic_code_data::table::ODD_TERMINATING][i];
+		code_table[generic_code_data::table::OPEER][i] = peer;
+		code_table[generic_code_data::table::EPEER][(peer-1)/2] = 2*i;
+		
+		if (old_code_table[generic_code_data::table::TYPE][i] == generic_code_data::TYPE1)
+			code_table[generic_code_data::table::TYPE][i] = generic_code_data::TYPE1;
+		else
+			code_table[generic_code_data::table::TYPE][i] = generic_code_data::TYPE2;
+		
+		int label = old_code_table[generic_code_data::table::LABEL][i];
+		if (label == generic_code_data::POSITIVE || label == generic_code_data::NEGATIVE || label == generic_code_data::FLAT)
+		{
+			code_table[generic_code_data::table::LABEL][i] = label;
+		}
+		else if (label == generic_code_data::VIRTUAL)
+		{
+			code_table[generic_code_data::table::LABEL][i] = label;
+			
+			if (code_data.multi_virtual && code_data.virtual_index[i] != 0 && code_data.virtual_index[i] != 1)
+				virtual_index[i] = code_data.virtual_index[i];
+			else
+				virtual_index[i] = 1;
+		}
+		else
+			code_table[generic_code_data::table::LABEL][i] = generic_code_data::SINGULAR;
+	}
+
+	/* only the head of a pure knotoid is written to the peer code, and a pure knotoid whose head is not set is read as a closed code */
+	if (code_data.immersion_character == generic_code_data::character::PURE_KNOTOID && code_data.head >= 0 && code_data.head < num_crossings)
+	{
+		code_data.num_open_components = 1;
+	}
+	else
+	{
+		if (code_data.immersion_character == generic_code_data::character::KNOTOID)
+			code_data.num_open_components = 1;
+		else if (code_data.immersion_character == generic_code_data::character::PURE_KNOTOID)
+			code_data.immersion_character = generic_code_data::character::CLOSED;
+			
+		code_data.head = -1;
+	}
+	
+	/* write the component data into code_data */
+	int num_edges = 2*num_crossings;
+	int num_components = component+1;
+
+	vector<int> num_component_edges(num_components);
+	vector<int> first_edge_on_component(num_components);
+	component=0;
+	
+	for (int i=1; i< num_crossings; i++)
+	{
+		if (code_table[generic_code_data::table::COMPONENT][i] != code_table[generic_code_data::table::COMPONENT][i-1])
+		{
+			num_component_edges[component] = 2*i-first_edge_on_component[component];
+			component++;
+			first_edge_on_component[component] = 2*i;
+		}
+	}
+	
+	num_component_edges[component] = num_edges - first_edge_on_component[component];
+	
+	/* now we can write the originating and terminating vertices and edges */
+	vector<int> term_crossing(num_edges);
+	vector<int> orig_crossing(num_edges);
+	
+	for (int i=0; i< num_crossings; i++)
+	{
+		term_crossing[2*i] = i;
+		orig_crossing[2*i+1] = i;
+		term_crossing[code_table[generic_code_data::table::OPEER][i]] = i;
+		
+		int component = code_table[generic_code_data::table::COMPONENT][(code_table[generic_code_data::table::OPEER][i]-1)/2];
+		int peer_successor = (code_table[generic_code_data::table::OPEER][i]+1 - first_edge_on_component[component])%
+		                     num_component_edges[component] + first_edge_on_component[component];
+
+		orig_crossing[peer_successor] = i;
+		
+		code_table[generic_code_data::table::EVEN_TERMINATING][i] = 2*i;
+		code_table[generic_code_data::table::ODD_ORIGINATING][i] = 2*i+1;
+		code_table[generic_code_data::table::ODD_TERMINATING][i] = code_table[generic_code_data::table::OPEER][i];
+		code_table[generic_code_data::table::EVEN_ORIGINATING][i] = peer_successor;
+	}
+	
+	code_data.num_components = num_components;
+	code_data.code_table = code_table;
+	code_data.num_component_edges = num_component_edges;
+	code_data.first_edge_on_component = first_edge_on_component;
+	code_data.term_crossing = term_crossing;
+	code_data.orig_crossing = orig_crossing;
+	code_data.virtual_index = virtual_index;
+	
+if (debug_control::DEBUG >= debug_control::EXHAUSTIVE)
+{
+	debug << "rebuild_peer_code_data: rebuilt code data:" << endl;
+	print_code_data(debug,code_data,"rebuild_peer_code_data: ");	
+}
+}
+
 /* This function uses:
 
 	immersion_character, 
@@ -1382,6 +1535,87 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	delete[] inbuf;
 }
 
+/* assign_gauss_code_data sets code_data to the Gauss code data of a classical Gauss code, producing the same result as 
+   read_gauss_code would from the corresponding Gauss code string, without writing and parsing that string.  The gauss_data 
+   holds the signed crossing numbers of the terms, numbered from one, component by component according to 
+   num_terms_in_component, with the terms for under-arcs negative.  A crossing is considered to be positive if its 
+   crossing_sign is positive and negative otherwise.
+*/
+void assign_gauss_code_data (generic_code_data& code_data, const vector<int>& gauss_data, const vector<int>& num_terms_in_component, const vector<int>& crossing_sign)
+{
+	int num_components = num_terms_in_component.size();
+	int num_edges = gauss_data.size();
+	int num_crossings = num_edges/2;
+
+	code_data.type = generic_code_data::gauss_code;
+	code_data.immersion_character = generic_code_data::character::CLOSED;
+	code_data.head = -1;
+	code_data.num_crossings = num_crossings;
+	
+	matrix<int> code_table(generic_code_data::table::CODE_TABLE_SIZE,num_crossings);
+
+	for (int i=0; i<num_crossings; i++)
+		code_table[generic_code_data::table::OPEER][i] = -1;
+
+	vector<int> term_crossing(num_edges);
+	vector<int> orig_crossing(num_edges);
+	vector<int> num_component_edges(num_components);
+	vector<int> first_edge_on_component(num_components);
+	
+	int edge = 0;
+	for (int i=0; i< num_components; i++)
+	{
+		first_edge_on_component[i] = edge;
+		num_component_edges[i] = num_terms_in_component[i];
+		
+		for (int j=0; j< num_terms_in_component[i]; j++)
+		{
+			int crossing = abs(gauss_data[edge])-1;
+			
+			if (code_table[generic_code_data::table::OPEER][crossing] == -1)
+			{
+				/* first visit, as in read_gauss_code the label records whether the second visit is the over-arc */
+				code_table[generic_code_data::table::OPEER][crossing] = edge;
+				code_table[generic_code_data::table::COMPONENT][crossing] = i;
+				code_table[generic_code_data::table::LABEL][crossing] = (gauss_data[edge] > 0? generic_code_data::NEGATIVE: generic_code_data::POSITIVE);
+				code_table[generic_code_data::table::ODD_TERMINATING][crossing] = edge;
+				code_table[generic_code_data::table::EVEN_ORIGINATING][crossing] = first_edge_on_component[i] + (j+1)%num_component_edges[i];
+			}
+			else
+			{
+				code_table[generic_code_data::table::EPEER][crossing] = edge;
+				code_table[generic_code_data::table::EVEN_TERMINATING][crossing] = edge;
+				code_table[generic_code_data::table::ODD_ORIGINATING][crossing] = first_edge_on_component[i] + (j+1)%num_component_edges[i];
+			}
+			
+			term_crossing[edge] = crossing;
+			orig_crossing[first_edge_on_component[i] + (j+1)%num_component_edges[i]] = crossing;
+			edge++;
+		}
+	}
+	
+	for (int i=0; i< num_crossings; i++)
+	{
+		if ((crossing_sign[i] > 0) == (code_table[generic_code_data::table::LABEL][i] == generic_code_data::POSITIVE))
+			code_table[generic_code_data::table::TYPE][i] = generic_code_data::TYPE2;
+		else
+			code_table[generic_code_data::table::TYPE][i] = generic_code_data::TYPE1;
+	}
+	
+	code_data.num_components = num_components;	
+	code_data.code_table = code_table;
+	code_data.num_component_edges = num_component_edges;
+	code_data.first_edge_on_component = first_edge_on_component;
+	code_data.term_crossing = term_crossing;
+	code_data.orig_crossing = orig_crossing;
+	
+if (debug_control::DEBUG >= debug_control::DETAIL)
+{
+	debug << "assign_gauss_code_data: code data produced from gauss data:" << endl;
+	print_code_data(debug,code_data,"assign_gauss_code_data: ");	
+}
+}
+
 /* write_gauss_code is capable of writing a gauss code from any kind of generic code data, 
    so it can convert from peer codes or immersion codes as well as output "native" Gauss codes
 */
@@ -11,6 +11,7 @@ bool calculate_turning_cycles(generic_code_data& code_data, matrix<int>& cycle,
 bool realizable_code_data(generic_code_data& code_data, matrix<int>& cycle, int& num_left_cycles, int& num_cycles)
 bool valid_knotoid_input(generic_code_data& code_data)
 string over_preferred_gauss_code(generic_code_data& code_data, bool unoriented)
+void print_canonical_cache_use(string cache_name, long hits, long misses, size_t size)
 vector<int> classical_gauss_data(generic_code_data& code_data)
 int amalgamate_zig_zag_counts(int a, int b)
 void trace_component(generic_code_data& code_data, int start, int end, int component, int base_component, vector<bool>& visited_component, vector<bool>& visited_crossing,
@@ -44,9 +45,11 @@ extern ifstream     input;
 #include <matrix.h>
 #include <generic-code.h>
 #include <debug-control.h>
+#include <braid-control.h>
 #include <gauss-orientation.h>
 #include <reidemeister.h>
 
+lru_cache<string,string> over_preferred_cache;
 
 /* convert_gauss_code converts from OU to standard Gauss code format i.e from
    O1-O2+U1-O3+O4+U2+U3+U4+ to 1 2 -1 3 4 -2 -3 -4/- + + +
@@ -1654,6 +1657,12 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 
 	num_cycles = 0;
 	
+	/* in_cycle records the turning cycle containing each edge, or -1 if the edge has not yet been 
+	   traced, so we do not have to search the cycles found so far for each edge.  It is reset 
+	   before we look for the right turning cycles.
+	*/
+	vector<int> in_cycle(num_edges,-1);
+	
 	/* First look for left turning cycles */
 	for (int i=0; i<2*num_crossings; i++)
 	{
@@ -1662,22 +1671,13 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
     debug << "calculate_turning_cycles: edge = " << i;
 
     	/* does edge i already appear in a cycle ? */
-		bool found = false;
-		for (int j=0; j<num_cycles; j++)
-		{
-			for (int k=1; k<= cycle[j][0]; k++)
-			{
-				if (abs(cycle[j][k]) == i)
-				{
+		bool found = (in_cycle[i] != -1);
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
-    debug << " found in left turning cycle " << j << endl;
-
-					found = true;
-					break;
-				}
-			}
-		}
+{
+	if (found)
+	    debug << " found in left turning cycle " << in_cycle[i] << endl;
+}
 
 		if (!found)
 		{
@@ -1733,6 +1733,10 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 				{
 					complete = true;
 					cycle[num_cycles][0] = column-1;
+					
+					for (int k=1; k< column; k++)
+						in_cycle[abs(cycle[num_cycles][k])] = num_cycles;
+						
 					num_cycles++;
 				}
 				else
@@ -1753,6 +1757,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 
 	/* record the number of left cycles */
 	num_left_cycles = num_cycles;
+	in_cycle.assign(num_edges,-1);
 		
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 {
@@ -1775,22 +1780,13 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
     debug << "calculate_turning_cycles: edge = " << i;
 
 		/* does edge i already appear in a right cycle ? */
-		bool found = false;
-		for (int j=num_left_cycles; j<num_cycles; j++)
-		{
-			for (int k=1; k<= cycle[j][0]; k++)
-			{
-				if (abs(cycle[j][k]) == i)
-				{
-					
+		bool found = (in_cycle[i] != -1);
+
 if (debug_control::DEBUG >= debug_control::DETAIL)
-    debug << " found in right turning cycle " << j << endl;
-    
-    					found = true;
-					break;
-				}
-			}
-		}
+{
+	if (found)
+	    debug << " found in right turning cycle " << in_cycle[i] << endl;
+}
 
 		if (!found)
 		{
@@ -1847,6 +1843,10 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 				{
 					complete = true;
 					cycle[num_cycles][0] = column-1;
+					
+					for (int k=1; k< column; k++)
+						in_cycle[abs(cycle[num_cycles][k])] = num_cycles;
+						
 					num_cycles++;
 				}
 				else
@@ -2166,9 +2166,29 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	}
 	else
 	{
-		ostringstream oss;
-		write_gauss_code(oss, code_data);
-		read_gauss_code(g, oss.str());
+		/* for the peer code of a closed diagram with classical and virtual crossings only, the Gauss orientation data numbers the 
+		   classical crossings in the same way as write_gauss_code, so we can assign the Gauss code data directly.  Otherwise we 
+		   write the Gauss code and read it back.
+		*/
+		bool classical_or_virtual = (code_data.type == generic_code_data::peer_code && code_data.immersion_character == generic_code_data::character::CLOSED);
+		for (int i=0; classical_or_virtual && i< code_data.num_crossings; i++)
+		{
+			int label = code_data.code_table[generic_code_data::table::LABEL][i];
+			if (label != generic_code_data::POSITIVE && label != generic_code_data::NEGATIVE && label != generic_code_data::VIRTUAL)
+				classical_or_virtual = false;
+		}
+		
+		if (classical_or_virtual)
+		{
+			gauss_orientation_data gdata(code_data);
+			assign_gauss_code_data(g, gdata.classical_gauss_data, gdata.num_terms_in_component, gdata.classical_crossing_sign);
+		}
+		else
+		{
+			ostringstream oss;
+			write_gauss_code(oss, code_data);
+			read_gauss_code(g, oss.str());
+		}
 		
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
@@ -2180,6 +2200,22 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 		
 	}
 	
+	/* The over preferred Gauss code is determined by the Gauss code of g, so the results are memoised in over_preferred_cache, keyed on
+	   that Gauss code.  At most braid_control::canonical_cache_limit results are recorded, the least recently used being discarded.
+	*/
+	ostringstream key;
+	key << (unoriented? 'U': 'O') << ':';
+	write_gauss_code(key,g);
+	
+	string op_gauss_code;
+	if (braid_control::canonical_cache_limit > 0 && over_preferred_cache.find(key.str(),op_gauss_code))
+	{
+if (debug_control::DEBUG >= debug_control::DETAIL)
+	debug << "over_preferred_gauss_code: found " << key.str() << " in cache: " << op_gauss_code << endl;
+
+		return op_gauss_code;
+	}
+	
 	matrix<int>& code_table = g.code_table;
 	vector<pair<int,int> > min_perm_weight;  // initializes to zero size
 	vector<int> min_perm;
@@ -2775,9 +2811,34 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 if (debug_control::DEBUG >= debug_control::DETAIL)
 	debug << "over_preferred_gauss_code: over preferred Gauss code string = " << oss.str() << endl;
 
+	over_preferred_cache.insert(key.str(),oss.str(),braid_control::canonical_cache_limit);
 	return oss.str();
 }
 
+/* print_canonical_cache_use reports the hits and misses recorded by the left or over preferred cache cache_name while evaluating a 
+   diagram, together with the hit rate and the number of codes held in the cache.
+*/
+void print_canonical_cache_use(string cache_name, long hits, long misses, size_t size)
+{
+	ostringstream oss;
+	oss << cache_name << " cache: " << hits << " hits, " << misses << " misses, ";
+	if (hits + misses > 0)
+		oss << fixed << setprecision(1) << 100.0*hits/(hits+misses) << "% hit rate, ";
+	oss << size << " codes cached";
+	
+	if (!braid_control::SILENT_OPERATION)
+		cout << oss.str() << endl;
+	
+	if (!braid_control::RAW_OUTPUT)
+	{
+		output << (braid_control::OUTPUT_AS_INPUT? ";" : "");
+		output << oss.str() << endl;
+	}
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "print_canonical_cache_use: " << oss.str() << endl;
+}
+
 int amalgamate_zig_zag_counts(int a, int b)
 {
 	if (a == 0)
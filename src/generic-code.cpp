@@ -14,10 +14,16 @@ void doodle_Q_polynomial(generic_code_data code_data)
 generic_code_data isolate_component(generic_code_data& code_data, int component,vector<int>& crossing_map)
 bool smooth_diagram(generic_code_data& code_data, int smoothed_crossing, generic_code_data& smoothed_code_data)
 int linking_number (generic_code_data& code_data, int crossing_type, int component_1, int component_2)
-list<vector<int> > calculate_colourings( generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td)
-vector<Cpolynomial> cocycle_invariant(generic_code_data& code_data, generic_switch_data& switch_data, list<vector<int> >& colourings)
+void crossing_edge_labels(generic_code_data& code_data, vector<int>& ingress_top_label, vector<int>& ingress_bottom_label, vector<int>& egress_top_label, 
+                          vector<int>& egress_bottom_label, vector<int>& crossing_type)
+list<vector<int> > list_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td)
+void calculate_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
+                          function<void(const vector<int>&)> record_colouring)
+void cocycle_invariant(generic_code_data& code_data, generic_switch_data& switch_data, const vector<int>& colouring, vector<Cpolynomial>& invariant)
+colouring_data code_data_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, 
+                                    matrix<int>& Tu, matrix<int>& Td, generic_switch_data& switch_data, bool refine)
 void peer_code_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
-			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period)
+			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period, ostream& os, ostream& output_os)
 **************************************************************************/
 #include <sstream>
 #include <fstream>
@@ -29,6 +35,7 @@ void peer_code_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>
 #include <cctype>
 #include <iomanip>
 #include <map>
+#include <functional>
 
 using namespace std;
 
@@ -52,6 +59,8 @@ extern ifstream     input;
 #include <generic-code.h>
 #include <gauss-orientation.h>
 
+extern lru_cache<string,string> over_preferred_cache;
+
 //bool CYCLE_KNOT_TYPE_NABLA_K = true;
 
 /********************* Function prototypes ***********************/
@@ -74,16 +83,17 @@ void remove_fringe_edge(int edge, vector<int>& current_fringe);
 void manturov_alexander(generic_code_data& code_data);
 void mock_alexander(generic_code_data& code_data);
 int find_cycle(matrix<int>& cycle, int num_cycles, int num_left_cycles, int edge_1, int edge_2, bool left_cycle);
-list<vector<int> > hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit,int include_edge);
+long hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit, int include_edge,
+                         function<void(const vector<int>&)> record_circuit);
 
 void doodle_Q_polynomial(generic_code_data code_data);
 bool smooth_diagram(generic_code_data& code_data, int smoothed_crossing, generic_code_data& smoothed_code_data);
 generic_code_data isolate_component(generic_code_data& code_data, int component, vector<int>& crossing_map);
 int linking_number (generic_code_data& code_data, int crossing_type, int component_1, int component_2);
 void print_k_chain(ostream& os, const vector<int> k_chain, generic_switch_data& switch_data, int k);
-void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0);
-void determine_cohomology_generators(generic_switch_data& switch_data);
-void test_cohomology_generators(generic_switch_data& switch_data);
+void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0, ostream& os=cout, ostream& output_os=output);
+void determine_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os);
+void test_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os);
 vector<int> smallest_parent_birack(matrix<int>& Su, matrix<int>& Sd, vector<int> labels);
 generic_code_data add_Reidemeister_1_loop (generic_code_data& code_data, bool positive_crossing, bool positive_turn = true);
 void display_fixed_point_switch(matrix<int>& M, ostream& os, bool number_from_zero);
@@ -699,6 +709,10 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 		}
 		
 		
+		/* note the over preferred Gauss code cache counts, so that we can report the hits and misses for this code */
+		long initial_cache_hits = over_preferred_cache.hits();
+		long initial_cache_misses = over_preferred_cache.misses();
+
 		ostringstream oss;
 		if (braid_control::PD_FORMAT)
 		{
@@ -749,6 +763,12 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 		}
 		output << oss.str() << endl;
 
+		if (braid_control::EXTRA_OUTPUT && (braid_control::OPGC || braid_control::UOPGC))
+		{
+			print_canonical_cache_use("Over preferred Gauss code",over_preferred_cache.hits() - initial_cache_hits,
+			                          over_preferred_cache.misses() - initial_cache_misses, over_preferred_cache.size());
+		}
+
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "\ngeneric_code: Gauss code = " << oss.str() << endl;
 		
@@ -773,41 +793,32 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		}
 		else
 		{
-			list<vector<int> > circuit_list = hamiltonian_circuit(code_data, braid_control::HC_LIST_ALL, braid_control::HC_COUNT, braid_control::HC_EDGES, braid_control::HC_INCLUDE_EDGE);
-			
-			if (circuit_list.size() != 0)
+			long num_circuits = hamiltonian_circuit(code_data, braid_control::HC_LIST_ALL, braid_control::HC_COUNT, braid_control::HC_EDGES, braid_control::HC_INCLUDE_EDGE,
+			                                        [&](const vector<int>& circuit)
 			{
-				list<vector<int> >::iterator cptr = circuit_list.begin();
-				while (cptr != circuit_list.end())
+				if (!braid_control::SILENT_OPERATION)
 				{
-					vector<int>& circuit = *cptr;
-					
-						if (!braid_control::HC_COUNT)
-						{
-							if (!braid_control::SILENT_OPERATION)
-							{
-								cout << "Hamiltonian circuit ";
-								for (int i=0; i< code_data.num_crossings; i++)
-									cout << circuit[i] << ' ';
-								cout << endl;
-							}
-							
-							if (!braid_control::RAW_OUTPUT)
-							{
-								output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-								output << "Hamiltonian circuit ";
-							}
-							if (braid_control::OUTPUT_AS_INPUT)
-								output << "\n";
-			
-							for (int i=0; i< code_data.num_crossings; i++)
-								output << circuit[i] << ' ';
-							output << endl;
-			
-							if (!braid_control::SILENT_OPERATION)
-								cout << "\n";
-								
-			
+					cout << "Hamiltonian circuit ";
+					for (int i=0; i< code_data.num_crossings; i++)
+						cout << circuit[i] << ' ';
+					cout << endl;
+				}
+				
+				if (!braid_control::RAW_OUTPUT)
+				{
+					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					output << "Hamiltonian circuit ";
+				}
+				if (braid_control::OUTPUT_AS_INPUT)
+					output << "\n";
+				
+				for (int i=0; i< code_data.num_crossings; i++)
+					output << circuit[i] << ' ';
+				output << endl;
+				
+				if (!braid_control::SILENT_OPERATION)
+					cout << "\n";
+				
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
 		debug << "generic_code: hamiltonian_circuit: " << endl;
@@ -815,12 +826,9 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			debug << circuit[i] << ' ';
 		debug << endl;
 }
-						}
-						
-					cptr++;
-				}
-			}
-			else
+			});
+			
+			if (num_circuits == 0)
 			{
 				if (!braid_control::SILENT_OPERATION)
 					cout << "No Hamiltonian circuit found" << endl;
@@ -838,16 +846,16 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			if (braid_control::HC_COUNT)
 			{
 				if (!braid_control::SILENT_OPERATION)
-					cout << "Found " << circuit_list.size() << " Hamiltonian circuits" << endl;
+					cout << "Found " << num_circuits << " Hamiltonian circuits" << endl;
 				
 				if (!braid_control::RAW_OUTPUT)
 				{
 					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-					output << "Found " << circuit_list.size() << " Hamiltonian circuits" << endl;
+					output << "Found " << num_circuits << " Hamiltonian circuits" << endl;
 				}
 		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-		debug << "generic_code: hamiltonian_circuit: found " << circuit_list.size() << " Hamiltonian circuits" << endl;
+		debug << "generic_code: hamiltonian_circuit: found " << num_circuits << " Hamiltonian circuits" << endl;
 			}			
 		}
 	}
@@ -1931,12 +1939,14 @@ string minimal_peer_code_representation (generic_code_data peer_code_data)
 		return "Error! minimal_peer_code_representation supports only peer codes";
 
 	int num_crossings = peer_code_data.num_crossings;
+	int num_edges = 2*num_crossings;
 	int num_components = peer_code_data.num_components;
+	matrix<int>& code_table = peer_code_data.code_table;
 	vector<int>& num_component_edges = peer_code_data.num_component_edges;
+	vector<int>& first_edge_on_component = peer_code_data.first_edge_on_component;
+	vector<int>& term_crossing = peer_code_data.term_crossing;
+	vector<int>& orig_crossing = peer_code_data.orig_crossing;
 	
-	generic_code_data minimum_peer_code_data(peer_code_data);
-
-
 	/* If the code represents a link and any component is shifted by an odd number of edges, 
 	   we must have all intersecting components shifted by an odd number of edges, otherwise 
 	   we will violate the requirement to have an odd and even edge terminating at every crossing.
@@ -1956,10 +1966,78 @@ string minimal_peer_code_representation (generic_code_data peer_code_data)
 	   light of the above coments), a particular shift vector is valid if every entry is odd or every entry
 	   is even.  Thus -2 is odd and -1 is even.  Note no attempt is made to avoid checking the zero vector 
 	   in the following code.
+	   
+	   Rather than renumbering the peer code for each valid shift vector and then comparing it with the minimum
+	   found so far, we generate the terms TYPE*OPEER of the renumbered code in the order they are compared,
+	   following the renumbering rules of renumber_peer_code, and abandon the shift vector as soon as a term 
+	   exceeds the corresponding term of the minimum.  Only the shift vector of the minimum is recorded and the
+	   peer code is renumbered once, when the search is complete.
 	*/
+	vector<int> edge_component(num_edges);
+	for (int i=0; i< num_crossings; i++)
+	{
+		edge_component[2*i] = code_table[generic_code_data::table::COMPONENT][i];
+		edge_component[2*i+1] = code_table[generic_code_data::table::COMPONENT][i];
+	}
+	
+	/* renumber_peer_code leaves a knotoid unchanged if the shift vector moves the shortcut, so such shift vectors
+	   cannot yield a new minimum
+	*/
+	int head_semi_arc = -1;
+	if (peer_code_data.head != -1)
+	{
+		if (code_table[generic_code_data::table::LABEL][peer_code_data.head] == generic_code_data::POSITIVE)
+			head_semi_arc = code_table[generic_code_data::table::OPEER][peer_code_data.head];
+		else
+			head_semi_arc = 2*peer_code_data.head;
+	}
+
 	vector<int> shift(num_components); 
 	for (int j=0; j< num_components; j++)
 		shift[j] = -1 * num_component_edges[j];
+
+	/* new_edge returns the number given to edge by the shift vector, old_edge is its inverse */
+	auto new_edge = [&](int edge) -> int
+	{
+		int component = edge_component[edge];
+		int first_edge = first_edge_on_component[component];
+		int component_edges = num_component_edges[component];
+		int offset = (edge - first_edge - abs(shift[component]) + component_edges)%component_edges;
+		if (shift[component] < 0)
+			offset = (component_edges - offset)%component_edges;
+		return first_edge + offset;
+	};
+	
+	auto old_edge = [&](int edge) -> int
+	{
+		int component = edge_component[edge];
+		int first_edge = first_edge_on_component[component];
+		int component_edges = num_component_edges[component];
+		int offset = edge - first_edge;
+		if (shift[component] < 0)
+			offset = (component_edges - offset)%component_edges;
+		return first_edge + (offset + abs(shift[component]))%component_edges;
+	};
+	
+	auto successor = [&](int edge) -> int
+	{
+		int component = edge_component[edge];
+		return first_edge_on_component[component] + (edge - first_edge_on_component[component] + 1)%num_component_edges[component];
+	};
+
+	auto predecessor = [&](int edge) -> int
+	{
+		int component = edge_component[edge];
+		int component_edges = num_component_edges[component];
+		return first_edge_on_component[component] + (edge - first_edge_on_component[component] - 1 + component_edges)%component_edges;
+	};
+	
+	vector<int> minimum_term(num_crossings);
+	for (int i=0; i< num_crossings; i++)
+		minimum_term[i] = code_table[generic_code_data::table::TYPE][i]*code_table[generic_code_data::table::OPEER][i];
+	
+	vector<int> minimum_shift;  // initializes to zero size, the given peer code is the minimum
+	vector<int> term(num_crossings);
 	
 	bool next_shift_vector_found;
 	do
@@ -1992,38 +2070,51 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 			}
 		}
 
+		if (valid_shift_vector && head_semi_arc != -1 && shift[0] != 0 && shift[0] != -head_semi_arc)
+			valid_shift_vector = false;
+
 		if (valid_shift_vector)
 		{
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
   	debug << " is valid, testing resultant renumbering" << endl;
 
-			generic_code_data renumbered_code_data(peer_code_data);						
-			renumber_peer_code(renumbered_code_data, shift);
-			
-			matrix<int>& mcode_table = minimum_peer_code_data.code_table;
-			matrix<int>& rcode_table = renumbered_code_data.code_table;
-							
-							
-			bool new_minimal_rep_found = false;
-			/* check the lexicographic ordering of the peer code, ignoring components, that is
-			   compare the product of the generic_code_data::table::TYPE and generic_code_data::table::OPEER
+			/* The renumbered crossing c is the crossing at which the new edge 2c terminates.  If the component containing 
+			   that edge is reversed, the new edge 2c was the edge leaving the old crossing, otherwise it was the edge arriving at
+			   the old crossing.  The crossing type is reversed if the old naming edge becomes odd, unless the peer of the old
+			   naming edge is reversed, and is reversed if the old naming edge remains even and its peer is reversed.
 			*/
+			bool new_minimal_rep_found = false;
+			
 			for (int i=0; i< num_crossings; i++)
 			{
-				if (rcode_table[generic_code_data::table::TYPE][i]*rcode_table[generic_code_data::table::OPEER][i] < mcode_table[generic_code_data::table::TYPE][i]*mcode_table[generic_code_data::table::OPEER][i])
-				{
-					new_minimal_rep_found = true;
-					break;
-				}
-				else if (rcode_table[generic_code_data::table::TYPE][i]*rcode_table[generic_code_data::table::OPEER][i] > mcode_table[generic_code_data::table::TYPE][i]*mcode_table[generic_code_data::table::OPEER][i])
+				int edge = old_edge(2*i);
+				bool reversed = shift[edge_component[edge]] < 0;
+				int crossing = (reversed? orig_crossing[edge] : term_crossing[edge]);
+				int terminating_edge = (reversed? predecessor(edge) : edge);
+				int peer = (terminating_edge == 2*crossing? code_table[generic_code_data::table::OPEER][crossing] : 2*crossing);
+				int odd_edge = (shift[edge_component[peer]] < 0? new_edge(successor(peer)) : new_edge(peer));
+				
+				int type = code_table[generic_code_data::table::TYPE][crossing];
+				bool naming_edge_odd = new_edge(2*crossing)%2;
+				bool peer_reversed = shift[edge_component[code_table[generic_code_data::table::OPEER][crossing]]] < 0;
+				if (naming_edge_odd != peer_reversed)
+					type *= -1;
+					
+				term[i] = type*odd_edge;
+				
+				if (!new_minimal_rep_found)
 				{
-					break;
+					if (term[i] < minimum_term[i])
+						new_minimal_rep_found = true;
+					else if (term[i] > minimum_term[i])
+						break;
 				}
 			}
 			
 			if (new_minimal_rep_found)
 			{
-				minimum_peer_code_data = renumbered_code_data;
+				minimum_term = term;
+				minimum_shift = shift;
 			}
 		}
    	
@@ -2044,8 +2135,11 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 		}
 	} while(next_shift_vector_found);				
 
+	if (minimum_shift.size())
+		renumber_peer_code(peer_code_data, minimum_shift);
+
 	ostringstream oss;
-	write_peer_code(oss,minimum_peer_code_data);
+	write_peer_code(oss,peer_code_data);
 	return oss.str();
 }
 #endif
@@ -3354,45 +3448,19 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	return link_count;
 }
 
-/* calculate_colourings is a list based search for colourings of a diagram described by a labelled peer code.  Colourings are represented as a vector of integer
-   colours with -1 indicating that no colour has been assigned to the corresponding edge.  A list, candidate_schemes, of potential colourings is  initialized 
-   with a candidate indicating each possible colouring of edge zero.  The function then takes the first colouring on the list and attempts to extend the 
-   colouring of a diagram at a single crossing.  The function searches the crossings in order for one having a colour assigned to at least one of the ingress edges 
-   but not having a colour assigned to one (or both) of the egress edges. 
-   
-   If such a crossing is found with colour assigned to just one ingress edge, the function considers all possible colourings for the other ingress edge and, 
-   for each one, determines the egress edge colours.  If the crossing has colour assigned to both ingress edges, the function simply determines the egress 
-   colour for the given edges.  The calculated egress colours are compared to any that have already been assigned.  If the colouring is consistent, the extended 
-   colouring is pushed onto the back of the list.  Inconsitent colourings are discarded.
-
-   If no such crossing is found, provided the diagram is connected, every edge will have been assigned a colour, however, it is not necessarily the case that 
-   they will be globally consistent, since the colour calculated for an egress edge may not be consistent with colours already assigned at the crossing on which 
-   that edge terminates.  An example may be found in the figure 8 knot [-5 7 -1 3]/++++, where the colour calculated for edge three may, in conjunction with the 
-   edge calculated earlier for edge 6, conflict with conflict with the colours calculated for edges 4 or 7.  We therefore check each crossing for consistency
-   before accepting the colouring as valid.
-   
-   It is also possible that we may determine the same colouring twice, so the list of completed colouring_schemes is checked for a duplicate before a new
-   scheme is added.
+/* crossing_edge_labels identifies the ingress and egress edges at each crossing of the diagram described by code_data, together with the
+   type of each crossing, as used by the colouring searches below.
 */
-
-//list<vector<int> > calculate_colourings( generic_code_data& code_data, generic_switch_data& switch_data)
-list<vector<int> > calculate_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td)
+void crossing_edge_labels(generic_code_data& code_data, vector<int>& ingress_top_label, vector<int>& ingress_bottom_label, vector<int>& egress_top_label, 
+                          vector<int>& egress_bottom_label, vector<int>& crossing_type)
 {
-
-	if (braid_control::EXTRA_OUTPUT)
-	{
-		output << "H: ";
-		write_code_data(output, code_data);
-		output << endl;
-	}
-	
 	matrix<int>& code_table = code_data.code_table;
 	
-	vector<int> ingress_top_label(code_data.num_crossings);
-	vector<int> ingress_bottom_label(code_data.num_crossings);
-	vector<int> egress_top_label(code_data.num_crossings);
-	vector<int> egress_bottom_label(code_data.num_crossings);
-	vector<int> crossing_type(code_data.num_crossings);
+	ingress_top_label = vector<int>(code_data.num_crossings);
+	ingress_bottom_label = vector<int>(code_data.num_crossings);
+	egress_top_label = vector<int>(code_data.num_crossings);
+	egress_bottom_label = vector<int>(code_data.num_crossings);
+	crossing_type = vector<int>(code_data.num_crossings);
 	
 	for (int i=0; i< code_data.num_crossings; i++)
 	{
@@ -3436,23 +3504,23 @@ list<vector<int> > calculate_colourings(generic_code_data& code_data, matrix<int
 	}
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-	debug << "calculate_colourings: ingress_top_label    ";
+	debug << "crossing_edge_labels: ingress_top_label    ";
 	for (int i=0; i< code_data.num_crossings; i++)
 		debug << ingress_top_label[i] << ' ';
 	debug << endl;
-	debug << "calculate_colourings: ingress_bottom_label ";
+	debug << "crossing_edge_labels: ingress_bottom_label ";
 	for (int i=0; i< code_data.num_crossings; i++)
 		debug << ingress_bottom_label[i] << ' ';
 	debug << endl;
-	debug << "calculate_colourings: egress_top_label     ";
+	debug << "crossing_edge_labels: egress_top_label     ";
 	for (int i=0; i< code_data.num_crossings; i++)
 		debug << egress_top_label[i] << ' ';
 	debug << endl;
-	debug << "calculate_colourings: egress_bottom_label  ";
+	debug << "crossing_edge_labels: egress_bottom_label  ";
 	for (int i=0; i< code_data.num_crossings; i++)
 		debug << egress_bottom_label[i] << ' ';
 	debug << endl;
-	debug << "calculate_colourings: crossing_type ";
+	debug << "crossing_edge_labels: crossing_type ";
 	for (int i=0; i< code_data.num_crossings; i++)
 	{
 		if (crossing_type[i] == generic_code_data::label::VIRTUAL)		
@@ -3464,6 +3532,41 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	}
 	debug << endl;
 }
+}
+
+/* list_colourings is a list based search for colourings of a diagram described by a labelled peer code.  Colourings are represented as a vector of integer
+   colours with -1 indicating that no colour has been assigned to the corresponding edge.  A list, candidate_schemes, of potential colourings is  initialized 
+   with a candidate indicating each possible colouring of edge zero.  The function then takes the first colouring on the list and attempts to extend the 
+   colouring of a diagram at a single crossing.  The function searches the crossings in order for one having a colour assigned to at least one of the ingress edges 
+   but not having a colour assigned to one (or both) of the egress edges. 
+   
+   If such a crossing is found with colour assigned to just one ingress edge, the function considers all possible colourings for the other ingress edge and, 
+   for each one, determines the egress edge colours.  If the crossing has colour assigned to both ingress edges, the function simply determines the egress 
+   colour for the given edges.  The calculated egress colours are compared to any that have already been assigned.  If the colouring is consistent, the extended 
+   colouring is pushed onto the back of the list.  Inconsitent colourings are discarded.
+
+   If no such crossing is found and the diagram is split, the edges of the components not connected to edge zero by crossings will not have been assigned 
+   a colour, so the function considers all possible colourings of the first such edge, pushing each onto the back of the list.  Otherwise every edge will
+   have been assigned a colour, however, it is not necessarily the case that they will be globally consistent, since the colour calculated for an egress 
+   edge may not be consistent with colours already assigned at the crossing on which that edge terminates.  An example may be found in the figure 8 knot 
+   [-5 7 -1 3]/++++, where the colour calculated for edge three may, in conjunction with the 
+   edge calculated earlier for edge 6, conflict with conflict with the colours calculated for edges 4 or 7.  We therefore check each crossing for consistency
+   before accepting the colouring as valid.
+   
+   It is also possible that we may determine the same colouring twice, so the list of completed colouring_schemes is checked for a duplicate before a new
+   scheme is added.
+*/
+
+list<vector<int> > list_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td)
+{
+	vector<int> ingress_top_label;
+	vector<int> ingress_bottom_label;
+	vector<int> egress_top_label;
+	vector<int> egress_bottom_label;
+	vector<int> crossing_type;
+	crossing_edge_labels(code_data,ingress_top_label,ingress_bottom_label,egress_top_label,egress_bottom_label,crossing_type);
+
+	matrix<int>& code_table = code_data.code_table;
 	
 	list<vector<int> > candidate_schemes;	
 	list<vector<int> > colouring_schemes;	
@@ -3483,7 +3586,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-	debug << "calculate_colourings: candidate colouring ";
+	debug << "list_colourings: candidate colouring ";
 	for (int i=0; i< 2*code_data.num_crossings; i++)
 		debug << colouring[i] << ' ';
 	debug << endl;
@@ -3516,14 +3619,14 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-	debug << "calculate_colourings: extending colouring at crossing " << i << ", num_peer_colours = " << num_peer_colours << endl;
-	debug << "calculate_colourings:   even_ingress_edge_coloured = " << even_ingress_edge_coloured << ", odd_ingress_edge_coloured = " << odd_ingress_edge_coloured << endl;
+	debug << "list_colourings: extending colouring at crossing " << i << ", num_peer_colours = " << num_peer_colours << endl;
+	debug << "list_colourings:   even_ingress_edge_coloured = " << even_ingress_edge_coloured << ", odd_ingress_edge_coloured = " << odd_ingress_edge_coloured << endl;
 }
 			
 				for (int j=0; j< num_peer_colours; j++)
 				{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:   peer colour test " << j << endl;
+	debug << "list_colourings:   peer colour test " << j << endl;
 
 					if (!even_ingress_edge_coloured)
 						colouring[even_terminating] = j;
@@ -3532,7 +3635,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-	debug << "calculate_colourings:   test colouring ";
+	debug << "list_colourings:   test colouring ";
 	for (int i=0; i< 2*code_data.num_crossings; i++)
 		debug << colouring[i] << ' ';
 	debug << endl;
@@ -3542,7 +3645,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 					int ingress_bottom_colour = colouring[ingress_bottom_label[i]];
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     ingress_top_colour = " << ingress_top_colour << " ingress_bottom_colour = " << ingress_bottom_colour << endl;
+	debug << "list_colourings:     ingress_top_colour = " << ingress_top_colour << " ingress_bottom_colour = " << ingress_bottom_colour << endl;
 
 					int egress_top_colour;
 					int egress_bottom_colour;
@@ -3551,7 +3654,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 					if (crossing_type[i] == generic_code_data::label::VIRTUAL)
 					{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     virtual crossing" << endl;
+	debug << "list_colourings:     virtual crossing" << endl;
 						int temp = Td[ingress_bottom_colour][ingress_top_colour];
 						egress_top_colour = Tu[ingress_top_colour][ingress_bottom_colour];
 						egress_bottom_colour = temp;					
@@ -3559,7 +3662,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 					else if (crossing_type[i] == generic_code_data::label::POSITIVE)
 					{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     positive crossing" << endl;
+	debug << "list_colourings:     positive crossing" << endl;
 						int temp = Sd[ingress_bottom_colour][ingress_top_colour];
 						egress_top_colour = Su[ingress_top_colour][ingress_bottom_colour];
 						egress_bottom_colour = temp;
@@ -3567,14 +3670,14 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 					else // negative_crossing)
 					{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     negative crossing" << endl;
+	debug << "list_colourings:     negative crossing" << endl;
 						int temp = invSu[ingress_bottom_colour][ingress_top_colour];
 						egress_top_colour = invSd[ingress_top_colour][ingress_bottom_colour];
 						egress_bottom_colour = temp;
 					}	
 				
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     egress_top_colour = " << egress_top_colour << " egress_bottom_colour = " << egress_bottom_colour << endl;
+	debug << "list_colourings:     egress_top_colour = " << egress_top_colour << " egress_bottom_colour = " << egress_bottom_colour << endl;
 					
 					bool consistent_colouring = true;			
 					
@@ -3599,7 +3702,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-	debug << "calculate_colourings:     consistent colouring extended to ";
+	debug << "list_colourings:     consistent colouring extended to ";
 	for (int i=0; i< 2*code_data.num_crossings; i++)
 		debug << extended_colouring[i] << ' ';
 	debug << endl;
@@ -3609,12 +3712,33 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 					else
 					{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     inconsistent colouring, ignoring" << endl;							
+	debug << "list_colourings:     inconsistent colouring, ignoring" << endl;							
 					}
 				}						
 			}
 		}
 	
+		if (!found)
+		{
+			/* in a split diagram the colouring only reaches the edges connected to edge zero, so colour the first uncoloured edge in all possible ways */
+			vector<int>::iterator uncoloured_edge = find(colouring.begin(),colouring.end(),-1);
+			if (uncoloured_edge != colouring.end())
+			{
+				found = true;
+				int edge = uncoloured_edge - colouring.begin();
+
+if (debug_control::DEBUG >= debug_control::DETAIL)
+	debug << "list_colourings: no crossing to extend, colouring uncoloured edge " << edge << endl;
+
+				for (size_t j=0; j< Su.numrows(); j++)
+				{
+					vector<int> extended_colouring = colouring;
+					extended_colouring[edge] = j;
+					candidate_schemes.push_back(extended_colouring);
+				}
+			}
+		}
+		
 		if (!found)
 		{					
 			/* check each crossing to make sure the colouring is consistent Necessary since the egress edge consistency check does not take into account that the 
@@ -3649,13 +3773,13 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 				if(colouring[egress_top_label[i]] != egress_top_colour)
 				{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     inconsistence at crossing " << i << ": egress_top_colour = " << egress_top_colour << " colouring[egress_top_label[i]] = " << colouring[egress_top_label[i]] << endl;
+	debug << "list_colourings:     inconsistence at crossing " << i << ": egress_top_colour = " << egress_top_colour << " colouring[egress_top_label[i]] = " << colouring[egress_top_label[i]] << endl;
 					consistent_colouring = false;
 				}
 				else if (colouring[egress_bottom_label[i]] != egress_bottom_colour)
 				{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     inconsistence at crossing " << i << ": egress_bottom_colour = " << egress_bottom_colour << " colouring[egress_bottom_label[i]] = " << colouring[egress_bottom_label[i]] << endl;
+	debug << "list_colourings:     inconsistence at crossing " << i << ": egress_bottom_colour = " << egress_bottom_colour << " colouring[egress_bottom_label[i]] = " << colouring[egress_bottom_label[i]] << endl;
 					consistent_colouring = false;
 				}
 			}
@@ -3663,7 +3787,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 			if (consistent_colouring)
 			{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings: colouring complete, checking for duplicates...";
+	debug << "list_colourings: colouring complete, checking for duplicates...";
 	
 				if (find(colouring_schemes.begin(),colouring_schemes.end(),colouring) == colouring_schemes.end())
 				{
@@ -3675,14 +3799,6 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	debug << "to colouring_schemes" << endl;
 }
 					
-					if (braid_control::EXTRA_OUTPUT)
-					{
-						output << "H: ";
-						for (int i=0; i< 2*code_data.num_crossings; i++)
-							output << colouring[i] << ' ';
-						output << endl;
-					}
-
 					colouring_schemes.push_back(colouring);
 					
 				}
@@ -3695,7 +3811,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 			else
 			{
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "calculate_colourings:     inconsistent colouring, ignoring" << endl;							
+	debug << "list_colourings:     inconsistent colouring, ignoring" << endl;							
 			}
 		}
 		
@@ -3703,54 +3819,184 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	}
 	
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "calculate_colourings: found a total of " << colouring_schemes.size() << " colourings" << endl;							
+	debug << "list_colourings: found a total of " << colouring_schemes.size() << " colourings" << endl;							
+
+	return colouring_schemes;
+}
+
+/* calculate_colourings determines the colourings of a diagram described by a labelled peer code and passes each of them in turn to record_colouring, 
+   so that the colourings are never held together in memory.  Colourings are represented as a vector of integer colours indexed by edge.
 
+   Unless braid_control::COLOURING_ENGINE is EXHAUSTIVE, the colourings are found by a depth first colouring_search, whose variables are the edge labels 
+   and whose crossings relate the ingress colours at each crossing of the diagram to the egress colours.  The search labels the edges in an elimination 
+   order that starts at edge zero and repeatedly chooses the edge that shares the most crossings with the edges already chosen, so that the colours at as 
+   many crossings as possible are determined by propagation before another edge has to be labelled.  With the exhaustive engine, the colourings are 
+   determined by list_colourings.
+*/
+void calculate_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
+                          function<void(const vector<int>&)> record_colouring)
+{
 	if (braid_control::EXTRA_OUTPUT)
 	{
-		if (colouring_schemes.size() == 0)
-			output << "H: no colourings" << endl;
+		output << "H: ";
+		write_code_data(output, code_data);
+		output << endl;
 	}
+
+	int num_colourings = 0;
 	
-	return colouring_schemes;
+	if (braid_control::COLOURING_ENGINE == braid_control::colouring_engine::EXHAUSTIVE)
+	{
+		list<vector<int> > colourings = list_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td);
+		list<vector<int> >::iterator lptr = colourings.begin();
+		while (lptr != colourings.end())
+		{
+			if (braid_control::EXTRA_OUTPUT)
+			{
+				output << "H: ";
+				for (size_t i=0; i< lptr->size(); i++)
+					output << (*lptr)[i] << ' ';
+				output << endl;
+			}
+			
+			record_colouring(*lptr);
+			num_colourings++;
+			lptr++;
+		}
+	}
+	else
+	{
+		vector<int> ingress_top_label;
+		vector<int> ingress_bottom_label;
+		vector<int> egress_top_label;
+		vector<int> egress_bottom_label;
+		vector<int> crossing_type;
+		crossing_edge_labels(code_data,ingress_top_label,ingress_bottom_label,egress_top_label,egress_bottom_label,crossing_type);
+		
+		/* The relations take the ingress colours (top,bottom) at a crossing to the egress colours (top,bottom) */
+		int n = Su.numrows();
+		vector<int> relation_egress[3];  // positive, negative and virtual
+		for (int r=0; r<3; r++)
+			relation_egress[r] = vector<int>(n*n);
+			
+		for (int a=0; a< n; a++)
+		for (int b=0; b< n; b++)
+		{
+			int pair[3][2] = {{Su[a][b],Sd[b][a]},{invSd[a][b],invSu[b][a]},{Tu[a][b],Td[b][a]}};
+			for (int r=0; r<3; r++)
+				relation_egress[r][a*n+b] = (pair[r][0] == -1 || pair[r][1] == -1? -1: pair[r][0]*n+pair[r][1]);
+		}
+
+		int num_edges = 2*code_data.num_crossings;
+		colouring_search search(n,num_edges);
+		int relation[3];
+		for (int r=0; r<3; r++)
+			relation[r] = search.add_relation(relation_egress[r]);
+		
+		vector<vector<int> > crossing_edges(num_edges);
+		for (int i=0; i< code_data.num_crossings; i++)
+		{
+			int r = (crossing_type[i] == generic_code_data::label::POSITIVE? 0: crossing_type[i] == generic_code_data::label::NEGATIVE? 1: 2);
+			search.add_crossing(relation[r],ingress_top_label[i],ingress_bottom_label[i],egress_top_label[i],egress_bottom_label[i]);
+			
+			int edge[4] = {ingress_top_label[i],ingress_bottom_label[i],egress_top_label[i],egress_bottom_label[i]};
+			for (int j=0; j< 4; j++)
+				crossing_edges[edge[j]].push_back(i);
+		}
+
+		/* shared_crossings[e] counts the crossings that edge e shares with the edges already included in the elimination order, counted
+		   once for each such edge.
+		*/
+		vector<int> branch_order;
+		vector<int> shared_crossings(num_edges);
+		vector<bool> included(num_edges);
+		for (int k=0; k< num_edges; k++)
+		{
+			int edge = -1;
+			for (int e=0; e< num_edges; e++)
+			{
+				if (!included[e] && (edge == -1 || shared_crossings[e] > shared_crossings[edge]))
+					edge = e;
+			}
+			
+			included[edge] = true;
+			branch_order.push_back(edge);
+			
+			for (size_t j=0; j< crossing_edges[edge].size(); j++)
+			{
+				int c = crossing_edges[edge][j];
+				int incident_edge[4] = {ingress_top_label[c],ingress_bottom_label[c],egress_top_label[c],egress_bottom_label[c]};
+				for (int l=0; l< 4; l++)
+					shared_crossings[incident_edge[l]]++;
+			}
+		}
+
+if (debug_control::DEBUG >= debug_control::DETAIL)
+{
+	debug << "calculate_colourings: elimination order ";
+	for (int i=0; i< num_edges; i++)
+		debug << branch_order[i] << ' ';
+	debug << endl;
 }
+		search.set_branch_order(branch_order);
+		
+		vector<int> colouring;
+		while (search.next(colouring))
+		{
+if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
+{
+	debug << "calculate_colourings: colouring ";
+	for (int i=0; i< num_edges; i++)
+		debug << setw(3) << colouring[i] << ' ';
+	debug << endl;
+}
+			if (braid_control::EXTRA_OUTPUT)
+			{
+				output << "H: ";
+				for (int i=0; i< num_edges; i++)
+					output << colouring[i] << ' ';
+				output << endl;
+			}
+			
+			record_colouring(colouring);
+			num_colourings++;
+		}
+	}
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "calculate_colourings: found a total of " << num_colourings << " colourings" << endl;							
 
-/* cocycle_invariant determines a vector of cocycle invariant polynomials, one for each of the cocycles in the switch data, with the
-   k-chains determined by the given colourings of the given diagram.
+	if (braid_control::EXTRA_OUTPUT)
+	{
+		if (num_colourings == 0)
+			output << "H: no colourings" << endl;
+	}
+}
+
+/* cocycle_invariant adds the terms determined by the k-chain of the given colouring of the given diagram to the cocycle invariant polynomials
+   in invariant, one for each of the cocycles in the switch data, so that the invariants may be accumulated as the colourings are found by 
+   calculate_colourings.
    
    if braid_control::DOUBLE_BIRACKS the k-chains are 3-chains, otherwise they are 2-chains.  The function requires that the switch_data
    contains the appropriate type of cocycle.
 */
-//vector<polynomial<int> > cocycle_invariant(generic_code_data& code_data, generic_switch_data& switch_data, list<vector<int> >& colourings)
-vector<Cpolynomial> cocycle_invariant(generic_code_data& code_data, generic_switch_data& switch_data, list<vector<int> >& colourings)
+void cocycle_invariant(generic_code_data& code_data, generic_switch_data& switch_data, const vector<int>& colouring, vector<Cpolynomial>& invariant)
 {
 	int n = switch_data.size;				
-	int num_cocycles = switch_data.cocycle_scalar.size();
 	int num_chain_generators = switch_data.num_chain_generators;
 	matrix<int>& code_table = code_data.code_table;
 
-	/* determine whether the scalar coefficients are a field */
-	bool field_coefficients = true;
-	if (scalar::variant == scalar::scalar_variant::INT || scalar::variant == scalar::scalar_variant::BIGINT)
-		field_coefficients = false;
-
 if (debug_control::DEBUG >= debug_control::BASIC)
 {
-	debug << "cocycle_invariant: presented with switch_data: " << endl;
-	print_switch_data(debug, switch_data, "cocycle_invariant:  ");
-	debug << "cocycle_invariant: num_cocycles = " << num_cocycles << endl;	
+	debug << "cocycle_invariant: presented with colouring ";
+	for (size_t i=0; i< colouring.size(); i++)
+		debug << colouring[i] << ' ';
+	debug << endl;
+	debug << "cocycle_invariant: num_cocycles = " << switch_data.cocycle_scalar.size() << endl;	
 }
 
-	/* each colouring determines a k_chain to which we apply each cocycle, so to avoid working through the diagram crossing more than once we
-	   create a matrix k_chain, whose rows will store the three chain for each colouring.  We therefore work through the crossings of the diagram
-	   and for each one, determine the contribution to the k_chain for each colouring.
-	*/
-	matrix<int> k_chain(colourings.size(), num_chain_generators);  
-//	vector<polynomial<int> > invariant(num_cocycles);
-	vector<Cpolynomial> invariant(num_cocycles);
-
-	/* For testing whether all k-chains are boundaries */
-	matrix<int> B;
-
+	/* the colouring determines a k_chain, to which we apply each cocycle */
+	vector<int> k_chain(num_chain_generators);  
 	
 	for (int i=0; i< code_data.num_crossings; i++)
 	{
@@ -3800,32 +4046,25 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 				positive_classical = false;
 			}
 
+			/* identify the colour assigned to the lower two labels of the crossing */
+			int under_arc_colour = colouring[ingress_bottom_label];
+			int over_arc_colour = colouring[egress_bottom_label];
 			
-			int colouring_index = 0;
-			list<vector<int> >::iterator lptr =  colourings.begin();
-			while (lptr != colourings.end())
-			{
-				vector<int>& colouring = *lptr;					
-
-				/* identify the colour assigned to the lower two labels of the crossing */
-				int under_arc_colour = colouring[ingress_bottom_label];
-				int over_arc_colour = colouring[egress_bottom_label];
-				
-				if (!positive_classical)
-					swap(under_arc_colour,over_arc_colour);
+			if (!positive_classical)
+				swap(under_arc_colour,over_arc_colour);
 
-				/* The 3-tuple to which the crossing maps is (x,y,z) where x is the right label in both of the pairs
-				   on which the twitch acts, y is the left label of the under arc and z the left label of the over-arc.
-				*/
-				int under_left = under_arc_colour/n;
-				int under_right = under_arc_colour%n;
-				int over_left = over_arc_colour/n;
-				int over_right = over_arc_colour%n;
-				int sign = (positive_classical?1:-1);
+			/* The 3-tuple to which the crossing maps is (x,y,z) where x is the right label in both of the pairs
+			   on which the twitch acts, y is the left label of the under arc and z the left label of the over-arc.
+			*/
+			int under_left = under_arc_colour/n;
+			int under_right = under_arc_colour%n;
+			int over_left = over_arc_colour/n;
+			int over_right = over_arc_colour%n;
+			int sign = (positive_classical?1:-1);
 
 if (debug_control::DEBUG >= debug_control::BASIC)
 {
-	debug << "cocycle_invariant: crossing i=" << i << " colouring " << colouring_index << " under_arc_colour = " << under_arc_colour
+	debug << "cocycle_invariant: crossing i=" << i << " under_arc_colour = " << under_arc_colour
 	      << " over_arc_colour = " << over_arc_colour << endl;
 	debug << "cocycle_invariant:     under_left = " << under_left << ", under_right = " << under_right 
 	      << ", over_left = " << over_left << ", over_right = " << over_right << endl;
@@ -3835,180 +4074,216 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 		debug << "cocycle_invariant:     tuple = (" << under_arc_colour << ',' << over_arc_colour << ") sign " << sign << endl;
 	
 }				
-				int tuple;
-				if (braid_control::DOUBLE_BIRACKS)
-					tuple = n*n*under_right+n*under_left+over_left;
-				else
-					tuple = n*under_arc_colour+over_arc_colour;
+			int tuple;
+			if (braid_control::DOUBLE_BIRACKS)
+				tuple = n*n*under_right+n*under_left+over_left;
+			else
+				tuple = n*under_arc_colour+over_arc_colour;
 
-				if (braid_control::BIRACK_HOMOLOGY)
-				{
+			if (braid_control::BIRACK_HOMOLOGY)
+			{
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << "cocycle_invariant: tuple = " << tuple << endl;				
-	
-					/* positive crossing map to negative triple points, negative crossings to positive triple points */
-					k_chain[colouring_index][tuple] -= sign;
+
+				/* positive crossing map to negative triple points, negative crossings to positive triple points */
+				k_chain[tuple] -= sign;
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "cocycle_invariant:   updated k_chain[" << colouring_index << "][" << tuple << "] to " << k_chain[colouring_index][tuple] << endl;		
-	
-				}
-				else
-				{
-	
-					int non_degenerate_tuple = switch_data.chain_map[tuple];
+	debug << "cocycle_invariant:   updated k_chain[" << tuple << "] to " << k_chain[tuple] << endl;		
+
+			}
+			else
+			{
+				int non_degenerate_tuple = switch_data.chain_map[tuple];
 
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << "cocycle_invariant:     tuple = " << tuple << ", non_degenerate_tuple = " << non_degenerate_tuple << endl;				
-											
-					if (non_degenerate_tuple != -1)
-					{
-						/* positive crossing map to negative triple points, negative crossings to positive triple points */
-						k_chain[colouring_index][non_degenerate_tuple] -= sign;
-									
+										
+				if (non_degenerate_tuple != -1)
+				{
+					/* positive crossing map to negative triple points, negative crossings to positive triple points */
+					k_chain[non_degenerate_tuple] -= sign;
+								
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "cocycle_invariant:     updated k_chain[" << colouring_index << "][" << non_degenerate_tuple << "] to " << k_chain[colouring_index][non_degenerate_tuple] << endl;		
-					}
+	debug << "cocycle_invariant:     updated k_chain[" << non_degenerate_tuple << "] to " << k_chain[non_degenerate_tuple] << endl;		
 				}
+			}
 
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 {
 	debug << "cocycle_invariant:  3-chain stands at ";
 	for (int i=0; i< num_chain_generators; i++)
-		debug << k_chain[colouring_index][i] << ' ';
+		debug << k_chain[i] << ' ';
 	debug << endl;
 }		
-
-				colouring_index++;
-				lptr++;
-			}
 		}					
 	}
 
-if (debug_control::DEBUG >= debug_control::BASIC)	
-{
-	debug << "cocycle_invariant: k_chain, rows of :"<< endl;
-	print(k_chain, debug,3,"cocycle_invariant: ");
-}				
-	/* boundary test for k-chain */
-	if (B.numcols())
-	{
-		matrix<int> B_copy=B;
-		matrix<int> B_P;
-		echelon(B_copy,field_coefficients,true,&B_P);
-
-if (debug_control::DEBUG >= debug_control::DETAIL)	
-{
-	debug << "cocycle_invariant: change of basis matrix B_P: " << endl;
-	print(B_P, debug,3,"cocycle_invariant: ");
-}				
-					
-		matrix<int> chains(num_chain_generators,B.numcols()+k_chain.numrows());
-
-		for (size_t c=0; c< B.numcols(); c++)
-		for (int i=0; i< num_chain_generators; i++)
-			chains[i][c] = B[i][c];
-		
-		for (size_t r=0; r< k_chain.numrows(); r++)
-		for (int i=0; i< num_chain_generators; i++)
-			chains[i][B.numcols()+r] = k_chain[r][i];
-
-if (debug_control::DEBUG >= debug_control::DETAIL)	
-{
-	debug << "cocycle_invariant: chains: " << num_chain_generators << " x  " << B.numcols()+k_chain.numrows() << endl;
-	print(chains, debug,3,"cocycle_invariant: ");
-}				
-
-		matrix<int> chains_COB = B_P*chains;
-				
-if (debug_control::DEBUG >= debug_control::DETAIL)	
-{
-	debug << "cocycle_invariant: chains_COB: " << endl;
-	print(chains_COB, debug,3,"cocycle_invariant: ");
-}				
-	}
-	/* end of boundary test for k-chain */
-	
-	for (size_t c=0; c< colourings.size(); c++)
-	{
-
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 {
 	debug << "cocycle_invariant:  3-chain corresponding to colouring " ;
 		for (int i=0; i< num_chain_generators; i++)
-			debug << setw(3) << k_chain[c][i];
+			debug << setw(3) << k_chain[i];
 		debug << endl;
 }
 
-		if(!braid_control::RAW_OUTPUT && braid_control::EXTRA_OUTPUT)
-		{
-			output << "k-chain ";
-			vector<int> chain_vector(num_chain_generators);
-			
-			for (int i=0; i< num_chain_generators; i++)
-			{
-				output << k_chain[c][i] << ' ';
-				chain_vector[i] = k_chain[c][i];
-			}
-			print_k_chain(output, chain_vector, switch_data,(braid_control::DOUBLE_BIRACKS?3:2));
-			output << endl;
-		}					
-						
-/*	
-		int number_of_k_tuples = 0;
+	if(!braid_control::RAW_OUTPUT && braid_control::EXTRA_OUTPUT)
+	{
+		output << "k-chain ";
 		for (int i=0; i< num_chain_generators; i++)
-			number_of_k_tuples += abs(k_chain[c][i]);
-					
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-	debug << "cocycle_invariant:  3-chain " << c << " contains " << number_of_k_tuples << " 3-tuples" << endl;
-*/	
-		list<vector<scalar> >::iterator lptr = switch_data.cocycle_scalar.begin();
-		int cocycle_index = 0;
-		char variable_char = 's'; //(braid_control::BIRACK_POLYNOMIAL? 's': 't');
+			output << k_chain[i] << ' ';
+		print_k_chain(output, k_chain, switch_data,(braid_control::DOUBLE_BIRACKS?3:2));
+		output << endl;
+	}					
+						
+	list<vector<scalar> >::iterator lptr = switch_data.cocycle_scalar.begin();
+	int cocycle_index = 0;
+	char variable_char = 's'; //(braid_control::BIRACK_POLYNOMIAL? 's': 't');
 
-		while (lptr != switch_data.cocycle_scalar.end())
-		{
+	while (lptr != switch_data.cocycle_scalar.end())
+	{
 
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << "cocycle_invariant:  cocycle " << cocycle_index << "                          ";
 		vector<scalar>& cocycle=*lptr;
+	
+		scalar exponent = 0; // the exponent lies in the coefficient group of the cocycle, so is a scalar
 		
-			scalar exponent = 0; // the exponent lies in the coefficient group of the cocycle, so is a scalar
-			
-			for (int i=0; i< num_chain_generators; i++)
-			{
+		for (int i=0; i< num_chain_generators; i++)
+		{
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << setw(3) << cocycle[i];
-					exponent += k_chain[c][i]*cocycle[i];
-			}
+				exponent += k_chain[i]*cocycle[i];
+		}
 
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << ": exponent = " << exponent;
-	
-			ostringstream oss;
-			if (exponent == scalar(0))
-				oss << "1";
-			else if (exponent == scalar(1))
-				oss << variable_char;
-			else
-				oss << variable_char << "^" << exponent;
-	
-			Cpolynomial term(oss.str());
-	
+
+		ostringstream oss;
+		if (exponent == scalar(0))
+			oss << "1";
+		else if (exponent == scalar(1))
+			oss << variable_char;
+		else
+			oss << variable_char << "^" << exponent;
+
+		Cpolynomial term(oss.str());
+
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << ", term = " << term;
-	
-			invariant[cocycle_index] += term;
-					
+
+		invariant[cocycle_index] += term;
+				
 if (debug_control::DEBUG >= debug_control::BASIC)
 	debug << ", invariant = " << invariant[cocycle_index] << endl;
-					
-			cocycle_index++;
-			lptr++;
-		}
+				
+		cocycle_index++;
+		lptr++;
 	}
+}
+
+/* code_data_colourings evaluates the colourings of the diagram described by code_data, returning the number of colourings together with, if
+   refine is true, the number of colourings whose image has a smallest parent birack of each size or, if braid_control::COCYCLE_INVARIANT
+   is set, the cocycle invariants for each of the cocycles in switch_data.  The colourings are passed to record_colouring as they are 
+   found, so they are never held together in memory.
+*/
+colouring_data code_data_colourings(generic_code_data& code_data, matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, 
+                                    matrix<int>& Tu, matrix<int>& Td, generic_switch_data& switch_data, bool refine)
+{
+	int n = Su.numcols();
+	
+	/* With the threads option the colourings may have been evaluated in advance by batch_colouring_invariant, or are to be recorded for 
+	   evaluation in advance, see batch_colouring_data.
+	*/
+	if (switch_data.batch_recording || switch_data.batch_colourings.size())
+	{
+		ostringstream oss;
+		write_peer_code(oss,code_data);
+		
+		auto evaluate = [=,&switch_data]() mutable {return code_data_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td,switch_data,refine);};
+		
+		colouring_data result;
+		if (batch_colouring_data(switch_data,oss.str(),n,evaluate,result))
+			return result;
+	}
+	
+	int num_colourings = 0;
+	vector<int> image_size_count(n);
+	vector<Cpolynomial> invariant(switch_data.cocycle_scalar.size());
+	
+		auto record_colouring = [&](const vector<int>& colouring)
+		{
+			num_colourings++;
+			
+			if (refine)
+			{
+				/* identify the labels used in the colouring */
+				vector<int> labels(n);
+				for (size_t i=0; i< colouring.size(); i++)
+					labels[colouring[i]] = 1;
+
+if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
+{
+	debug << "code_data_colourings:  cumulative label record ";
+	for (int j=0; j< n; j++)
+	debug << labels[j] << ' ';	
+	debug << endl;
+}							
+				int num_labels=0;
+				for (int i=0; i< n; i++)
+					num_labels += labels[i];
+					
+				vector<int> label_values(num_labels);
+				int index=0;
+				for (int i=0; i< n; i++)
+				{
+					if (labels[i] == 1)
+						label_values[index++] = i;
+				}
 	
-	return invariant;
+				vector<int> parent_birack = smallest_parent_birack(Su,Sd,label_values);
+	
+				int image_size=parent_birack.size();
+			
+
+if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
+{
+	debug << "code_data_colourings:  image_size = " << image_size;
+	debug << " labels: ";
+	for (int j=0; j< n; j++)
+	debug << labels[j] << ' ';	
+	debug << endl;
+
+	debug << "code_data_colourings:  parent_birack: ";
+	for (int j=0; j< image_size; j++)
+	debug << parent_birack[j] << ' ';	
+	
+	for (int j=image_size; j< n; j++)
+	debug << "  ";
+	
+	debug << "numbering from 1: ";
+	for (int j=0; j< image_size; j++)
+	debug << parent_birack[j]+1 << ' ';	
+	debug << endl;
+}
+				image_size_count[image_size-1] ++;
+			}
+			else if (braid_control::COCYCLE_INVARIANT && invariant.size() != 0)
+			{
+				cocycle_invariant(code_data,switch_data,colouring,invariant);
+			}
+		};
+		
+
+	
+	calculate_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td,record_colouring);
+	
+	colouring_data result;
+	result.num_fixed_points = num_colourings;
+	result.num_cocycle_invariants = invariant.size();
+	result.cocycle_invariant = invariant;
+	result.image_size_count = image_size_count;
+	return result;
 }
 
 /* peer_code_colouring_invariant evaluates invariants based on colourings of a diagram described by code_data.  It supports
@@ -4022,7 +4297,7 @@ if (debug_control::DEBUG >= debug_control::BASIC)
    to describe the number of colourings as a polynomial \Sum x_i s^i whose coefficient x_i are the number of colourings of size i.
 */
 void peer_code_colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td,
-			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period)
+			braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, int period, ostream& os, ostream& output_os)
 {	
 	int n = Su.numcols();  // can't use switch_data.size, since Su,Sd may be the double of the underlying switch in switch_data
 	int writhe = 0;
@@ -4092,17 +4367,17 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 	   	if (!braid_control::SILENT_OPERATION)
 	   	{
-			cout << "reflected input ";
-			write_code_data(cout,code_data);
-			cout << endl;
+			os << "reflected input ";
+			write_code_data(os,code_data);
+			os << endl;
 		}
 
 		if (!braid_control::RAW_OUTPUT)
 		{
-			output << (braid_control::OUTPUT_AS_INPUT? ";" : "");
-			output << "reflected input ";
-			write_code_data(output,code_data);
-			output << endl;
+			output_os << (braid_control::OUTPUT_AS_INPUT? ";" : "");
+			output_os << "reflected input ";
+			write_code_data(output_os,code_data);
+			output_os << endl;
 		}
 	}	
 	
@@ -4128,17 +4403,17 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 }
 	   	if (!braid_control::SILENT_OPERATION)
 	   	{
-			cout << "reversed input ";
-			write_code_data(cout,code_data);
-			cout << endl;
+			os << "reversed input ";
+			write_code_data(os,code_data);
+			os << endl;
 		}
 
 		if (!braid_control::RAW_OUTPUT)
 		{
-			output << (braid_control::OUTPUT_AS_INPUT? ";" : "");
-			output << "reversed input ";
-			write_code_data(output,code_data);
-			output << endl;
+			output_os << (braid_control::OUTPUT_AS_INPUT? ";" : "");
+			output_os << "reversed input ";
+			write_code_data(output_os,code_data);
+			output_os << endl;
 		}
 	}
 
@@ -4154,14 +4429,14 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		if (switch_data.cocycles_calculated == false)
 		{
 			if (!braid_control::SILENT_OPERATION)
-				cout << "switch_data does not contain cocycles" << endl;
+				os << "switch_data does not contain cocycles" << endl;
 				
 			bool hold_silent_operation = braid_control::SILENT_OPERATION;
 			
 			if (braid_control::RAW_OUTPUT)
 				braid_control::SILENT_OPERATION = true;
 				
-			birack_homology_generators(switch_data,(braid_control::DOUBLE_BIRACKS?3:2),true); //cohomology = true
+			birack_homology_generators(switch_data,(braid_control::DOUBLE_BIRACKS?3:2),true,0,os,output_os); //cohomology = true
 			
 			braid_control::SILENT_OPERATION = hold_silent_operation;
 			
@@ -4171,7 +4446,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		else
 		{
 			if (!braid_control::SILENT_OPERATION)
-				cout << "switch_data contains cocycles" << endl;
+				os << "switch_data contains cocycles" << endl;
 		}
 				
 		/* birack_homology_generators has calculated all the cohomology generators, recording them in switch_data.cocycle_string,
@@ -4182,10 +4457,10 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		{
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "peer_code_colouring_invariant: no integer cocycles found in switch data" << endl;
-			determine_cohomology_generators(switch_data);		
+			determine_cohomology_generators(switch_data,os,output_os);		
 								
 			if (check_cocycle_conditions)
-				test_cohomology_generators(switch_data);
+				test_cohomology_generators(switch_data,os,output_os);
 			
 		}
 		else
@@ -4272,12 +4547,12 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		matrix<Cpolynomial,int> coefficient_poly(num_invariants,num_invariant_terms);
 	
 		if (braid_control::BIRACK_POLYNOMIAL && !braid_control::SILENT_OPERATION) // && braid_control::EXTRA_OUTPUT)
-			cout << "term " ;
+			os << "term " ;
 
 		for (int i=0; i< num_invariant_terms; i++)
 		{
 			if (braid_control::BIRACK_POLYNOMIAL && !braid_control::SILENT_OPERATION) // && braid_control::EXTRA_OUTPUT)
-				cout << i << ' ' << flush;
+				os << i << ' ' << flush;
 			
 			if (braid_control::COCYCLE_INVARIANT)
 			{
@@ -4308,9 +4583,10 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				
 			}
 			
-			list<vector<int> > colourings = calculate_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td);
-			
-			int num_colourings = colourings.size();
+			colouring_data c_data = code_data_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td,switch_data,braid_control::REFINE_RACK_POLYNOMIAL);
+			int num_colourings = c_data.num_fixed_points;
+			vector<int>& image_size_count = c_data.image_size_count;
+			vector<Cpolynomial>& invariant = c_data.cocycle_invariant;
 					
 			/* we need exponent to be positive but the % operator can give negative results: n = -1 p = 5 n%p = -1 (n%p+p)%p = 4 */
 			int exponent = (braid_control::COCYCLE_INVARIANT? i:((writhe+i)%period+period)%period); 
@@ -4321,64 +4597,6 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 										
 			if (braid_control::REFINE_RACK_POLYNOMIAL)
 			{
-				vector<int> image_size_count(n);
-				list<vector<int> >::iterator lptr = colourings.begin();
-				
-				while (lptr != colourings.end())
-				{
-					/* identify the labels used in the colouring lptr*/
-					vector<int> labels(n);
-					for (size_t i=0; i< (*lptr).size(); i++)
-						labels[(*lptr)[i]] = 1;
-
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-{
-	debug << "peer_code_colouring_invariant:  cumulative label record ";
-	for (int j=0; j< n; j++)
-		debug << labels[j] << ' ';	
-	debug << endl;
-}							
-					int num_labels=0;
-					for (int i=0; i< n; i++)
-						num_labels += labels[i];
-						
-					vector<int> label_values(num_labels);
-					int index=0;
-					for (int i=0; i< n; i++)
-					{
-						if (labels[i] == 1)
-							label_values[index++] = i;
-					}
-		
-					vector<int> parent_birack = smallest_parent_birack(Su,Sd,label_values);
-		
-					int image_size=parent_birack.size();
-				
-
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-{
-	debug << "peer_code_colouring_invariant:  image_size = " << image_size;
-	debug << " labels: ";
-	for (int j=0; j< n; j++)
-		debug << labels[j] << ' ';	
-	debug << endl;
-
-	debug << "peer_code_colouring_invariant:  parent_birack: ";
-	for (int j=0; j< image_size; j++)
-		debug << parent_birack[j] << ' ';	
-	
-	for (int j=image_size; j< n; j++)
-		debug << "  ";
-		
-	debug << "numbering from 1: ";
-	for (int j=0; j< image_size; j++)
-		debug << parent_birack[j]+1 << ' ';	
-	debug << endl;
-}
-					image_size_count[image_size-1] ++;
-					lptr++;
-				}
-
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 {
   	debug << "peer_code_colouring_invariant:   number of colourings =  " << num_colourings << endl;
@@ -4418,9 +4636,6 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			}
 			else if (braid_control::COCYCLE_INVARIANT)
 			{
-//				vector<polynomial<int> > invariant = cocycle_invariant(code_data,switch_data,colourings);		
-				vector<Cpolynomial> invariant = cocycle_invariant(code_data,switch_data,colourings);		
-						
 				/* set coefficient_poly[exponent] to the first cocycle invariant for the colourings of this writhe */
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
@@ -4461,16 +4676,16 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			{
 				
 				if (braid_control::BIRACK_POLYNOMIAL)
-					cout << endl;
+					os << endl;
 				
 				for (int i=0; i< num_invariants; i++)
 				{
 					bool first_term = true;
 					
 					if(braid_control::COCYCLE_INVARIANT)
-						cout << "Cocycle " << i+1 << " birack polynomial = ";
+						os << "Cocycle " << i+1 << " birack polynomial = ";
 					else
-						cout << "Birack polynomial = ";
+						os << "Birack polynomial = ";
 						
 					for (int j=num_invariant_terms-1; j >=0; j--)
 					{
@@ -4487,33 +4702,33 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 							if (!first_term)
 							{
 								if  (parentheses || !coefficient_poly[i][j].is_negative())
-									cout << '+';
+									os << '+';
 								else if (coefficient_poly[i][j].is_minus_one())
-									cout << '-';
+									os << '-';
 							}
 							
-							if (parentheses) 						cout << "(";
-							if (!coefficient_poly[i][j].is_one()|| exponent == 0)	cout << coefficient_poly[i][j];
-							if (parentheses)						cout << ")";
+							if (parentheses) 						os << "(";
+							if (!coefficient_poly[i][j].is_one()|| exponent == 0)	os << coefficient_poly[i][j];
+							if (parentheses)						os << ")";
 							
 							if (exponent != 0)
 							{
-								cout << 't';
+								os << 't';
 								if (exponent !=1)
 								{
-									cout << '^';
-									cout << exponent;
+									os << '^';
+									os << exponent;
 								}
 							}							
 							first_term = false;
 						}
 					}
-					cout << endl;
+					os << endl;
 				}
 			}
 			else
 			{
-				cout << "Birack polynomial = " << birack_poly << endl;
+				os << "Birack polynomial = " << birack_poly << endl;
 			}
 		}
 
@@ -4524,11 +4739,11 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			{
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 					if(braid_control::COCYCLE_INVARIANT)
-						output << "Cocycle " << i+1 << " birack polynomial = ";
+						output_os << "Cocycle " << i+1 << " birack polynomial = ";
 					else
-						output << "Birack polynomial = ";
+						output_os << "Birack polynomial = ";
 				}
 
 				bool first_term=true;
@@ -4551,14 +4766,14 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 						if (!first_term)
 						{
 							if  (parentheses || !coefficient_poly[i][j].is_negative())
-								output << '+';
+								output_os << '+';
 							else if (coefficient_poly[i][j].is_minus_one())
-								output << '-';
+								output_os << '-';
 						}
 						
-						if (parentheses) 						output << "(";
-						if (!coefficient_poly[i][j].is_one()|| exponent == 0)	output << coefficient_poly[i][j];
-						if (parentheses)						output << ")";	
+						if (parentheses) 						output_os << "(";
+						if (!coefficient_poly[i][j].is_one()|| exponent == 0)	output_os << coefficient_poly[i][j];
+						if (parentheses)						output_os << ")";	
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
@@ -4569,47 +4784,47 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 }						
 						if (exponent != 0)
 						{
-							output << 't';
+							output_os << 't';
 							if (exponent != 1)
 							{
-								output << '^';
-								output << exponent;
+								output_os << '^';
+								output_os << exponent;
 							}
 						}							
 						first_term = false;
 					}
 				}
-				output << endl;
+				output_os << endl;
 			}
 		}
 		else
 		{
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << "Birack polynomial = ";
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "Birack polynomial = ";
 			}
 			
-			output << birack_poly << endl;
+			output_os << birack_poly << endl;
 		}
 		
     	if (braid_control::EXTRA_OUTPUT)
     	{
 			if (!braid_control::REFINE_RACK_POLYNOMIAL && !braid_control::COCYCLE_INVARIANT)
 			{
-				cout << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";
+				os << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";
 
 				for (int i=0; i < period; i++)
-					cout << rack_poly_coefficients[i] << ' ';
-				cout << endl;
+					os << rack_poly_coefficients[i] << ' ';
+				os << endl;
 
 		    	if (!braid_control::RAW_OUTPUT)
 				{
-					output << "Birack polynomial " << birack_poly << endl;
-					output << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";					
+					output_os << "Birack polynomial " << birack_poly << endl;
+					output_os << "Birack polynomial coefficients t^0 to t^" << period-1 << ": ";					
 					for (int i=0; i < period; i++)
-						output << rack_poly_coefficients[i] << ' ';
-					output << endl;			
+						output_os << rack_poly_coefficients[i] << ' ';
+					output_os << endl;			
 				}
 			}
 		}	
@@ -4635,17 +4850,15 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	}
 	else if (braid_control::COCYCLE_INVARIANT)
 	{			
-		list<vector<int> > colourings = calculate_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td);
-
 		int num_cocycles = switch_data.cocycle_scalar.size();
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
     debug << "peer_code_colouring_invariant: calculating cocycle_invariant with num_cocycles = " << num_cocycles << endl;
 			
+		vector<Cpolynomial> invariant = code_data_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td,switch_data,false).cocycle_invariant;
+
 		if (num_cocycles != 0)
 		{
-//			vector<polynomial<int> > invariant = cocycle_invariant(code_data,switch_data,colourings);		
-			vector<Cpolynomial> invariant = cocycle_invariant(code_data,switch_data,colourings);		
 
 			list<string>::iterator lptr=switch_data.cocycle_string.begin();
 			int cocycle_index=0;
@@ -4655,8 +4868,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				
 				if (!braid_control::SILENT_OPERATION)
 				{
-					cout << "\ncocycle " << *lptr << endl;
-					cout << "invariant " << invariant[cocycle_index] << endl;
+					os << "\ncocycle " << *lptr << endl;
+					os << "invariant " << invariant[cocycle_index] << endl;
 				}
 		    
 				if (!braid_control::RAW_OUTPUT)
@@ -4664,8 +4877,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 					
 if (true && invariant[cocycle_index].nv >0) // added only to identify non trivial output easily for inclusion in a paper 
 {					
-	output << (braid_control::OUTPUT_AS_INPUT? "\n;XX " : "\nXX ");					
-	write_peer_code(output,code_data);
+	output_os << (braid_control::OUTPUT_AS_INPUT? "\n;XX " : "\nXX ");					
+	write_peer_code(output_os,code_data);
 
 	int size = switch_data.size;
 	matrix<int> twitch_u(size,size,-1);
@@ -4688,27 +4901,27 @@ if (true && invariant[cocycle_index].nv >0) // added only to identify non trivia
 	}
 	bool saved_bool = matrix_control::SINGLE_LINE_OUTPUT;
 	matrix_control::SINGLE_LINE_OUTPUT = true;
-	output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");					
-	output << "XX Su = ";
-	display_fixed_point_switch(twitch_u, output, false);
+	output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");					
+	output_os << "XX Su = ";
+	display_fixed_point_switch(twitch_u, output_os, false);
 //	display_fixed_point_switch(switch_data.Su, output, false);
-	output << " Sd = ";
-	display_fixed_point_switch(twitch_d, output, false);
+	output_os << " Sd = ";
+	display_fixed_point_switch(twitch_d, output_os, false);
 //	display_fixed_point_switch(switch_data.Sd, output, false);
 	matrix_control::SINGLE_LINE_OUTPUT = saved_bool;
 
-	output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-	output << "XX cocycle " << cocycle_index+1 << ": " << *lptr << endl;
-	output << "XX invariant ";
+	output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+	output_os << "XX cocycle " << cocycle_index+1 << ": " << *lptr << endl;
+	output_os << "XX invariant ";
 }
 else
 {				
-		    		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-					output << "cocycle " << cocycle_index+1 << ": " << *lptr << endl;
-					output << "invariant ";
+		    		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					output_os << "cocycle " << cocycle_index+1 << ": " << *lptr << endl;
+					output_os << "invariant ";
 }				
 		    	}
-		    	output << invariant[cocycle_index] << endl;
+		    	output_os << invariant[cocycle_index] << endl;
 		    	
 				lptr++;
 				cocycle_index++;
@@ -4717,19 +4930,17 @@ else
 	}
 	else
 	{
-		list<vector<int> > colourings = calculate_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td);
-
-		int fixed_points = colourings.size();
+		int fixed_points = code_data_colourings(code_data,Su,Sd,invSu,invSd,Tu,Td,switch_data,false).num_fixed_points;
     	
 		if (!braid_control::SILENT_OPERATION)
-			cout <<"\nNumber of fixed-points = " << fixed_points << endl;
+			os <<"\nNumber of fixed-points = " << fixed_points << endl;
     
 		if (!braid_control::RAW_OUTPUT)
     	{
-    		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-    		output << "Number of fixed points = ";
+    		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+    		output_os << "Number of fixed points = ";
     	}
-    	output << fixed_points << endl;
+    	output_os << fixed_points << endl;
 		    
 if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
     debug << "peer_code_colouring_invariant: total number of fixed points = " << fixed_points << endl;
@@ -1,6 +1,7 @@
 /**************************************************************************
 
-void hamiltonian_circuit(generic_code_data& code_data)
+long hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit, int include_edge,
+                         function<void(const vector<int>&)> record_circuit)
 
  **************************************************************************/
 #include <string>
@@ -12,6 +13,9 @@ void hamiltonian_circuit(generic_code_data& code_data)
 #include <valarray>
 #include <list>
 #include <map>
+#include <set>
+#include <unordered_set>
+#include <functional>
 #include <iomanip>
 #include <ctype.h>
 #include <stdio.h>
@@ -26,12 +30,18 @@ extern ifstream     input;
 #include <util.h>
 #include <matrix.h>
 #include <debug-control.h>
+#include <braid-control.h>
 #include <generic-code.h>
 #include <gauss-orientation.h>
 
 bool gauss_to_peer_code(generic_code_data gauss_code_data, generic_code_data& peer_code_data, bool optimal=true, vector<int>* gauss_crossing_perm=0, bool evaluate_gauss_crossing_perm=false);
 
-list<vector<int> > hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit, int include_edge)
+/* hamiltonian_circuit searches for the Hamiltonian circuits in the diagram described by code_data, passing each circuit to 
+   record_circuit as it is found, unless count_circuits_only is set, and returns the number of circuits found.  If neither 
+   list_all_circuits nor count_circuits_only is set, the search stops once a circuit has been found.
+*/
+long hamiltonian_circuit(generic_code_data& code_data, bool list_all_circuits, bool count_circuits_only, bool edge_circuit, int include_edge,
+                         function<void(const vector<int>&)> record_circuit)
 {
 if (debug_control::DEBUG >= debug_control::SUMMARY)	
 {
@@ -41,8 +51,6 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	print_code_data(debug,code_data,"hamiltonian_circuit: ");
 }
 
-	list<vector<int> > circuit_list;
-
 	generic_code_data peer_code_data;
 	if(code_data.type == generic_code_data::gauss_code)
 	{
@@ -61,7 +69,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "generic_code: Error converting Gauss code to peer code, doing nothing" << endl;
 	
-			return circuit_list;
+			return 0;
 		}
 	}
 	else
@@ -92,7 +100,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "hamiltonian_circuit: Hamiltonian circuits not defined for diagrams including virtual crossings, doing nothing" << endl;
 	
-		return circuit_list;
+		return 0;
 	}
 
 	int num_cycles;
@@ -235,9 +243,20 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	   as consecutive entries in each row.
 	   num_boundary_vertices will hold the number of valid entries: that is, the number of crossings in the boundary
 	   of each region
+	   
+	   A region may meet the same crossing more than once, for example at a nugatory crossing or where a split component lies 
+	   inside it, so we size place_map from the largest number of boundary vertices rather than from num_crossings.
 	*/
-	matrix<int> place_map(num_cycles,2*num_crossings);
 	vector<int> num_boundary_vertices(num_cycles);
+	for (int i=0; i< num_crossings; i++)
+	{
+		for (int j=0; j< 4; j++)
+			num_boundary_vertices[crossing_region[i][j]]++;
+	}
+	
+	int max_boundary_vertices = *max_element(num_boundary_vertices.begin(),num_boundary_vertices.end());
+	matrix<int> place_map(num_cycles,2*max_boundary_vertices);
+	num_boundary_vertices = vector<int>(num_cycles);
 	
 	for (int i=0; i< num_crossings; i++)
 	{
@@ -262,20 +281,53 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	}
 }
 	
-	/* We record the colour associated with each region in a vector that we increment as a binary number RED = 0, BLUE = 1 */
+	/* We colour the regions RED = 0 or BLUE = 1 depth first, in the order of their index, so that colourings are considered in
+	   ascending order when colour_map is regarded as a binary number.  Interchanging RED and BLUE yields the same circuit, 
+	   since we always traverse circuits in the same direction regardless of colour polarity, so region 0 is always coloured RED.  
+	   
+	   The colours around a crossing are determined once its max_region is coloured, so completed_crossings[r] records the 
+	   crossings whose max_region is r and these crossings are checked as soon as region r is coloured.  A partial colouring 
+	   that is invalid at some crossing is therefore not extended.
+	*/
 	int RED = 0;
 	int BLUE= 1;
 
-	vector<int> colour_map(num_cycles,RED);
-			
-	bool not_finished = true;
-	do
+	vector<vector<int> > completed_crossings(num_cycles);
+	for (int i=0; i< num_crossings; i++)
+		completed_crossings[max_region[i]].push_back(i);
+
+	/* valid_region_colour checks each crossing completed by colouring region has at least one region of each colour around it 
+	   and does not have opposite regions of the same colour
+	*/
+	auto valid_region_colour = [&](const vector<int>& colour_map, int region) -> bool
 	{
-		bool contains_include_edge = true; 
-		
-		if (include_edge != -1)
-			contains_include_edge = false;
+		for (size_t i=0; i< completed_crossings[region].size(); i++)
+		{
+			int crossing = completed_crossings[region][i];
+			int colour[4];
+			int colour_sum = 0;
+			for (int j=0; j< 4; j++)
+			{
+				colour[j] = colour_map[crossing_region[crossing][j]];
+				colour_sum += colour[j];
+			}
+			
+			if (colour_sum == 0 || colour_sum == 4 || (colour[0] == colour[2] && colour[1] == colour[3]))
+			{
+if (debug_control::DEBUG >= debug_control::DETAIL)
+	debug << "hamiltonian_circuit: colouring region " << region << (colour_map[region] == RED? " RED": " BLUE") << " is invalid at crossing " << crossing << endl;
+
+				return false;
+			}
+		}
+		return true;
+	};
 
+	/* trace_boundary traces the boundary of a valid colour_map from crossing zero, recording the crossings, or edges, in circuit.
+	   It returns true if the boundary is a Hamiltonian circuit containing the include_edge.
+	*/
+	auto trace_boundary = [&](const vector<int>& colour_map, vector<int>& circuit) -> bool
+	{
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {	
 	debug << "hamiltonian_circuit: colour_map: ";
@@ -283,6 +335,11 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << (colour_map[i] == RED? "R ": "B ");
 	debug << endl;
 }		
+		bool contains_include_edge = true; 
+	
+		if (include_edge != -1)
+			contains_include_edge = false;
+
 		/* record the colour of the regions around each crossing when coloured with colour_map */
 		matrix<int> crossing_colour(num_crossings,4);
 		for (int i=0; i< num_cycles; i++)
@@ -291,371 +348,324 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				crossing_colour[place_map[i][2*j]][place_map[i][2*j+1]] = colour_map[i];				
 		}
 
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{	
-	debug << "hamiltonian_circuit: crossing_colour: " << endl;
-	for (int i=0; i< num_crossings; i++)
-	{
-		debug << "hamiltonian_circuit:   ";
-		for (int j=0; j< 4; j++)
-			debug << (crossing_colour[i][j] == RED? "R ": "B ");
-		debug << endl;
-	}
-}
-
-		/* reject any colour_map that doesn't result in at least one region of each colour at each crossing 
-		   if we sum the region colours at each crossing we should not get a total of zero or four.
-		*/
-		bool valid_colour_map = true;
+		circuit = vector<int>(num_crossings);
+		circuit[0] = 0;
 		
-		for (int i=0; i< num_crossings; i++)
-		{
-			int colour_sum = 0;
-			for (int j=0; j< 4; j++)
-				colour_sum += crossing_colour[i][j];
-				
-			if (colour_sum == 0) // all RED
-			{
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "hamiltonian_circuit: all regions around crossing " << i << " coloured RED." << endl;
+		debug << "hamiltonian_circuit: trace boundary of colour_map starting at crossing zero" << endl;
+	
+		/* find an edge incident with crossing zero that lies in the colour boundary and determine whether we are going forwards
+		   or backwards with respect to the label orientation when we leave the crossing on the selected edge.
+		*/
+		int edge = 0;
+		bool forwards=false;
 
-				valid_colour_map = false;				
-				colour_map[max_region[i]] = BLUE;
-				
-				for (int j=max_region[i]+1; j< num_cycles; j++)
-					colour_map[j] = RED;
-					
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{	
-	debug << "hamiltonian_circuit: incremented colour_map: ";
-	for (int i=0; i< num_cycles; i++)
-		debug << (colour_map[i] == RED? "R ": "B ");
-	debug << endl;
-}
+		int peer = code_table[generic_code_data::table::OPEER][0];
+		int peer_component = 0;
+		for (int i=1; i< num_components; i++)
+		{
+			if (peer >= first_edge_on_component[i])
+				peer_component++;
+			else
 				break;
-			}
-			else if (colour_sum == 4) // all BLUE
-			{				
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{	
-	debug << "hamiltonian_circuit: all regions around crossing " << i << " coloured BLUE" << endl;
-}
-				valid_colour_map = false;
-				not_finished = false;
-//				for (int j= min_region[i]; j>=0; j--)
-				for (int j= max_region[i]; j>=0; j--)
-				{
-					if (colour_map[j] == RED)
-					{
-						colour_map[j] = BLUE;
+		}			
+		int peer_successor = (peer+1 - first_edge_on_component[peer_component])%
+	                     num_component_edges[peer_component] + first_edge_on_component[peer_component];
 
-						for (int k=j+1; k< num_cycles; k++)
-							colour_map[k] = RED;
-						not_finished = true;
-						break;
-					}
-				}
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{	
-	if (not_finished)
-	{
-		debug << "hamiltonian_circuit: incremented colour_map: ";
-		for (int i=0; i< num_cycles; i++)
-			debug << (colour_map[i] == RED? "R ": "B ");
-		debug << endl;
-	}
-	else
-	{
-		debug << "hamiltonian_circuit: cannot increment colour_map further, finished" << endl;
-	}
-}
-				break;
-			}
-		}
-		
-		if (valid_colour_map)
+		for (int i=0; i<4; i++)
 		{
-			/* check we don't have opposite regions of the same colour at any crossing */
-			for (int i=0; i< num_crossings && valid_colour_map; i++)
+			if (crossing_colour[0][i] != crossing_colour[0][(i+1)%4])
 			{
-				if (crossing_colour[i][0] == crossing_colour[i][2] && crossing_colour[i][1] == crossing_colour[i][3])
+				if (code_table[generic_code_data::table::TYPE][0] == generic_code_data::TYPE1)
 				{
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "hamiltonian_circuit: opposite regions at crossing " << i << " have the same colour" << endl;
-
-					valid_colour_map = false;
-					
-					/* increment the region_colour, if possible */
-					not_finished = false;
-					for (int i = num_cycles-1; i>=0; i--)
+					switch (i)
 					{
-						if (colour_map[i] == RED)
-						{
-							colour_map[i] = BLUE;
-							
-							for (int j=i+1; j< num_cycles; j++)
-								colour_map[j] = RED;
-							not_finished = true;
-							break;
-						}
-					}
-
-					if (not_finished)
-					{
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-{	
-	debug << "hamiltonian_circuit: incremented colour_map: ";
-	for (int i=0; i< num_cycles; i++)
-		debug << (colour_map[i] == RED? "R ": "B ");
-	debug << endl;
-}
+						case 0: edge = 0; forwards = false; break;
+						case 1: edge = peer_successor; forwards = true; break;
+						case 2: edge = 1; forwards = true; break;
+						case 3: edge = peer; forwards = false; break;
 					}
-					else
-					{
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-		debug << "hamiltonian_circuit: cannot increment colour_map further, finished" << endl;
-					}
-					
-					break;
 				}
-			}
-		}
-		
-		if (valid_colour_map)
-		{
-			vector<int> circuit(num_crossings);
-			circuit[0] = 0;
-			
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-		debug << "hamiltonian_circuit: trace boundary of colour_map starting at crossing zero" << endl;
-		
-			/* find an edge incident with crossing zero that lies in the colour boundary and determine whether we are going forwards
-			   or backwards with respect to the label orientation when we leave the crossing on the selected edge.
-			*/
-			int edge = 0;
-			bool forwards=false;
-
-			int peer = code_table[generic_code_data::table::OPEER][0];
-			int peer_component = 0;
-			for (int i=1; i< num_components; i++)
-			{
-				if (peer >= first_edge_on_component[i])
-					peer_component++;
 				else
-					break;
-			}			
-			int peer_successor = (peer+1 - first_edge_on_component[peer_component])%
-		                     num_component_edges[peer_component] + first_edge_on_component[peer_component];
-
-			for (int i=0; i<4; i++)
-			{
-				if (crossing_colour[0][i] != crossing_colour[0][(i+1)%4])
 				{
-					if (code_table[generic_code_data::table::TYPE][0] == generic_code_data::TYPE1)
+					switch (i)
 					{
-						switch (i)
-						{
-							case 0: edge = 0; forwards = false; break;
-							case 1: edge = peer_successor; forwards = true; break;
-							case 2: edge = 1; forwards = true; break;
-							case 3: edge = peer; forwards = false; break;
-						}
-					}
-					else
-					{
-						switch (i)
-						{
-							case 0: edge = 0; forwards = false; break;
-							case 1: edge = peer; forwards = false; break;
-							case 2: edge = 1; forwards = true; break;
-							case 3: edge = peer_successor; forwards = true; break;
-						}
+						case 0: edge = 0; forwards = false; break;
+						case 1: edge = peer; forwards = false; break;
+						case 2: edge = 1; forwards = true; break;
+						case 3: edge = peer_successor; forwards = true; break;
 					}
-					break;
 				}
+				break;
 			}
-			
+		}
+		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << "hamiltonian_circuit:   found boundary edge " << edge << " at crossing 0, forwards = " << forwards << endl;
 
-			if (edge_circuit)
-				circuit[0] = edge;
+		if (edge_circuit)
+			circuit[0] = edge;
+		
+		if (include_edge != -1 && edge == include_edge)
+			contains_include_edge = true;
+		
+		vector<bool> visited(num_crossings);
+		visited[0] = true;
+		
+		int edge_count = 0;						
+		int next_crossing = 0;
+		do
+		{				
+			edge_count++;
 			
-			if (include_edge != -1 && edge == include_edge)
-				contains_include_edge = true;
+			/* identify the crossing we reach going along edge */
+			next_crossing = (forwards? peer_code_data.term_crossing[edge] : peer_code_data.orig_crossing[edge]);
 			
-			int edge_count = 0;						
-			int next_crossing = 0;
-			do
-			{				
-				edge_count++;
-				
-				/* identify the crossing we reach going along edge */
-				next_crossing = (forwards? peer_code_data.term_crossing[edge] : peer_code_data.orig_crossing[edge]);
-				
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
 		debug << "hamiltonian_circuit:   next_crossing = " << next_crossing;
 		debug << (code_table[generic_code_data::table::TYPE][next_crossing] == generic_code_data::TYPE1? " TYPE1" : " TYPE2") << endl;
 }
 
-				if (next_crossing !=0)
-				{			
+			if (next_crossing !=0)
+			{			
+				/* a boundary that visits a crossing twice, or reaches more than num_crossings crossings before returning to 
+				   crossing zero, cannot be a Hamiltonian circuit; stop before writing beyond the end of circuit.
+				*/
+				if (edge_count >= num_crossings || visited[next_crossing])
+				{
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "hamiltonian_circuit: boundary revisits crossing " << next_crossing << " after " << edge_count << " edges, colour_map rejected" << endl;
+					return false;
+				}
+				visited[next_crossing] = true;
 
-					if (!edge_circuit)
-						circuit[edge_count] = next_crossing;					
+				if (!edge_circuit)
+					circuit[edge_count] = next_crossing;					
 
-					peer = code_table[generic_code_data::table::OPEER][next_crossing];
-					peer_component = 0;
-					for (int i=1; i< num_components; i++)
-					{
-						if (peer >= first_edge_on_component[i])
-							peer_component++;
-						else
-							break;
-					}			
-					peer_successor = (peer+1 - first_edge_on_component[peer_component])%
-				                     num_component_edges[peer_component] + first_edge_on_component[peer_component];
-					
-					/* identify the unique other boundary edge at next_crossing */
-					int boundary_edge;
-					for (int i=0; i<4; i++)
-					{
+				peer = code_table[generic_code_data::table::OPEER][next_crossing];
+				peer_component = 0;
+				for (int i=1; i< num_components; i++)
+				{
+					if (peer >= first_edge_on_component[i])
+						peer_component++;
+					else
+						break;
+				}			
+				peer_successor = (peer+1 - first_edge_on_component[peer_component])%
+			                     num_component_edges[peer_component] + first_edge_on_component[peer_component];
+				
+				/* identify the unique other boundary edge at next_crossing */
+				int boundary_edge;
+				for (int i=0; i<4; i++)
+				{
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
 		debug << "hamiltonian_circuit:     edge " << i << " boundary colours "
 		      << (crossing_colour[next_crossing][i] == RED? 'R': 'B') << " and " << (crossing_colour[next_crossing][(i+1)%4] == RED? 'R': 'B') << endl;
 }
 
-						if (crossing_colour[next_crossing][i] != crossing_colour[next_crossing][(i+1)%4])
+					if (crossing_colour[next_crossing][i] != crossing_colour[next_crossing][(i+1)%4])
+					{
+						if (code_table[generic_code_data::table::TYPE][next_crossing] == generic_code_data::TYPE1)
 						{
-							if (code_table[generic_code_data::table::TYPE][next_crossing] == generic_code_data::TYPE1)
+							switch (i)
 							{
-								switch (i)
-								{
-									case 0: boundary_edge = 2*next_crossing; forwards = false; break;
-									case 1: boundary_edge = peer_successor; forwards = true; break;
-									case 2: boundary_edge = 2*next_crossing+1; forwards = true; break;
-									case 3: boundary_edge = peer; forwards = false; break;
-								}
+								case 0: boundary_edge = 2*next_crossing; forwards = false; break;
+								case 1: boundary_edge = peer_successor; forwards = true; break;
+								case 2: boundary_edge = 2*next_crossing+1; forwards = true; break;
+								case 3: boundary_edge = peer; forwards = false; break;
 							}
-							else
+						}
+						else
+						{
+							switch (i)
 							{
-								switch (i)
-								{
-									case 0: boundary_edge = 2*next_crossing; forwards = false; break;
-									case 1: boundary_edge = peer; forwards = false; break;
-									case 2: boundary_edge = 2*next_crossing+1; forwards = true; break;
-									case 3: boundary_edge = peer_successor; forwards = true; break;
-								}
+								case 0: boundary_edge = 2*next_crossing; forwards = false; break;
+								case 1: boundary_edge = peer; forwards = false; break;
+								case 2: boundary_edge = 2*next_crossing+1; forwards = true; break;
+								case 3: boundary_edge = peer_successor; forwards = true; break;
 							}
+						}
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << "hamiltonian_circuit:   found boundary edge " << boundary_edge << endl;
-							
-							if (boundary_edge != edge)
-							{
-								edge = boundary_edge;
+						
+						if (boundary_edge != edge)
+						{
+							edge = boundary_edge;
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 		debug << "hamiltonian_circuit:   next boundary edge " << edge << " at crossing " << next_crossing << ", forwards = " << forwards << endl;
-								break;
-							}
+							break;
 						}
 					}
-					
-					if (edge_circuit)
-						circuit[edge_count] = edge;
-
-					if (include_edge != -1 && edge == include_edge)
-						contains_include_edge = true;
-					
 				}
-			} while (next_crossing !=0); // not back where we started
-			
+				
+				if (edge_circuit)
+					circuit[edge_count] = edge;
+
+				if (include_edge != -1 && edge == include_edge)
+					contains_include_edge = true;
+				
+			}
+		} while (next_crossing !=0); // not back where we started
+		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "hamiltonian_circuit: returned to crossing zero with edge_count " << edge_count << endl;
+	
+		return (edge_count == num_crossings && contains_include_edge);
+	};
+	
+	/* search_colourings extends the colouring of regions 0,...,start_region-1 in colour_map depth first, calling found_circuit
+	   for each Hamiltonian circuit in the order the colourings are considered.  It returns when all the extensions have been 
+	   considered, or when found_circuit returns true.
+	*/
+	auto search_colourings = [&](vector<int> colour_map, int start_region, function<bool(const vector<int>&)> found_circuit)
+	{
+		vector<int> next_colour(num_cycles,RED);
+		vector<int> circuit;
+		int region = start_region;
 		
-			if (edge_count == num_crossings && contains_include_edge) 
-			{
-				circuit_list.push_back(circuit);				
-				if (!list_all_circuits && !count_circuits_only)
-					break;				
-			}
-		}
-		
-		/* increment the region_colour, if possible */
-		if (valid_colour_map)
+		while (region >= start_region)
 		{
-			not_finished = false;
-			for (int i = num_cycles-1; i>=0; i--)
+			if (region == num_cycles)
 			{
-				if (colour_map[i] == RED)
-				{
-					colour_map[i] = BLUE;
-					
-					for (int j=i+1; j< num_cycles; j++)
-						colour_map[j] = RED;
-					not_finished = true;
+				if (trace_boundary(colour_map,circuit) && found_circuit(circuit))
 					break;
-				}
+				
+				region--;
+				continue;
+			}
+			
+			if (next_colour[region] > (region == 0? RED: BLUE))
+			{
+				/* both colours have been considered, backtrack */
+				region--;
+				continue;
+			}
+			
+			colour_map[region] = next_colour[region]++;
+
+			if (valid_region_colour(colour_map,region))
+			{
+				region++;
+				if (region < num_cycles)
+					next_colour[region] = RED;
 			}
 		}
-		
-	} while (not_finished);
-	
-	/* remove the duplicates from circuit_list, we shall find circuits twice by interchanging RED and BLUE
-	   but we shall always traverse circuits in the same direction, regardless of colour polarity.
+	};
+
+	/* Distinct colourings have distinct boundaries but, if two crossings are joined by more than one edge, distinct circuits 
+	   may visit the crossings in the same order.  Only crossing circuits that pass between such a pair of crossings can be 
+	   duplicated, so we record the encoding of these circuits alone in found_circuits, and the memory used by other circuits 
+	   is released as soon as they have been recorded.
 	*/
-if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "hamiltonian_circuit: initial circuit_list contains " << circuit_list.size() << " entries" << endl;
+	set<pair<int,int> > multiple_edge_pair;
+	if (!edge_circuit)
+	{
+		set<pair<int,int> > edge_pair;
+		for (int i=0; i< num_edges; i++)
+		{
+			pair<int,int> crossings(min(peer_code_data.orig_crossing[i],peer_code_data.term_crossing[i]), max(peer_code_data.orig_crossing[i],peer_code_data.term_crossing[i]));
+			if (!edge_pair.insert(crossings).second)
+				multiple_edge_pair.insert(crossings);
+		}
+	}
 	
-	if (circuit_list.size() > 0)
+	auto may_be_duplicated = [&](const vector<int>& circuit) -> bool
 	{
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-	debug << "hamiltonian_circuit: remove circuit_list duplicates" << endl;
+		for (int i=0; i< num_crossings && multiple_edge_pair.size(); i++)
+		{
+			int a = circuit[i];
+			int b = circuit[(i+1)%num_crossings];
+			if (multiple_edge_pair.count(pair<int,int>(min(a,b),max(a,b))))
+				return true;
+		}
+		return false;
+	};
 
-		list<vector<int> >::iterator aptr = circuit_list.begin();
+	unordered_set<string> found_circuits;
+	long num_circuits = 0;
+
+	/* record accepts a circuit if it has not been found before, passing it to record_circuit unless we are only counting */
+	auto record = [&](const vector<int>& circuit)
+	{
+		if (may_be_duplicated(circuit) && !found_circuits.insert(string(reinterpret_cast<const char*>(circuit.data()), circuit.size()*sizeof(int))).second)
+			return;
 		
-		while (aptr != circuit_list.end())
-		{
+		num_circuits++;
+		if (!count_circuits_only)
+			record_circuit(circuit);
+	};
+	
+	bool first_circuit_only = !list_all_circuits && !count_circuits_only;
+	
+	/* With more than one thread, the regions 1,...,prefix_length are coloured in each of the 2^prefix_length possible ways and the 
+	   extensions of each of these prefixes are searched by a pool of worker threads.  The circuits found for each prefix are recorded 
+	   in order by the calling thread, so circuits are recorded in the same order as a serial search.  When we are counting circuits, 
+	   a worker returns only the circuits that may be duplicated, together with the number of other circuits it has found.
+	*/
+	int num_workers = 1;
+	if (braid_control::num_threads > 1 && debug_control::DEBUG == debug_control::OFF)
+		num_workers = braid_control::num_threads;
+		
+	int prefix_length = 0;
+	while ((1 << prefix_length) < 8*num_workers && prefix_length < num_cycles-1)
+		prefix_length++;
 
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-{
-	debug << "hamiltonian_circuit:  aptr: " ;
-	for (size_t i=0; i< aptr->size(); i++)
-		debug << (*aptr)[i] << ' ';
-	debug << endl;
-}
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "hamiltonian_circuit: num_workers = " << num_workers << ", prefix_length = " << prefix_length << endl;
 
-			list<vector<int> >::iterator bptr = aptr;
-			bptr++;
+	if (num_workers == 1)
+	{
+		vector<int> colour_map(num_cycles,RED);
+		search_colourings(colour_map, 0, [&](const vector<int>& circuit) -> bool
+		{
+			record(circuit);
+			return (first_circuit_only && num_circuits > 0);
+		});
+	}
+	else
+	{
+		auto evaluate = [&](int prefix, pair<long,list<vector<int> > >& result)
+		{
+			vector<int> colour_map(num_cycles,RED);
+			for (int r=1; r<= prefix_length; r++)
+				colour_map[r] = ((prefix >> (prefix_length-r)) & 1)? BLUE: RED;
 			
-			while (bptr != circuit_list.end())
+			for (int r=0; r<= prefix_length; r++)
 			{
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-{
-	debug << "hamiltonian_circuit:  bptr: " ;
-	for (size_t i=0; i< bptr->size(); i++)
-		debug << (*bptr)[i] << ' ';
-}
-				if (*bptr == *aptr)
-				{
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-	debug << ":  duplicate found" << endl;
-	
-					bptr = circuit_list.erase(bptr);
-				}
-				else	
-				{			
-if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
-	debug << endl;
-
-					bptr++;
-				}
+				if (!valid_region_colour(colour_map,r))
+					return;
 			}
 			
-			aptr++;
-		}
+			search_colourings(colour_map, prefix_length+1, [&](const vector<int>& circuit) -> bool
+			{
+				if (count_circuits_only && !may_be_duplicated(circuit))
+					result.first++;
+				else
+					result.second.push_back(circuit);
+				return (first_circuit_only && result.second.size());
+			});
+		};
+		
+		auto fold = [&](int prefix, pair<long,list<vector<int> > >& result) -> bool
+		{
+			num_circuits += result.first;
+			for (list<vector<int> >::iterator cptr = result.second.begin(); cptr != result.second.end(); cptr++)
+			{
+				record(*cptr);
+				if (first_circuit_only && num_circuits > 0)
+					break;
+			}
+			return (first_circuit_only && num_circuits > 0);
+		};
+		
+		ordered_parallel_fold(1 << prefix_length, num_workers, pair<long,list<vector<int> > >(0,list<vector<int> >()), evaluate, fold);
 	}
-	return circuit_list;
+	
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "hamiltonian_circuit: found " << num_circuits << " circuits" << endl;
+
+	return num_circuits;
 }
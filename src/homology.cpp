@@ -5,9 +5,9 @@
                   
 void perm_print(matrix<int>& M, ostream& os, int w, vector<int>& rperm, string prefix)
 void print_characteristic_function(ostream& os, vector<scalar>& generator, vector<int>& reverse_map, bool cohomology, int n)
-void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0)
-void calculate_boundary(int n, vector<int>& tuple, matrix<scalar>& Delta, int domain_index, vector<int>& codomain_map, matrix<int>& twitch_u, matrix<int>& twitch_d)
-void test_cohomology_generators(generic_switch_data& switch_data)
+void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0, ostream& os=cout, ostream& output_os=output)
+template <class M> void calculate_boundary(int n, vector<int>& tuple, M& Delta, int domain_index, vector<int>& codomain_map, matrix<int>& twitch_u, matrix<int>& twitch_d)
+void test_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os)
 *************************************************************************************************/
 #include <string>
 #include <sstream>
@@ -36,10 +36,11 @@ extern bool SIDEWAYS_SEARCH;
 #include <matrix.h>
 #include <ctype.h>
 #include <braid.h>
+#include <sparse-matrix.h>
 #include <homology.h>
 
 void print_k_chain(ostream& os, const vector<scalar> k_chain, generic_switch_data& switch_data, int k);
-void calculate_boundary(int n, vector<int>& tuple, matrix<scalar>& Delta, int domain_index, vector<int>& codomain_map, matrix<int>& twitch_u, matrix<int>& twitch_d);
+template <class M> void calculate_boundary(int n, vector<int>& tuple, M& Delta, int domain_index, vector<int>& codomain_map, matrix<int>& twitch_u, matrix<int>& twitch_d);
 
 
 void perm_print(matrix<int>& M, ostream& os, int w, vector<int>& rperm, string prefix)
@@ -200,7 +201,10 @@ int create_chain_map(vector<int>& chain_map, int n, int k)
 	return num_generators;
 }
 
-void create_boundary_map(matrix<scalar>& Delta, vector<int>& chain_map, matrix<int>& twitch_u,matrix<int>& twitch_d, int n, int k)
+/* create_boundary_map is instantiated for both matrix<scalar> and sparse_matrix<scalar>, the latter being used when 
+   braid_control::HOMOLOGY_ENGINE selects the sparse calculation of homology generators
+*/
+template <class M> void create_boundary_map(M& Delta, vector<int>& chain_map, matrix<int>& twitch_u,matrix<int>& twitch_d, int n, int k)
 {
 	vector<int> tuple(k);
 	int index = 0;
@@ -256,7 +260,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
    cohomology boolean.  If braid_control::BIRACK_HOMOLOGY is false, the default, the function determines the biquandle variant of the homology
    or cohomology, setting degenerate tuples to zero.  Otherwise the birack variant is calculated, taking into account the degenerate tuples.
 */
-void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0)
+void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0, ostream& os=cout, ostream& output_os=output)
 {
 	if (braid_control::BIRACK_HOMOLOGY)
 		braid_control::USE_BIGINT = true;
@@ -313,7 +317,7 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	list<string>& cocycles = switch_data.cocycle_string;
 	
 	if (!braid_control::SILENT_OPERATION)
-		cout << "calculating homology generators, cohomology flag = " << cohomology << endl;
+		os << "calculating homology generators, cohomology flag = " << cohomology << endl;
 
 	int n_km1_power = 1;
 	for (int i=0; i< k-1; i++)
@@ -342,9 +346,9 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	*/
 	if (braid_control::BIRACK_HOMOLOGY)
 	{
-		num_km1_generators = n*n;
-		num_k_generators = n* num_km1_generators;
-		num_kp1_generators = n* num_k_generators;
+		num_km1_generators = n_km1_power;
+		num_k_generators = n_k_power;
+		num_kp1_generators = n_kp1_power;
 	}
 	else
 	{		
@@ -426,11 +430,62 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	}
 }	
 	
-	matrix<scalar> Delta_k(num_km1_generators,num_k_generators);
-	matrix<scalar> Delta_kp1(num_k_generators,num_kp1_generators);
+	homology_control h_control;
+	h_control.field_coefficients = field_coefficients;
+	h_control.silent_operation = braid_control::SILENT_OPERATION;
+	h_control.modular_first = braid_control::MODULAR_HOMOLOGY;
+	h_control.os = &os;
+
+	/* The dense boundary maps hold every entry of Delta_k and Delta_kp1 but each column of a boundary map has at most 2(k+1) non-zero
+	   entries, so if the choice of engine has been left to the programme we use sparse boundary maps once the dense maps would exceed 
+	   SPARSE_HOMOLOGY_THRESHOLD entries.  The dense engine is the default, since the two engines may report different generators,
+	   and the sparse engine does not make the dense engine's checks that the boundary maps are consistent.
+	*/
+	bool sparse_homology;
+	if (braid_control::HOMOLOGY_ENGINE == braid_control::homology_engine::BY_SIZE)
+		sparse_homology = (1.0*num_k_generators*(num_km1_generators+num_kp1_generators) > SPARSE_HOMOLOGY_THRESHOLD);
+	else
+		sparse_homology = (braid_control::HOMOLOGY_ENGINE == braid_control::homology_engine::SPARSE);
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)	
+	debug << "birack_homology_generators: sparse_homology = " << sparse_homology << endl;
+
+	homology_generators_return<scalar> homology_data;
 	
-	create_boundary_map(Delta_k, km1_chain_map, twitch_u, twitch_d,n,k);
-	create_boundary_map(Delta_kp1, k_chain_map, twitch_u, twitch_d,n,k+1);
+	if (sparse_homology)
+	{
+		sparse_matrix<scalar> Delta_k(num_km1_generators,num_k_generators);
+		sparse_matrix<scalar> Delta_kp1(num_k_generators,num_kp1_generators);
+
+		create_boundary_map(Delta_k, km1_chain_map, twitch_u, twitch_d,n,k);
+		create_boundary_map(Delta_kp1, k_chain_map, twitch_u, twitch_d,n,k+1);
+		
+		Delta_k.remove_zeros();
+		Delta_kp1.remove_zeros();
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)	
+{
+	debug << "birack_homology_generators: Delta_k has " << Delta_k.non_zero_count() << " non-zero entries" << endl;
+	debug << "birack_homology_generators: Delta_kp1 has " << Delta_kp1.non_zero_count() << " non-zero entries" << endl;
+}
+
+if (debug_control::DEBUG >= debug_control::BASIC)	
+{
+	debug << "birack_homology_generators: Delta_k:" << endl;
+	print(Delta_k, debug,3,"birack_homology_generators: ");
+	debug << "birack_homology_generators: Delta_kp1:" << endl;
+	print(Delta_kp1, debug,3,"birack_homology_generators: ");
+}
+
+		homology_data = sparse_homology_generators(Delta_k, Delta_kp1, cohomology, h_control);
+	}
+	else
+	{
+		matrix<scalar> Delta_k(num_km1_generators,num_k_generators);
+		matrix<scalar> Delta_kp1(num_k_generators,num_kp1_generators);
+		
+		create_boundary_map(Delta_k, km1_chain_map, twitch_u, twitch_d,n,k);
+		create_boundary_map(Delta_kp1, k_chain_map, twitch_u, twitch_d,n,k+1);
 
 if (debug_control::DEBUG >= debug_control::BASIC)	
 {
@@ -455,13 +510,9 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	}
 }
 
-	homology_control h_control;
-	h_control.field_coefficients = field_coefficients;
-	h_control.silent_operation = braid_control::SILENT_OPERATION;
-
-//	homology_generators_return<scalar> homology_data = homology_generators(Delta_k, Delta_kp1, cohomology, field_coefficients, braid_control::SILENT_OPERATION);
-	homology_generators_return<scalar> homology_data = homology_generators(Delta_k, Delta_kp1, cohomology, h_control);
-	
+		homology_data = homology_generators(Delta_k, Delta_kp1, cohomology, h_control);
+	}
+		
 	int num_generators = homology_data.num_generators;
 	int num_torsion_generators = homology_data.num_torsion_generators;
 	vector<scalar>& torsion = homology_data.torsion;
@@ -484,114 +535,114 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 	if (!braid_control::SILENT_OPERATION)
 	{
-		cout << "Found " << num_generators << (cohomology? " cohomology": " homology") << " generators" << endl;
+		os << "Found " << num_generators << (cohomology? " cohomology": " homology") << " generators" << endl;
 		
 		if (num_generators !=0)
 		{
 			if (cohomology)
 			{
-				cout << (braid_control::BIRACK_HOMOLOGY?"H_B^":"H_{BQ}^");
-				cout << k;
+				os << (braid_control::BIRACK_HOMOLOGY?"H_B^":"H_{BQ}^");
+				os << k;
 				if (scalar::variant == scalar::scalar_variant::MOD_P)
-					cout << "(X,Z_" << mod_p::get_p() << ')';
+					os << "(X,Z_" << mod_p::get_p() << ')';
 				else if (scalar::variant == scalar::scalar_variant::RATIONAL || scalar::variant == scalar::scalar_variant::BIGRATIONAL)
-					cout << "(X,Q)";
+					os << "(X,Q)";
 				else
-					cout << "(X,Z)";
+					os << "(X,Z)";
 				
-				cout << " is isomorphic to ";
+				os << " is isomorphic to ";
 			}
 			else
 			{
-				cout << (braid_control::BIRACK_HOMOLOGY?"H^B^":"H^{BQ}^");
-				cout << k;
+				os << (braid_control::BIRACK_HOMOLOGY?"H^B^":"H^{BQ}^");
+				os << k;
 				if (scalar::variant == scalar::scalar_variant::MOD_P)
-					cout << "(X,Z_" << mod_p::get_p() << ')';
+					os << "(X,Z_" << mod_p::get_p() << ')';
 				else if (scalar::variant == scalar::scalar_variant::RATIONAL || scalar::variant == scalar::scalar_variant::BIGRATIONAL)
-					cout << "(X,Q)";
+					os << "(X,Q)";
 				else
-					cout << "(X,Z)";
-				cout << " is isomorphic to ";
+					os << "(X,Z)";
+				os << " is isomorphic to ";
 			}
 			
 			for (int i=0; i<num_torsion_generators; i++)
 			{
-				cout << "Z_" << torsion[i];
+				os << "Z_" << torsion[i];
 				if (i< num_generators-1)
-					cout << " + ";
+					os << " + ";
 			}
 			
 			for (int i=num_torsion_generators; i<num_generators; i++)
 			{
 				if (scalar::variant == scalar::scalar_variant::MOD_P)
-					cout << "Z_" << mod_p::get_p();
+					os << "Z_" << mod_p::get_p();
 				else if (scalar::variant == scalar::scalar_variant::RATIONAL || scalar::variant == scalar::scalar_variant::BIGRATIONAL)
-					cout << "Q";
+					os << "Q";
 				else
-					cout << "Z";
+					os << "Z";
 				if (i< num_generators-1)
-					cout << " + ";
+					os << " + ";
 			}
-			cout << endl;
+			os << endl;
 		}
 	}
 	
 	if (!braid_control::RAW_OUTPUT)
 	{
-		output << "\n";
+		output_os << "\n";
 		if (braid_control::OUTPUT_AS_INPUT)
-			output << ';';
-		output << "Found " << num_generators << (cohomology? " cohomology": " homology") << " generators" << endl;
+			output_os << ';';
+		output_os << "Found " << num_generators << (cohomology? " cohomology": " homology") << " generators" << endl;
 
 		if (num_generators !=0)
 		{
 			if (braid_control::OUTPUT_AS_INPUT)
-				output << ';';
+				output_os << ';';
 
 			if (cohomology)
 			{
-				output << (braid_control::BIRACK_HOMOLOGY?"H_B^":"H_{BQ}^");
-				output << k;
+				output_os << (braid_control::BIRACK_HOMOLOGY?"H_B^":"H_{BQ}^");
+				output_os << k;
 				if (scalar::variant == scalar::scalar_variant::MOD_P)
-					output << "(X,Z_" << mod_p::get_p() << ')';
+					output_os << "(X,Z_" << mod_p::get_p() << ')';
 				else if (scalar::variant == scalar::scalar_variant::RATIONAL || scalar::variant == scalar::scalar_variant::BIGRATIONAL)
-					output << "(X,Q)";
+					output_os << "(X,Q)";
 				else
-					output << "(X,Z)";
-				output << " is isomorphic to ";
+					output_os << "(X,Z)";
+				output_os << " is isomorphic to ";
 			}
 			else
 			{
-				output << (braid_control::BIRACK_HOMOLOGY?"H^B^":"H^{BQ}^");
-				output << k;
+				output_os << (braid_control::BIRACK_HOMOLOGY?"H^B^":"H^{BQ}^");
+				output_os << k;
 				if (scalar::variant == scalar::scalar_variant::MOD_P)
-					output << "(X,Z_" << mod_p::get_p() << ')';
+					output_os << "(X,Z_" << mod_p::get_p() << ')';
 				else if (scalar::variant == scalar::scalar_variant::RATIONAL || scalar::variant == scalar::scalar_variant::BIGRATIONAL)
-					output << "(X,Q)";
+					output_os << "(X,Q)";
 				else
-					output << "(X,Z)";
-				output << " is isomorphic to ";
+					output_os << "(X,Z)";
+				output_os << " is isomorphic to ";
 			}
 
 			for (int i=0; i<num_torsion_generators; i++)
 			{
-				output << "Z_" << torsion[i];
+				output_os << "Z_" << torsion[i];
 				if (i< num_generators-1)
-					output << " + ";
+					output_os << " + ";
 			}
 			
 			for (int i=num_torsion_generators; i<num_generators; i++)
 			{
 				if (scalar::variant == scalar::scalar_variant::MOD_P)
-					output << "Z_" << mod_p::get_p();
+					output_os << "Z_" << mod_p::get_p();
 				else if (scalar::variant == scalar::scalar_variant::RATIONAL || scalar::variant == scalar::scalar_variant::BIGRATIONAL)
-					output << "Q";
+					output_os << "Q";
 				else
-					output << "Z";
+					output_os << "Z";
 				if (i< num_generators-1)
-					output << " + ";
+					output_os << " + ";
 			}
-			output << endl;
+			output_os << endl;
 		}
 	}
 
@@ -601,11 +652,11 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		if (cocycles.size() == 0)
 		{
 			if (!braid_control::SILENT_OPERATION)
-				cout << "no " << (cohomology? "cohomology":"homology") << " generators found" << endl;
+				os << "no " << (cohomology? "cohomology":"homology") << " generators found" << endl;
 				    
 //			if (!braid_control::RAW_OUTPUT)
 		 	{
-				output << "no " << (cohomology? "cohomology":"homology") << " generators found" << endl;
+				output_os << "no " << (cohomology? "cohomology":"homology") << " generators found" << endl;
 		 	}	
 		}
 		else
@@ -613,30 +664,30 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			list<string>::iterator lptr = cocycles.begin();		
 			if (!braid_control::SILENT_OPERATION)
 			{
-				cout << cocycles.size() << (cohomology? " cohomology":" homology") << " generators:" << endl;
+				os << cocycles.size() << (cohomology? " cohomology":" homology") << " generators:" << endl;
 				lptr = cocycles.begin();
 				while (lptr != cocycles.end())
 				{
-					cout << "C=" << *lptr << endl;
+					os << "C=" << *lptr << endl;
 					lptr++;
 				};
 			}
 	
 			if (!braid_control::RAW_OUTPUT)
 			{
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-				output << cocycles.size() << (cohomology? " cohomology":" homology") << " generators:";
-		   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << cocycles.size() << (cohomology? " cohomology":" homology") << " generators:";
+		   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 			}
 		   	
 			lptr = cocycles.begin();
 			while (lptr != cocycles.end())
 			{
-				output << "C=" << *lptr;
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "C=" << *lptr;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 				lptr++;
 			};
-			output << flush;
+			output_os << flush;
 		}
 	}		
 }
@@ -647,7 +698,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
    
    The codomain_map is used when braid_control::BIRACK_HOMOLOGY is false, since then the co-domain tuples need checking to ignore any that are degenerate.
 */
-void calculate_boundary(int n, vector<int>& tuple, matrix<scalar>& Delta, int domain_index, vector<int>& codomain_map, matrix<int>& twitch_u, matrix<int>& twitch_d)
+template <class M> void calculate_boundary(int n, vector<int>& tuple, M& Delta, int domain_index, vector<int>& codomain_map, matrix<int>& twitch_u, matrix<int>& twitch_d)
 {
 	
 if (debug_control::DEBUG >= debug_control::DETAIL)	
@@ -815,21 +866,21 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
    9/1/26 Added the check for the "pseudo-rack" condition: \theta(b_a,c_a,d_a) = \theta(b,c,d) to look for biracks that are 
    not racks giving doubled colouring invariants
 */
-void test_2_cohomology_generators(generic_switch_data& switch_data);
-void test_3_cohomology_generators(generic_switch_data& switch_data);
+void test_2_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os);
+void test_3_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os);
 
-void test_cohomology_generators(generic_switch_data& switch_data)
+void test_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os)
 {
 	if (braid_control::DOUBLE_BIRACKS)
-		test_3_cohomology_generators(switch_data);
+		test_3_cohomology_generators(switch_data,os,output_os);
 	else
-		test_2_cohomology_generators(switch_data);
+		test_2_cohomology_generators(switch_data,os,output_os);
 }
 	
-void test_2_cohomology_generators(generic_switch_data& switch_data)
+void test_2_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os)
 {	
 	if (!braid_control::SILENT_OPERATION)
-		cout << "testing 2-cohomology generators" << endl;
+		os << "testing 2-cohomology generators" << endl;
 	
 	int n = switch_data.size;
 	int num_chain_generators = switch_data.num_chain_generators;
@@ -1056,7 +1107,7 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	debug << "test_2_cohomology_generators:   generator fails condition a=" << a << ", b=" << b << ", c=" << c
 	      << " lhs_value = " << lhs_value << ", rhs_value = " << rhs_value  << endl;
 }
-				cout << "Error! Cohomology generator fails cocycle condition." << endl;
+				os << "Error! Cohomology generator fails cocycle condition." << endl;
 				exit(0);
 			}
 			else
@@ -1074,12 +1125,12 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	if (switch_data.cocycle_string.size() == 0)
 	{
 		if (!braid_control::SILENT_OPERATION)
-			cout << "no cohomology generators satisfying cocycle condition:" << endl;
+			os << "no cohomology generators satisfying cocycle condition:" << endl;
 			    
 		if (!braid_control::RAW_OUTPUT)
 	 	{
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << "no cohomology generators satisfying cocycle condition:" << endl;
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << "no cohomology generators satisfying cocycle condition:" << endl;
 	 	}	
 	}
 	else
@@ -1087,37 +1138,37 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 		
 		if (!braid_control::SILENT_OPERATION)
 		{
-			cout << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:" << endl;
+			os << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:" << endl;
 			strptr = switch_data.cocycle_string.begin();
 			while (strptr != switch_data.cocycle_string.end())
 			{
-				cout << "C=" << *strptr << endl;
+				os << "C=" << *strptr << endl;
 				strptr++;
 			};
 		}
 
 		if (!braid_control::RAW_OUTPUT)
 		{
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:";
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:";
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 			strptr = switch_data.cocycle_string.begin();
 			while (strptr != switch_data.cocycle_string.end())
 			{
-				output << "C=" << *strptr;
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "C=" << *strptr;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 				strptr++;
 			};
-			output << flush;
+			output_os << flush;
 		}
 
 	}	
 }
 
-void test_3_cohomology_generators(generic_switch_data& switch_data)
+void test_3_cohomology_generators(generic_switch_data& switch_data, ostream& os, ostream& output_os)
 {	
 	if (!braid_control::SILENT_OPERATION)
-		cout << "testing 3-cohomology generators" << endl;
+		os << "testing 3-cohomology generators" << endl;
 	
 	int n = switch_data.size;
 	int nn = n*n;
@@ -1396,7 +1447,7 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	debug << "test_3_cohomology_generators:   generator fails condition a=" << a << ", b=" << b << ", c=" << c << ", d=" << d 
 	      << " lhs_value = " << lhs_value << ", rhs_value = " << rhs_value  << endl;
 }
-				cout << "Error! Cohomology generator fails cocycle condition." << endl;
+				os << "Error! Cohomology generator fails cocycle condition." << endl;
 				exit(0);
 			}
 			else
@@ -1434,12 +1485,12 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	if (switch_data.cocycle_string.size() == 0)
 	{
 		if (!braid_control::SILENT_OPERATION)
-			cout << "no cohomology generators satisfying cocycle condition:" << endl;
+			os << "no cohomology generators satisfying cocycle condition:" << endl;
 			    
 		if (!braid_control::RAW_OUTPUT)
 	 	{
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << "no cohomology generators satisfying cocycle condition:" << endl;
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << "no cohomology generators satisfying cocycle condition:" << endl;
 	 	}	
 	}
 	else
@@ -1447,28 +1498,28 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 		
 		if (!braid_control::SILENT_OPERATION)
 		{
-			cout << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:" << endl;
+			os << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:" << endl;
 			strptr = switch_data.cocycle_string.begin();
 			while (strptr != switch_data.cocycle_string.end())
 			{
-				cout << "C=" << *strptr << endl;
+				os << "C=" << *strptr << endl;
 				strptr++;
 			};
 		}
 
 		if (!braid_control::RAW_OUTPUT)
 		{
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-			output << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:";
-	   		output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+			output_os << switch_data.cocycle_string.size() << " cohomology generators satisfying cocycle condition:";
+	   		output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 			strptr = switch_data.cocycle_string.begin();
 			while (strptr != switch_data.cocycle_string.end())
 			{
-				output << "C=" << *strptr;
-				output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+				output_os << "C=" << *strptr;
+				output_os << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 				strptr++;
 			};
-			output << flush;
+			output_os << flush;
 		}
 
 	}	
@@ -132,6 +132,11 @@ documentation, available at www.layer8.co.uk/maths/braids
 #include <list>
 #include <iomanip>
 #include <map>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 using namespace std;
 
@@ -210,6 +215,7 @@ bool braid_control::LONG_KNOT = false;
 bool braid_control::MANTUROV_ALEXANDER = false;
 bool braid_control::MATRIX = false;
 bool braid_control::MOCK_ALEXANDER = false;
+bool braid_control::MODULAR_HOMOLOGY = false;
 bool braid_control::NORMALIZING_Q_POLYNOMIALS = false;
 bool braid_control::NORMALIZE_BRACKET = true;
 bool braid_control::NUMERATOR_GCD = false;
@@ -270,6 +276,9 @@ bool braid_control::first_time = true;
 
 int braid_control::REMOVE_COMPONENT=0; // used to identify a component of a peer code to be removed
 int	braid_control::SWITCH_POWER=0; // used to control whether powers of switches are calculated.
+int braid_control::BRACKET_ENGINE = bracket_engine::AUTOMATIC;
+int braid_control::HOMOLOGY_ENGINE = homology_engine::DENSE;
+int braid_control::COLOURING_ENGINE = colouring_engine::PROPAGATE;
 
 bool braid_control::VOGEL_DEBUG = false;
 
@@ -281,11 +290,14 @@ int	braid_control::INFINITE_CYCLE = cycle::UNSPECIFIED; // used by turning-numbe
 int braid_control::SATELLITE = 0;
 
 
+int braid_control::num_threads = 1;
 int braid_control::wait_threshold = 1;
 int braid_control::wait_count = 0;
 int braid_control::reset_count = 0; 
 int braid_control::birack_poly_writhe_limit = 5; 
 int braid_control::homology_index = 3; 
+int braid_control::homfly_cache_limit = 100000; 
+int braid_control::canonical_cache_limit = 10000; 
 
 /********************* Function prototypes ***********************/
 void braid(string input_string, string title);
@@ -320,6 +332,34 @@ template <typename T, typename V, typename St>  void normalize(polynomial<T,V>&
 void normalize(Hpolynomial& poly, const Hpmatrix& switch_matrix);
 
 
+/* right_multiply_block multiplies M on the right by the matrix that agrees with the identity except in the columns 
+   col_base,...,col_base+block.numcols()-1, whose entries are zero except in the rows row_base,...,row_base+block.numrows()-1,
+   where they are given by block.  Only the affected columns of M are changed, so the product takes O(n) operations
+   per entry of block rather than the O(n^3) of a full matrix product.  Rows of block lying beyond the last row of 
+   the matrix are ignored.
+   
+   The terms contributing to each entry of the product are accumulated in the same order as in matrix::operator *=
+*/
+template <typename T, typename St> void right_multiply_block(matrix<T,St>& M, const matrix<T,St>& block, size_t row_base, size_t col_base)
+{
+	size_t block_rows = min(block.numrows(), M.numcols()-row_base);
+	size_t block_cols = block.numcols();
+	vector<T> product(block_cols, T("0"));
+	
+	for (size_t i=0; i< M.numrows(); i++)
+	{
+		for (size_t j=0; j< block_cols; j++)
+		{
+			product[j] = T("0");
+			for (size_t k=0; k< block_rows; k++)
+				product[j] += M[i][row_base+k]*block[k][j];
+		}
+
+		for (size_t j=0; j< block_cols; j++)
+			M[i][col_base+j] = product[j];
+	}
+}
+
 template <typename T, typename St> 
 bool braid_rep(matrix<T,St>*& Matrix_rep, const matrix<T,St>& switch_matrix, const matrix<T,St>& switch_matrix_inverse, string input_string,
                 int num_terms, int num_strings);
@@ -335,9 +375,12 @@ bool two_dominates(matrix<int>& Ua, matrix<int>& Da, matrix<int>& Ub, matrix<int
 bool power_2(matrix<int>& U, matrix<int>& D);
 int switch_order(matrix<int>& U, matrix<int>& D);
 void colouring_invariant(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, 
-						   matrix<int>& Tu, matrix<int>& Td, braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data);
+						   matrix<int>& Tu, matrix<int>& Td, braid_control::ST_pair_type pair_type, string input_string, string title, generic_switch_data& switch_data, ostream& os = cout, ostream& output_os = output);
+void batch_colouring_invariant(vector<batch_switch_data>& batch_switch, vector<generic_switch_data>& switch_cache, vector<pair<string,string> >& finite_switch_input);
+colouring_data num_fixed_points(matrix<int>& Su, matrix<int>& Sd, matrix<int>& invSu, matrix<int>& invSd, matrix<int>& Tu, matrix<int>& Td, 
+                     string input_string, int num_terms, int num_strings, generic_switch_data& switch_data, vector<int>* image_size_count);
 void commutative_automorphism_invariant(const Qpmatrix& phi, const Qpmatrix& psi, string input_string, string title);			
-void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0);
+void birack_homology_generators(generic_switch_data& switch_data, int k, bool cohomology=false, matrix<scalar>* _B=0, ostream& os=cout, ostream& output_os=output);
 void set_acceptable_input_type();
 
 bool switch_biquandle_test(matrix<int>& U, matrix<int>& D);
@@ -1360,8 +1403,77 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 			switch_cache.push_back(switch_data);
 		}
 		
+		/* The finite switch colouring tasks read the input file once, rather than once for each switch.  With the threads option the
+		   colourings of the input for a window of batch_window switches are evaluated together by batch_colouring_invariant.  In that 
+		   case the report of each switch in the window is held in held_cout and held_output while the switches are read, and the 
+		   switches for which colourings are required are recorded in batch_switch.  At the end of the window write_batch_window writes 
+		   the reports and the invariants of its switches in the usual order, so the output of a long run is written as it proceeds.
+		*/
+		vector<pair<string,string> > finite_switch_input; // input strings and titles
+		bool batch_colourings = false;
+		const unsigned int batch_window = 256;
+		unsigned int window_start = 0;
+		vector<batch_switch_data> batch_switch;
+		vector<ostringstream> held_cout;
+		vector<ostringstream> held_output;
+		
+		if (braid_control::FINITE_SWITCH_INVARIANT && !braid_control::HOMOLOGY && !braid_control::COHOMOLOGY && command_line_input_file.length())
+		{
+			input.clear();
+			input.seekg(0);
+			
+			string input_string;
+			while (get_next_input_string(command_line_input_file,input_string, title))
+				finite_switch_input.push_back(pair<string,string>(input_string,title));
+				
+			if (braid_control::num_threads > 1 && debug_control::DEBUG == debug_control::OFF && !braid_control::BIGELOW_KNOT_SEARCH && 
+			    !braid_control::WAIT_SWITCH && !braid_control::EXTRA_OUTPUT && !braid_control::DEVELOPMENT_MODE)
+			{
+				batch_colourings = true;
+				held_cout = vector<ostringstream>(batch_window);
+				held_output = vector<ostringstream>(batch_window);
+			}
+		}
+		
+		/* write_batch_window evaluates the colourings of the switches window_start to window_end-1, then writes the report of each 
+		   switch and evaluates its invariants, colouring_invariant retrieving the colourings evaluated in advance from the switch_cache
+		*/
+		auto write_batch_window = [&](unsigned int window_end)
+		{
+			batch_colouring_invariant(batch_switch, switch_cache, finite_switch_input);
+			
+			unsigned int next_batch = 0;
+			for (unsigned int s=window_start; s< window_end; s++)
+			{
+				ostringstream& held_switch_cout = held_cout[s-window_start];
+				ostringstream& held_switch_output = held_output[s-window_start];
+				
+				cout << held_switch_cout.str();
+				output << held_switch_output.str();
+				held_switch_cout.str("");
+				held_switch_output.str("");
+				
+				if (next_batch < batch_switch.size() && batch_switch[next_batch].index == s)
+				{
+					batch_switch_data& b = batch_switch[next_batch++];
+					for (unsigned int i=0; i< finite_switch_input.size(); i++)
+						colouring_invariant(b.Su, b.Sd, b.invSu, b.invSd, b.Tu, b.Td, b.pair_type, finite_switch_input[i].first, finite_switch_input[i].second, switch_cache[s]);
+						
+					switch_cache[s].batch_colourings.clear();
+				}
+			}
+			
+			cout << flush;
+			output << flush;
+			batch_switch.clear();
+			window_start = window_end;
+		};
+		
     	for (unsigned int s=0; s< switch_cache.size(); s++)
     	{	
+			if (batch_colourings && s == window_start + batch_window)
+				write_batch_window(s);
+			
 			string next_switch;
 			string switch_title;
 //			first_time = true; // with this switch
@@ -2693,6 +2805,10 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			}
 			else if (braid_control::FINITE_SWITCH_INVARIANT) // includes braid_control::HOMOLOGY and braid_control::COHOMOLOGY
 			{
+				/* with batch_colourings the report of the switch is held until the colourings of its window have been evaluated */
+				ostream& switch_cout = (batch_colourings? static_cast<ostream&>(held_cout[s-window_start]): cout);
+				ostream& switch_output = (batch_colourings? static_cast<ostream&>(held_output[s-window_start]): static_cast<ostream&>(output));
+				
 				/*  determine the value of n, whether the switch is numbered from 
 				    zero and how many terms we've been given
 				*/
@@ -2781,15 +2897,15 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				{
 					if (!braid_control::SILENT_OPERATION)
 					{
-						cout << "\nError! Incorrect number of terms in switch: " << next_switch
+						switch_cout << "\nError! Incorrect number of terms in switch: " << next_switch
 							 << " found " << switch_terms << " terms, expected " <<
 							(default_twist? 2*size*size: 4*size*size) << endl;
 					}
 
 					if (!braid_control::RAW_OUTPUT)
 					{
-						output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-						output << "Error! Incorrect number of terms in switch: " << next_switch << endl;
+						switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+						switch_output << "Error! Incorrect number of terms in switch: " << next_switch << endl;
 					}
 					
 if (debug_control::DEBUG >= debug_control::SUMMARY)	
@@ -3190,23 +3306,23 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 				if (!braid_control::SILENT_OPERATION)
 				{
 					if (essential_welded_pair)
-						cout << "\nEssential welded pair";
+						switch_cout << "\nEssential welded pair";
 					else if (essential_doodle_pair)
-						cout << "\nEssential doodle pair";
+						switch_cout << "\nEssential doodle pair";
 					else if (!braid_control::CLASSICAL_ONLY)
-						cout << "\nEssential virtual pair";
+						switch_cout << "\nEssential virtual pair";
 				}
 
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 
 					if (essential_welded_pair)
-						output << "Essential welded pair";
+						switch_output << "Essential welded pair";
 					else if (essential_doodle_pair)
-						output << "Essential doodle pair";
+						switch_output << "Essential doodle pair";
 					else if (!braid_control::CLASSICAL_ONLY)
-						output << "Essential virtual pair";
+						switch_output << "Essential virtual pair";
 				}
 				
 //				if (switch_cache.size() && switch_cache[s].first != "")
@@ -3214,12 +3330,12 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 				{
 					if (!braid_control::SILENT_OPERATION)
 //						cout << "\n" << switch_cache[s].first;
-						cout << "\n" << switch_cache[s].title;
+						switch_cout << "\n" << switch_cache[s].title;
 					if (!braid_control::RAW_OUTPUT)
 					{
-						output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+						switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 //						output << switch_cache[s].first;
-						output << switch_cache[s].title;
+						switch_output << switch_cache[s].title;
 					}
 				}
 
@@ -3227,40 +3343,40 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 				matrix_control::SINGLE_LINE_OUTPUT = true;
 				if (!braid_control::SILENT_OPERATION)
 				{
-					cout << "\nSu = ";
-					display_fixed_point_switch(Su, cout, number_from_zero);
-					cout << "  Sd = ";
-					display_fixed_point_switch(Sd, cout, number_from_zero);
-					cout << "\nTu = ";
-					display_fixed_point_switch(Tu, cout, number_from_zero);
-					cout << "  Td = ";
-					display_fixed_point_switch(Td, cout, number_from_zero);
-					cout << endl;
-					cout << "\nInverse invSu = ";
-					display_fixed_point_switch(invSu, cout, number_from_zero);
-					cout << "  invSd = ";
-					display_fixed_point_switch(invSd, cout, number_from_zero);
-					cout << "\n" << endl;
+					switch_cout << "\nSu = ";
+					display_fixed_point_switch(Su, switch_cout, number_from_zero);
+					switch_cout << "  Sd = ";
+					display_fixed_point_switch(Sd, switch_cout, number_from_zero);
+					switch_cout << "\nTu = ";
+					display_fixed_point_switch(Tu, switch_cout, number_from_zero);
+					switch_cout << "  Td = ";
+					display_fixed_point_switch(Td, switch_cout, number_from_zero);
+					switch_cout << endl;
+					switch_cout << "\nInverse invSu = ";
+					display_fixed_point_switch(invSu, switch_cout, number_from_zero);
+					switch_cout << "  invSd = ";
+					display_fixed_point_switch(invSd, switch_cout, number_from_zero);
+					switch_cout << "\n" << endl;
 				}
 				if (!braid_control::RAW_OUTPUT)
 				{
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");					
-					output << "Su = ";
-					display_fixed_point_switch(Su, output, number_from_zero);
-					output << " Sd = ";
-					display_fixed_point_switch(Sd, output, number_from_zero);
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-					output <<  "Tu = ";
-					display_fixed_point_switch(Tu, output, number_from_zero);
-					output << " Td = ";
-					display_fixed_point_switch(Td, output, number_from_zero);
-					output << endl;
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
-					output <<  "Inverse invSu = ";
-					display_fixed_point_switch(invSu, output, number_from_zero);
-					output << " invSd = ";
-					display_fixed_point_switch(invSd, output, number_from_zero);
-					output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");					
+					switch_output << "Su = ";
+					display_fixed_point_switch(Su, switch_output, number_from_zero);
+					switch_output << " Sd = ";
+					display_fixed_point_switch(Sd, switch_output, number_from_zero);
+					switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					switch_output <<  "Tu = ";
+					display_fixed_point_switch(Tu, switch_output, number_from_zero);
+					switch_output << " Td = ";
+					display_fixed_point_switch(Td, switch_output, number_from_zero);
+					switch_output << endl;
+					switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
+					switch_output <<  "Inverse invSu = ";
+					display_fixed_point_switch(invSu, switch_output, number_from_zero);
+					switch_output << " invSd = ";
+					display_fixed_point_switch(invSd, switch_output, number_from_zero);
+					switch_output << (braid_control::OUTPUT_AS_INPUT? "\n;" : "\n");
 				}
 				matrix_control::SINGLE_LINE_OUTPUT = saved_bool;
 				
@@ -3784,10 +3900,22 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 				}
 				else // COCYCLE_INVARIANT or number of fixed points
 				{
-					string input_string;
-					while (get_next_input_string(command_line_input_file,input_string, title))
-//						colouring_invariant(Su, Sd, invSu, invSd, Tu, Td, pair_type, input_string, title);			
-						colouring_invariant(Su, Sd, invSu, invSd, Tu, Td, pair_type, input_string, title, switch_cache[s]);			
+					if (batch_colourings)
+					{
+						batch_switch.push_back(batch_switch_data(s,Su,Sd,invSu,invSd,Tu,Td,pair_type));
+					}
+					else if (command_line_input_file.length())
+					{
+						for (unsigned int i=0; i< finite_switch_input.size(); i++)
+							colouring_invariant(Su, Sd, invSu, invSd, Tu, Td, pair_type, finite_switch_input[i].first, finite_switch_input[i].second, switch_cache[s]);
+					}
+					else
+					{
+						string input_string;
+						while (get_next_input_string(command_line_input_file,input_string, title))
+//							colouring_invariant(Su, Sd, invSu, invSd, Tu, Td, pair_type, input_string, title);			
+							colouring_invariant(Su, Sd, invSu, invSd, Tu, Td, pair_type, input_string, title, switch_cache[s]);			
+					}
 				}
 			}
 			else if (braid_control::COMMUTATIVE_AUTOMORPHISM)
@@ -4004,6 +4132,9 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 				
 			}
 	    }
+	    
+	    if (batch_colourings)
+			write_batch_window(switch_cache.size());
 	}
 	else
 	{
@@ -4200,6 +4331,22 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 
 		}		
 	}
+	else if (option.find("bracket-engine") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+		{
+			string engine = option.substr(pos+1);
+			if (engine == "tangle")
+				braid_control::BRACKET_ENGINE = braid_control::bracket_engine::TANGLE;
+			else if (engine == "state-sum")
+				braid_control::BRACKET_ENGINE = braid_control::bracket_engine::STATE_SUM;
+			else
+				braid_control::BRACKET_ENGINE = braid_control::bracket_engine::AUTOMATIC;
+		}
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: BRACKET_ENGINE = " << braid_control::BRACKET_ENGINE << " read from " << source << endl;
+	}
 	else if (option == "braid-permutation")
 	{
    		braid_control::BRAID_PERMUTATION = true;
@@ -4221,6 +4368,14 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: BURAU read from " << source << endl;
 	}	
+	else if (option.find("canonical-cache") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+			get_number(braid_control::canonical_cache_limit,option,pos+1);
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: canonical_cache_limit read from " << source << ", canonical_cache_limit = " << braid_control::canonical_cache_limit << endl;
+	}
 	else if (option == "classical")
 	{
     	braid_control::CLASSICAL_ONLY = true;
@@ -4272,6 +4427,20 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: COHOMOLOGY read from " << source << "braid_control::homology_index = " << braid_control::homology_index << endl;
 	}
+	else if (option.find("colouring-engine") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+		{
+			string engine = option.substr(pos+1);
+			if (engine == "exhaustive")
+				braid_control::COLOURING_ENGINE = braid_control::colouring_engine::EXHAUSTIVE;
+			else
+				braid_control::COLOURING_ENGINE = braid_control::colouring_engine::PROPAGATE;
+		}
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: COLOURING_ENGINE = " << braid_control::COLOURING_ENGINE << " read from " << source << endl;
+	}
 	else if (option == "colouring-invariant")
 	{
 		braid_control::SWITCH_POLYNOMIAL_INVARIANT = true;
@@ -4314,6 +4483,24 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: DISPLAY_DELTA_1_ONLY read from " << source << endl;
 	}
+	else if (option.find("determinant-algorithm") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+		{
+			string algorithm = option.substr(pos+1);
+			if (algorithm == "expansion")
+				matrix_control::DETERMINANT_ALGORITHM = matrix_control::expansion;
+			else if (algorithm == "bareiss")
+				matrix_control::DETERMINANT_ALGORITHM = matrix_control::bareiss;
+			else if (algorithm == "modular")
+				matrix_control::DETERMINANT_ALGORITHM = matrix_control::modular;
+			else
+				matrix_control::DETERMINANT_ALGORITHM = matrix_control::automatic;
+		}
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: DETERMINANT_ALGORITHM = " << matrix_control::DETERMINANT_ALGORITHM << " read from " << source << endl;
+	}
 /*    else if (option == "doodle")
 	{
 		braid_control::DOODLE_CONDITIONS = true;
@@ -4438,12 +4625,42 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: HC_LIST_ALL read from " << source << endl;
 	}
+	else if (option.find("homfly-cache") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+			get_number(braid_control::homfly_cache_limit,option,pos+1);
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: homfly_cache_limit read from " << source << ", homfly_cache_limit = " << braid_control::homfly_cache_limit << endl;
+	}
 	else if (option == "homfly")
 	{
     	braid_control::HOMFLY = true;
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: HOMFLY read from " << source << endl;
 	}
+	else if (option == "modular-homology")
+	{
+    	braid_control::MODULAR_HOMOLOGY = true;
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: MODULAR_HOMOLOGY read from " << source << endl;
+	}
+	else if (option.find("homology-engine") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+		{
+			string engine = option.substr(pos+1);
+			if (engine == "sparse")
+				braid_control::HOMOLOGY_ENGINE = braid_control::homology_engine::SPARSE;
+			else if (engine == "auto")
+				braid_control::HOMOLOGY_ENGINE = braid_control::homology_engine::BY_SIZE;
+			else
+				braid_control::HOMOLOGY_ENGINE = braid_control::homology_engine::DENSE;
+		}
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: HOMOLOGY_ENGINE = " << braid_control::HOMOLOGY_ENGINE << " read from " << source << endl;
+	}
 	else if (option.find("homology") != string::npos)
 	{
     	braid_control::HOMOLOGY = true;
@@ -4652,6 +4869,14 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: PLANE_REFLECT_INPUT read from " << source << endl;
 	}
+	else if (option.find("polynomial-terms") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+			polynomial_control::ACCUMULATE_PTERMS = (option.substr(pos+1) != "insert");
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: polynomial_control::ACCUMULATE_PTERMS = " << polynomial_control::ACCUMULATE_PTERMS << " read from " << source << endl;
+	}
 	else if (option.find("power") != string::npos)
 	{
 
@@ -4791,6 +5016,18 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "set_programme_long_option: braid_control::TeX_POLYNOMIAL_OUTPUT read from " << source << endl;
 	}
+	else if (option.find("threads") != string::npos)
+	{
+		size_t pos = option.find('=');
+		if (pos != string::npos)
+   		{
+			int threads;
+			get_number(threads,option,pos+1);
+	    	braid_control::num_threads = max(threads,1);
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+	debug << "set_programme_long_option: num_threads " << braid_control::num_threads << " read from " << source << endl;
+   		}
+	}
 	else if (option == "turning-number")
 	{
     	braid_control::VOGEL_ALGORITHM = true;
@@ -4953,10 +5190,14 @@ void set_programme_short_option(string argument)
 
 			cout << "  bigint                     use arbitrary precision arithmetic for evaluating homology generators\n";
 	    	cout << "  birack-homology:           calculate birack homology or cohomology, rather than the biquandle variant\n";
+			cout << "  bracket-engine=tangle|state-sum  evaluate the Kauffman bracket by cutting the diagram into tangles, or by a sum over all states\n";
+			cout << "  canonical-cache=n          record at most n left or over preferred Gauss codes in the canonical Gauss code caches, n=0 disables the caches, default 10000\n";
 			cout << "  classical                  classical input only, no need to test conditions related to other knot theories\n";
+			cout << "  colouring-engine=propagate|exhaustive  find colourings by propagating labels through the diagram, or by an exhaustive search\n";
 			cout << "  complex-delta1             calculate Delta_1^C rather than Delta_1^H for quaternionic switches\n";
 			cout << "  delta0-only                display polynomial output for Delta_0 only\n";
 			cout << "  delta1-only                display polynomial output for Delta_1 only\n";
+			cout << "  determinant-algorithm=bareiss|expansion|modular  evaluate polynomial determinants by fraction-free elimination, cofactor expansion or modular interpolation\n";
 			cout << "  double-biracks             evaluate the double of input biracks before applying them to a task\n";
 			cout << "  double-braid               calculate the Kamada double covering of all the braids in the input file\n";
 			cout << "  equality                   test for A=D or B=C in switch when calculating switch polynomial invariants\n";
@@ -4969,10 +5210,13 @@ void set_programme_short_option(string argument)
 			cout << "  HC-edges                   create Hamiltonian circuits from edges rather than crossings\n";
 			cout << "  HC-include-edge            find only Hamiltonian circuits that include a specified edge\n";
 			cout << "  HC-list-all                find all of the Hamiltonian circuits in a diagram\n";
+			cout << "  homfly-cache=n             record at most n polynomials in the HOMFLY skein tree cache, n=0 disables the cache, default 100000\n";
+			cout << "  homology-engine=dense|sparse|auto  evaluate homology generators from dense or sparse boundary maps, or choose by size, default dense\n";
 			cout << "  invert-braid               invert all the braids in the input file\n";
 			cout << "  line-reflect-braid         reflect all the braids in the file in a horizontal line drawn south of the braid\n";
 			cout << "  lpgd                       calculate the left preferred Gauss code, rather than a standard gauss code\n";
 			cout << "  mod-p=n                    calculate mod p with p=n (only used for non-Weyl algebra switches)\n";
+			cout << "  modular-homology           evaluate integer or rational homology generators modulo word-size primes where possible\n";
 			cout << "  no-auto-delta1             only calculate Delta_1 if Delta_0 is zero\n";
 			cout << "  no-even-writhe             normalize the parity bracket polynomial with the full writhe rather than the even writhe\n";
 			cout << "  no-expanded-bracket        do not expand D=(-A^2-A^{-2}) in bracket polynomials\n";
@@ -4984,6 +5228,7 @@ void set_programme_short_option(string argument)
 			cout << "  OU-format                  write Gauss codes as a sequence (O|U)<crossing-num><crossing-sign>\n";
 			cout << "  PD-format                  write Gauss code as a planar diagram\n";
 			cout << "  plane-reflect-input        reflect all the braids and peer codes in the input file in the plane of the page\n";
+			cout << "  polynomial-terms=sort|insert  combine the terms of polynomial products and sums by sorting them once, or by inserting each term, default sort\n";
 			cout << "  power=n                    evaluate the nth power of the switch when calculating switch polynomial invariants\n";
 			cout << "  rational                   use rational coefficients for evaluating homology generators, may be combined with bigint for big-rationals\n";
 			cout << "  raw-output                 produce raw output, that is the result only without descriptive text\n";
@@ -4997,6 +5242,7 @@ void set_programme_short_option(string argument)
 			cout << "  show-varmaps               show variable mappings instead of substituting mapped variables in polynomial output\n";
 			cout << "  silent                     do not generate any output to the command line (stdout)\n";
 			cout << "  TeX-polynomials            display output polynomials in TeX format\n";
+			cout << "  threads=n                  use n worker threads for bracket states, Delta_1 minors, colourings and Hamiltonian circuits\n";
 			cout << "  ulpgd                      calculate the unoriented left preferred Gauss code, rather than a standard gauss code\n";
 			cout << "  uopgc                      calculate the unoriented over preferred Gauss code, rather than a standard gauss code\n";
 			cout << "  wait[=n]                   display determinant wait information, (based on nxn minors, so larger n produces less frequent output)\n";
@@ -6486,11 +6732,87 @@ matrix<polynomial<T,V>,St> R_study_matrix(const matrix<polynomial<T,V>,St>& C_ma
 	return R_matrix;
 }
 
+/* batch_colouring_invariant evaluates in advance the colourings required by colouring_invariant for each of the switches in batch_switch
+   and each of the input strings in finite_switch_input, using braid_control::num_threads worker threads, so that the work is shared 
+   across every switch and knot pair rather than across the knots of a single switch.  It supports the colouring invariant, the 
+   birack polynomial and the cocycle invariant of both braids and labelled peer codes.
+   
+   For each switch, colouring_invariant is first called for each input string with a copy of the switch data in which batch_recording 
+   is set, so that the colourings it requires are recorded, rather than evaluated, by batch_colouring_data.  The output of these calls
+   is discarded.  The recorded colourings of all the switches are then evaluated by the worker threads and the results are recorded in
+   the batch_colourings of the corresponding switch in the switch_cache, from where they are retrieved when the input strings are 
+   subsequently processed in order by colouring_invariant, so the output is unchanged.
+*/
+void batch_colouring_invariant(vector<batch_switch_data>& batch_switch, vector<generic_switch_data>& switch_cache, vector<pair<string,string> >& finite_switch_input)
+{
+	int num_switches = batch_switch.size();
+	vector<generic_switch_data> recording_data(num_switches);
+	vector<pair<int,map<string,function<colouring_data()> >::iterator> > request;  // the batch_switch index and recorded colouring
+	
+	/* the output of the recording is discarded by a stream without a buffer */
+	ostream discard(0);
+	
+	for (int i=0; i< num_switches; i++)
+	{
+		batch_switch_data& b = batch_switch[i];
+		generic_switch_data& switch_data = recording_data[i];
+
+		switch_data = switch_cache[b.index];
+		switch_data.batch_recording = true;
+		
+		for (unsigned int j=0; j< finite_switch_input.size(); j++)
+		{
+			colouring_invariant(b.Su, b.Sd, b.invSu, b.invSd, b.Tu, b.Td, b.pair_type, finite_switch_input[j].first, finite_switch_input[j].second, switch_data, discard, discard);
+		}
+		
+		switch_data.batch_recording = false;
+		switch_data.batch_evaluating = true;
+		
+		map<string,function<colouring_data()> >::iterator mptr = switch_data.batch_request.begin();
+		while (mptr != switch_data.batch_request.end())
+		{
+			request.push_back(pair<int,map<string,function<colouring_data()> >::iterator>(i,mptr));
+			mptr++;
+		}
+	}
+	
+	/* the recording data is read by the workers, so each result is recorded in the switch_cache */
+	auto evaluate = [&](int i, colouring_data& result)
+	{
+		result = request[i].second->second();
+	};
+	
+	auto fold = [&](int i, colouring_data& result)
+	{
+		switch_cache[batch_switch[request[i].first].index].batch_colourings[request[i].second->first] = result;
+		return false;
+	};
+	
+	ordered_parallel_fold(request.size(), braid_control::num_threads, colouring_data(), evaluate, fold);
+}
+
+/* delta_1_minor records the rows r1, r2 and columns c1, c2, c3 removed from the matrix to form a minor in delta_1, unused 
+   indices being zero, as in the parameters of minor_determinant.
+*/
+struct delta_1_minor
+{
+	int r1;
+	int r2;
+	int c1;
+	int c2;
+	int c3;
+	
+	delta_1_minor(int a, int b, int c, int d, int e): r1(a), r2(b), c1(c), c2(d), c3(e) {}
+};
+
 /* delta_1 evaluates the gcd of the generators of the first elementary ideal, E_1,
    determined by the matrix M.  It is able to work with the intermediate
    ideals determined by mapping from M_{n,m}(H) into M_{2n,2m}(C) and evaluating codimension
    1 or 2 determinants of the image in M_{2n,2m}(C), providing M is given as 
    this image at the time of the call.  
+   
+   The minors are listed in the order in which they are folded into the gcd, so that with the threads 
+   option they may be evaluated in parallel by ordered_parallel_fold without affecting the result.
 */
 template <typename T, typename St> T delta_1(const matrix<T,St>& M, int codimension, string title, T delta_0 = T("0"))
 {
@@ -6503,8 +6825,37 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
 	int matrix_rows = M.numrows();
 	int matrix_cols = M.numcols();
 	
-	vector<int> rperm(matrix_rows);
-	vector<int> cperm(matrix_cols);
+	/* minor_determinant sets s=1 in each generator unless we are working with quaternions, so unless the generators are to be 
+	   displayed we set s=1 in the matrix before evaluating the minors, which gives the same generators more cheaply.  The matrix 
+	   with s=1 is also used for the modular check below when the generators are displayed.
+	*/
+	bool unit_s = !braid_control::QUATERNION && !braid_control::EXTRA_OUTPUT;
+	matrix<T,St> unit_s_matrix;
+	if (!braid_control::QUATERNION)
+	{
+		unit_s_matrix = M;
+		for (int i=0; i< matrix_rows; i++)
+		for (int j=0; j< matrix_cols; j++)
+		{
+			if (unit_s_matrix[i][j].nv && find(unit_s_matrix[i][j].vc.begin(),unit_s_matrix[i][j].vc.end(),'s')!=unit_s_matrix[i][j].vc.end())
+			    set_to_one(unit_s_matrix[i][j],'s');
+		}
+	}
+	const matrix<T,St>& minor_matrix = (unit_s? unit_s_matrix: M);
+	
+	/* Once the hcf is non-zero, a minor whose determinant is a multiple of the hcf with larger span leaves the hcf unchanged, so
+	   where the generators are polynomials in a single variable we use a modular check to skip such minors.
+	*/
+	vector<vector<modular_term> > modular_entry;
+	char modular_variable;
+	if (braid_control::QUATERNION || matrix_rows-codimension < 2 || !modular_minor_matrix(unit_s_matrix, modular_entry, modular_variable))
+		modular_entry.clear();
+
+	int num_pruned = 0;
+	
+	/* In the case of a long knot there is one more column than row, so we remove an extra column */
+	bool long_knot = matrix_cols > matrix_rows;
+	vector<delta_1_minor> minor;
 	
 	if (codimension == 1)
 	{
@@ -6513,50 +6864,16 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
     debug << "delta_1: codimension 1 generators of 1st elementary ideal, E_1:" << endl;
 
 		for (int r1=0;r1<matrix_rows;r1++)
-    	{
-			if (!braid_control::SILENT_OPERATION && matrix_control::WAIT_INFO && matrix_control::COMFORT_DOTS)
+		for (int c1=0;c1<matrix_cols;c1++)
+		{
+			if (long_knot)
 			{
-				cout << ".";
-				cout.flush();
+				for (int c2= c1+1; c2< matrix_cols; c2++)
+					minor.push_back(delta_1_minor(r1,0,c1,c2,0));
 			}
-
-			/* take out the r1-th row */
-			for (int i=0; i<r1; i++)
-			    rperm[i] = i;
-			for (int i=r1+1; i<matrix_rows; i++)
-			    rperm[i-1] = i;
-
-			for (int c1=0;c1<matrix_cols;c1++)
+			else
 			{
-			    /* take out the c1-th column */
-		    	for (int i=0; i<c1; i++)
-				cperm[i] = i;
-					
-				if (matrix_cols > matrix_rows)
-				{
-					/* We're dealing with a long knot and there is one extra column than row */
-					for (int c2= c1+1; c2< matrix_cols; c2++)
-					{
-						/* take out the c2-nd column */
-						for (int i=c1+1; i<c2; i++)
-						    cperm[i-1] = i;
-					
-			    		for (int i=c2+1; i<matrix_cols; i++)
-							cperm[i-2] = i;
-						
-						if (minor_determinant(hcf, M, rperm, cperm, codimension, r1, 0, c1, c2, 0, title))
-							goto delta_1_calculation_complete;
-						
-					}
-				}
-				else
-				{				
-			    	for (int i=c1+1; i<matrix_cols; i++)
-					cperm[i-1] = i;
-
-					if (minor_determinant(hcf, M, rperm, cperm, codimension, r1, 0, c1, 0, 0, title))
-						goto delta_1_calculation_complete;
-				}
+				minor.push_back(delta_1_minor(r1,0,c1,0,0));
 			}
 		}
 	}
@@ -6567,66 +6884,18 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
     debug << "delta_1: codimension 2 generators of intermediate 1st elementary ideal, E_1:" << endl;
 	
 		for (int r1=0;r1<matrix_rows;r1++)
-    	{
-
-			if (!braid_control::SILENT_OPERATION && matrix_control::WAIT_INFO && matrix_control::COMFORT_DOTS)
+		for (int r2= r1+1; r2< matrix_rows; r2++)
+		for (int c1=0;c1<matrix_cols;c1++)
+		for (int c2= c1+1; c2< matrix_cols; c2++)
+		{
+			if (long_knot)
 			{
-				cout << ".";
-				cout.flush();
+				for (int c3= c2+1; c3< matrix_cols; c3++)
+					minor.push_back(delta_1_minor(r1,r2,c1,c2,c3));
 			}
-
-			/* take out the r1-th row */
-			for (int i=0; i<r1; i++)
-			    rperm[i] = i;
-			
-			for (int r2= r1+1; r2< matrix_rows; r2++)
+			else
 			{
-				/* take out the r2-nd row */
-				for (int i=r1+1; i<r2; i++)
-				    rperm[i-1] = i;
-				
-				for (int i=r2+1; i<matrix_rows; i++)
-			    	rperm[i-2] = i;
-
-				for (int c1=0;c1<matrix_cols;c1++)
-				{
-				    /* take out the c1-th column */
-			    	for (int i=0; i<c1; i++)
-						cperm[i] = i;
-					
-					for (int c2= c1+1; c2< matrix_cols; c2++)
-					{
-						/* take out the c2-nd column */
-						for (int i=c1+1; i<c2; i++)
-						    cperm[i-1] = i;
-					
-						if (matrix_cols > matrix_rows)
-						{
-							/* We're dealing with a long knot and there is one extra column than row */
-							for (int c3= c2+1; c3< matrix_cols; c3++)
-							{
-								/* take out the c3-rd column */
-								for (int i=c2+1; i<c3; i++)
-						    		cperm[i-2] = i;
-					
-			    				for (int i=c3+1; i<matrix_cols; i++)
-									cperm[i-3] = i;
-						
-								if (minor_determinant(hcf, M, rperm, cperm, codimension, r1, r2, c1, c2, c3, title))
-									goto delta_1_calculation_complete;
-							}
-						}
-						else
-						{
-				    		for (int i=c2+1; i<matrix_cols; i++)
-								cperm[i-2] = i;
-						
-							if (minor_determinant(hcf, M, rperm, cperm, codimension, r1, r2, c1, c2, 0, title))
-								goto delta_1_calculation_complete;
-						}
-
-					}
-				}
+				minor.push_back(delta_1_minor(r1,r2,c1,c2,0));
 			}
 		}
     }
@@ -6639,37 +6908,172 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		exit(0);
 	}
 
-delta_1_calculation_complete:
+	/* The debug output is not thread safe, so we use a single thread if debugging.  The wait information in matrix_control 
+	   is shared between threads, so it is suspended while the workers evaluate the minors.
+	*/
+	bool wait_info = matrix_control::WAIT_INFO;
+	int num_workers = 1;
+	if (braid_control::num_threads > 1 && debug_control::DEBUG == debug_control::OFF)
+		num_workers = braid_control::num_threads;
+
+	/* when the minors are shared between workers each minor is evaluated by a single thread */
+	int minor_threads = (num_workers > 1? 1 : braid_control::num_threads);
+
+	/* The workers check minors against a copy of the hcf taken under hcf_mutex.  Since the hcf only ever 
+	   becomes a divisor of its earlier values, a minor that is a proper multiple of an earlier hcf is 
+	   also a proper multiple of the current one.
+	*/
+	mutex hcf_mutex;
+	
+	/* evaluate sets the generator in the second element of result, or sets the first element to false if the minor is pruned.  
+	   With the extra-output option every generator is displayed, so minors that would be pruned are evaluated and counted.
+	*/
+	auto evaluate = [&](int i, pair<bool,T>& result)
+	{
+		const delta_1_minor& m = minor[i];
+		
+		/* take out the rows r1 (and r2) and the columns c1, (c2 and c3) */
+		vector<int> rperm;
+		for (int r=0; r< matrix_rows; r++)
+		{
+			if (r != m.r1 && (codimension == 1 || r != m.r2))
+				rperm.push_back(r);
+		}
+		
+		vector<int> cperm;
+		for (int c=0; c< matrix_cols; c++)
+		{
+			if (c != m.c1 && ((codimension == 1 && !long_knot) || c != m.c2) && (codimension == 1 || !long_knot || c != m.c3))
+				cperm.push_back(c);
+		}
+
+		T current_hcf;
+		if (modular_entry.size())
+		{
+			lock_guard<mutex> lock(hcf_mutex);
+			current_hcf = hcf;
+		}
+		
+		result.first = minor_generator(result.second, minor_matrix, rperm, cperm, codimension, m.r1, m.r2, m.c1, m.c2, m.c3, title, 
+		                               current_hcf, modular_entry, modular_variable, minor_threads, braid_control::EXTRA_OUTPUT);
+	};
+
+	/* we write a comfort dot as we reach each row r1, as did the loops over the rows that the list of minors replaces */
+	int num_dots = 0;
+	bool terminated = false;
+	
+	auto fold = [&](int i, pair<bool,T>& result)
+	{
+		const delta_1_minor& m = minor[i];
+
+		for (; num_dots <= m.r1; num_dots++)
+		{
+			if (!braid_control::SILENT_OPERATION && wait_info && matrix_control::COMFORT_DOTS)
+			{
+				cout << ".";
+				cout.flush();
+			}
+		}
+		
+		if (!result.first)
+		{
+			num_pruned++;
+			if (!braid_control::EXTRA_OUTPUT)
+				return false;
+		}
+
+		T new_hcf = hcf;
+		terminated = minor_determinant(new_hcf, result.second, codimension, m.r1, m.r2, m.c1, m.c2, m.c3);
+		
+		lock_guard<mutex> lock(hcf_mutex);
+		hcf = new_hcf;
+		return terminated;
+	};
+	
+	if (num_workers > 1)
+		matrix_control::WAIT_INFO = false;
+
+	ordered_parallel_fold(minor.size(), num_workers, pair<bool,T>(false,T("0")), evaluate, fold);
+	
+	matrix_control::WAIT_INFO = wait_info;
+	
+	for (; !terminated && num_dots < matrix_rows; num_dots++)
+	{
+		if (!braid_control::SILENT_OPERATION && matrix_control::WAIT_INFO && matrix_control::COMFORT_DOTS)
+		{
+			cout << ".";
+			cout.flush();
+		}
+	}
+
+	if (num_pruned && !braid_control::SILENT_OPERATION && matrix_control::WAIT_INFO && !braid_control::EXTRA_OUTPUT)
+		cout << "\n" << num_pruned << " minors pruned by modular check";
+		
+	/* with extra-output every minor is evaluated, so report how many would otherwise have been pruned, provided the modular check was made */
+	if (braid_control::EXTRA_OUTPUT && modular_entry.size())
+	{
+		ostringstream oss;
+		oss << num_pruned << " of " << minor.size() << " minors shown by the modular check to be multiples of the gcd, pruned without extra-output";
+			
+		if (!braid_control::SILENT_OPERATION)
+			cout << "\n" << oss.str();
+		if (!braid_control::RAW_OUTPUT)
+			output << "\n" << oss.str();
+	}
+
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
+	if (modular_entry.size())
+	    debug << "delta_1: " << num_pruned << " minors pruned by modular check" << endl;
+	else
+	    debug << "delta_1: modular check not applicable, no minors pruned" << endl;
+}
+
 	return hcf;
 }
 
-/* minor determinant is a macro-like function that is only used because delta_1
-   needs to cope with codimension 1 and 2 cases for both square and non-square matrices, 
-   so this function provides common code for all cases.  The parameters at the call
-   are therefore essentially the same as those for delta_1.
+/* minor_generator evaluates the generator of E_1 given by the minor of M determined by rperm and cperm, which 
+   is obtained by removing the rows r1 (and r2) and columns c1 (c2 and c3) from M.  If modular_entry is not empty 
+   the minor is first checked using modular_minor_multiple and the function returns false if it cannot change 
+   the hcf, without evaluating the generator unless evaluate_multiples is true.  Otherwise the function returns true.
    
-   The function was extended in version 12.0 to return a boolean indicating whether or not the
-   minor determinant it calculates is a unit.  If so then the function returns true, otherwise
-   it returns false.
+   Since the function may be called by several threads at once it must not change any shared state.  The modular check and the
+   determinant use num_threads worker threads of their own, so the caller sets num_threads to one when the minors themselves are
+   shared between workers.
 */
-template <typename T, typename St> bool minor_determinant(T& hcf, const matrix<T,St>& M, vector<int> rperm, vector<int> cperm,
-                       int codimension, int r1, int r2, int c1, int c2, int c3, string title)
+template <typename T, typename St> bool minor_generator(T& delta, const matrix<T,St>& M, const vector<int>& rperm, const vector<int>& cperm,
+                       int codimension, int r1, int r2, int c1, int c2, int c3, string title, const T& hcf,
+                       const vector<vector<modular_term> >& modular_entry, char modular_variable, int num_threads, bool evaluate_multiples)
 {
 	/* rperm and cperm will always indicate a square submatrix of M but there may be more columns than rows
 	   in M, so we use the number of rows as the matrix_size to pass to the determinant functions*/	
     int matrix_size = M.numrows();
+	bool multiple = false;
+	
+	if (modular_entry.size() && modular_minor_multiple(modular_entry, M.numcols(), modular_variable, matrix_size-codimension, rperm, cperm, hcf, num_threads))
+	{
+if (debug_control::DEBUG >= debug_control::SUMMARY)
+{
+	if (codimension == 2)
+		debug << "minor_generator: generator (" << r1 << " & " << r2 << "," << c1 << " & " << c2 << ") is a multiple of the gcd" << (evaluate_multiples? "" : ", pruned") << endl;
+	else
+    	debug << "minor_generator: generator (" << r1 << "," << c1 << ") is a multiple of the gcd" << (evaluate_multiples? "" : ", pruned") << endl;
+}
+		if (!evaluate_multiples)
+			return false;
+			
+		multiple = true;
+	}
 	
-	T delta;
-
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-    debug << "minor_determinant: matrix_size = " << matrix_size << ", codimension = " << codimension
+    debug << "minor_generator: matrix_size = " << matrix_size << ", codimension = " << codimension
           << ", r1=" << r1 << ", r2=" << r2 << ", c1=" << c1 << ", c2=" << c2 << ", c3=" << c3 << endl;;
-    debug << "minor_determinant: rperm: ";
+    debug << "minor_generator: rperm: ";
 	for ( int k = 0 ; k< matrix_size-codimension; k++)
     	debug << rperm[k] << " ";
 	debug << endl;
-    debug << "minor_determinant: cperm: ";
+    debug << "minor_generator: cperm: ";
 	for ( int k = 0 ; k< matrix_size-codimension; k++)
     	debug << cperm[k] << " ";
 	debug << endl;
@@ -6689,7 +7093,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 			   because the matrix contains complex or real entries
 			   determined in the course of evaluating the Study versions of Delta_1
 			*/	
-    			delta = determinant(M,title,matrix_size-codimension,rperm,cperm);
+    			delta = determinant(M,title,matrix_size-codimension,rperm,cperm,num_threads);
 			
 		}
 		else
@@ -6699,7 +7103,24 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
     		delta = study_determinant(M,title,matrix_size-codimension,rperm,cperm);
 		}
    	}
+	
+	return !multiple;
+}
 
+/* minor determinant is a macro-like function that is only used because delta_1
+   needs to cope with codimension 1 and 2 cases for both square and non-square matrices, 
+   so this function provides common code for all cases.  The parameters at the call
+   are therefore essentially the same as those for delta_1.  
+   
+   The function was extended in version 12.0 to return a boolean indicating whether or not the
+   minor determinant it calculates is a unit.  If so then the function returns true, otherwise
+   it returns false.
+   
+   The generator delta is now evaluated by minor_generator, so that the generators may be 
+   evaluated in parallel, and minor_determinant folds it into the hcf.
+*/
+template <typename T> bool minor_determinant(T& hcf, T delta, int codimension, int r1, int r2, int c1, int c2, int c3)
+{
     if (braid_control::EXTRA_OUTPUT)
    	{
 		if (codimension == 1)
@@ -6964,8 +7385,10 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	matrix_rep = identity;		
 
     /* Now evaluate the product of the matrices determined by
-       the word in inbuf.
+       the word in inbuf.  The doodle_term holds the non-trivial column of 
+       a term when calculating the doodle Alexander polynomial.
     */
+	matrix<T,St> doodle_term(3,1);
 	bool S;
 	bool inverse;
     char* cptr = inbuf;
@@ -6994,8 +7417,6 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 		int number;
 		get_number(number, mark);
 
-		matrix<T,St> term = identity;
-
 		const matrix<T,St>* Mptr;
 		
 		if (S && inverse)
@@ -7011,14 +7432,18 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 			Mptr = Twist;
 		}
 				
-		/* determine which form of Sn we are using Sn_matrix_top_down == true iff
+		/* Each term differs from the identity only in a block of columns, so rather than forming the term matrix and 
+		   taking a full matrix product we record the block together with the position of its top left corner in the 
+		   term and update only the corresponding columns of matrix_rep.
+		   
+		   Determine which form of Sn we are using Sn_matrix_top_down == true iff
            Sn = I^{n-1} x S x I^{k-n-1}, otherwise Sn = I^{k-n-1} x S x I^{n-1}
 		*/
 		size_t base;
 		if (braid_control::Sn_matrix_top_down)
 			base = (number-1)*N; // offsets from 0, braid strings from 1
 		else
-			base = term.numcols() - switch_matrix.numcols() - (number-1)*N;  // 
+			base = matrix_rep.numcols() - switch_matrix.numcols() - (number-1)*N;  // 
 			                                                                      
 if (debug_control::DEBUG >= debug_control::DETAIL)
 	debug << "\nbraid_rep: base for S in term matrix is " << base << endl;					
@@ -7026,43 +7451,49 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 		/* If we're calculating the doodle Alexander polynomial, set the term 
 		   explicitly, otherwise set it from Mptr;
 		*/
+		const matrix<T,St>* term = Mptr;
+		size_t row_base = base;
+		size_t col_base = base;
 																	  																					   
 	    if (braid_control::DOODLE_ALEXANDER)
 		{
+			/* The doodle term differs from the identity only in column number-1 */
+			col_base = number-1;
+			
 			if (number == 1)
 			{
-				term[0][0] = T("-1");
-				term[1][0] = T("x");
+				doodle_term = matrix<T,St>(2,1);
+				doodle_term[0][0] = T("-1");
+				doodle_term[1][0] = T("x");
+				row_base = 0;
 			}
 			else if (number == num_strings-1)
 			{
 				/* If num_strings == 2, number will always be 1.  Therefore here num_strings >= 3 and number >=2 
 				   term is a (num_strings-1,num_strings-1) matrix, so indices up to num_strings-2
 				*/
-				term[num_strings-3][num_strings-2] = T("x");
-				term[num_strings-2][num_strings-2] = T("-1");
+				doodle_term = matrix<T,St>(2,1);
+				doodle_term[0][0] = T("x");
+				doodle_term[1][0] = T("-1");
+				row_base = num_strings-3;
+				col_base = num_strings-2;
 			}
 			else // 2 <= number < num_strings-1
 			{
-				term[number-2][number-1] = T("x");
-				term[number-1][number-1] = T("-1");
-				term[number][number-1] = T("x");
-			}
-		}
-		else
-		{
-			size_t switch_size = switch_matrix.numcols();		
-			for (size_t j=0; j < switch_size; j++)
-			for (size_t k=0; k < switch_size; k++)
-			{
-				term[base+j][base+k] = (*Mptr)[j][k];
+				doodle_term = matrix<T,St>(3,1);
+				doodle_term[0][0] = T("x");
+				doodle_term[1][0] = T("-1");
+				doodle_term[2][0] = T("x");
+				row_base = number-2;
 			}
+			
+			term = &doodle_term;
 		}
 		
 		if (!braid_control::SILENT_OPERATION && braid_control::WAIT_SWITCH)
 			cout << "term " << i+1 << endl;
 			
-		matrix_rep *= term;
+		right_multiply_block(matrix_rep, *term, row_base, col_base);
 
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
@@ -7074,8 +7505,8 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
         debug << "s";
     else
         debug << "t";
-    debug << number << ":\n";
-    debug << term << endl;
+    debug << number << ", rows from " << row_base << ", columns from " << col_base << ":\n";
+    debug << *term << endl;
 
 }
 
@@ -7602,29 +8033,26 @@ if (debug_control::DEBUG >= debug_control::BASIC)
 
 }
 
-/* rat_minor_determinant was introduced for rat_poly_invariant to deal with both long knots and closed knots.  
-   It evaluates a minor determinant and if necessary updates the numerator gcd, returning true if it detects a
-   unit generator or gcd, and false otherwise.
+/* rat_minor_generator writes the generator det of the minor obtained by removing the N-rows and N-columns
+   indicated by Nr1, Nc1 (and Nc2) and updates the numerator gcd, returning true if it detects a unit generator 
+   or gcd, and false otherwise.  It allows rat_poly_invariant to evaluate the minors in parallel.
 */
-bool rat_minor_determinant (Qpmatrix* Matrix_rep, int N, int Nr1, int Nc1, int Nc2, vector<int> rperm, vector<int> cperm, string title, polynomial<scalar,char>& hcf)
+bool rat_minor_generator (Qpolynomial det, int N, int Nr1, int Nc1, int Nc2, const vector<int>& rperm, const vector<int>& cperm, int matrix_rows, polynomial<scalar,char>& hcf)
 {
-	int matrix_rows = Matrix_rep->numrows();
-	Qpolynomial det = determinant(*Matrix_rep, title,  matrix_rows - N, rperm, cperm);
-
 if (debug_control::DEBUG >= debug_control::BASIC)
 {
-	debug << "rat_minor_determinant: " << (braid_control::LONG_KNOT? "p^{(1)}":"Delta_1") << " generator " << N << "-row/column (" << Nr1 << "," << Nc1;
+	debug << "rat_minor_generator: " << (braid_control::LONG_KNOT? "p^{(1)}":"Delta_1") << " generator " << N << "-row/column (" << Nr1 << "," << Nc1;
 	if (braid_control::LONG_KNOT)
 		debug << "&" << Nc2;
 	debug << ")" << endl;
 }
 if (debug_control::DEBUG >= debug_control::DETAIL)
 {
-	debug << "rat_minor_determinant: rperm: ";
+	debug << "rat_minor_generator: rperm: ";
     for (int k = 0 ; k< matrix_rows-N; k++)
 		debug << rperm[k] << " ";
 	debug << endl;
-	debug << "rat_minor_determinant: cperm: ";
+	debug << "rat_minor_generator: cperm: ";
     for (int k = 0 ; k< matrix_rows-N; k++)
 		debug << cperm[k] << " ";
 	debug << endl;
@@ -7650,7 +8078,7 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 {
-	debug << "rat_minor_determinant: ";
+	debug << "rat_minor_generator: ";
 	debug << (braid_control::LONG_KNOT? "p^{(1)}":"Delta_1") << " generator det = " << det << endl;
 }
 
@@ -7670,7 +8098,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		}
 		
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "rat_minor_determinant: unit generator detected, terminating calculation" << endl;
+	debug << "rat_minor_generator: unit generator detected, terminating calculation" << endl;
 
 		if (braid_control::NUMERATOR_GCD)
 			hcf = polynomial<scalar,char>("1");					
@@ -7691,7 +8119,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 		}
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-   	debug << "rat_minor_determinant:  numerator gcd stands at " << hcf << endl;
+   	debug << "rat_minor_generator:  numerator gcd stands at " << hcf << endl;
 	
 		if (braid_control::DELTA_1_UNIT_CHECK && hcf.is_unit())
 		{
@@ -7704,7 +8132,7 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			}
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
-	debug << "rat_minor_determinant: unit gcd detected, terminating calculation" << endl;
+	debug << "rat_minor_generator: unit gcd detected, terminating calculation" << endl;
 
 			return true;; 
 		}
@@ -7714,6 +8142,17 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 	
 }
 
+/* rat_minor_determinant was introduced for rat_poly_invariant to deal with both long knots and closed knots.  
+   It evaluates a minor determinant and if necessary updates the numerator gcd, returning true if it detects a
+   unit generator or gcd, and false otherwise.
+*/
+bool rat_minor_determinant (Qpmatrix* Matrix_rep, int N, int Nr1, int Nc1, int Nc2, vector<int> rperm, vector<int> cperm, string title, polynomial<scalar,char>& hcf)
+{
+	int matrix_rows = Matrix_rep->numrows();
+	Qpolynomial det = determinant(*Matrix_rep, title,  matrix_rows - N, rperm, cperm);
+	return rat_minor_generator(det, N, Nr1, Nc1, Nc2, rperm, cperm, matrix_rows, hcf);
+}
+
 
 /* rat_poly_invariant calculates the codimension 0 and codimension 1 invariants determined by the supplied 
    switch matrix and its inverse for the braid or immersion code given in the input string.  
@@ -8105,59 +8544,83 @@ if (debug_control::DEBUG >= debug_control::INTERMEDIATE)
     debug << "\nrat_poly_invariant: hcf initialized to " << hcf << endl;
 
 
-			vector<int> rperm(matrix_rows);
-			vector<int> cperm(matrix_cols);
-
 			/* take out a (N) row and (N) column from the matrix representation 
-			   and calculate the determinant of what is left
+			   and calculate the determinant of what is left.  In the case of a long knot there is one 
+			   extra N-column than N-row, so we take out a second N-column, Nc2.
 			*/
+			vector<delta_1_minor> minor;
 			for (int Nr1=0;Nr1<matrix_N_rows;Nr1++)
+			for (int Nc1= 0; Nc1< matrix_N_cols; Nc1++)
 			{
-				/* take out the N rows of the matrix rep starting from row Nr1*N row */
-				for (int i=0; i<Nr1*N; i++)
-	    			rperm[i] = i;
-				for (int i = Nr1*N+N; i< matrix_rows; i++)
-					rperm[i-N] = i;
+				if (braid_control::LONG_KNOT)
+				{
+					for (int Nc2= Nc1+1; Nc2< matrix_N_cols; Nc2++)
+						minor.push_back(delta_1_minor(Nr1,0,Nc1,Nc2,0));
+				}
+				else
+				{
+					minor.push_back(delta_1_minor(Nr1,0,Nc1,0,0));
+				}
+			}
 
+			auto rperm = [&](const delta_1_minor& m)
+			{
+				/* take out the N rows of the matrix rep starting from row Nr1*N row */
+				vector<int> perm(matrix_rows);
+				for (int i=0; i<m.r1*N; i++)
+	    			perm[i] = i;
+				for (int i = m.r1*N+N; i< matrix_rows; i++)
+					perm[i-N] = i;
+				return perm;
+			};
+			
+			auto cperm = [&](const delta_1_minor& m)
+			{
+				/* take out the N columns of the matrix rep starting from column N*Nc1, and the Nc2-nd N column for long knots */
+				vector<int> perm(matrix_cols);
+				for (int i=0; i<m.c1*N; i++)
+	   				perm[i] = i;
 
-				int Nc2; // declared here so in scope for debug output below;
-				for (int Nc1= 0; Nc1< matrix_N_cols; Nc1++)
+				if (braid_control::LONG_KNOT)
 				{
-				
-					Qpolynomial det = polynomial<scalar,char> ("0");
-					
-					/* take out the N columns of the matrix rep starting from column N*j */
-					for (int i=0; i<Nc1*N; i++)
-		   				cperm[i] = i;
-
-					if (braid_control::LONG_KNOT)
-					{
-						/* There is one extra N-column than N-row */
-						for (Nc2= Nc1+1; Nc2< matrix_N_cols; Nc2++)
-						{
-							/* take out Nc2-nd N column*/
-							for (int i=Nc1*N+N; i<Nc2*N; i++)
-		   						cperm[i-N] = i;
+					for (int i=m.c1*N+N; i<m.c2*N; i++)
+						perm[i-N] = i;
+					for (int i=m.c2*N+N; i<matrix_cols; i++)
+						perm[i-2*N] = i;
+				}
+				else
+				{
+					for (int i=m.c1*N+N; i<matrix_cols; i++)
+						perm[i-N] = i;
+				}
+				return perm;
+			};
 
-							for (int i=Nc2*N+N; i<matrix_cols; i++)
-		   						cperm[i-2*N] = i;
-								
-							if (rat_minor_determinant(Matrix_rep, N, Nr1, Nc1, Nc2, rperm, cperm, title, hcf))
-								goto rat_poly_delta_1_calculation_complete;
-						}
-					}
-					else
-					{
-						for (int i=Nc1*N+N; i<matrix_cols; i++)
-	   						cperm[i-N] = i;
-						
-						if (rat_minor_determinant(Matrix_rep, N, Nr1, Nc1, Nc2, rperm, cperm, title, hcf))
-							goto rat_poly_delta_1_calculation_complete;
-					}
-				}			
+			/* As in delta_1, the minors are evaluated by worker threads only if we are not debugging, and the 
+			   wait information is suspended while they do so.
+			*/
+			bool wait_info = matrix_control::WAIT_INFO;
+			int num_workers = 1;
+			if (braid_control::num_threads > 1 && debug_control::DEBUG == debug_control::OFF)
+			{
+				num_workers = braid_control::num_threads;
+				matrix_control::WAIT_INFO = false;
 			}
+			int minor_threads = (num_workers > 1? 1 : braid_control::num_threads);
+
+			ordered_parallel_fold(minor.size(), num_workers, Qpolynomial(polynomial<scalar,char> ("0")), 
+				[&](int i, Qpolynomial& det)
+				{
+					det = determinant(*Matrix_rep, title,  matrix_rows - N, rperm(minor[i]), cperm(minor[i]), minor_threads);
+				},
+				[&](int i, Qpolynomial& det)
+				{
+					const delta_1_minor& m = minor[i];
+					return rat_minor_generator(det, N, m.r1, m.c1, m.c2, rperm(m), cperm(m), matrix_rows, hcf);
+				});
+
+			matrix_control::WAIT_INFO = wait_info;
 
-rat_poly_delta_1_calculation_complete:
 
 			if (!braid_control::SILENT_OPERATION)
 				cout << endl;
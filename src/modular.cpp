@@ -0,0 +1,1104 @@
+/**************************************************************************
+                  Word-size modular arithmetic
+
+unsigned int modular_prime(int i)
+unsigned int modular_inverse(unsigned int a, unsigned int p)
+unsigned int modular_determinant(vector<unsigned int>& A, int n, unsigned int p)
+int modular_Smith_normal_form(vector<unsigned int>& D, int n, int m, vector<unsigned int>& P, vector<unsigned int>& Q, unsigned int p)
+bool modular_matrix_inverse(const vector<unsigned int>& A, int n, vector<unsigned int>& inverse, unsigned int p)
+void modular_matrix_product(const vector<unsigned int>& A, const vector<unsigned int>& B, int n, int k, int m, vector<unsigned int>& C, unsigned int p)
+void modular_interpolate(unsigned int* values, int num_points, int stride, unsigned int p, const vector<unsigned int>& inverse)
+bool modular_polynomial_determinant(const vector<vector<modular_term> >& entry, int n, int num_variables, vector<int>& degree, vector<string>& coefficient, int num_threads, unsigned int field_prime)
+bool modular_proper_multiple(const vector<vector<modular_term> >& entry, int n, const vector<string>& divisor, int num_threads)
+int modular_rank(vector<unsigned int>& A, int n, int m, unsigned int p)
+bool modular_residue(const string& value, unsigned int p, unsigned int& residue)
+bool modular_linear_solve(const vector<string>& A, int n, int m, const vector<string>& B, int c, vector<string>& X)
+
+ **************************************************************************/
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+extern ofstream     debug;
+
+#include <util.h>
+#include <debug-control.h>
+#include <bigint.h>
+#include <modular.h>
+
+/* the largest number of evaluation points we are prepared to use in modular_polynomial_determinant */
+#define MODULAR_GRID_LIMIT 1048576
+
+/* the largest number of primes modular_linear_solve uses to reconstruct a solution, and the number of primes that may be rejected 
+   because they divide a denominator or a minor of the coefficient matrix, before it gives up
+*/
+#define MODULAR_SOLVE_PRIMES	256
+#define MODULAR_SOLVE_FAILURES	4
+
+/* modular_prime may be called from several threads evaluating determinants in parallel, so the primes are found under prime_mutex */
+unsigned int modular_prime(int i)
+{
+	static vector<unsigned int> prime;
+	static mutex prime_mutex;
+	lock_guard<mutex> lock(prime_mutex);
+
+	while (static_cast<int>(prime.size()) <= i)
+	{
+		unsigned int candidate = (prime.size() == 0? 0x7FFFFFFF : prime.back()-2);
+
+		for (;; candidate -= 2)
+		{
+			bool is_prime = true;
+			for (unsigned int d = 3; d*d <= candidate; d+=2)
+			{
+				if (candidate % d == 0)
+				{
+					is_prime = false;
+					break;
+				}
+			}
+
+			if (is_prime)
+				break;
+		}
+
+		prime.push_back(candidate);
+	}
+
+	return prime[i];
+}
+
+unsigned int modular_inverse(unsigned int a, unsigned int p)
+{
+	long long r0 = p, r1 = a;
+	long long s0 = 0, s1 = 1;
+
+	while (r1 != 0)
+	{
+		long long q = r0/r1;
+		long long t = r0 - q*r1;
+		r0 = r1;
+		r1 = t;
+		t = s0 - q*s1;
+		s0 = s1;
+		s1 = t;
+	}
+
+	if (s0 < 0)
+		s0 += p;
+
+	return static_cast<unsigned int>(s0);
+}
+
+/* modular_axpy adds factor times the residues y[0], y[stride], ... to the 64-bit accumulators x[0], x[stride], ..., leaving them
+   unreduced.  The loop carries no dependencies between iterations, so the compiler may vectorise it when stride is 1.
+*/
+template <typename Y> inline void modular_axpy(unsigned long long* x, const Y* y, unsigned long long factor, int length, int stride=1)
+{
+	for (int j=0; j< length; j++)
+		x[j*stride] += factor * y[j*stride];
+}
+
+/* modular_elimination reduces the n x n matrix A, stored by row, to upper triangular form modulo p and returns its determinant.  
+   The rows below the pivot are held as 64-bit accumulators that are only reduced when a further row operation could overflow, 
+   as determined by R.lazy_limit, or when an entry is needed for the choice of pivot.  For all but the largest primes this means
+   the active part of the matrix is reduced only a few times during the elimination.
+*/
+static unsigned int modular_elimination(vector<unsigned long long>& A, int n, const modular_reducer& R)
+{
+	unsigned long long p = R.p;
+	unsigned long long det = 1;
+	unsigned long long pending = 0; // the number of row operations applied to the active rows since they were last reduced
+
+	for (int k=0; k< n; k++)
+	{
+		int pivot_row = -1;
+		for (int i=k; i< n; i++)
+		{
+			A[i*n+k] = R.reduce(A[i*n+k]);
+			if (pivot_row == -1 && A[i*n+k] != 0)
+				pivot_row = i;
+		}
+
+		if (pivot_row == -1)
+			return 0;
+
+		if (pivot_row != k)
+		{
+			for (int j=k; j< n; j++)
+				swap(A[k*n+j],A[pivot_row*n+j]);
+			det = p - det;
+		}
+
+		for (int j=k+1; j< n; j++)
+			A[k*n+j] = R.reduce(A[k*n+j]);
+
+		unsigned long long pivot = A[k*n+k];
+		det = R.multiply(det,pivot);
+
+		unsigned long long pivot_inverse = modular_inverse(pivot,p);
+
+		if (pending == R.lazy_limit)
+		{
+			for (int i=k+1; i< n; i++)
+			for (int j=k+1; j< n; j++)
+				A[i*n+j] = R.reduce(A[i*n+j]);
+			pending = 0;
+		}
+
+		for (int i=k+1; i< n; i++)
+		{
+			if (A[i*n+k] == 0)
+				continue;
+
+			unsigned long long factor = p - R.multiply(A[i*n+k],pivot_inverse);
+			modular_axpy(&A[i*n+k+1],&A[k*n+k+1],factor,n-k-1);
+		}
+		pending++;
+	}
+
+	return static_cast<unsigned int>(det);
+}
+
+unsigned int modular_determinant(vector<unsigned int>& A, int n, unsigned int p)
+{
+	modular_reducer R(p);
+	vector<unsigned long long> accumulator(A.begin(),A.end());
+	unsigned int det = modular_elimination(accumulator, n, R);
+	
+	for (int i=0; i< n*n; i++)
+		A[i] = R.reduce(accumulator[i]);
+		
+	return det;
+}
+
+/* modular_row_operation subtracts factor times the residues y[0], y[stride], ... from the residues x[0], x[stride], ... */
+static inline void modular_row_operation(unsigned int* x, const unsigned int* y, unsigned long long factor, int length, int stride, const modular_reducer& R)
+{
+	if (factor == 0)
+		return;
+		
+	unsigned long long negative_factor = R.p - factor;
+	for (int j=0; j< length; j++)
+		x[j*stride] = R.reduce(x[j*stride] + negative_factor * y[j*stride]);
+}
+
+/* The pivot search follows Smith_normal_form: look along the pivot row, then down the pivot column, then step down the diagonal 
+   and repeat.  Once the pivot has been scaled to 1 every division in Smith_normal_form is exact, so the quotients are simply the 
+   entries being cleared.
+*/
+int modular_Smith_normal_form(vector<unsigned int>& D, int n, int m, vector<unsigned int>& P, vector<unsigned int>& Q, unsigned int p)
+{
+	modular_reducer R(p);
+	
+	P = vector<unsigned int>(n*n,0);
+	for (int i=0; i< n; i++)
+		P[i*n+i] = 1;
+		
+	Q = vector<unsigned int>(m*m,0);
+	for (int i=0; i< m; i++)
+		Q[i*m+i] = 1;
+
+	int rank = 0;
+	
+	for (int pivot=0; pivot < n && pivot < m; pivot++)
+	{
+		if (D[pivot*m+pivot] == 0)
+		{
+			bool found_pivot = false;
+			int step = 0;
+			int r = pivot;
+			int c;
+			
+			do
+			{
+				for (c=pivot+step+1; c< m; c++)
+				{
+					if (D[r*m+c] != 0)
+					{
+						found_pivot = true;
+						break;
+					}
+				}
+				
+				if (!found_pivot)
+				{
+					c = pivot+step;
+					for (r=pivot+step+1; r< n; r++)
+					{
+						if (D[r*m+c] != 0)
+						{
+							found_pivot = true;
+							break;
+						}
+					}
+				}
+				
+				if (!found_pivot)
+				{
+					step++;
+					r = pivot+step;
+					c = pivot+step;
+					
+					if (r == n || c == m)
+						break;
+					else if (D[r*m+c] != 0)
+						found_pivot = true;
+				}
+			} while (!found_pivot);
+			
+			if (!found_pivot)
+				break;
+				
+			if (c != pivot)
+			{
+				for (int j=0; j< n; j++)
+					swap(D[j*m+pivot],D[j*m+c]);
+				for (int j=0; j< m; j++)
+					swap(Q[j*m+pivot],Q[j*m+c]);
+			}
+			
+			if (r != pivot)
+			{
+				for (int j=0; j< m; j++)
+					swap(D[pivot*m+j],D[r*m+j]);
+				for (int j=0; j< n; j++)
+					swap(P[pivot*n+j],P[r*n+j]);
+			}
+		}
+		
+		rank++;
+		
+		unsigned long long factor = D[pivot*m+pivot];
+		if (factor != 1)
+		{
+			unsigned long long factor_inverse = modular_inverse(factor,p);
+			for (int j=pivot; j< m; j++)
+				D[pivot*m+j] = R.multiply(D[pivot*m+j],factor_inverse);
+			for (int j=0; j< n; j++)
+				P[pivot*n+j] = R.multiply(P[pivot*n+j],factor_inverse);
+		}
+		
+		/* clear the pivot row with column operations, then the pivot column with row operations; since the pivot row is then 
+		   zero apart from the pivot the row operations leave it clear, so unlike the Euclidean case there is no need to return
+		   to the row.
+		*/
+		for (int j=pivot+1; j< m; j++)
+		{
+			unsigned long long quotient = D[pivot*m+j];
+			modular_row_operation(&D[pivot*m+j],&D[pivot*m+pivot],quotient,n-pivot,m,R);
+			modular_row_operation(&Q[j],&Q[pivot],quotient,m,m,R);
+		}
+		
+		for (int j=pivot+1; j< n; j++)
+		{
+			unsigned long long quotient = D[j*m+pivot];
+			modular_row_operation(&D[j*m],&D[pivot*m],quotient,m,1,R);
+			modular_row_operation(&P[j*n],&P[pivot*n],quotient,n,1,R);
+		}
+	}
+	
+	return rank;
+}
+
+/* We reduce [A|I] to reduced echelon form, so the right hand half becomes the inverse */
+bool modular_matrix_inverse(const vector<unsigned int>& A, int n, vector<unsigned int>& inverse, unsigned int p)
+{
+	modular_reducer R(p);
+	int width = 2*n;
+	vector<unsigned int> AI(n*width,0);
+	for (int i=0; i< n; i++)
+	{
+		for (int j=0; j< n; j++)
+			AI[i*width+j] = A[i*n+j];
+		AI[i*width+n+i] = 1;
+	}
+	
+	for (int k=0; k< n; k++)
+	{
+		int pivot_row = k;
+		while (pivot_row < n && AI[pivot_row*width+k] == 0)
+			pivot_row++;
+			
+		if (pivot_row == n)
+			return false;
+			
+		if (pivot_row != k)
+		{
+			for (int j=k; j< width; j++)
+				swap(AI[k*width+j],AI[pivot_row*width+j]);
+		}
+		
+		unsigned long long pivot_inverse = modular_inverse(AI[k*width+k],p);
+		for (int j=k; j< width; j++)
+			AI[k*width+j] = R.multiply(AI[k*width+j],pivot_inverse);
+			
+		for (int i=0; i< n; i++)
+		{
+			if (i != k)
+				modular_row_operation(&AI[i*width+k],&AI[k*width+k],AI[i*width+k],width-k,1,R);
+		}
+	}
+	
+	inverse = vector<unsigned int>(n*n);
+	for (int i=0; i< n; i++)
+	for (int j=0; j< n; j++)
+		inverse[i*n+j] = AI[i*width+n+j];
+		
+	return true;
+}
+
+/* Each row of C is accumulated as a combination of the rows of B in 64-bit accumulators, which are reduced only every R.lazy_limit
+   terms.
+*/
+void modular_matrix_product(const vector<unsigned int>& A, const vector<unsigned int>& B, int n, int k, int m, vector<unsigned int>& C, unsigned int p)
+{
+	modular_reducer R(p);
+	C = vector<unsigned int>(n*m);
+	vector<unsigned long long> row(m);
+	
+	for (int i=0; i< n; i++)
+	{
+		fill(row.begin(),row.end(),0);
+		unsigned long long pending = 0;
+		
+		for (int l=0; l< k; l++)
+		{
+			if (A[i*k+l] == 0)
+				continue;
+				
+			if (pending == R.lazy_limit)
+			{
+				for (int j=0; j< m; j++)
+					row[j] = R.reduce(row[j]);
+				pending = 0;
+			}
+			
+			modular_axpy(&row[0],&B[l*m],A[i*k+l],m);
+			pending++;
+		}
+		
+		for (int j=0; j< m; j++)
+			C[i*m+j] = R.reduce(row[j]);
+	}
+}
+
+/* We use Newton's divided differences at the points 0,1,...,num_points-1, so the denominators of the divided differences of
+   order j are all equal to j, and then expand the Newton form into the coefficients of the powers of x.
+*/
+void modular_interpolate(unsigned int* values, int num_points, int stride, unsigned int p, const vector<unsigned int>& inverse)
+{
+	modular_reducer R(p);
+	
+	for (int j=1; j< num_points; j++)
+	{
+		for (int i=num_points-1; i>= j; i--)
+		{
+			unsigned long long difference = values[i*stride] + p - values[(i-1)*stride];
+			values[i*stride] = R.multiply(difference,inverse[j]);
+		}
+	}
+
+	/* values now holds the Newton coefficients c_i of the product (x-0)...(x-(i-1)).  Evaluate c_0 + x(c_1 + (x-1)(c_2 + ...))
+	   from the inside out, holding the coefficients of the partial result in poly.
+	*/
+	vector<unsigned long long> poly(num_points,0);
+	poly[0] = values[(num_points-1)*stride];
+	for (int i=num_points-2; i>= 0; i--)
+	{
+		/* multiply poly, of degree num_points-2-i, by (x-i) and add c_i */
+		for (int d=num_points-1-i; d > 0; d--)
+			poly[d] = R.reduce(poly[d-1] + (p - static_cast<unsigned long long>(i) % p) * poly[d]);
+		poly[0] = R.reduce((p - static_cast<unsigned long long>(i) % p) * poly[0] + values[i*stride]);
+	}
+
+	for (int i=0; i< num_points; i++)
+		values[i*stride] = static_cast<unsigned int>(poly[i]);
+}
+
+/* the residue of a decimal integer string modulo p */
+static unsigned int modular_residue(const string& decimal, unsigned int p)
+{
+	unsigned long long r = 0;
+	size_t start = (decimal[0] == '-'? 1: 0);
+	for (size_t i=start; i< decimal.length(); i++)
+		r = (r*10 + (decimal[i]-'0')) % p;
+
+	if (start && r)
+		r = p - r;
+
+	return static_cast<unsigned int>(r);
+}
+
+static inline bigint residue_bigint(unsigned int r)
+{
+	return bigint(static_cast<unsigned long>(r));
+}
+
+/* modular_bounds checks that all the coefficients are integers and determines the degree bound for each variable, taking the 
+   smaller of the sum of the row maxima and the sum of the column maxima.  We also bound the size of the coefficients of the 
+   determinant by the product of the row sums of the absolute values of the coefficients, since the sum of the absolute values 
+   of the coefficients of a product of polynomials is at most the product of those sums.
+*/
+static bool modular_bounds(const vector<vector<modular_term> >& entry, int n, int num_variables, vector<int>& degree, vector<int>& max_exponent, double& log2_bound, bool& zero_row)
+{
+	vector<int> row_sum(num_variables,0);
+	vector<int> column_sum(num_variables,0);
+	max_exponent = vector<int>(num_variables,0);
+	log2_bound = 0;
+	zero_row = false;
+
+	for (int i=0; i< n; i++)
+	{
+		vector<int> row_max(num_variables,0);
+		vector<int> column_max(num_variables,0);
+		long double row_norm = 0;
+
+		for (int j=0; j< n; j++)
+		{
+			const vector<modular_term>& row_entry = entry[i*n+j];
+			const vector<modular_term>& column_entry = entry[j*n+i];
+
+			for (size_t t=0; t< row_entry.size(); t++)
+			{
+				const string& c = row_entry[t].coefficient;
+				size_t start = (c[0] == '-'? 1: 0);
+				if (c.length() == start || c.find_first_not_of("0123456789",start) != string::npos)
+				{
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_bounds: coefficient " << c << " is not an integer" << endl;
+					return false;
+				}
+
+				row_norm += fabsl(strtold(c.c_str(),0));
+
+				for (int v=0; v< num_variables; v++)
+				{
+					row_max[v] = max(row_max[v],row_entry[t].exponent[v]);
+					max_exponent[v] = max(max_exponent[v],row_entry[t].exponent[v]);
+				}
+			}
+
+			for (size_t t=0; t< column_entry.size(); t++)
+			{
+				for (int v=0; v< num_variables; v++)
+					column_max[v] = max(column_max[v],column_entry[t].exponent[v]);
+			}
+		}
+
+		for (int v=0; v< num_variables; v++)
+		{
+			row_sum[v] += row_max[v];
+			column_sum[v] += column_max[v];
+		}
+
+		if (row_norm == 0)
+			zero_row = true;
+		else
+			log2_bound += log2l(row_norm);
+	}
+
+	degree = vector<int>(num_variables);
+	for (int v=0; v< num_variables; v++)
+		degree[v] = min(row_sum[v],column_sum[v]);
+	
+	return true;
+}
+
+/* modular_residues evaluates the determinant modulo p at each point of the grid determined by the degree bounds and interpolates
+   along each variable in turn, so that residue[g] holds the coefficient whose exponents are encoded by g, with the first variable 
+   most significant.
+*/
+static void modular_residues(const vector<vector<modular_term> >& entry, int n, int num_variables, const vector<int>& degree, const vector<int>& max_exponent, 
+                             long grid_size, unsigned int p, vector<unsigned int>& residue, int num_threads)
+{
+	modular_reducer R(p);
+	
+	vector<vector<unsigned int> > coefficient_residue(n*n);
+	for (int e=0; e< n*n; e++)
+	{
+		coefficient_residue[e] = vector<unsigned int>(entry[e].size());
+		for (size_t t=0; t< entry[e].size(); t++)
+			coefficient_residue[e][t] = modular_residue(entry[e][t].coefficient,p);
+	}
+
+	/* power[v][x*(max_exponent[v]+1)+e] = x^e mod p */
+	vector<vector<unsigned int> > power(num_variables);
+	int max_degree = 0;
+	for (int v=0; v< num_variables; v++)
+	{
+		max_degree = max(max_degree,degree[v]);
+		
+		int width = max_exponent[v]+1;
+		power[v] = vector<unsigned int>((degree[v]+1)*width);
+		for (int x=0; x<= degree[v]; x++)
+		{
+			unsigned long long value = 1;
+			for (int e=0; e< width; e++)
+			{
+				power[v][x*width+e] = static_cast<unsigned int>(value);
+				value = R.multiply(value,x);
+			}
+		}
+	}
+
+	residue = vector<unsigned int>(grid_size);
+
+	/* evaluate the determinant at the grid points first <= g < last */
+	auto evaluate_points = [&](long first, long last)
+	{
+		vector<unsigned int> A(n*n);
+		vector<int> point(num_variables);
+
+		for (long g=first; g< last; g++)
+		{
+			long index = g;
+			for (int v=num_variables-1; v>= 0; v--)
+			{
+				point[v] = index % (degree[v]+1);
+				index /= degree[v]+1;
+			}
+
+			for (int e=0; e< n*n; e++)
+			{
+				unsigned long long value = 0;
+				for (size_t t=0; t< entry[e].size(); t++)
+				{
+					unsigned long long term = coefficient_residue[e][t];
+					for (int v=0; v< num_variables; v++)
+						term = R.multiply(term,power[v][point[v]*(max_exponent[v]+1)+entry[e][t].exponent[v]]);
+					value += term;
+				}
+				A[e] = R.reduce(value);
+			}
+
+			residue[g] = modular_determinant(A,n,p);
+		}
+	};
+
+	int num_workers = static_cast<int>(min(static_cast<long>(max(num_threads,1)),grid_size));
+	if (num_workers > 1)
+	{
+		vector<thread> worker;
+		for (int w=0; w< num_workers; w++)
+			worker.push_back(thread(evaluate_points, grid_size*w/num_workers, grid_size*(w+1)/num_workers));
+		for (int w=0; w< num_workers; w++)
+			worker[w].join();
+	}
+	else
+	{
+		evaluate_points(0,grid_size);
+	}
+
+	/* interpolate along each variable in turn */
+	vector<unsigned int> inverse(max_degree+1,0);
+	for (int j=1; j<= max_degree; j++)
+		inverse[j] = modular_inverse(j,p);
+
+	long stride = grid_size;
+	for (int v=0; v< num_variables; v++)
+	{
+		int num_points = degree[v]+1;
+		long outer_size = grid_size/stride;
+		stride /= num_points;
+
+		for (long outer=0; outer < outer_size; outer++)
+		for (long inner=0; inner < stride; inner++)
+			modular_interpolate(&residue[outer*num_points*stride+inner],num_points,stride,p,inverse);
+	}
+}
+
+bool modular_polynomial_determinant(const vector<vector<modular_term> >& entry, int n, int num_variables, vector<int>& degree, vector<string>& coefficient, int num_threads, unsigned int field_prime)
+{
+	vector<int> max_exponent;
+	double log2_bound;
+	bool zero_row;
+	
+	if (!modular_bounds(entry, n, num_variables, degree, max_exponent, log2_bound, zero_row))
+		return false;
+
+	long grid_size = 1;
+	for (int v=0; v< num_variables; v++)
+	{
+		grid_size *= degree[v]+1;
+
+		if (grid_size > MODULAR_GRID_LIMIT)
+		{
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_polynomial_determinant: evaluation grid exceeds " << MODULAR_GRID_LIMIT << " points" << endl;
+			return false;
+		}
+	}
+
+	if (field_prime != 0)
+	{
+		for (int v=0; v< num_variables; v++)
+		{
+			if (static_cast<unsigned int>(degree[v]) >= field_prime)
+			{
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_polynomial_determinant: too few residues modulo " << field_prime << " for degree bound " << degree[v] << endl;
+				return false;
+			}
+		}
+	}
+	
+	if (zero_row)
+	{
+		coefficient = vector<string>(grid_size,"0");
+		return true;
+	}
+
+	if (field_prime != 0)
+	{
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_polynomial_determinant: n = " << n << ", grid size " << grid_size << ", evaluating modulo " << field_prime << endl;
+
+		vector<unsigned int> residue;
+		modular_residues(entry, n, num_variables, degree, max_exponent, grid_size, field_prime, residue, num_threads);
+		
+		coefficient = vector<string>(grid_size);
+		for (long g=0; g< grid_size; g++)
+		{
+			ostringstream oss;
+			oss << residue[g];
+			coefficient[g] = oss.str();
+		}
+		return true;
+	}
+	
+	/* The primes exceed 2^30, so num_primes primes suffice to recover coefficients of absolute value less than 2^(30*num_primes-1).
+	   We use one more prime than necessary to guard against rounding in the calculation of log2_bound.
+	*/
+	int num_primes = static_cast<int>(log2_bound+1)/30 + 2;
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+{
+	debug << "modular_polynomial_determinant: n = " << n << ", degree bounds ";
+	for (int v=0; v< num_variables; v++)
+		debug << degree[v] << ' ';
+	debug << ", grid size " << grid_size << ", log2 coefficient bound " << log2_bound << ", using " << num_primes << " primes" << endl;
+}
+
+	vector<unsigned int> prime(num_primes);
+	for (int k=0; k< num_primes; k++)
+		prime[k] = modular_prime(k);
+
+	vector<vector<unsigned int> > residue(num_primes);
+
+	for (int k=0; k< num_primes; k++)
+		modular_residues(entry, n, num_variables, degree, max_exponent, grid_size, prime[k], residue[k], num_threads);
+
+	/* Reconstruct the coefficients from their residues using Garner's algorithm: the coefficient is first written in the mixed radix
+	   form d_0 + d_1 p_0 + d_2 p_0 p_1 + ..., then evaluated as a bigint and moved into the symmetric range about zero.
+	*/
+	vector<vector<unsigned int> > product_inverse(num_primes,vector<unsigned int>(num_primes)); // (p_0...p_{j-1})^-1 mod p_k
+	for (int k=1; k< num_primes; k++)
+	{
+		unsigned long long product = 1;
+		for (int j=0; j< k; j++)
+			product = product * prime[j] % prime[k];
+		product_inverse[k][k] = modular_inverse(static_cast<unsigned int>(product),prime[k]);
+	}
+
+	bigint modulus = 1;
+	for (int k=0; k< num_primes; k++)
+		modulus *= residue_bigint(prime[k]);
+	bigint half_modulus = modulus / bigint(2);
+
+	coefficient = vector<string>(grid_size);
+	vector<unsigned int> digit(num_primes);
+
+	for (long g=0; g< grid_size; g++)
+	{
+		bool zero = true;
+		for (int k=0; k< num_primes; k++)
+		{
+			/* evaluate d_0 + d_1 p_0 + ... + d_{k-1} p_0...p_{k-2} mod p_k */
+			unsigned int p = prime[k];
+			unsigned long long value = 0;
+			unsigned long long radix = 1;
+			for (int j=0; j< k; j++)
+			{
+				value = (value + digit[j] % p * radix) % p;
+				radix = radix * prime[j] % p;
+			}
+
+			unsigned long long difference = (residue[k][g] + p - value) % p;
+			digit[k] = static_cast<unsigned int>(k == 0? difference : difference * product_inverse[k][k] % p);
+
+			if (digit[k] != 0)
+				zero = false;
+		}
+
+		if (zero)
+		{
+			coefficient[g] = "0";
+			continue;
+		}
+
+		bigint value = residue_bigint(digit[num_primes-1]);
+		for (int k=num_primes-2; k>= 0; k--)
+		{
+			value *= residue_bigint(prime[k]);
+			value += residue_bigint(digit[k]);
+		}
+
+		if (value > half_modulus)
+			value -= modulus;
+
+		ostringstream oss;
+		oss << value;
+		coefficient[g] = oss.str();
+	}
+
+	return true;
+}
+
+/* The pseudo-remainder R of the determinant D on division by the divisor H satisfies lc(H)^k D = QH + R, with k = deg D - deg H + 1,
+   and H divides D over the rationals if and only if R is zero.  Each step of the pseudo-division multiplies the coefficients by at 
+   most |lc(H)| + max|H_i| <= 2 max|H_i|, so |R_i| <= B (2 max|H_i|)^k, where B is the coefficient bound of the determinant.  For a 
+   prime p not dividing lc(H), R is zero mod p exactly when H mod p divides D mod p, so once R is zero modulo enough primes to exceed 
+   twice this bound it is zero.  A single prime for which the remainder is non-zero shows that H does not divide D.
+*/
+bool modular_proper_multiple(const vector<vector<modular_term> >& entry, int n, const vector<string>& divisor, int num_threads)
+{
+	vector<int> degree;
+	vector<int> max_exponent;
+	double log2_bound;
+	bool zero_row;
+	
+	if (!modular_bounds(entry, n, 1, degree, max_exponent, log2_bound, zero_row))
+		return false;
+
+	if (zero_row)
+		return true;
+		
+	int divisor_degree = divisor.size()-1;
+	if (degree[0] <= divisor_degree || degree[0]+1 > MODULAR_GRID_LIMIT)
+		return false;
+
+	long double divisor_max = 0;
+	for (size_t i=0; i< divisor.size(); i++)
+	{
+		const string& c = divisor[i];
+		size_t start = (c[0] == '-'? 1: 0);
+		if (c.length() == start || c.find_first_not_of("0123456789",start) != string::npos)
+			return false;
+		divisor_max = max(divisor_max,fabsl(strtold(c.c_str(),0)));
+	}
+
+	double log2_remainder_bound = log2_bound + (degree[0]-divisor_degree+1) * log2l(2*divisor_max);
+	int num_primes = static_cast<int>(log2_remainder_bound+1)/30 + 2;
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_proper_multiple: n = " << n << ", degree bound " << degree[0] << ", divisor degree " << divisor_degree 
+	      << ", log2 remainder bound " << log2_remainder_bound << ", using " << num_primes << " primes" << endl;
+
+	int span = 0;
+	for (int k=0, used=0; used < num_primes; k++)
+	{
+		unsigned int p = modular_prime(k);
+		
+		vector<unsigned int> H(divisor.size());
+		for (size_t i=0; i< divisor.size(); i++)
+			H[i] = modular_residue(divisor[i],p);
+			
+		if (H[divisor_degree] == 0)
+			continue;
+		used++;
+		
+		vector<unsigned int> D;
+		modular_residues(entry, n, 1, degree, max_exponent, degree[0]+1, p, D, num_threads);
+		
+		/* the span of D mod p is a lower bound for the span of D */
+		int low = 0;
+		int high = degree[0];
+		while (low <= high && D[low] == 0)
+			low++;
+		while (high >= low && D[high] == 0)
+			high--;
+		span = max(span,high-low);
+		
+		/* the span of D is almost certainly no larger than that of D mod p, so there is little to be gained from continuing */
+		if (span <= divisor_degree)
+			return false;
+
+		/* reduce D modulo H */
+		unsigned long long lc_inverse = modular_inverse(H[divisor_degree],p);
+		for (int d=high; d>= divisor_degree; d--)
+		{
+			if (D[d] == 0)
+				continue;
+				
+			unsigned long long factor = D[d] * lc_inverse % p;
+			for (int i=0; i<= divisor_degree; i++)
+				D[d-divisor_degree+i] = static_cast<unsigned int>((D[d-divisor_degree+i] + (p - factor) * H[i]) % p);
+		}
+		
+		for (int d=0; d< divisor_degree; d++)
+		{
+			if (D[d] != 0)
+			{
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_proper_multiple: non-zero remainder modulo " << p << endl;
+				return false;
+			}
+		}
+	}
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_proper_multiple: determinant is a multiple of the divisor with span at least " << span << endl;
+
+	return true;
+}
+
+/* The rank is found by Gaussian elimination with row operations alone, taking the first non-zero entry in each column as the pivot */
+int modular_rank(vector<unsigned int>& A, int n, int m, unsigned int p)
+{
+	modular_reducer R(p);
+	int rank = 0;
+	
+	for (int c=0; c< m && rank < n; c++)
+	{
+		int pivot_row = rank;
+		while (pivot_row < n && A[pivot_row*m+c] == 0)
+			pivot_row++;
+			
+		if (pivot_row == n)
+			continue;
+			
+		if (pivot_row != rank)
+		{
+			for (int j=c; j< m; j++)
+				swap(A[rank*m+j],A[pivot_row*m+j]);
+		}
+		
+		unsigned long long pivot_inverse = modular_inverse(A[rank*m+c],p);
+		for (int i=rank+1; i< n; i++)
+		{
+			if (A[i*m+c] != 0)
+				modular_row_operation(&A[i*m+c],&A[rank*m+c],R.multiply(A[i*m+c],pivot_inverse),m-c,1,R);
+		}
+		rank++;
+	}
+	
+	return rank;
+}
+
+bool modular_residue(const string& value, unsigned int p, unsigned int& residue)
+{
+	size_t slash = value.find('/');
+	if (slash == string::npos)
+	{
+		residue = modular_residue(value,p);
+		return true;
+	}
+	
+	unsigned int denominator = modular_residue(value.substr(slash+1),p);
+	if (denominator == 0)
+		return false;
+	
+	residue = static_cast<unsigned int>(static_cast<unsigned long long>(modular_residue(value.substr(0,slash),p)) * modular_inverse(denominator,p) % p);
+	return true;
+}
+
+/* modular_solve reduces [A|B] modulo p to reduced echelon form, returning false if A does not have rank m or the system is inconsistent 
+   modulo p.  Otherwise X is set to the first m rows of the reduced right hand block.
+*/
+static bool modular_solve(vector<unsigned int>& AB, int n, int m, int c, vector<unsigned int>& X, unsigned int p)
+{
+	modular_reducer R(p);
+	int width = m+c;
+	
+	for (int k=0; k< m; k++)
+	{
+		int pivot_row = k;
+		while (pivot_row < n && AB[pivot_row*width+k] == 0)
+			pivot_row++;
+			
+		if (pivot_row == n)
+			return false;
+			
+		if (pivot_row != k)
+		{
+			for (int j=k; j< width; j++)
+				swap(AB[k*width+j],AB[pivot_row*width+j]);
+		}
+		
+		unsigned long long pivot_inverse = modular_inverse(AB[k*width+k],p);
+		for (int j=k; j< width; j++)
+			AB[k*width+j] = R.multiply(AB[k*width+j],pivot_inverse);
+			
+		for (int i=0; i< n; i++)
+		{
+			if (i != k)
+				modular_row_operation(&AB[i*width+k],&AB[k*width+k],AB[i*width+k],width-k,1,R);
+		}
+	}
+	
+	for (int i=m; i< n; i++)
+	for (int j=m; j< width; j++)
+	{
+		if (AB[i*width+j] != 0)
+			return false;
+	}
+	
+	X = vector<unsigned int>(m*c);
+	for (int i=0; i< m; i++)
+	for (int j=0; j< c; j++)
+		X[i*c+j] = AB[i*width+m+j];
+		
+	return true;
+}
+
+/* rational_reconstruction finds the rational a/b congruent to u modulo the given modulus with |a| and |b| less than the square root 
+   of half the modulus, using the extended Euclidean algorithm, and returns false if there is no such rational.
+*/
+static bool rational_reconstruction(const bigint& u, const bigint& modulus, bigint& a, bigint& b)
+{
+	bigint r0 = modulus;
+	bigint r1 = u;
+	bigint t0 = 0;
+	bigint t1 = 1;
+	
+	while (bigint(2)*r1*r1 >= modulus)
+	{
+		bigint q = r0/r1;
+		bigint r = r0 - q*r1;
+		r0 = r1;
+		r1 = r;
+		bigint t = t0 - q*t1;
+		t0 = t1;
+		t1 = t;
+	}
+	
+	if (bigint(2)*t1*t1 >= modulus || gcd(r1,t1) != bigint(1))
+		return false;
+		
+	if (t1 < bigint(0))
+	{
+		a = bigint(0) - r1;
+		b = bigint(0) - t1;
+	}
+	else
+	{
+		a = r1;
+		b = t1;
+	}
+	return true;
+}
+
+/* The solution modulo each prime is combined with those found previously by the Chinese remainder theorem, held as a bigint for each 
+   entry of X, and a rational reconstruction is attempted.  The reconstruction is accepted when it agrees with the solution modulo the
+   next prime, the number of primes needed is then determined by the size of the entries of X, rather than by an a priori bound.
+*/
+bool modular_linear_solve(const vector<string>& A, int n, int m, const vector<string>& B, int c, vector<string>& X)
+{
+	if (m > n)
+		return false;
+		
+	int width = m+c;
+	int num_entries = m*c;
+	
+	vector<bigint> value(num_entries);
+	bigint modulus = 1;
+	int num_primes = 0;
+	int num_failures = 0;
+	
+	vector<string> candidate;
+	vector<bigint> numerator;
+	vector<bigint> denominator;
+		
+	for (int k=0; num_primes < MODULAR_SOLVE_PRIMES; k++)
+	{
+		unsigned int p = modular_prime(k);
+
+		vector<unsigned int> AB(n*width);
+		bool good_prime = true;
+		for (int i=0; i< n && good_prime; i++)
+		{
+			for (int j=0; j< m && good_prime; j++)
+				good_prime = modular_residue(A[i*m+j],p,AB[i*width+j]);
+			for (int j=0; j< c && good_prime; j++)
+				good_prime = modular_residue(B[i*c+j],p,AB[i*width+m+j]);
+		}
+		
+		vector<unsigned int> residue;
+		if (!good_prime || !modular_solve(AB, n, m, c, residue, p))
+		{
+			/* a handful of primes may divide a denominator or a non-zero minor of A, more than that indicates there is no solution */
+			if (++num_failures > MODULAR_SOLVE_FAILURES)
+				return false;
+			continue;
+		}
+				
+		if (candidate.size() != 0)
+		{
+			bool agree = true;
+			for (int e=0; e< num_entries && agree; e++)
+			{
+				bigint b = denominator[e] % bigint(static_cast<unsigned long>(p));
+				bigint a = numerator[e] % bigint(static_cast<unsigned long>(p));
+				if (a < bigint(0))
+					a += bigint(static_cast<unsigned long>(p));
+				agree = (static_cast<unsigned long long>(int(a)) == static_cast<unsigned long long>(int(b)) * residue[e] % p);
+			}
+			
+			if (agree)
+			{
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_linear_solve: " << n << " by " << m << " system with " << c << " right hand sides solved using " << num_primes+1 << " primes" << endl;
+				X = candidate;
+				return true;
+			}
+		}
+		
+		/* combine the residues with value modulo modulus */
+		bigint p_bigint = residue_bigint(p);
+		unsigned int modulus_inverse = modular_inverse(int(bigint(modulus % p_bigint)),p);
+		for (int e=0; e< num_entries; e++)
+		{
+			unsigned long long current = int(bigint(value[e] % p_bigint));
+			unsigned long long difference = (residue[e] + p - current) % p * modulus_inverse % p;
+			if (difference != 0)
+				value[e] += modulus * residue_bigint(static_cast<unsigned int>(difference));
+		}
+		modulus *= p_bigint;
+		num_primes++;
+		
+		candidate.clear();
+		numerator = vector<bigint>(num_entries);
+		denominator = vector<bigint>(num_entries);
+		for (int e=0; e< num_entries; e++)
+		{
+			if (!rational_reconstruction(value[e], modulus, numerator[e], denominator[e]))
+			{
+				candidate.clear();
+				break;
+			}
+			
+			ostringstream oss;
+			oss << numerator[e];
+			if (denominator[e] != bigint(1))
+				oss << '/' << denominator[e];
+			candidate.push_back(oss.str());
+		}
+	}
+
+if (debug_control::DEBUG >= debug_control::BASIC)
+	debug << "modular_linear_solve: no solution reconstructed from " << num_primes << " primes" << endl;
+
+	return false;
+}
@@ -1125,15 +1125,15 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 			
 		}
 
-		/* write the modified code to a string */
-		ostringstream oss;
-		write_code_data (oss, code_data);
-
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "remove_edge_flags_from_peer_code: new peer code = " << oss.str() << endl;
+{
+	debug << "remove_edge_flags_from_peer_code: new peer code = ";
+	write_code_data (debug, code_data);
+	debug << endl;
+}
 	
-		/* read back the peer code into code_data */
-		read_peer_code(code_data, oss.str());
+		/* rebuild the rest of the code data for the modified peer code */
+		rebuild_peer_code_data(code_data);
 		
 		/* if we're dealing with a knotoid, we need to reset the shortcut crossings, do this by using
 		   valid_knotoid_input, which will assign a new vector to code_data.shortcut crossing, thereby
@@ -4767,17 +4767,17 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 					for (int i=0; i< code_data.num_crossings; i++)
 						code_data.num_component_edges[i] = new_last_component_edge[i] - new_first_component_edge[i]+1;
 					
-					/* write the modified code to a string */
-					ostringstream oss;
-					write_code_data (oss, code_data);
-				
 if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "remove_Reidemeister_II: new peer code with head cleared = " << oss.str() << endl;
+{
+	debug << "remove_Reidemeister_II: new peer code with head cleared = ";
+	write_code_data (debug, code_data);
+	debug << endl;
+}
 					
-					/* read back the peer code into code_data */
-					read_peer_code(code_data, oss.str());
+					/* rebuild the rest of the code data for the modified peer code */
+					rebuild_peer_code_data(code_data);
 				
-					/* We can't set the head until we have the generic_code_data::table::EPEER row of the code table, which is completed by read_peer_code,
+					/* We can't set the head until we have the generic_code_data::table::EPEER row of the code table, which is completed by rebuild_peer_code_data,
 					   so have to set both the head and the immersion character manually here.
 					
 					   If new_head_semi_arc == 0, we have already cleared pure_knotoid_code_data 
@@ -5505,37 +5505,8 @@ if (debug_control::DEBUG >= debug_control::DETAIL)
 	debug << endl;
 }
 
-	ostringstream oss;
-	int index = 0;
-	
-	for (int i=0; i< num_components; i++)
-	{
-		for (int j=0; j<num_terms_in_component[i]; j++)
-		{
-			oss << new_gauss_data[index++];
-			if (j < num_terms_in_component[i] -1)
-				oss << ' ';
-		}
-		
-		if (i < num_components-1)
-			oss << ',';
-	}
-	
-	oss << '/';
-	
-	for (int i=0; i< num_terms/2; i++)
-	{
-		if (crossing_sign[i] > 0)
-			oss << "+ ";
-		else
-			oss << "- ";
-	}	
-		
-if (debug_control::DEBUG >= debug_control::DETAIL)
-	debug << "Reidemeister_III_move: oss.str() =  " << oss.str() << endl;
-
 	generic_code_data updated_gauss_code_data;
-	read_gauss_code(updated_gauss_code_data,oss.str());
+	assign_gauss_code_data(updated_gauss_code_data, new_gauss_data, num_terms_in_component, crossing_sign);
 	
 	if (code_data.type == generic_code_data::peer_code)
 	{
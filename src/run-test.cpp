@@ -22,7 +22,7 @@ options and any that appear in the specified #test directive and returns the fil
 result, as given by the #result directive corresponding to the <test-name.
 
 The _tmpfile is then passed to the braid proramme via a system call and the braid.out file compared to the
-result file using diff.  The failure of a test does not halt operation, run-test just proceeds to the next 
+result file using diff, ignoring the running time reported when the output is not raw.  The failure of a test does not halt operation, run-test just proceeds to the next 
 test.
 
 Using the command line option --suite, run-test can run a suite of test scripts listed in a file <suite-name>
@@ -351,7 +351,8 @@ if (debug_control::DEBUG >= debug_control::SUMMARY)
 			{
 				rf.close();
 
-				string command = "diff braid.out " + result_file + " > _diff_output";
+				/* the running time reported when the output is not raw depends on the machine, so it is ignored */
+				string command = "diff -I '^Running time' braid.out " + result_file + " > _diff_output";
 
 if (debug_control::DEBUG >= debug_control::SUMMARY)
 	debug << "run-test: bash command string = " << command << endl;
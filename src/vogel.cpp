@@ -855,8 +855,8 @@ if (braid_control::VOGEL_DEBUG)
 
 			new_code_data.code_table = new_code_table;
 			
-			/* write the peer code to an ostringstream and read it back into 
-			   code_data ready for the next loop
+			/* complete the rest of the code data for the new peer code in place and 
+			   copy it to code_data ready for the next loop
 			*/
 if (braid_control::VOGEL_DEBUG)
 {
@@ -865,11 +865,8 @@ if (braid_control::VOGEL_DEBUG)
 	debug << "\nvogel: new_code_data = ";
 	write_peer_code(debug, new_code_data);
 }
-			ostringstream oss;
-			write_peer_code(oss, new_code_data);
-			read_peer_code(code_data, oss.str());
-
-dev_str = oss.str();
+			rebuild_peer_code_data(new_code_data);
+			code_data = new_code_data;
 		
 			/* increase num_crossings and reset num_edges*/
 			num_crossings += 2;
@@ -896,8 +893,10 @@ if (braid_control::VOGEL_DEBUG)
 		debug << new_code_table[generic_code_data::table::COMPONENT][i] << ' ';
 	debug << endl;
 
-	debug << "vogel: peer code written from new_code_table: " << oss.str() << endl;
-	debug << "vogel: new code data after reading new peer_code: " << endl;
+	debug << "vogel: peer code written from new_code_table: ";
+	write_peer_code(debug, code_data);
+	debug << endl;
+	debug << "vogel: new code data after rebuilding new peer_code: " << endl;
 	print_code_data(debug,code_data,"vogel: ");
 }
 			if (braid_control::EXTRA_OUTPUT)